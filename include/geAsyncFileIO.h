@@ -0,0 +1,211 @@
+/*****************************************************************************/
+/**
+ * @file    geAsyncFileIO.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Asynchronous, batched file reads and writes.
+ *
+ * Asynchronous, batched file reads and writes. On Linux the requests are
+ * submitted to the kernel through io_uring, so hundreds of them can be in
+ * flight without tying up a thread each. Elsewhere, or if the kernel doesn't
+ * support io_uring, they are executed by a small set of dedicated I/O
+ * threads.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geModule.h"
+#include "geAsyncOp.h"
+#include "geThreadPool.h"
+
+namespace geEngineSDK {
+  using std::function;
+
+  namespace ASYNC_IO_OP {
+    enum E {
+      kREAD = 0,
+      kWRITE
+    };
+  }
+
+  /**
+   * @brief Outcome of an asynchronous read or write.
+   */
+  struct AsyncIOResult
+  {
+    /**
+     * Number of bytes read or written. Reads that reach the end of the file
+     * transfer less bytes than requested, and still succeed.
+     */
+    SIZE_T bytesTransferred = 0;
+
+    /**
+     * False if the file couldn't be opened, or the operation failed.
+     */
+    bool success = false;
+  };
+
+  /**
+   * @brief Single read or write of a range of a file.
+   */
+  struct AsyncIORequest
+  {
+    Path path;
+    ASYNC_IO_OP::E operation = ASYNC_IO_OP::kREAD;
+
+    /**
+     * Memory to read into, or to write from. Must stay valid until the
+     * operation completes.
+     */
+    void* buffer = nullptr;
+    SIZE_T size = 0;
+    uint64 offset = 0;
+
+    /**
+     * Optional callback triggered when the operation completes. Runs on the
+     * TaskScheduler if it's started, otherwise on an I/O thread. It may
+     * submit more requests, but must not call waitUntilIdle().
+     */
+    function<void(const AsyncIOResult&)> callback;
+  };
+
+  /**
+   * @brief Executes file reads and writes asynchronously, in batches.
+   *
+   * Each submitted request returns an AsyncOp that completes with an
+   * AsyncIOResult. Writes create the file if it doesn't exist, but never
+   * truncate it.
+   * @note  Thread safe.
+   * @note  Requires the ThreadPool to be started.
+   */
+  class GE_UTILITIES_EXPORT AsyncFileIO : public Module<AsyncFileIO>
+  {
+   public:
+    /**
+     * @param[in] queueDepth  Maximum number of operations in flight at once.
+     *            Submitting more blocks the caller until some complete,
+     *            except from callbacks running on an I/O thread, where the
+     *            operations are queued until a slot is free.
+     * @param[in] numThreads  Number of I/O threads used when io_uring isn't
+     *            available.
+     * @param[in] allowIOUring  If false the I/O threads are always used.
+     */
+    AsyncFileIO(uint32 queueDepth = 256,
+                uint32 numThreads = 4,
+                bool allowIOUring = true);
+    ~AsyncFileIO();
+
+    /**
+     * @brief Queues a single read or write.
+     */
+    AsyncOp
+    submit(const AsyncIORequest& request);
+
+    /**
+     * @brief Queues a batch of reads and writes, handing them to the kernel
+     *        with as few system calls as possible.
+     * @return  One AsyncOp per request, in the same order.
+     */
+    Vector<AsyncOp>
+    submit(const Vector<AsyncIORequest>& requests);
+
+    /**
+     * @brief Loads a whole file into memory.
+     * @param[in] path  Path of the file to read.
+     * @param[in] callback  Optional callback triggered with the loaded data,
+     *            or null if the file couldn't be read. Runs on the same
+     *            threads as the request callbacks.
+     * @return  AsyncOp that completes with a SPtr<DataStream> holding a
+     *          MemoryDataStream with the file contents, or null on failure.
+     */
+    AsyncOp
+    readFileAsync(const Path& path,
+                  function<void(const SPtr<DataStream>&)> callback = nullptr);
+
+    /**
+     * @brief Blocks until all the submitted operations have completed.
+     *        Callbacks queued on the TaskScheduler may still be running.
+     */
+    void
+    waitUntilIdle();
+
+    /**
+     * @brief Returns the number of operations submitted that haven't
+     *        completed yet.
+     */
+    uint32
+    getNumPending() const;
+
+    /**
+     * @brief Returns true if the operations are executed through io_uring.
+     */
+    bool
+    isUsingIOUring() const {
+      return nullptr != m_ring;
+    }
+
+   private:
+    struct PendingIO;
+    struct IOUring;
+
+    /**
+     * @brief Creates the tracking data of a request, taking a free slot of
+     *        the queue. If there are none, waits for one if @p block is true
+     *        or returns null otherwise.
+     */
+    PendingIO*
+    createPending(const Path& path, ASYNC_IO_OP::E operation, bool block);
+
+    /**
+     * @brief Starts executing a batch of operations created by
+     *        createPending().
+     */
+    void
+    start(PendingIO** operations, uint32 count);
+
+    /**
+     * @brief Finishes an operation, completing its AsyncOp and triggering
+     *        its callbacks.
+     */
+    void
+    complete(PendingIO* operation);
+
+    /**
+     * @brief Executes an operation synchronously on an I/O thread.
+     */
+    void
+    execute(PendingIO* operation);
+
+    /**
+     * @brief Main loop of the I/O threads.
+     */
+    void
+    runWorker();
+
+    IOUring* m_ring = nullptr;
+    HThread m_completionThread;
+    Vector<HThread> m_workers;
+    Deque<PendingIO*> m_queue;
+
+    Deque<PendingIO*> m_waiting;
+
+    uint32 m_queueDepth;
+    uint32 m_numInFlight = 0;
+    uint32 m_numPending = 0;
+    bool m_shutdown = false;
+
+    mutable Mutex m_mutex;
+    Mutex m_createMutex;
+    Signal m_queueCond;
+    Signal m_slotCond;
+    Signal m_idleCond;
+  };
+}
@@ -0,0 +1,531 @@
+/*****************************************************************************/
+/**
+ * @file    geAsyncLog.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Logs messages formatting them on a background thread.
+ *
+ * While the AsyncLog module is started GE_LOG doesn't format the messages.
+ * It writes a compact record, with the call site, a timestamp and the raw
+ * bytes of the arguments, to a lock-free ring buffer owned by the calling
+ * thread. A background thread reads the records of all the threads in the
+ * order they were logged, formats them and sends them to the Debug log.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geLog.h"
+#include "geBinaryLog.h"
+#include "geModule.h"
+
+#include <atomic>
+#include <string_view>
+#include <tuple>
+
+namespace geEngineSDK {
+  using std::atomic;
+  using std::decay_t;
+  using std::remove_reference_t;
+
+  namespace LOG_ARG_TYPE {
+    enum E {
+      /**
+       * Copied bitwise, and converted to text on the logging thread.
+       */
+      kRAW = 0,
+
+      /**
+       * Strings. Their characters are copied.
+       */
+      kSTRING,
+
+      /**
+       * Anything else. Converted to text on the calling thread.
+       */
+      kCONVERTED
+    };
+  }
+
+  /**
+   * @brief Characters of a string argument, copied to the record as is.
+   */
+  struct LogStringRef
+  {
+    const ANSICHAR* data;
+    uint32 size;
+  };
+
+  /**
+   * @brief Message of a GE_LOG given as a string literal. Only its address
+   *        is stored in the record. GE_LOG wraps the messages spelled as
+   *        string literals in it, see ge_logMessageArg().
+   */
+  struct LogLiteral
+  {
+    const ANSICHAR* data;
+  };
+
+  /**
+   * @brief Determines how an argument of a GE_LOG is stored in a record.
+   */
+  template<class T>
+  struct LogArgTraits
+  {
+    using Type = decay_t<T>;
+
+    static_assert(!std::is_pointer<Type>::value ||
+                  std::is_same<Type, const ANSICHAR*>::value ||
+                  std::is_same<Type, ANSICHAR*>::value,
+                  "Invalid pointer type.");
+
+    static CONSTEXPR LOG_ARG_TYPE::E value =
+      (std::is_same<Type, const ANSICHAR*>::value ||
+       std::is_same<Type, ANSICHAR*>::value ||
+       std::is_same<Type, String>::value) ? LOG_ARG_TYPE::kSTRING :
+      (std::is_trivially_copyable<Type>::value &&
+       std::is_default_constructible<Type>::value) ? LOG_ARG_TYPE::kRAW :
+                                                     LOG_ARG_TYPE::kCONVERTED;
+  };
+
+  /**
+   * @brief Captures an argument of a GE_LOG on the calling thread, and reads
+   *        it back from the record on the logging thread.
+   */
+  template<class T, LOG_ARG_TYPE::E = LogArgTraits<T>::value>
+  struct LogArg;
+
+  template<class T>
+  struct LogArg<T, LOG_ARG_TYPE::kRAW>
+  {
+    using Type = typename LogArgTraits<T>::Type;
+    using Decoded = Type;
+
+    static const Type&
+    capture(const Type& value) {
+      return value;
+    }
+
+    static Type
+    read(const uint8*& data) {
+      Type value;
+      memcpy(&value, data, sizeof(Type));
+      data += sizeof(Type);
+      return value;
+    }
+  };
+
+  template<class T>
+  struct LogArg<T, LOG_ARG_TYPE::kSTRING>
+  {
+    using Decoded = String;
+
+    static LogStringRef
+    capture(const ANSICHAR* value) {
+      if (nullptr == value) {
+        return { "", 0 };
+      }
+      return { value, static_cast<uint32>(strlen(value)) };
+    }
+
+    static LogStringRef
+    capture(const String& value) {
+      return { value.data(), static_cast<uint32>(value.size()) };
+    }
+
+    static String
+    read(const uint8*& data) {
+      uint32 size;
+      memcpy(&size, data, sizeof(size));
+      String value(reinterpret_cast<const ANSICHAR*>(data + sizeof(size)), size);
+      data += sizeof(size) + size;
+      return value;
+    }
+  };
+
+  template<class T>
+  struct LogArg<T, LOG_ARG_TYPE::kCONVERTED>
+  {
+    using Type = typename LogArgTraits<T>::Type;
+    using Decoded = String;
+
+    static String
+    capture(const Type& value) {
+      return geEngineSDK::toString(value);
+    }
+
+    static String
+    read(const uint8*& data) {
+      return LogArg<String>::read(data);
+    }
+  };
+
+  /**
+   * @brief Captures the message of a GE_LOG. String literals, wrapped in a
+   *        LogLiteral, are stored by address. Anything else is copied as any
+   *        other argument, including character arrays that may not outlive
+   *        the call.
+   */
+  template<class T, bool = std::is_same<decay_t<T>, LogLiteral>::value>
+  struct LogMessageArg : LogArg<T>
+  {};
+
+  template<class T>
+  struct LogMessageArg<T, true>
+  {
+    using Decoded = const ANSICHAR*;
+
+    static const LogLiteral&
+    capture(const LogLiteral& value) {
+      return value;
+    }
+
+    static const ANSICHAR*
+    read(const uint8*& data) {
+      const ANSICHAR* value;
+      memcpy(&value, data, sizeof(value));
+      data += sizeof(value);
+      return value;
+    }
+  };
+
+  /**
+   * @brief Writes the captured arguments of a GE_LOG to a record.
+   */
+  struct LogRecordArgs
+  {
+    template<class T>
+    static SIZE_T
+    getSize(const T&) {
+      return sizeof(T);
+    }
+
+    static SIZE_T
+    getSize(const LogStringRef& value) {
+      return sizeof(uint32) + value.size;
+    }
+
+    static SIZE_T
+    getSize(const String& value) {
+      return sizeof(uint32) + value.size();
+    }
+
+    template<class T>
+    static void
+    write(uint8*& data, const T& value) {
+      memcpy(data, &value, sizeof(T));
+      data += sizeof(T);
+    }
+
+    static void
+    write(uint8*& data, const LogStringRef& value) {
+      memcpy(data, &value.size, sizeof(value.size));
+      memcpy(data + sizeof(value.size), value.data, value.size);
+      data += sizeof(value.size) + value.size;
+    }
+
+    static void
+    write(uint8*& data, const String& value) {
+      write(data, LogStringRef{ value.data(), static_cast<uint32>(value.size()) });
+    }
+
+    static void
+    write(uint8*& data, const LogLiteral& value) {
+      memcpy(data, &value.data, sizeof(value.data));
+      data += sizeof(value.data);
+    }
+
+    /**
+     * @brief Combines the hash of a captured argument with @p seed. Used to
+     *        find repeated messages without formatting them. The bytes of
+     *        a value are only hashed if they have no padding, which isn't
+     *        guaranteed to be the same for equal values.
+     */
+    template<class T>
+    static void
+    hash(SIZE_T& seed, const T& value) {
+      IF_CONSTEXPR (std::has_unique_object_representations<T>::value) {
+        ge_hash_combine(seed, std::string_view(reinterpret_cast<const ANSICHAR*>(&value),
+                                               sizeof(T)));
+      }
+      else IF_CONSTEXPR (std::is_enum<T>::value ||
+                         std::is_default_constructible<std::hash<T>>::value) {
+        ge_hash_combine(seed, value);
+      }
+      else {
+        ge_hash_combine(seed, geEngineSDK::toString(value));
+      }
+    }
+
+    static void
+    hash(SIZE_T& seed, const LogStringRef& value) {
+      ge_hash_combine(seed, std::string_view(value.data, value.size));
+    }
+
+    static void
+    hash(SIZE_T& seed, const String& value) {
+      ge_hash_combine(seed, std::string_view(value.data(), value.size()));
+    }
+
+    static void
+    hash(SIZE_T& seed, const LogLiteral& value) {
+      ge_hash_combine(seed, reinterpret_cast<const void*>(value.data));
+    }
+  };
+
+  /**
+   * @brief Formats the message of a record written by a GE_LOG with the
+   *        given message and argument types, or encodes it for a binary log.
+   */
+  template<class Message, class... Args>
+  struct LogFormatter
+  {
+    static String
+    format(const uint8* data) {
+      auto message = LogMessageArg<Message>::read(data);
+
+      //Braced initialization reads the arguments in order
+      std::tuple<typename LogArg<Args>::Decoded...> values{ LogArg<Args>::read(data)... };
+      return std::apply([&message](const auto&... args) {
+                          return StringUtil::format(message, args...);
+                        },
+                        values);
+    }
+
+    static void
+    encode(const uint8* data, BinaryLogArgs& output) {
+      output.writeMessage(LogMessageArg<Message>::read(data));
+
+      //The comma operator writes the arguments in order
+      (output.write(LogArg<Args>::read(data)), ...);
+    }
+  };
+
+  /**
+   * @brief Returns true if the spelling of a GE_LOG message, as stringized
+   *        by the preprocessor, is a string literal or several concatenated
+   *        ones.
+   */
+  template<SIZE_T N>
+  CONSTEXPR bool
+  ge_isStringLiteral(const ANSICHAR (&spelling)[N]) {
+    return N >= 3 && '"' == spelling[0] && '"' == spelling[N - 2];
+  }
+
+  /**
+   * @brief Wraps the message of a GE_LOG in a LogLiteral if it's a string
+   *        literal, so only its address is stored. The type of a character
+   *        array doesn't tell if it's a literal, so GE_LOG checks how the
+   *        message is spelled instead.
+   */
+  template<bool isLiteral, class T>
+  decltype(auto)
+  ge_logMessageArg(T&& message) {
+    IF_CONSTEXPR (isLiteral && std::is_array<remove_reference_t<T>>::value) {
+      return LogLiteral{ message };
+    }
+    else {
+      return std::forward<T>(message);
+    }
+  }
+
+  /**
+   * @brief Returns the text of a message returned by ge_logMessageArg().
+   */
+  template<class T>
+  decltype(auto)
+  ge_logMessageText(T&& message) {
+    IF_CONSTEXPR (std::is_same<decay_t<T>, LogLiteral>::value) {
+      return message.data;
+    }
+    else {
+      return std::forward<T>(message);
+    }
+  }
+
+  /**
+   * @brief Returns the formatter of a GE_LOG with the given arguments. Only
+   *        used through decltype, so the arguments aren't evaluated.
+   */
+  template<class Message, class... Args>
+  LogFormatter<Message, Args...>
+  ge_logFormatterOf(Message&&, Args&&...);
+
+  /**
+   * @brief Options used to start the AsyncLog.
+   */
+  struct AsyncLogOptions
+  {
+    /**
+     * Size in bytes of the ring buffer of each thread. Rounded up to a
+     * power of two. Messages too big for a quarter of it are logged
+     * synchronously.
+     */
+    uint32 bufferSize = 256 * 1024;
+
+    /**
+     * Maximum time records wait in the buffers before being formatted.
+     */
+    uint32 flushIntervalMs = 10;
+
+    /**
+     * If true threads wait for the logging thread when their buffer is full.
+     * Otherwise the message is dropped.
+     */
+    bool blockWhenFull = true;
+
+    /**
+     * Messages this important or more are logged synchronously, once all
+     * the previous ones were, so they are in the log if the application
+     * crashes right after.
+     */
+    LogVerbosity syncVerbosity = LogVerbosity::kFatal;
+
+    /**
+     * If set, messages are written to it with their arguments instead of
+     * formatted and sent to the Debug log. It's also added as a sink of the
+     * Debug log while the module is started, for the messages logged
+     * synchronously.
+     */
+    SPtr<BinaryLogSink> binaryLog;
+  };
+
+  class LogRingBuffer;
+
+  /**
+   * @brief Formats the messages logged by GE_LOG on a background thread.
+   *        Messages are sent to the Debug log in the order they were
+   *        logged, a few milliseconds after it.
+   * @note  Thread safe.
+   * @note  Messages still in the buffers are logged when the module is shut
+   *        down, or flush() is called.
+   */
+  class GE_UTILITIES_EXPORT AsyncLog : public Module<AsyncLog>
+  {
+   public:
+    explicit AsyncLog(const AsyncLogOptions& options = AsyncLogOptions());
+    ~AsyncLog();
+
+    /**
+     * @brief Blocks until all the messages logged before the call are sent
+     *        to the Debug log.
+     */
+    void
+    flush();
+
+    /**
+     * @brief Returns the number of messages dropped because the buffer of
+     *        their thread was full.
+     */
+    uint64
+    getNumDropped() const {
+      return m_numDropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns true if messages are being logged asynchronously.
+     */
+    static bool
+    isActive() {
+      return s_active.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Writes a record with the captured arguments of a GE_LOG.
+     * @return  False if the message must be logged synchronously instead.
+     * @note  Internal method.
+     */
+    template<class... Captured>
+    static bool
+    _write(const LogCallSite& site, const Captured&... captured) {
+      uint8* data = nullptr;
+      if (!_beginRecord(site, (LogRecordArgs::getSize(captured) + ... + 0), data)) {
+        return false;
+      }
+
+      //A null record means it was dropped
+      if (nullptr != data) {
+        (LogRecordArgs::write(data, captured), ...);
+        _commitRecord();
+      }
+
+      return true;
+    }
+
+   private:
+    /**
+     * @copydoc Module::onStartUp
+     */
+    void
+    onStartUp() override;
+
+    /**
+     * @copydoc Module::onShutDown
+     */
+    void
+    onShutDown() override;
+
+    /**
+     * @brief Reserves a record in the buffer of the calling thread.
+     * @param[out] data Where the arguments must be written. Null if the
+     *             message was dropped.
+     * @return  False if the message must be logged synchronously.
+     */
+    static bool
+    _beginRecord(const LogCallSite& site, SIZE_T argsSize, uint8*& data);
+
+    /**
+     * @brief Makes the record reserved by _beginRecord() visible to the
+     *        logging thread.
+     */
+    static void
+    _commitRecord();
+
+    /**
+     * @brief Creates the buffer of the calling thread.
+     */
+    SPtr<LogRingBuffer>
+    createBuffer();
+
+    /**
+     * @brief Wakes the logging thread up before its interval ends.
+     */
+    void
+    wakeUp();
+
+    /**
+     * @brief Main loop of the logging thread.
+     */
+    void
+    run();
+
+    /**
+     * @brief Logs the records of all the buffers, ordered by time.
+     */
+    void
+    drain(const Vector<SPtr<LogRingBuffer>>& buffers);
+
+    AsyncLogOptions m_options;
+    Vector<SPtr<LogRingBuffer>> m_buffers;
+    uint32 m_nextThreadIdx = 0;
+    atomic<uint64> m_numDropped{ 0 };
+
+    Thread m_thread;
+    Mutex m_mutex;
+    Signal m_wakeSignal;
+    Signal m_flushSignal;
+    uint64 m_passesStarted = 0;
+    uint64 m_passesDone = 0;
+    bool m_flushRequested = false;
+    bool m_stop = false;
+
+    static atomic<bool> s_active;
+  };
+}
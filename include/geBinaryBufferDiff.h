@@ -0,0 +1,342 @@
+/*****************************************************************************/
+/**
+ * @file    geBinaryBufferDiff.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Generates and applies diffs directly on data encoded by the
+ *          BinarySerializer.
+ *
+ * Generates and applies diffs directly on data encoded by the
+ * BinarySerializer, without building SerializedObject trees for the original
+ * and the new states first.
+ *
+ * Objects in the encoded data are matched by their object ID, which the
+ * BinarySerializer assigns deterministically as it walks the object graph.
+ * Unchanged objects and fields are skipped with a plain memory comparison.
+ * Changed fields are stored whole, except for arrays, where only the runs of
+ * modified elements are stored.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geRTTIField.h"
+
+namespace geEngineSDK {
+  struct SerializationContext;
+
+  class GE_UTILITIES_EXPORT BinaryBufferDiff
+  {
+   public:
+    /**
+     * @brief Index of the objects, classes and fields contained in a buffer
+     *        encoded by the BinarySerializer. Entries point into the indexed
+     *        buffer, so it must outlive the index.
+     */
+    struct EncodedIndex
+    {
+      struct Field
+      {
+        uint32 meta;
+        uint32 size;
+        const uint8* data;
+      };
+
+      struct Class
+      {
+        uint32 typeId;
+        uint32 firstField;
+        uint32 numFields;
+      };
+
+      struct Object
+      {
+        uint32 id;
+        uint32 typeId;
+        const uint8* data;
+        uint32 size;
+        uint32 firstClass;
+        uint32 numClasses;
+      };
+
+      void
+      clear() {
+        objects.clear();
+        classes.clear();
+        fields.clear();
+      }
+
+      Vector<Object> objects;
+      Vector<Class> classes;
+      Vector<Field> fields;
+    };
+
+    /**
+     * @brief Encodes @p object with the BinarySerializer into @p output,
+     *        reusing the memory already held by it.
+     */
+    static void
+    encode(IReflectable& object, Vector<uint8>& output, bool shallow = false);
+
+    /**
+     * @brief Builds the index of a buffer encoded by the BinarySerializer.
+     */
+    static void
+    buildIndex(const uint8* data, uint32 size, EncodedIndex& index);
+
+    /**
+     * @brief Generates the per-field differences that transform the object
+     *        encoded in @p orgData into the one encoded in @p newData.
+     * @return  False if there are no differences, in which case @p patch is
+     *          left empty.
+     */
+    static bool
+    generateDiff(const uint8* orgData,
+                 uint32 orgSize,
+                 const uint8* newData,
+                 uint32 newSize,
+                 Vector<uint8>& patch);
+
+    /**
+     * @copydoc generateDiff(const uint8*, uint32, const uint8*, uint32, Vector<uint8>&)
+     */
+    static bool
+    generateDiff(const EncodedIndex& orgIndex,
+                 const EncodedIndex& newIndex,
+                 Vector<uint8>& patch);
+
+    /**
+     * @brief Applies a patch generated by generateDiff() to @p object.
+     *        The object, along with the objects it references, must be in
+     *        the state that was encoded as the original data.
+     */
+    static void
+    applyDiff(const SPtr<IReflectable>& object,
+              const uint8* patch,
+              uint32 patchSize,
+              SerializationContext* context = nullptr);
+
+   private:
+    using ObjectIdMap = UnorderedMap<uint32, SPtr<IReflectable>>;
+
+    /**
+     * @brief Contents of a field meta data entry of the encoded format.
+     */
+    struct FieldMeta
+    {
+      uint16 id;
+      uint8 size;
+      bool isArray;
+      SERIALIZABLE_FIELD_TYPE::E type;
+      bool hasDynamicSize;
+      bool terminator;
+      bool hasReferences;
+    };
+
+    /**
+     * @brief Decodes the field meta data written by the BinarySerializer.
+     */
+    static FieldMeta
+    decodeFieldMeta(uint32 meta);
+
+    /**
+     * @brief Returns true if the 4 bytes of meta data start an object or a
+     *        base class entry rather than a field.
+     */
+    static bool
+    isObjectMeta(uint32 meta);
+
+    /**
+     * @brief Reads the object meta data at @p data and advances past it.
+     */
+    static void
+    readObjectMeta(const uint8*& data,
+                   const uint8* end,
+                   uint32& objectId,
+                   uint32& typeId,
+                   bool& isBaseClass);
+
+    /**
+     * @brief Returns the end of the embedded object entry at @p data.
+     */
+    static const uint8*
+    skipEntry(const uint8* data, const uint8* end);
+
+    /**
+     * @brief Returns the end of the field payload at @p data.
+     */
+    static const uint8*
+    skipPayload(const FieldMeta& meta, const uint8* data, const uint8* end);
+
+    /**
+     * @brief Returns the end of a single value, or array element, of the
+     *        field payload at @p data.
+     */
+    static const uint8*
+    skipValue(const FieldMeta& meta, const uint8* data, const uint8* end);
+
+    /**
+     * @brief Writes the field changes between two objects of the same
+     *        layout. Returns true if any of the changed fields can reference
+     *        other objects.
+     */
+    static bool
+    diffFields(const EncodedIndex& orgIndex,
+               const EncodedIndex::Object& orgObject,
+               const EncodedIndex& newIndex,
+               const EncodedIndex::Object& newObject,
+               Vector<uint8>& patch,
+               uint32& numChanges);
+
+    /**
+     * @brief Writes only the modified elements of an array field. Returns
+     *        false if nothing was written because replacing the whole field
+     *        is cheaper.
+     */
+    static bool
+    writeArrayElements(const FieldMeta& meta,
+                       const EncodedIndex::Field& orgField,
+                       const EncodedIndex::Field& newField,
+                       Vector<uint8>& patch);
+
+    /**
+     * @brief Finds the objects in the graph of @p root under the same IDs
+     *        the BinarySerializer would assign them when encoding it.
+     */
+    static void
+    gatherObjectIds(const SPtr<IReflectable>& root,
+                    FrameAlloc& alloc,
+                    ObjectIdMap& objects);
+
+    /**
+     * @brief Appends the objects referenced by @p object, that weren't
+     *        found yet, to @p foundObjects.
+     */
+    static void
+    gatherReferences(IReflectable* object,
+                     FrameAlloc& alloc,
+                     UnorderedSet<IReflectable*>& visited,
+                     Vector<SPtr<IReflectable>>& foundObjects);
+
+    /**
+     * @brief Applies all the fields of an encoded object entry to
+     *        @p object.
+     */
+    static const uint8*
+    applyEntry(IReflectable* object,
+               const uint8* data,
+               const uint8* end,
+               bool embedded,
+               FrameAlloc& alloc,
+               const ObjectIdMap& objects,
+               SerializationContext* context);
+
+    /**
+     * @brief Applies the field changes of a patch record to @p object.
+     */
+    static void
+    applyFieldChanges(IReflectable* object,
+                      const uint8* data,
+                      const uint8* end,
+                      FrameAlloc& alloc,
+                      const ObjectIdMap& objects,
+                      SerializationContext* context);
+
+    /**
+     * @brief Sets a single value, or an array element if @p arrayIdx is not
+     *        -1, of the field from the encoded value at @p data.
+     */
+    static const uint8*
+    applyValue(RTTIField* field,
+               RTTITypeBase* rttiInstance,
+               IReflectable* object,
+               const FieldMeta& meta,
+               int32 arrayIdx,
+               const uint8* data,
+               const uint8* end,
+               FrameAlloc& alloc,
+               const ObjectIdMap& objects,
+               SerializationContext* context);
+
+    /**
+     * @brief Sets the whole field from the encoded payload at @p data.
+     */
+    static const uint8*
+    applyPayload(RTTIField* field,
+                 RTTITypeBase* rttiInstance,
+                 IReflectable* object,
+                 const FieldMeta& meta,
+                 const uint8* data,
+                 const uint8* end,
+                 FrameAlloc& alloc,
+                 const ObjectIdMap& objects,
+                 SerializationContext* context);
+
+    /**
+     * @brief Returns the field matching the encoded meta data, or null if
+     *        the field no longer exists.
+     */
+    static RTTIField*
+    findField(RTTITypeBase* rtti, const FieldMeta& meta);
+  };
+
+  /**
+   * @brief Keeps the encoded state of an object around so diffs of the live
+   *        object against it can be generated repeatedly, without parsing
+   *        the baseline again on every call.
+   */
+  class GE_UTILITIES_EXPORT BinaryDiffBaseline
+  {
+   public:
+    /**
+     * @param[in] shallow If true referenced objects are not encoded, and
+     *            changes to them won't be detected.
+     */
+    explicit BinaryDiffBaseline(bool shallow = false)
+      : m_shallow(shallow)
+    {}
+
+    /**
+     * @brief Encodes the current state of @p object as the baseline.
+     */
+    void
+    setBaseline(IReflectable& object);
+
+    /**
+     * @brief Generates the differences between the baseline and the current
+     *        state of @p object.
+     * @param[in]  object  Object to compare against the baseline.
+     * @param[out] patch   Generated patch, to be applied with
+     *             BinaryBufferDiff::applyDiff().
+     * @param[in]  updateBaseline If true the current state of @p object
+     *             becomes the new baseline.
+     * @return  False if there are no differences.
+     */
+    bool
+    generateDiff(IReflectable& object,
+                 Vector<uint8>& patch,
+                 bool updateBaseline = true);
+
+    /**
+     * @brief Returns the encoded baseline.
+     */
+    const Vector<uint8>&
+    getData() const {
+      return m_data;
+    }
+
+   private:
+    Vector<uint8> m_data;
+    Vector<uint8> m_scratchData;
+    BinaryBufferDiff::EncodedIndex m_index;
+    BinaryBufferDiff::EncodedIndex m_scratchIndex;
+    bool m_shallow;
+  };
+}
@@ -29,6 +29,10 @@ namespace geEngineSDK {
      * @param[in] shallow   If false then all referenced objects will be cloned
      *            as well, otherwise the references to the original objects
      *            will be kept.
+     * @note  Fields are copied directly from one object to the other. If any
+     *        type in the cloned graph overrides the serialization callbacks
+     *        the object is cloned by serializing and deserializing it instead
+     *        so the callbacks get a chance to run.
      */
     static SPtr<IReflectable>
     clone(IReflectable* object, bool shallow = false);
@@ -36,6 +40,42 @@ namespace geEngineSDK {
    private:
     struct ObjectReferenceData;
 
+    /**
+     * @brief Maps objects referenced from the source graph to their clones,
+     *        so objects referenced from multiple places get cloned only once.
+     */
+    using CloneMap = UnorderedMap<IReflectable*, SPtr<IReflectable>>;
+
+    /**
+     * @brief Clones the object by copying its fields directly into a new
+     *        instance. Returns null if some type in the graph requires the
+     *        serialization callbacks and the slow path must be used instead.
+     */
+    static SPtr<IReflectable>
+    cloneDirect(IReflectable* object, bool shallow);
+
+    /**
+     * @brief Returns the clone of an object referenced through a
+     *        ReflectablePtr field, creating it if it wasn't cloned yet.
+     *        Returns null if the object can't be cloned directly.
+     */
+    static SPtr<IReflectable>
+    cloneReference(const SPtr<IReflectable>& object,
+                   FrameAlloc& alloc,
+                   CloneMap& clonedObjects);
+
+    /**
+     * @brief Copies all the fields of @p src into @p dst, which must be of
+     *        the same type. Returns false if some type in the graph requires
+     *        the serialization callbacks.
+     */
+    static bool
+    copyFields(IReflectable* src,
+               IReflectable* dst,
+               bool shallow,
+               FrameAlloc& alloc,
+               CloneMap& clonedObjects);
+
     /**
      * @brief Identifier representing a single field or an array entry in an
      *        object.
@@ -23,6 +23,7 @@
 
 namespace geEngineSDK {
   struct SerializationContext;
+  class FingerprintCache;
 
   /**
    * @brief Represents an interface RTTI objects need to implement if they want
@@ -55,6 +56,20 @@ namespace geEngineSDK {
     bool
     run(IReflectable& a, IReflectable& b) override;
 
+    /**
+     * @brief Sets a cache of fingerprints used to skip the comparison of
+     *        objects whose fingerprints were already computed. Objects are
+     *        only skipped if the fingerprints of both were stored for
+     *        @p version. Set to null to always compare field by field.
+     * @note  The cache is not owned by the comparer and must outlive it, or be
+     *        unset before being destroyed.
+     */
+    void
+    setFingerprintCache(FingerprintCache* cache, uint64 version = 0) {
+      m_fingerprintCache = cache;
+      m_fingerprintVersion = version;
+    }
+
    protected:
     /**
      * @brief Checks if two IReflectable objects are equal. Inserts the results
@@ -64,8 +79,134 @@ namespace geEngineSDK {
     bool
     compare(IReflectable& a, IReflectable& b);
 
+    /**
+     * @brief Compares two child objects with the compare handler of their
+     *        type, skipping the comparison if their cached fingerprints
+     *        already decide it.
+     */
+    bool
+    compareChild(IReflectable& a, IReflectable& b);
+
+    /**
+     * @brief Looks up the fingerprints of both objects in the fingerprint
+     *        cache. Returns false if either of them is missing.
+     */
+    bool
+    findFingerprints(IReflectable& a, IReflectable& b, bool& equal) const;
+
     UnorderedSet<IReflectable*> m_objectMap;
     SerializationContext* m_context = nullptr;
     FrameAlloc* m_alloc = nullptr;
+    FingerprintCache* m_fingerprintCache = nullptr;
+    uint64 m_fingerprintVersion = 0;
+  };
+
+  /**
+   * @brief 128-bit structural hash of an IReflectable object, computed over
+   *        its serializable fields and the ones of the objects it references.
+   */
+  struct ObjectFingerprint
+  {
+    bool
+    operator==(const ObjectFingerprint& rhs) const {
+      return low == rhs.low && high == rhs.high;
+    }
+
+    bool
+    operator!=(const ObjectFingerprint& rhs) const {
+      return !(*this == rhs);
+    }
+
+    uint64 low = 0;
+    uint64 high = 0;
+  };
+
+  /**
+   * @brief Stores the fingerprints of objects, tagged with a version chosen
+   *        by the caller (e.g. a frame or modification counter), so they don't
+   *        need to be computed again while the objects remain unchanged.
+   * @note  Not thread safe. Entries are keyed by the object address, so
+   *        objects must be invalidated before being destroyed.
+   */
+  class GE_UTILITIES_EXPORT FingerprintCache
+  {
+   public:
+    /**
+     * @brief Returns the fingerprint stored for @p object, if it was stored
+     *        for the same @p version.
+     */
+    bool
+    find(const IReflectable* object,
+         uint64 version,
+         ObjectFingerprint& fingerprint) const;
+
+    /**
+     * @brief Stores the fingerprint of @p object for the provided version,
+     *        replacing any previous entry.
+     */
+    void
+    store(const IReflectable* object,
+          uint64 version,
+          const ObjectFingerprint& fingerprint);
+
+    /**
+     * @brief Removes the entry of @p object, if any.
+     */
+    void
+    invalidate(const IReflectable* object);
+
+    /**
+     * @brief Removes all the entries.
+     */
+    void
+    clear();
+
+   private:
+    struct Entry
+    {
+      uint64 version;
+      ObjectFingerprint fingerprint;
+    };
+
+    UnorderedMap<const IReflectable*, Entry> m_entries;
+  };
+
+  /**
+   * @brief Computes structural fingerprints of IReflectable objects, usable
+   *        to detect changes or to quickly tell different objects apart.
+   *
+   * The fingerprint covers the same data the BinaryCompare checks: the type
+   * of every class in the hierarchy, and the contents of every field,
+   * including embedded and referenced objects. Two objects that compare
+   * equal always have the same fingerprint. Objects with the same fingerprint
+   * are equal with overwhelming probability, but not with certainty.
+   */
+  class GE_UTILITIES_EXPORT BinaryFingerprint
+  {
+   public:
+    /**
+     * @brief Computes the fingerprint of @p object.
+     * @param[in] object  Object to compute the fingerprint of.
+     * @param[in] cache   Optional cache. Fingerprints of the objects found
+     *            in it for @p version are reused instead of computed, and
+     *            the fingerprints computed for @p object and the objects it
+     *            references are stored in it.
+     * @param[in] version Version to look up and store the fingerprints with.
+     * @note  Objects that are part of a reference cycle, together with the
+     *        objects referencing them, are only stored in the cache if the
+     *        cycle is fully contained in their own references, as their
+     *        fingerprint otherwise depends on where the walk started.
+     */
+    static ObjectFingerprint
+    compute(IReflectable& object,
+            FingerprintCache* cache = nullptr,
+            uint64 version = 0);
+
+    /**
+     * @brief Computes a fingerprint of raw bytes, using the same hash
+     *        function as compute().
+     */
+    static ObjectFingerprint
+    hashBytes(const void* data, SIZE_T size);
   };
 }
@@ -0,0 +1,382 @@
+/*****************************************************************************/
+/**
+ * @file    geBinaryLog.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Compact binary log files and the reader that decodes them.
+ *
+ * A binary log stores each GE_LOG call site once, with its message, location
+ * and argument types. Every message logged from it afterwards only stores
+ * the call site id, the time and the values of the arguments, so messages
+ * are formatted when the log is read instead of when they are logged.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geLog.h"
+#include "geLogSink.h"
+
+#include <bitset>
+
+namespace geEngineSDK {
+  /**
+   * @brief Type of an argument stored in a binary log.
+   */
+  namespace LOG_BINARY_TYPE {
+    enum E {
+      kBOOL = 0,
+      kINT8,
+      kINT16,
+      kINT32,
+      kINT64,
+      kUINT8,
+      kUINT16,
+      kUINT32,
+      kUINT64,
+      kFLOAT,
+      kDOUBLE,
+
+      /**
+       * Strings, and anything else converted to text when logged.
+       */
+      kSTRING
+    };
+  }
+
+  /**
+   * @brief Arguments of a message encoded for a binary log. Integers are
+   *        stored as variable length integers, strings with their size.
+   */
+  class BinaryLogArgs
+  {
+   public:
+    /**
+     * @brief Clears the arguments so a new message can be encoded.
+     */
+    void
+    clear() {
+      m_message = nullptr;
+      m_types.clear();
+      m_data.clear();
+    }
+
+    /**
+     * @brief Sets a message given as a string literal. It's stored once, with
+     *        the call site.
+     */
+    void
+    writeMessage(const ANSICHAR* literal) {
+      m_message = literal;
+    }
+
+    /**
+     * @brief Stores a message that isn't a string literal before the
+     *        arguments.
+     */
+    void
+    writeMessage(const String& message) {
+      m_message = nullptr;
+      writeString(message);
+    }
+
+    void
+    write(bool value) {
+      m_types.push_back(LOG_BINARY_TYPE::kBOOL);
+      m_data.push_back(value ? 1 : 0);
+    }
+
+    void
+    write(float value) {
+      m_types.push_back(LOG_BINARY_TYPE::kFLOAT);
+      writeBytes(&value, sizeof(value));
+    }
+
+    void
+    write(double value) {
+      m_types.push_back(LOG_BINARY_TYPE::kDOUBLE);
+      writeBytes(&value, sizeof(value));
+    }
+
+    void
+    write(const String& value) {
+      m_types.push_back(LOG_BINARY_TYPE::kSTRING);
+      writeString(value);
+    }
+
+    /**
+     * @brief Stores integers as they are, and converts anything else to
+     *        text the same way StringUtil::format() does.
+     */
+    template<class T>
+    void
+    write(const T& value) {
+      IF_CONSTEXPR (std::is_integral<T>::value) {
+        const uint32 sizeIdx = sizeof(T) == 1 ? 0 :
+                               sizeof(T) == 2 ? 1 :
+                               sizeof(T) == 4 ? 2 : 3;
+        IF_CONSTEXPR (std::is_signed<T>::value) {
+          m_types.push_back(static_cast<uint8>(LOG_BINARY_TYPE::kINT8 + sizeIdx));
+          writeVarInt(zigZagEncode(static_cast<int64>(value)));
+        }
+        else {
+          m_types.push_back(static_cast<uint8>(LOG_BINARY_TYPE::kUINT8 + sizeIdx));
+          writeVarInt(static_cast<uint64>(value));
+        }
+      }
+      else {
+        write(geEngineSDK::toString(value));
+      }
+    }
+
+    /**
+     * @brief Returns the message set by writeMessage(), if it's a literal.
+     */
+    const ANSICHAR*
+    getMessage() const {
+      return m_message;
+    }
+
+    /**
+     * @brief Returns the LOG_BINARY_TYPE::E of each argument.
+     */
+    const Vector<uint8>&
+    getTypes() const {
+      return m_types;
+    }
+
+    /**
+     * @brief Returns the encoded arguments.
+     */
+    const Vector<uint8>&
+    getData() const {
+      return m_data;
+    }
+
+    static uint64
+    zigZagEncode(int64 value) {
+      return (static_cast<uint64>(value) << 1) ^ static_cast<uint64>(value >> 63);
+    }
+
+    static int64
+    zigZagDecode(uint64 value) {
+      return static_cast<int64>(value >> 1) ^ -static_cast<int64>(value & 1);
+    }
+
+    /**
+     * @brief Appends a variable length integer to @p output: 7 bits per
+     *        byte, with the high bit set on all but the last.
+     */
+    static void
+    writeVarInt(Vector<uint8>& output, uint64 value) {
+      while (value >= 0x80) {
+        output.push_back(static_cast<uint8>(value | 0x80));
+        value >>= 7;
+      }
+      output.push_back(static_cast<uint8>(value));
+    }
+
+   private:
+    void
+    writeVarInt(uint64 value) {
+      writeVarInt(m_data, value);
+    }
+
+    void
+    writeBytes(const void* data, SIZE_T size) {
+      auto bytes = reinterpret_cast<const uint8*>(data);
+      m_data.insert(m_data.end(), bytes, bytes + size);
+    }
+
+    void
+    writeString(const String& value) {
+      writeVarInt(value.size());
+      writeBytes(value.data(), value.size());
+    }
+
+    const ANSICHAR* m_message = nullptr;
+    Vector<uint8> m_types;
+    Vector<uint8> m_data;
+  };
+
+  /**
+   * @brief Options used to create a BinaryLogSink.
+   */
+  struct BinaryLogSinkOptions
+  {
+    /**
+     * Size in bytes the encoded messages are written to the file in. Blocks
+     * are also written when the sink is flushed.
+     */
+    uint32 blockSize = 64 * 1024;
+
+    /**
+     * If true the blocks are compressed with LZ4.
+     */
+    bool compress = true;
+  };
+
+  /**
+   * @brief Writes the log to a binary file that can be read back with
+   *        BinaryLogReader.
+   *
+   *        Entries sent to it as a LogSink are stored as text. Messages
+   *        logged with GE_LOG while the AsyncLog is started with the sink in
+   *        AsyncLogOptions::binaryLog are stored with their arguments
+   *        instead, and never formatted by the application.
+   * @note  Thread safe.
+   */
+  class GE_UTILITIES_EXPORT BinaryLogSink : public LogSink
+  {
+   public:
+    explicit BinaryLogSink(const Path& path,
+                           const BinaryLogSinkOptions& options = BinaryLogSinkOptions());
+    ~BinaryLogSink();
+
+    /**
+     * @copydoc LogSink::write
+     */
+    void
+    write(const LogEntry& entry) override;
+
+    /**
+     * @copydoc LogSink::flush
+     */
+    void
+    flush() override;
+
+    /**
+     * @brief Writes a message logged from @p site, with the arguments of
+     *        an AsyncLog record.
+     * @param[in] timestamp Time the message was logged at, in nanoseconds
+     *            since the epoch.
+     * @note  Internal method. Called by the AsyncLog thread only.
+     */
+    void
+    _writeRecord(const LogCallSite& site, int64 timestamp, const uint8* args);
+
+   private:
+    /**
+     * @brief Adds the name of a category to the block, if it wasn't yet.
+     */
+    void
+    writeCategory(uint32 category);
+
+    /**
+     * @brief Adds a time to the block, as the difference with the previous.
+     */
+    void
+    writeTimestamp(int64 timestamp);
+
+    void
+    writeString(const String& value);
+
+    /**
+     * @brief Compresses the block and writes it to the file.
+     */
+    void
+    writeBlock();
+
+    BinaryLogSinkOptions m_options;
+    SPtr<DataStream> m_file;
+
+    /**
+     * Arguments of the last record. Only used by the AsyncLog thread.
+     */
+    BinaryLogArgs m_args;
+
+    Mutex m_mutex;
+    Vector<uint8> m_block;
+    Vector<uint8> m_compressed;
+    Vector<bool> m_writtenSites;
+    std::bitset<Log::MAX_CATEGORIES> m_writtenCategories;
+    int64 m_lastTimestamp = 0;
+  };
+
+  /**
+   * @brief Selects which entries of a binary log are read. Entries filtered
+   *        out are skipped without decoding their arguments.
+   */
+  struct BinaryLogFilter
+  {
+    /**
+     * Categories read. Empty to read all of them.
+     */
+    Vector<uint32> categories;
+
+    /**
+     * Most verbose entries read.
+     */
+    LogVerbosity verbosity = LogVerbosity::kVeryVerbose;
+
+    /**
+     * Time range read, inclusive. 0 for no limit.
+     */
+    time_t startTime = 0;
+    time_t endTime = 0;
+  };
+
+  /**
+   * @brief Reads a file written by BinaryLogSink, and saves it in the same
+   *        text or HTML format as Debug::saveLog().
+   */
+  class GE_UTILITIES_EXPORT BinaryLogReader
+  {
+   public:
+    /**
+     * @brief Opens a binary log. Logs an error if the file can't be read or
+     *        isn't one.
+     */
+    explicit BinaryLogReader(const Path& path);
+
+    /**
+     * @brief Returns true if the file was opened as a binary log.
+     */
+    bool
+    isValid() const {
+      return 0 != m_dataOffset;
+    }
+
+    /**
+     * @brief Returns the entries that pass the filter.
+     */
+    Vector<LogEntry>
+    getEntries(const BinaryLogFilter& filter = BinaryLogFilter()) const;
+
+    /**
+     * @brief Saves the entries that pass the filter as a text log.
+     */
+    void
+    saveTextLog(const Path& path,
+                const BinaryLogFilter& filter = BinaryLogFilter()) const;
+
+    /**
+     * @brief Saves the entries that pass the filter as a HTML log.
+     */
+    void
+    saveHtmlLog(const Path& path,
+                const BinaryLogFilter& filter = BinaryLogFilter()) const;
+
+   private:
+    /**
+     * @brief Calls @p callback with every entry that passes the filter, and
+     *        the name its category had in the application that logged it.
+     */
+    void
+    readEntries(const BinaryLogFilter& filter,
+                const function<void(const LogEntry& entry,
+                                    const String& categoryName)>& callback) const;
+
+    Path m_path;
+    String m_textHeader;
+    String m_htmlHeader;
+    SIZE_T m_dataOffset = 0;
+  };
+}
@@ -34,6 +34,7 @@
 #include "gePrerequisitesUtilities.h"
 #include "geSerializedObject.h"
 #include "geRTTIField.h"
+#include "geBinaryCompare.h"
 
 namespace geEngineSDK {
   using std::function;
@@ -70,6 +71,32 @@ namespace geEngineSDK {
      *             restored upon decoding.
      * @param[in]  context  Optional parameters to be passed to the
      *             serialization callbacks on the objects being serialized.
+     * @param[in]  deduplicate  If true identical content is only written
+     *             once. Referenced objects with the same fingerprint (see
+     *             BinaryFingerprint) are encoded as a single object, and are
+     *             shared once decoded. Repeated embedded objects and data
+     *             blocks are encoded as references to their first copy, and
+     *             are copied from it when decoded.
+     * @param[in]  parallel  If true, and the TaskScheduler is running, the
+     *             object and the objects it references are encoded on the
+     *             TaskScheduler workers, each task into its own buffer. The
+     *             buffers are written out in object ID order, so the output is
+     *             identical to the one of a serial encode. Ignored when
+     *             deduplicating or encoding shallow.
+     * @param[in]  compact  If true the data is written in the compact
+     *             format, where IDs, sizes and array counts are stored as
+     *             variable length integers and field sizes are only stored
+     *             for fixed size plain fields. The format is flagged at the
+     *             start of the data, decode() accepts both formats.
+     * @note  Deduplication walks the referenced objects to compute their
+     *        fingerprints, which triggers their serialization callbacks more
+     *        than once.
+     * @note  A parallel encode first walks the referenced objects on the
+     *        calling thread to assign their IDs, which also triggers their
+     *        serialization callbacks more than once. The callbacks and the
+     *        field getters are then called from the worker threads, which
+     *        must have a MemStack. If a getter doesn't return the same
+     *        object on every call the encode falls back to the serial path.
      */
     void
     encode(IReflectable* object,
@@ -78,9 +105,10 @@ namespace geEngineSDK {
            uint32* bytesWritten,
            function<uint8*(uint8*, uint32, uint32&)> flushBufferCallback,
            bool shallow = false,
-           SerializationContext* context = nullptr);
-
-
+           SerializationContext* context = nullptr,
+           bool deduplicate = false,
+           bool parallel = false,
+           bool compact = false);
 
     /**
      * @brief Decodes an object from binary data.
@@ -88,12 +116,53 @@ namespace geEngineSDK {
      * @param[in] dataLength  Length of the data in bytes.
      * @param[in] params      Optional parameters to be passed to the
      *            serialization callbacks on the objects being serialized.
+     * @param[in] progress    Optional callback receiving the decode progress,
+     *            in range [0, 1].
+     * @param[in] parallel    If true, the data is held in memory and the
+     *            TaskScheduler is running, the objects are decoded on the
+     *            TaskScheduler workers. Objects are still only decoded after
+     *            all the objects they reference. Objects in reference cycles,
+     *            and the ones referencing them, are decoded serially after
+     *            the rest. The worker threads must have a MemStack.
      */
     SPtr<IReflectable>
     decode(const SPtr<DataStream>& data,
            uint32 dataLength,
            SerializationContext* context = nullptr,
-           function<void(float)> progress = nullptr);
+           function<void(float)> progress = nullptr,
+           bool parallel = false);
+
+    /**
+     * @brief Returns the version of the format the data was encoded with:
+     *        FORMAT_VERSION_DEFAULT or FORMAT_VERSION_COMPACT.
+     */
+    static uint32
+    getFormatVersion(const uint8* data, uint32 dataLength);
+
+    /**
+     * @brief Returns the RTTI type ID of the root object of the encoded data,
+     *        without decoding it. Only the first few bytes of the data are
+     *        needed (MAX_HEADER_SIZE).
+     * @return  The type ID, or 0 if the data is too short or invalid.
+     */
+    static uint32
+    getEncodedTypeId(const uint8* data, uint32 dataLength);
+
+    /**
+     * Format written by default, with fixed size meta data.
+     */
+    static constexpr const uint32 FORMAT_VERSION_DEFAULT = 1;
+
+    /**
+     * Format written when encoding with the compact flag.
+     */
+    static constexpr const uint32 FORMAT_VERSION_COMPACT = 2;
+
+    /**
+     * Maximum size of the format header and the meta data of the root
+     * object, in any format.
+     */
+    static constexpr const uint32 MAX_HEADER_SIZE = 16;
 
    private:
     /**
@@ -132,6 +201,44 @@ namespace geEngineSDK {
       SIZE_T offset;
     };
 
+    /**
+     * @brief Encodes @p object, with ID @p objectId, and the objects it
+     *        references on the TaskScheduler workers.
+     * @return  False if the objects couldn't be encoded in parallel, in which
+     *          case nothing was written and the object IDs were reset.
+     */
+    bool
+    encodeParallel(IReflectable* object,
+                   uint32 objectId,
+                   uint8*& buffer,
+                   uint32& bufferLength,
+                   uint32* bytesWritten,
+                   function<uint8*(uint8*, uint32, uint32&)> flushBufferCallback);
+
+    /**
+     * @brief Registers the objects referenced by @p object, including the ones
+     *        referenced from its embedded objects, in the same order
+     *        encodeEntry() registers them.
+     */
+    void
+    gatherObjectPtrs(IReflectable* object);
+
+    /**
+     * @brief Decodes the objects found by the first pass of decode() on the
+     *        TaskScheduler workers, in waves of objects whose references
+     *        were all decoded in earlier waves.
+     * @param[in] objectIds       IDs of the objects, in the order found.
+     * @param[in] firstReference  Index of the first reference of each
+     *            object in @p references.
+     * @param[in] references      IDs of the objects referenced by each object.
+     */
+    void
+    decodeParallel(MemoryDataStream& data,
+                   SIZE_T dataEnd,
+                   const Vector<uint32>& objectIds,
+                   const Vector<uint32>& firstReference,
+                   const Vector<uint32>& references);
+
     /**
      * @brief Encodes a single IReflectable object.
      */
@@ -164,6 +271,39 @@ namespace geEngineSDK {
                         function<uint8*(uint8*, uint32, uint32&)> flushBufferCallback,
                         bool shallow);
 
+    /**
+     * @brief Encodes a complex object the same way as complexTypeToBuffer(),
+     *        unless an identical entry was already encoded, in which case
+     *        only a reference to it is written.
+     */
+    uint8*
+    dedupComplexTypeToBuffer(IReflectable* object,
+                             uint8* buffer,
+                             uint32& bufferLength,
+                             uint32* bytesWritten,
+                             function<uint8*(uint8*, uint32, uint32&)> flushBufferCallback,
+                             bool shallow);
+
+    /**
+     * @brief Finds a value with the same contents encoded earlier. If there
+     *        is none, the value about to be written at @p offset is
+     *        registered and 0 is returned.
+     * @return  Offset of the earlier value, from the start of the encoded
+     *          data.
+     */
+    uint32
+    findOrAddDuplicateValue(const ObjectFingerprint& hash, uint32 offset);
+
+    /**
+     * @brief Decodes a value stored earlier in the data, at the offset of a
+     *        value reference written when deduplicating, and returns to the
+     *        current read position afterwards.
+     */
+    void
+    decodeReferencedValue(const SPtr<DataStream>& data,
+                          uint32 reference,
+                          const function<void()>& decodeValue);
+
     /**
      * @brief Helper method for encoding a data block to a buffer.
      */
@@ -190,6 +330,44 @@ namespace geEngineSDK {
     uint32
     registerObjectPtr(SPtr<IReflectable> object);
 
+    /**
+     * @brief Writes field meta data encoded by encodeFieldMetaData() to
+     *        @p output, in the format being encoded.
+     * @return  Number of bytes written, at most MAX_META_SIZE.
+     */
+    uint32
+    writeFieldMetaData(uint32 metaData, uint8* output) const;
+
+    /**
+     * @brief Writes object meta data encoded by encodeObjectMetaData() to
+     *        @p output, in the format being encoded.
+     * @return  Number of bytes written, at most MAX_META_SIZE.
+     */
+    uint32
+    writeObjectMetaData(const ObjectMetaData& metaData, uint8* output) const;
+
+    /**
+     * @brief Writes an ID, size or array count to @p output, in the format
+     *        being encoded.
+     * @return  Number of bytes written, at most MAX_META_SIZE.
+     */
+    uint32
+    writeUInt32(uint32 value, uint8* output) const;
+
+    /**
+     * @brief Reads the meta data of a field or an object. Field meta data is
+     *        returned as encoded by encodeFieldMetaData(), and object meta
+     *        data as ObjectMetaData::objectMeta, whatever the format.
+     */
+    uint32
+    readMetaData(const SPtr<DataStream>& data);
+
+    /**
+     * @brief Reads an ID, size or array count written by writeUInt32().
+     */
+    uint32
+    readUInt32(const SPtr<DataStream>& data);
+
     /**
      * @brief Encodes data required for representing a serialized field, into
      *        4 bytes.
@@ -200,7 +378,8 @@ namespace geEngineSDK {
                         bool array,
                         SERIALIZABLE_FIELD_TYPE::E type,
                         bool hasDynamicSize,
-                        bool terminator);
+                        bool terminator,
+                        bool hasReferences = false);
 
     /**
      * @brief Decode meta field that was encoded using encodeFieldMetaData()
@@ -212,7 +391,8 @@ namespace geEngineSDK {
                         bool& array,
                         SERIALIZABLE_FIELD_TYPE::E& type,
                         bool& hasDynamicSize,
-                        bool& terminator);
+                        bool& terminator,
+                        bool& hasReferences);
 
     /**
      * @brief Encodes data required for representing an object identifier, into
@@ -255,6 +435,49 @@ namespace geEngineSDK {
     SerializationContext* m_context = nullptr;
     function<void(float)> m_reportProgress = nullptr;
 
+    /**
+     * @brief A fingerprint registered for deduplication, indexed by its low
+     *        half, along with the object ID or value offset it maps to.
+     */
+    struct DuplicateEntry
+    {
+      uint64 high;
+      uint32 value;
+    };
+
+    bool m_deduplicate = false;
+    uint32 m_dedupSuspended = 0;
+    FingerprintCache m_fingerprintCache;
+    UnorderedMap<uint64, DuplicateEntry> m_duplicateObjects;
+    UnorderedMap<uint64, DuplicateEntry> m_duplicateValues;
+    Vector<SPtr<IReflectable>> m_duplicatesToKeep;
+    Vector<uint8> m_dedupScratch;
+    SIZE_T m_decodeStart = 0;
+
+    /**
+     * IDs assigned to all the objects before a parallel encode. Set on the
+     * serializers encoding on the worker threads.
+     */
+    const UnorderedMap<void*, uint32>* m_assignedObjectIds = nullptr;
+    bool m_unassignedObjectFound = false;
+
+    /**
+     * Objects of the serializer running a parallel decode. Set on the
+     * serializers decoding on the worker threads.
+     */
+    Map<uint32, ObjectToDecode>* m_sharedDecodeObjectMap = nullptr;
+
+    /**
+     * If set, the IDs of the referenced objects are appended to it while
+     * parsing the objects.
+     */
+    Vector<uint32>* m_gatheredReferences = nullptr;
+
+    /**
+     * True if the data being encoded or decoded is in the compact format.
+     */
+    bool m_compact = false;
+
     //Meta field size
     static constexpr const uint32 META_SIZE = 4;
     
@@ -265,5 +488,13 @@ namespace geEngineSDK {
     static constexpr const uint32 COMPLEX_TYPE_FIELD_SIZE = 4;
 
     static constexpr const uint32 DATA_BLOCK_TYPE_FIELD_SIZE = 4;
+
+    //Size of the reference preceding deduplicated values
+    static constexpr const uint32 VALUE_REFERENCE_SIZE = 4;
+
+    //Maximum size of any meta data or value written by the write methods
+    static constexpr const uint32 MAX_META_SIZE = 16;
+
+    friend class BinaryBufferDiff;
   };
 }
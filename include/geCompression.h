@@ -18,10 +18,169 @@
  */
 /*****************************************************************************/
 #include "gePrerequisitesUtilities.h"
+#include "geDataStream.h"
+#include "geNonCopyable.h"
+
+union LZ4_stream_u;
 
 namespace geEngineSDK {
   using std::function;
 
+  /**
+   * @brief Reversible filters applied to each block before it's compressed.
+   *        They rearrange numeric data so it compresses better. Shuffles and
+   *        deltas can be combined, in which case the delta is applied first.
+   */
+  namespace COMPRESSION_FILTER {
+    enum E {
+      kNone = 0,
+
+      /**
+       * Groups together the n-th byte of every element. Works best on arrays
+       * of floats or similar values where the high bytes barely change.
+       */
+      kByteShuffle = 1 << 0,
+
+      /**
+       * Groups together the n-th bit of every element. Slower than the byte
+       * shuffle but exposes more redundancy on noisy data.
+       */
+      kBitShuffle = 1 << 1,
+
+      /**
+       * Stores the difference between consecutive integer elements. Works
+       * best on sorted values like ids or timestamps.
+       */
+      kDelta = 1 << 2,
+
+      /**
+       * Stores the XOR of consecutive elements. Works on any element type
+       * where neighbors share most of their bits.
+       */
+      kXorDelta = 1 << 3
+    };
+  }
+
+  using CompressionFilterFlags = Flags<COMPRESSION_FILTER::E>;
+  GE_FLAGS_OPERATORS(COMPRESSION_FILTER::E);
+
+  /**
+   * @brief Options used to build a compressed frame.
+   *
+   * A frame is split in independent blocks of @p blockSize bytes that can be
+   * compressed and decompressed on their own, in any order. A block index is
+   * stored at the end of the frame so the blocks can be located without
+   * decompressing the ones before them.
+   */
+  struct CompressionOptions
+  {
+    /**
+     * Size in bytes of the uncompressed data stored in each block.
+     */
+    uint32 blockSize = 256 * 1024;
+
+    /**
+     * LZ4 acceleration. 1 is the default trade-off, higher values compress
+     * faster at the cost of a worse ratio. This is not an LZ4 HC level.
+     */
+    int32 acceleration = 1;
+
+    /**
+     * Filters applied to the data before compressing it. The filters are
+     * stored in the frame header so decompression doesn't need to know them.
+     */
+    CompressionFilterFlags filters;
+
+    /**
+     * Size in bytes of each element the filters work on. e.g. 4 for arrays
+     * of floats, Vector3 or Quaternion. Deltas only support 1, 2, 4 and 8.
+     */
+    uint32 elementSize = 4;
+
+    /**
+     * If true and the TaskScheduler is running, the blocks are processed in
+     * parallel by the scheduler workers.
+     */
+    bool parallel = true;
+  };
+
+  /**
+   * @brief Dictionary shared by the compressor and the decompressor of small
+   *        blobs with similar contents, e.g. network messages or cache
+   *        entries, that are too small to compress well on their own.
+   *
+   * The dictionary is prepared for compression once, when it's created, and
+   * can then be used concurrently from any number of threads.
+   */
+  class GE_UTILITIES_EXPORT CompressionDictionary : INonCopyable
+  {
+   public:
+    /**
+     * Largest dictionary LZ4 can reference. Only the last MAX_SIZE bytes of
+     * bigger dictionaries are used.
+     */
+    static CONSTEXPR uint32 MAX_SIZE = 64 * 1024;
+
+    /**
+     * @brief Creates a dictionary from its raw contents, as returned by
+     *        getData() on a trained dictionary.
+     */
+    CompressionDictionary(const void* data, SIZE_T size);
+
+    ~CompressionDictionary();
+
+    /**
+     * @brief Builds a dictionary from the byte sequences that repeat the most
+     *        across the provided samples.
+     * @param[in] samples Data the dictionary should be good at compressing,
+     *            read from the current position of each stream. Memory
+     *            streams are left unchanged.
+     * @param[in] maxSize Maximum size in bytes of the dictionary.
+     * @return  The trained dictionary, or null if the samples don't have
+     *          enough data in common.
+     */
+    static SPtr<CompressionDictionary>
+    train(const Vector<SPtr<DataStream>>& samples, uint32 maxSize = MAX_SIZE);
+
+    /**
+     * @brief Returns the identifier stored along with the data compressed
+     *        with this dictionary. It's derived from the dictionary contents.
+     */
+    uint32
+    getId() const {
+      return m_id;
+    }
+
+    /**
+     * @brief Returns the contents of the dictionary.
+     */
+    const uint8*
+    getData() const {
+      return m_data.data();
+    }
+
+    /**
+     * @brief Returns the size of the dictionary in bytes.
+     */
+    uint32
+    getSize() const {
+      return static_cast<uint32>(m_data.size());
+    }
+
+   private:
+    friend class Compression;
+
+    Vector<uint8> m_data;
+    uint32 m_id = 0;
+
+    /**
+     * Compression state with the dictionary already loaded. Compressing
+     * threads attach it to their own state instead of loading the dictionary
+     * again.
+     */
+    LZ4_stream_u* m_stream = nullptr;
+  };
+
   class GE_UTILITIES_EXPORT Compression
   {
    public:
@@ -32,11 +191,183 @@ namespace geEngineSDK {
     static SPtr<MemoryDataStream>
     compress(SPtr<DataStream>& input, function<void(float)> reportProgress = nullptr);
 
+    /**
+     * @brief Compresses the data from the provided data stream and outputs the
+     *        new stream with compressed data, using the specified options.
+     */
+    static SPtr<MemoryDataStream>
+    compress(SPtr<DataStream>& input,
+             const CompressionOptions& options,
+             function<void(float)> reportProgress = nullptr);
+
     /**
      * @brief Decompresses the data from the provided data stream and outputs
      *        the new stream with decompressed data.
+     * @note  Accepts both the chunked frame format and the single block format
+     *        written by older versions.
      */
     static SPtr<MemoryDataStream>
     decompress(SPtr<DataStream>& input, function<void(float)> reportProgress = nullptr);
+
+    /**
+     * @brief Returns true if the stream is positioned at the start of a
+     *        compressed frame. The stream position is left unchanged.
+     */
+    static bool
+    isCompressedFrame(DataStream& input);
+
+    /**
+     * @brief Compresses the data from the provided data stream using a
+     *        dictionary. Meant for small inputs, the data is compressed as a
+     *        single block with a much smaller header than a regular frame.
+     * @param[in] input       Data to compress.
+     * @param[in] dictionary  Dictionary to compress with. The same dictionary
+     *            is needed to decompress the data.
+     * @param[in] acceleration  LZ4 acceleration, see
+     *            CompressionOptions::acceleration.
+     */
+    static SPtr<MemoryDataStream>
+    compress(SPtr<DataStream>& input,
+             const CompressionDictionary& dictionary,
+             int32 acceleration = 1);
+
+    /**
+     * @brief Decompresses data compressed with a dictionary.
+     * @note  Fails if @p dictionary isn't the one the data was compressed
+     *        with.
+     */
+    static SPtr<MemoryDataStream>
+    decompress(SPtr<DataStream>& input, const CompressionDictionary& dictionary);
+
+    /**
+     * @brief Returns the ID of the dictionary the data at the current
+     *        position of the stream was compressed with, or 0 if it wasn't
+     *        compressed with a dictionary. The stream position is left
+     *        unchanged.
+     */
+    static uint32
+    getDictionaryId(DataStream& input);
+  };
+
+  /**
+   * @brief Data stream that compresses or decompresses the data on the fly
+   *        while it is written to or read from another stream.
+   *
+   * In write mode every call to write() is buffered until a full block is
+   * available, the block is then compressed and written to the underlying
+   * stream. The frame is completed when the stream is closed.
+   * In read mode blocks are decompressed as they are needed. Seeking is
+   * supported, using the block index when available.
+   *
+   * @note  The underlying stream is not closed when this stream is closed.
+   */
+  class GE_UTILITIES_EXPORT CompressedDataStream : public DataStream
+  {
+   public:
+    /**
+     * @brief Wraps a stream in a compression/decompression stream.
+     * @param[in] stream      Stream to write the compressed data to, or to
+     *            read the compressed data from. The frame starts at the
+     *            current position of the stream.
+     * @param[in] accessMode  kREAD to decompress or kWRITE to compress.
+     * @param[in] options     Options used to compress the data (write mode).
+     */
+    CompressedDataStream(const SPtr<DataStream>& stream,
+                         ACCESS_MODE::E accessMode = ACCESS_MODE::kREAD,
+                         const CompressionOptions& options = CompressionOptions());
+
+    ~CompressedDataStream();
+
+    bool
+    isFile() const override {
+      return m_stream->isFile();
+    }
+
+    /**
+     * @brief @copydoc DataStream::read
+     */
+    SIZE_T
+    read(void* buf, SIZE_T count) override;
+
+    /**
+     * @brief @copydoc DataStream::write
+     */
+    SIZE_T
+    write(const void* buf, SIZE_T count) override;
+
+    /**
+     * @brief @copydoc DataStream::skip
+     */
+    void
+    skip(SIZE_T count) override;
+
+    /**
+     * @brief @copydoc DataStream::seek
+     * @note  Only supported in read mode.
+     */
+    void
+    seek(SIZE_T pos) override;
+
+    /**
+     * @brief @copydoc DataStream::tell
+     */
+    SIZE_T
+    tell() const override;
+
+    /**
+     * @brief @copydoc DataStream::isEOF
+     */
+    bool
+    isEOF() const override;
+
+    /**
+     * @brief @copydoc DataStream::clone
+     */
+    SPtr<DataStream>
+    clone(bool copyData = true) const override;
+
+    /**
+     * @brief @copydoc DataStream::close
+     * @note  In write mode this flushes the pending block and writes the
+     *        block index, completing the frame.
+     */
+    void
+    close() override;
+
+   private:
+    /**
+     * @brief Compresses the pending block and writes it to the stream.
+     */
+    void
+    flushBlock();
+
+    /**
+     * @brief Reads and decompresses the block starting at the current
+     *        position of the underlying stream.
+     * @return  false if there are no more blocks in the frame.
+     */
+    bool
+    loadNextBlock();
+
+    /**
+     * @brief Moves the underlying stream to the first block of the frame.
+     */
+    void
+    rewind();
+
+    SPtr<DataStream> m_stream;
+    CompressionOptions m_options;
+    SIZE_T m_frameStart = 0;
+
+    Vector<uint8> m_block;
+    Vector<uint8> m_compBlock;
+    Vector<uint8> m_filterBlock;
+    Vector<uint64> m_blockOffsets;
+
+    SIZE_T m_blockStart = 0;
+    SIZE_T m_blockPos = 0;
+    SIZE_T m_blockLength = 0;
+    bool m_endReached = false;
+    bool m_closed = false;
   };
 }
@@ -200,6 +200,12 @@ namespace geEngineSDK {
     virtual SPtr<DataStream>
     clone(bool copyData = true) const = 0;
 
+    /**
+     * @brief Writes any data buffered by the stream to its destination.
+     */
+    virtual void
+    flush() {}
+
     /**
      * @brief Close the stream. This makes further operations invalid.
      */
@@ -397,6 +403,12 @@ namespace geEngineSDK {
     SPtr<DataStream>
     clone(bool copyData = true) const override;
 
+    /**
+     * @brief @copydoc DataStream::flush
+     */
+    void
+    flush() override;
+
     /**
      * @brief @copydoc DataStream::close
      */
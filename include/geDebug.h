@@ -19,6 +19,8 @@
 /*****************************************************************************/
 #include "gePrerequisitesUtilities.h"
 #include "geLog.h"
+#include "geAsyncLog.h"
+#include "geLogSink.h"
 
 namespace geEngineSDK {
   class Log;
@@ -52,6 +54,36 @@ namespace geEngineSDK {
     void
     log(const String& message, LogVerbosity verbosity, uint32 category = 0);
 
+    /**
+     * @brief Logs a new message recorded at an earlier time.
+     * @param[in] localTime Time the message was recorded at.
+     */
+    void
+    log(const String& message,
+        LogVerbosity verbosity,
+        uint32 category,
+        time_t localTime);
+
+    /**
+     * @brief Adds a sink every new log entry is sent to.
+     */
+    void
+    addSink(const SPtr<LogSink>& sink);
+
+    /**
+     * @brief Removes a sink added by addSink(), after flushing it.
+     */
+    void
+    removeSink(const SPtr<LogSink>& sink);
+
+    /**
+     * @brief Blocks until all the entries logged so far are persisted by the
+     *        sinks. Logs the messages suppressed by the flood protection that
+     *        weren't reported yet, and flushes the AsyncLog if it's started.
+     */
+    void
+    flush();
+
     /**
      * @brief Retrieves the Log used by the Debug instance.
      */
@@ -96,6 +128,45 @@ namespace geEngineSDK {
     void
     saveTextLog(const Path& path) const;
 
+    /**
+     * @brief Returns the header of the text logs, with information about
+     *        the system.
+     */
+    static String
+    getTextLogHeader();
+
+    /**
+     * @brief Formats an entry as it's written to the text logs.
+     */
+    static String
+    getTextLogEntry(const LogEntry& entry);
+
+    /**
+     * @brief Formats an entry as it's written to the text logs, with the
+     *        given name for its category.
+     */
+    static String
+    getTextLogEntry(const LogEntry& entry, const String& categoryName);
+
+    /**
+     * @brief Returns the beginning of the HTML logs, with information about
+     *        the system, up to the first entry.
+     */
+    static String
+    getHtmlLogHeader();
+
+    /**
+     * @brief Formats an entry as it's written to the HTML logs.
+     */
+    static String
+    getHtmlLogEntry(const LogEntry& entry);
+
+    /**
+     * @brief Returns the end of the HTML logs, after the last entry.
+     */
+    static String
+    getHtmlLogFooter();
+
     /**
      * @brief Triggered when a new entry in the log is added.
      * @note  Sim thread only.
@@ -118,6 +189,8 @@ namespace geEngineSDK {
 
     /**
      * @brief Triggers callbacks that notify external code that a log entry was added.
+     *        Once per second also logs the messages suppressed by the flood
+     *        protection that weren't reported yet.
      * @note  Internal method. Sim thread only.
      */
     void
@@ -125,7 +198,14 @@ namespace geEngineSDK {
 
    private:
     uint64 m_logHash = 0;
+    time_t m_floodReportTime = 0;
     Log m_log;
+    /**
+     * Replaced as a whole when sinks are added or removed, so logging only
+     * holds the lock to copy the pointer.
+     */
+    SPtr<const Vector<SPtr<LogSink>>> m_sinks;
+    Mutex m_sinksMutex;
     function<bool(const String& message,
                   LogVerbosity verbosity,
                   uint32 category)> m_customLogCallback;
@@ -147,13 +227,15 @@ namespace geEngineSDK {
 
   /**
    * @brief Defines a new log category to use with GE_LOG.
-   *        Each category must have a unique ID.
+   *        Each category must have a unique ID, lower than
+   *        Log::MAX_CATEGORIES.
    */
 #define GE_LOG_CATEGORY(name, id)                                             \
   struct LogCategory##name {                                                  \
     enum {                                                                    \
     _id = id                                                                  \
     };                                                                        \
+    static_assert(id < Log::MAX_CATEGORIES, "Invalid log category ID.");      \
     static bool s_registered;                                                 \
   };
 
@@ -164,16 +246,136 @@ bool LogCategory##name::s_registered = Log::_registerCategory(LogCategory##name:
 #define GE_LOG_GET_CATEGORY_ID(category) LogCategory##category::_id
 
 
+  /**
+   * @brief Returns what is formatted in place of a GE_LOG argument. Arguments
+   *        converted to text when they are captured are formatted from that
+   *        text, so they are only converted once.
+   */
+  template<class T, class Captured>
+  decltype(auto)
+  ge_logFormatArg(const T& value, const Captured& captured) {
+    IF_CONSTEXPR (LOG_ARG_TYPE::kCONVERTED == LogArgTraits<T>::value) {
+      return (captured);
+    }
+    else {
+      return (value);
+    }
+  }
+
+  /**
+   * @brief Logs a message from a call site, given its arguments and what was
+   *        captured from them. If @p floodProtection isn't 0 the message is
+   *        checked against it first, which requires the hash of the captured
+   *        arguments. Sends the message to the AsyncLog if it's started,
+   *        otherwise formats it right away.
+   */
+  template<class Message, class CapturedMessage, class... Args, class... Captured>
+  void
+  ge_logCaptured(const LogCallSite& site,
+                 uint64 floodProtection,
+                 const Message& message,
+                 const std::tuple<Args&...>& args,
+                 const CapturedMessage& capturedMessage,
+                 const Captured&... captured) {
+    if (0 != floodProtection) {
+      SIZE_T argsHash = 0;
+      LogRecordArgs::hash(argsHash, capturedMessage);
+      (LogRecordArgs::hash(argsHash, captured), ...);
+      if (!Log::_admitMessage(site, floodProtection, argsHash)) {
+        return;
+      }
+    }
+
+    if (AsyncLog::isActive() && AsyncLog::_write(site, capturedMessage, captured...)) {
+      return;
+    }
+
+    std::apply([&](const auto&... values) {
+                 g_debug().log(StringUtil::format(ge_logMessageText(message),
+                                                  ge_logFormatArg(values, captured)...) +
+                                 site.location,
+                               site.verbosity,
+                               site.category);
+               },
+               args);
+  }
+
+  /**
+   * @brief Logs a message from a call site. Sends it to the AsyncLog if it's
+   *        started, otherwise formats it right away.
+   */
+  template<class Message, class... Args>
+  void
+  ge_logRecord(const LogCallSite& site, Message&& message, Args&&... args) {
+    ge_logCaptured(site,
+                   0,
+                   message,
+                   std::forward_as_tuple(args...),
+                   LogMessageArg<Message>::capture(message),
+                   LogArg<Args>::capture(args)...);
+  }
+
+  /**
+   * @brief Logs a message from a GE_LOG, unless the flood protection of its
+   *        category suppresses it.
+   */
+  template<class Message, class... Args>
+  void
+  ge_logMessage(const LogCallSite& site, Message&& message, Args&&... args) {
+    uint64 floodProtection = Log::_getFloodProtection(site.category);
+
+    //Only repeats are found through the arguments, the rate limit drops
+    //messages before they are captured
+    if (0 != floodProtection && !Log::_collapsesRepeats(floodProtection)) {
+      if (!Log::_admitMessage(site, floodProtection, 0)) {
+        return;
+      }
+      floodProtection = 0;
+    }
+
+    ge_logCaptured(site,
+                   floodProtection,
+                   message,
+                   std::forward_as_tuple(args...),
+                   LogMessageArg<Message>::capture(message),
+                   LogArg<Args>::capture(args)...);
+  }
+
+  /**
+   * @brief Returns the spelling of a macro argument, after expanding it.
+   */
+#define GE_LOG_STRINGIZE(x) #x
+
+  /**
+   * @brief Passes the message of a GE_LOG on, wrapped in a LogLiteral if it's
+   *        a string literal.
+   */
+#define GE_LOG_MESSAGE(message)                                               \
+  ge_logMessageArg<ge_isStringLiteral(GE_LOG_STRINGIZE(message))>(message)
+
+  /**
+   * @brief Logs a message. Messages more verbose than GE_LOG_VERBOSITY aren't
+   *        compiled in. The others are checked against the verbosity set
+   *        for their category with Log::setVerbosity() before evaluating the
+   *        arguments.
+   */
 #define GE_LOG(verbosity, category, message, ...)                             \
   do {                                                                        \
   using namespace ::geEngineSDK;                                              \
   IF_CONSTEXPR ((int32)LogVerbosity::verbosity <= (int32)GE_LOG_VERBOSITY) {  \
-    g_debug().log(StringUtil::format(message, ##__VA_ARGS__) +                \
-                          String("\n\t\t in ") +                              \
-                          __PRETTY_FUNCTION__ +                               \
-                          " [" + __FILE__ + ":" +                             \
-                          toString(static_cast<int32>(__LINE__)) + "]\n",     \
-                  LogVerbosity::verbosity, LogCategory##category::_id);       \
+    if (Log::isEnabled(LogCategory##category::_id, LogVerbosity::verbosity)) {\
+      using _geLogFormatter =                                                 \
+        decltype(ge_logFormatterOf(GE_LOG_MESSAGE(message), ##__VA_ARGS__));  \
+      static const LogCallSite _geLogCallSite(                                \
+        LogVerbosity::verbosity,                                              \
+        LogCategory##category::_id,                                           \
+        __PRETTY_FUNCTION__,                                                  \
+        __FILE__,                                                             \
+        static_cast<uint32>(__LINE__),                                        \
+        _geLogFormatter::format,                                              \
+        _geLogFormatter::encode);                                             \
+      ge_logMessage(_geLogCallSite, GE_LOG_MESSAGE(message), ##__VA_ARGS__);  \
+    }                                                                         \
   }} while (0)
 
   GE_LOG_CATEGORY(Uncategorized, 0);
@@ -0,0 +1,181 @@
+/*****************************************************************************/
+/**
+ * @file    geDirectoryWalker.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Walks directory trees without building a Path per entry.
+ *
+ * Walks directory trees handing the callbacks a lightweight view of each
+ * entry, instead of building and parsing a full Path for every one of them.
+ * On Linux the directories are read with getdents64, and the entry types
+ * reported by the file system are used so no stat is needed in most cases.
+ * Subdirectories can optionally be read in parallel by TaskScheduler
+ * workers.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+
+namespace geEngineSDK {
+  using std::function;
+
+  /**
+   * @brief Entry found while walking a directory tree. The strings it points
+   *        to are only valid during the callback it was provided to.
+   */
+  struct DirectoryEntry
+  {
+    /**
+     * Full path of the entry, using '/' as separator. Null terminated.
+     */
+    const ANSICHAR* path = nullptr;
+    uint32 pathLength = 0;
+
+    /**
+     * Offset, in @p path, of the name of the entry.
+     */
+    uint32 nameOffset = 0;
+
+    /**
+     * Depth of the entry, 0 for the direct children of the walked directory.
+     */
+    uint32 depth = 0;
+
+    bool isDirectory = false;
+
+    /**
+     * True for symbolic links. Links to directories are reported as
+     * directories but never walked into.
+     */
+    bool isSymbolicLink = false;
+
+    /**
+     * @brief Returns the name of the entry. Null terminated.
+     */
+    const ANSICHAR*
+    getName() const {
+      return path + nameOffset;
+    }
+
+    /**
+     * @brief Returns a copy of the full path of the entry.
+     */
+    String
+    toString() const {
+      return String(path, pathLength);
+    }
+
+    /**
+     * @brief Builds a Path for the entry.
+     */
+    Path
+    toPath() const;
+  };
+
+  /**
+   * @brief Options used to walk a directory tree.
+   */
+  struct DirectoryWalkOptions
+  {
+    /**
+     * If false only the direct children of the directory are visited.
+     */
+    bool recursive = true;
+
+    /**
+     * If true, and the TaskScheduler is running, subdirectories are read by
+     * the scheduler workers while the callbacks run. The callbacks are always
+     * triggered on the calling thread.
+     */
+    bool parallel = false;
+
+    /**
+     * If true the entries of a parallel walk are delivered in the same order
+     * a serial walk would: each directory is fully visited right after its
+     * entry. If false, directories are delivered as soon as they are read,
+     * which keeps less of the tree in memory.
+     */
+    bool ordered = true;
+  };
+
+  /**
+   * @brief Walks directory trees.
+   */
+  class GE_UTILITIES_EXPORT DirectoryWalker
+  {
+   public:
+    using EntryCallback = function<bool(const DirectoryEntry&)>;
+
+    /**
+     * @brief Visits the files and directories inside a directory.
+     * @param[in] dirPath Directory to walk.
+     * @param[in] fileCallback  Triggered for every file found. If it returns
+     *            false the walk stops. Can be null.
+     * @param[in] dirCallback Triggered for every directory found, before its
+     *            contents are visited. If it returns false the walk stops.
+     *            Can be null.
+     * @param[in] options Walk options.
+     * @return  True if the whole tree was visited, false if @p dirPath isn't
+     *          a directory or a callback stopped the walk.
+     */
+    static bool
+    walk(const Path& dirPath,
+         const EntryCallback& fileCallback,
+         const EntryCallback& dirCallback = nullptr,
+         const DirectoryWalkOptions& options = DirectoryWalkOptions());
+
+   private:
+    struct Listing;
+    struct ParallelWalk;
+
+    /**
+     * @brief Reads the entries of a single directory. Returns false if it
+     *        couldn't be opened.
+     */
+    static bool
+    listDirectory(const String& dirPath, Listing& listing);
+
+    /**
+     * @brief Appends the name of an entry of a listing to @p path, and
+     *        triggers the callback for it. Returns false if the callback
+     *        stopped the walk.
+     */
+    static bool
+    deliverEntry(String& path,
+                 uint32 depth,
+                 const Listing& listing,
+                 uint32 entryIdx,
+                 const EntryCallback& fileCallback,
+                 const EntryCallback& dirCallback);
+
+    /**
+     * @brief Walks the directory at @p path on the calling thread. The
+     *        listings of each depth are reused across directories.
+     */
+    static bool
+    walkSerial(String& path,
+               uint32 depth,
+               Deque<Listing>& listings,
+               const EntryCallback& fileCallback,
+               const EntryCallback& dirCallback,
+               const DirectoryWalkOptions& options);
+
+    /**
+     * @brief Walks the directory at @p rootPath reading the directories on
+     *        the TaskScheduler workers.
+     */
+    static bool
+    walkParallel(const String& rootPath,
+                 const EntryCallback& fileCallback,
+                 const EntryCallback& dirCallback,
+                 const DirectoryWalkOptions& options);
+  };
+}
@@ -18,16 +18,56 @@
  */
 /*****************************************************************************/
 #include "gePrerequisitesUtilities.h"
+#include "geCompression.h"
 
 namespace geEngineSDK {
   struct SerializationContext;
 
   using std::ofstream;
 
+  /**
+   * @brief Entry of the object index stored at the end of a serialized file.
+   */
+  struct FileObjectInfo
+  {
+    /**
+     * Offset of the object in the file, pointing to its size prefix.
+     */
+    uint64 offset = 0;
+
+    /**
+     * Size in bytes of the serialized object, without the size prefix.
+     */
+    uint32 size = 0;
+
+    /**
+     * RTTI type id of the object.
+     */
+    uint32 typeId = 0;
+  };
+
   class GE_UTILITIES_EXPORT FileEncoder
   {
    public:
-    FileEncoder(const Path& fileLocation);
+    /**
+     * @brief Creates an encoder writing to the specified file.
+     * @param[in] fileLocation  Path of the file to write.
+     * @param[in] writeIndex  If true an index of all the encoded objects is
+     *            appended to the file, allowing FileDecoder to decode any of
+     *            them without reading the ones that come before.
+     */
+    FileEncoder(const Path& fileLocation, bool writeIndex = false);
+
+    /**
+     * @brief Creates an encoder that compresses the file contents on the fly.
+     *        The compressed stream can't seek back to write the size of each
+     *        object before it, so the sizes are only stored in the index,
+     *        which is always written.
+     * @param[in] fileLocation  Path of the file to write.
+     * @param[in] options Options used to compress the data.
+     */
+    FileEncoder(const Path& fileLocation, const CompressionOptions& options);
+
     ~FileEncoder();
 
     /**
@@ -37,25 +77,58 @@ namespace geEngineSDK {
      * @param[in] object  Object to encode.
      * @param[in] params  Optional parameters to be passed to the serialization
      *            callbacks on the objects being serialized.
+     * @param[in] deduplicate If true identical content in the object is only
+     *            written once. See BinarySerializer::encode().
+     * @param[in] compact If true the object is written in the compact format.
+     *            See BinarySerializer::encode().
+     * @return  Identifier of the object in the file, which can be passed to
+     *          FileDecoder::decodeObject(). Objects are numbered in the order
+     *          they are encoded, starting at zero.
      */
-    void
-    encode(IReflectable* object, SerializationContext* context = nullptr);
+    uint32
+    encode(IReflectable* object,
+           SerializationContext* context = nullptr,
+           bool deduplicate = false,
+           bool compact = false);
 
    private:
+    /**
+     * @brief Appends the object index to the end of the file.
+     */
+    void
+    writeIndex();
+
     /**
      * @brief Called by the binary serializer whenever the buffer gets full.
      */
     uint8*
     flushBuffer(uint8* bufferStart, uint32 bytesWritten, uint32& newBufferSize);
 
+    /**
+     * @brief Called by the binary serializer whenever the buffer gets full,
+     *        when the file is being compressed.
+     */
+    uint8*
+    flushBufferCompressed(uint8* bufferStart, uint32 bytesWritten, uint32& newBufferSize);
+
     ofstream m_outputStream;
     uint8* m_writeBuffer = nullptr;
 
+    /**
+     * Compressed output, null if the file is not being compressed.
+     */
+    SPtr<DataStream> m_compressedStream;
+
+    bool m_writeIndex = false;
+    Vector<FileObjectInfo> m_objectIndex;
+
     static const uint32 WRITE_BUFFER_SIZE = 2048;
   };
 
   /**
-   * @brief Decodes objects from the specified file using the RTTI system.\
+   * @brief Decodes objects from the specified file using the RTTI system.
+   *        Files written by a compressing FileEncoder are decompressed on the
+   *        fly.
    */
   class GE_UTILITIES_EXPORT FileDecoder
   {
@@ -85,7 +158,86 @@ namespace geEngineSDK {
     void
     skip();
 
+    /**
+     * @brief Returns true if the file was written with an object index.
+     */
+    bool
+    hasIndex() const {
+      return m_hasIndex;
+    }
+
+    /**
+     * @brief Returns the number of objects in the file.
+     * @note  If the file has no index, the file is scanned once to build it.
+     */
+    uint32
+    getNumObjects();
+
+    /**
+     * @brief Returns the location, size and type of every object in the file,
+     *        in the order they were encoded.
+     * @note  If the file has no index, the file is scanned once to build it.
+     */
+    const Vector<FileObjectInfo>&
+    getObjectIndex();
+
+    /**
+     * @brief Decodes a single object, without decoding any of the objects
+     *        stored before it. Objects referenced by the decoded object are
+     *        stored together with it so they are decoded as well.
+     * @param[in] objectId  Identifier returned by FileEncoder::encode().
+     * @param[in] context   Optional parameters to be passed to the
+     *            serialization callbacks on the objects being serialized.
+     * @return  The decoded object, or null if the identifier is not valid.
+     * @note  The position used by decode() is not modified.
+     */
+    SPtr<IReflectable>
+    decodeObject(uint32 objectId, SerializationContext* context = nullptr);
+
+    /**
+     * @brief Decodes a subset of the objects in the file.
+     *        See decodeObject().
+     * @return  The decoded objects, in the same order as @p objectIds.
+     */
+    Vector<SPtr<IReflectable>>
+    decodeObjects(const Vector<uint32>& objectIds,
+                  SerializationContext* context = nullptr);
+
    private:
+    /**
+     * @brief Reads the object index from the end of the file, if present.
+     */
+    void
+    readIndex();
+
+    /**
+     * @brief Builds the object index by walking the object sizes, for files
+     *        written without one.
+     */
+    void
+    scanObjects();
+
+    /**
+     * @brief Reads the size stored before the next object, taking it from
+     *        the index if the file only stores it there.
+     * @return  0 if there are no more objects. The read position is left at
+     *          the index, if there is one.
+     */
+    uint32
+    readObjectSize() const;
+
+    /**
+     * @brief Returns true if the read position reached the end of the
+     *        objects in the file.
+     */
+    bool
+    isEndOfObjects() const;
+
     SPtr<DataStream> m_inputStream;
+
+    Vector<FileObjectInfo> m_objectIndex;
+    uint64 m_objectsEnd = 0;
+    bool m_hasIndex = false;
+    bool m_indexLoaded = false;
   };
 }
@@ -23,6 +23,47 @@ namespace geEngineSDK {
   using std::time_t;
   using std::function;
 
+  /**
+   * @brief Implementations of the data streams returned for files.
+   */
+  namespace FILE_STREAM_TYPE {
+    enum E {
+      /**
+       * Stream built on the standard library streams (FileDataStream).
+       */
+      kSTANDARD = 0,
+
+      /**
+       * Buffered stream built directly on the file API of the platform.
+       * Falls back to kSTANDARD on platforms without one.
+       */
+      kNATIVE,
+
+      /**
+       * Like kNATIVE, but read-only streams bypass the OS file cache where
+       * supported. Meant for large streaming reads.
+       */
+      kNATIVE_DIRECT
+    };
+  }
+
+  /**
+   * @brief Progress of a FileSystem::copy() operation.
+   */
+  struct FileCopyProgress
+  {
+    uint32 filesCopied = 0;
+    uint32 totalFiles = 0;
+    uint64 bytesCopied = 0;
+    uint64 totalBytes = 0;
+
+    /**
+     * Average rates since the copy started.
+     */
+    float filesPerSecond = 0.0f;
+    float bytesPerSecond = 0.0f;
+  };
+
   /**
    * @brief Utility class for dealing with files.
    */
@@ -34,9 +75,12 @@ namespace geEngineSDK {
      *        writing to that file.
      * @param[in] fullPath  Full path to a file.
      * @param[in] readOnly  (optional) If true, returned stream will only be readable.
+     * @param[in] streamType  (optional) Implementation of the returned stream.
      */
     static SPtr<DataStream>
-    openFile(const Path& fullPath, bool readOnly = true);
+    openFile(const Path& fullPath,
+             bool readOnly = true,
+             FILE_STREAM_TYPE::E streamType = FILE_STREAM_TYPE::kSTANDARD);
 
     /**
      * @brief Opens a file and returns a data stream capable of reading and
@@ -81,9 +125,17 @@ namespace geEngineSDK {
      * @param[in] overwriteExisting	(optional) If true, any existing file/folder
      *            at the new location will be overwritten, otherwise an exception
      *            will be thrown if a file/folder already exists.
+     * @param[in] progressCallback  (optional) Triggered on the calling thread
+     *            as files are copied.
+     * @note  If the TaskScheduler is started the files of a folder are copied
+     *        in parallel, as many at once per device as the FileScheduler
+     *        allows.
      */
     static void
-    copy(const Path& oldPath, const Path& newPath, bool overwriteExisting = true);
+    copy(const Path& oldPath,
+         const Path& newPath,
+         bool overwriteExisting = true,
+         const function<void(const FileCopyProgress&)>& progressCallback = nullptr);
 
     /**
      * @brief Creates a folder at the specified path.
@@ -135,6 +187,8 @@ namespace geEngineSDK {
      *            will be recursively visited as well.
      * @return  true if iteration finished iterating over all files/folders, or
      *          false if it was interrupted by a callback returning false.
+     * @note  Builds a Path for every entry. Walks over large trees should use
+     *        DirectoryWalker directly.
      */
     static bool
     iterate(const Path& dirPath,
@@ -163,7 +217,9 @@ namespace geEngineSDK {
 
    private:
     /**
-     * @brief Copy a single file. Internal function used by copy().
+     * @brief Copy a single file. Internal function used by copy(). On Linux
+     *        the data is shared through a reflink when the file system
+     *        supports it, and copied inside the kernel otherwise.
      */
     static void
     copyFile(const Path& from, const Path& to);
@@ -182,47 +238,115 @@ namespace geEngineSDK {
   };
 
   /**
-   * @brief Locks access to files on the same drive, allowing only one file to
-   *        be read at a time, per drive. This prevents multiple threads
-   *        accessing multiple files on the same drive at once, ruining
-   *        performance on mechanical drives.
+   * @brief Limits how many files can be accessed at once on the same device.
+   *        Rotational drives only allow one file to be read at a time, so
+   *        threads accessing different files on the same drive don't ruin
+   *        its performance. Solid state devices allow several, and files on
+   *        different devices can always be accessed at the same time.
    */
   class GE_UTILITIES_EXPORT FileScheduler final
   {
    public:
+    /**
+     * @brief Keeps access locked while it's alive.
+     */
+    class GE_UTILITIES_EXPORT ScopedLock final
+    {
+     public:
+      explicit ScopedLock(const Path& path);
+      explicit ScopedLock(uint64 deviceId);
+      ~ScopedLock();
+
+      ScopedLock(const ScopedLock&) = delete;
+
+      ScopedLock&
+      operator=(const ScopedLock&) = delete;
+
+     private:
+      uint64 m_deviceId;
+    };
+
     /**
      * @brief Locks access and doesn't allow other threads to get past this
-     *        point until access is unlocked. Any scheduled file access should
-     *        happen past this point.
+     *        point, once the concurrency limit of the device the path belongs
+     *        to is reached, until access is unlocked. Any scheduled file
+     *        access should happen past this point.
      */
     static void
-    lock(const Path& /*path*/) {
-      //Note: File path should be analyzed and determined on which drive does
-      //the path belong to. Locks can then be issued on a per-drive basis,
-      //instead of having one global lock. This would allow multiple files to
-      //be accessed at the same time, as long as they're on different drives.
-      m_mutex.lock();
-    }
+    lock(const Path& path);
 
     /**
      * @brief Unlocks access and allows another thread to lock file access.
      *        Must be provided with the same file path as lock().
      */
     static void
-    unlock(const Path& /*path*/) {
-      m_mutex.unlock();
-    }
+    unlock(const Path& path);
 
     /**
      * @brief Returns a lock object that immediately locks access (same as
      *        lock()), and then calls unlock() when it goes out of scope.
      */
-    static Lock
-    getLock(const Path& /*path*/) {
-      return Lock(m_mutex);
+    static ScopedLock
+    getLock(const Path& path) {
+      return ScopedLock(path);
     }
 
+    /**
+     * @brief Returns the identifier of the device the path belongs to. Paths
+     *        that don't exist yet resolve to the device of their closest
+     *        existing parent.
+     */
+    static uint64
+    getDeviceId(const Path& path);
+
+    /**
+     * @brief Sets the number of files that can be accessed at once on a
+     *        device, overriding the default for its type.
+     */
+    static void
+    setDeviceConcurrency(uint64 deviceId, uint32 maxConcurrent);
+
+    /**
+     * @brief Returns the number of files that can be accessed at once on a
+     *        device.
+     */
+    static uint32
+    getDeviceConcurrency(uint64 deviceId);
+
+    /**
+     * @brief Sets the number of files that can be accessed at once on
+     *        devices without their own limit. Devices whose type can't be
+     *        determined are treated as rotational.
+     * @note  Only affects devices that weren't accessed yet.
+     */
+    static void
+    setDefaultConcurrency(uint32 rotational, uint32 solidState);
+
    private:
+    struct DeviceState
+    {
+      uint32 maxConcurrent = 1;
+      uint32 numActive = 0;
+      Signal released;
+    };
+
+    /**
+     * @brief Returns the state of a device, creating it with the default
+     *        limit for its type the first time. Must be called with
+     *        m_mutex locked.
+     */
+    static DeviceState&
+    getDevice(uint64 deviceId);
+
+    static void
+    lockDevice(uint64 deviceId);
+
+    static void
+    unlockDevice(uint64 deviceId);
+
     static Mutex m_mutex;
+    static UnorderedMap<uint64, DeviceState> m_devices;
+    static uint32 m_rotationalConcurrency;
+    static uint32 m_solidStateConcurrency;
   };
 }
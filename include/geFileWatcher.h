@@ -0,0 +1,249 @@
+/*****************************************************************************/
+/**
+ * @file    geFileWatcher.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Notifies about changes to watched directories.
+ *
+ * Notifies about files created, modified or removed inside watched
+ * directories. On Linux the changes are reported by inotify, and queued in
+ * batches until update() triggers the callbacks.
+ *
+ * The watcher can also keep a cache of the state of the files inside the
+ * watched directories. FileSystem queries it before going to the OS, and the
+ * watcher invalidates the entries as changes are reported, so repeated
+ * existence, size and timestamp checks don't need any system call.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geModule.h"
+#include "geThreadPool.h"
+
+namespace geEngineSDK {
+  using std::function;
+
+  namespace FILE_CHANGE {
+    enum E {
+      kCREATED = 0,
+      kMODIFIED,
+      kREMOVED
+    };
+  }
+
+  /**
+   * @brief Single change reported by the FileWatcher. Renames are reported
+   *        as the removal of the old path and the creation of the new one.
+   */
+  struct FileChange
+  {
+    Path path;
+    FILE_CHANGE::E type = FILE_CHANGE::kMODIFIED;
+    bool isDirectory = false;
+  };
+
+  /**
+   * @brief State of a file as kept by the stat cache.
+   */
+  struct FileStat
+  {
+    bool exists = false;
+    bool isDirectory = false;
+    bool isRegularFile = false;
+    uint64 size = 0;
+    time_t lastModifiedTime = 0;
+  };
+
+  /**
+   * @brief Options used to create the FileWatcher.
+   */
+  struct FileWatcherOptions
+  {
+    /**
+     * Time changes are collected for before being queued as a batch. Editors
+     * usually save files with several writes, which end up merged into a
+     * single change.
+     */
+    uint32 batchDelayMs = 50;
+
+    /**
+     * If true FileSystem queries the state of the files inside the watched
+     * directories from a cache. Changes done through FileSystem are seen
+     * right away, changes done by other means as soon as the watcher
+     * receives their notification.
+     */
+    bool enableStatCache = false;
+
+    /**
+     * Maximum number of entries in the stat cache. Once reached the cache is
+     * emptied.
+     */
+    uint32 maxCachedEntries = 1024 * 1024;
+  };
+
+  /**
+   * @brief Watches directories for changes.
+   * @note  Thread safe.
+   * @note  Requires the ThreadPool to be started.
+   */
+  class GE_UTILITIES_EXPORT FileWatcher : public Module<FileWatcher>
+  {
+   public:
+    using ChangeCallback = function<void(const Vector<FileChange>&)>;
+
+    explicit FileWatcher(const FileWatcherOptions& options = FileWatcherOptions());
+    ~FileWatcher();
+
+    /**
+     * @brief Starts watching a directory.
+     * @param[in] dirPath Directory to watch.
+     * @param[in] recursive If true changes in subdirectories are reported
+     *            too, including the ones created after this call.
+     * @param[in] callback  Triggered by update() with the changes reported
+     *            since the last one.
+     * @return  Identifier of the watch, or 0 if the directory couldn't be
+     *          watched.
+     */
+    uint32
+    watch(const Path& dirPath, bool recursive, ChangeCallback callback);
+
+    /**
+     * @brief Stops a watch started by watch(). Changes already queued for it
+     *        are discarded.
+     */
+    void
+    unwatch(uint32 watchId);
+
+    /**
+     * @brief Triggers the callbacks for the changes queued so far, on the
+     *        calling thread.
+     */
+    void
+    update();
+
+    /**
+     * @brief Returns true if the stat cache is being used.
+     */
+    bool
+    isStatCacheEnabled() const {
+      return m_options.enableStatCache;
+    }
+
+    /**
+     * @brief Returns the state of a file from the stat cache, reading and
+     *        caching it if needed.
+     * @return  False if the file isn't inside a watched directory, so its
+     *          state can't be cached.
+     */
+    bool
+    getStat(const Path& fullPath, FileStat& stat);
+
+    /**
+     * @brief Drops a path, and everything under it, from the stat cache.
+     *        Used by FileSystem after modifying it.
+     */
+    void
+    invalidate(const Path& fullPath);
+
+   private:
+    struct Watch
+    {
+      uint32 id;
+      String path;
+      bool recursive;
+      ChangeCallback callback;
+    };
+
+    struct PendingChange
+    {
+      String path;
+      FILE_CHANGE::E type;
+      bool isDirectory;
+    };
+
+    struct Batch
+    {
+      uint32 watchId;
+      ChangeCallback callback;
+      Vector<FileChange> changes;
+    };
+
+    /**
+     * @brief Returns true if an existing watch covers the directory. Must be
+     *        called with the mutex locked.
+     */
+    bool
+    isCovered(const String& dirPath) const;
+
+    /**
+     * @brief Starts receiving notifications for a directory and, if
+     *        @p recursive, for all the ones inside it. The entries found are
+     *        added to @p found as created, if not null. Must be called with
+     *        the mutex locked.
+     */
+    bool
+    addDirectory(const String& dirPath,
+                 bool recursive,
+                 Vector<FileChange>* found);
+
+    /**
+     * @brief Records a change reported by the OS, invalidating the cache
+     *        and adding it to the pending batch. Must be called with the
+     *        mutex locked.
+     */
+    void
+    onChange(const String& path, FILE_CHANGE::E type, bool isDirectory);
+
+    /**
+     * @brief Moves the pending changes to the queue read by update().
+     */
+    void
+    flushPending();
+
+    /**
+     * @brief Drops a path, and optionally everything under it, from the
+     *        stat cache. Must be called with the mutex locked.
+     */
+    void
+    invalidateLocked(const String& path, bool recursive);
+
+    /**
+     * @brief Main loop of the thread reading the notifications.
+     */
+    void
+    run();
+
+    FileWatcherOptions m_options;
+    HThread m_thread;
+
+    int32 m_notifyFd = -1;
+    int32 m_wakeFd = -1;
+    UnorderedMap<int32, String> m_watchedDirs;
+    UnorderedMap<String, int32> m_watchedDirIds;
+
+    Vector<Watch> m_watches;
+    uint32 m_nextWatchId = 1;
+
+    Vector<PendingChange> m_pending;
+    UnorderedMap<String, uint32> m_pendingIdx;
+    Vector<Batch> m_queued;
+
+    /**
+     * Cached states, and their paths sorted so everything under a directory
+     * can be invalidated at once.
+     */
+    UnorderedMap<String, FileStat> m_statCache;
+    Set<String> m_cachedPaths;
+    uint64 m_cacheGeneration = 0;
+
+    mutable Mutex m_mutex;
+  };
+}
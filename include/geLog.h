@@ -21,6 +21,8 @@
 #include "gePrerequisitesUtilities.h"
 #include "geTime.h"
 
+#include <atomic>
+
 namespace geEngineSDK {
   using std::move;
   using std::time;
@@ -95,6 +97,13 @@ namespace geEngineSDK {
         m_localTime(time(nullptr))
     {}
 
+    LogEntry(String msg, LogVerbosity verbosity, uint32 category, time_t localTime)
+      : m_msg(move(msg)),
+        m_verbosity(verbosity),
+        m_category(category),
+        m_localTime(localTime)
+    {}
+
     /**
      * @brief Determines how important is the message and when should it be
      *        displayed.
@@ -135,6 +144,118 @@ namespace geEngineSDK {
     time_t m_localTime = 0;
   };
 
+  class BinaryLogArgs;
+
+  /**
+   * @brief Describes a place in the code that logs messages. GE_LOG creates
+   *        one in a static local the first time it runs, so the information
+   *        known at compile time isn't built again for every message.
+   */
+  struct GE_UTILITIES_EXPORT LogCallSite
+  {
+    /**
+     * @brief Function formatting the message of a record written by
+     *        AsyncLog, from the arguments stored in it.
+     */
+    using FormatFn = String(*)(const uint8* args);
+
+    /**
+     * @brief Function copying the arguments of a record written by AsyncLog
+     *        to a binary log, without formatting them.
+     */
+    using EncodeFn = void(*)(const uint8* args, BinaryLogArgs& output);
+
+    LogCallSite(LogVerbosity inVerbosity,
+                uint32 inCategory,
+                const ANSICHAR* inFunction,
+                const ANSICHAR* inFile,
+                uint32 inLine,
+                FormatFn inFormatArgs,
+                EncodeFn inEncodeArgs);
+
+    /**
+     * Unique identifier of the call site, assigned in the order they are
+     * first reached.
+     */
+    uint32 id;
+    LogVerbosity verbosity;
+    uint32 category;
+    const ANSICHAR* function;
+    const ANSICHAR* file;
+    uint32 line;
+    FormatFn formatArgs;
+    EncodeFn encodeArgs;
+
+    /**
+     * Text appended to every message logged from here, with the function,
+     * file and line.
+     */
+    String location;
+
+    /**
+     * @brief State of the flood protection of a call site. Only used if it's
+     *        enabled for its category.
+     */
+    struct FloodState
+    {
+      /**
+       * Time in nanoseconds the rate limit lets a message through at again,
+       * before counting the burst.
+       */
+      std::atomic<int64> allowedTime{ 0 };
+
+      /**
+       * Hash of the arguments of the last message logged. 0 if none was.
+       */
+      std::atomic<SIZE_T> lastArgsHash{ 0 };
+
+      /**
+       * Messages suppressed since the last time they were reported.
+       */
+      std::atomic<uint32> numRepeated{ 0 };
+      std::atomic<uint32> numRateLimited{ 0 };
+
+      /**
+       * Set once the call site is in the list Log::_reportSuppressed() goes
+       * through.
+       */
+      std::atomic<bool> isRegistered{ false };
+
+      /**
+       * Call site the reports are logged from, created by the first one.
+       */
+      std::atomic<const LogCallSite*> summarySite{ nullptr };
+    };
+
+    mutable FloodState flood;
+  };
+
+  /**
+   * @brief Limits the messages logged by each GE_LOG of a category, so one
+   *        called in a hot loop doesn't flood the log. Suppressed messages
+   *        aren't formatted, and their number is logged later.
+   */
+  struct LogFloodProtection
+  {
+    /**
+     * Messages each GE_LOG can log per second, on average. 0 for no limit.
+     */
+    uint32 maxPerSecond = 0;
+
+    /**
+     * Messages each GE_LOG can log at once before the rate limit applies.
+     */
+    uint32 burst = 10;
+
+    /**
+     * If true a message with the same arguments as the previous one logged
+     * by the same GE_LOG is suppressed. They are reported as "Previous
+     * message repeated N times" with the next different one, or by
+     * Debug::_triggerCallbacks() and Debug::flush() if it keeps repeating.
+     */
+    bool collapseRepeats = false;
+  };
+
   /**
    * @brief Used for logging messages. Can categorize messages according to
    *        channels, save the log to a file and send out callbacks when a new
@@ -144,6 +265,17 @@ namespace geEngineSDK {
   class GE_UTILITIES_EXPORT Log
   {
    public:
+    /**
+     * Category IDs must be lower than this, so their verbosity filter is a
+     * single element of a table.
+     */
+    static CONSTEXPR uint32 MAX_CATEGORIES = 256;
+
+    /**
+     * @brief Default number of entries kept in memory.
+     */
+    static CONSTEXPR uint32 DEFAULT_MAX_ENTRIES = 8192;
+
     Log() = default;
     ~Log();
 
@@ -158,6 +290,16 @@ namespace geEngineSDK {
     void
     logMsg(const String& message, LogVerbosity verbosity, uint32 category);
 
+    /**
+     * @brief Logs a new message recorded at an earlier time.
+     * @param[in] localTime Time the message was recorded at.
+     */
+    void
+    logMsg(const String& message,
+           LogVerbosity verbosity,
+           uint32 category,
+           time_t localTime);
+
     /**
      * @brief Removes all log entries.
      */
@@ -178,6 +320,19 @@ namespace geEngineSDK {
     Vector<LogEntry>
     getEntries() const;
 
+    /**
+     * @brief Sets the maximum number of read, and unread, entries kept in
+     *        memory. Once reached the oldest ones are discarded. Use a
+     *        LogSink to keep the whole history.
+     */
+    void
+    setMaxEntries(uint32 maxEntries);
+
+    uint32
+    getMaxEntries() const {
+      return m_maxEntries;
+    }
+
     /**
      * @brief Returns the latest unread entry from the log queue, and removes
      *        the entry from the unread entries list.
@@ -239,6 +394,123 @@ namespace geEngineSDK {
     static bool
     _registerCategory(uint32 id, const char* name);
 
+    /**
+     * @brief Checks if GE_LOG messages of a category and verbosity are
+     *        logged. GE_LOG checks it before evaluating its arguments.
+     */
+    static bool
+    isEnabled(uint32 category, LogVerbosity verbosity) {
+      return s_mutedLevels[category].load(std::memory_order_relaxed) <=
+             static_cast<int32>(LogVerbosity::kVeryVerbose) -
+               static_cast<int32>(verbosity);
+    }
+
+    /**
+     * @brief Returns the most verbose level of the GE_LOG messages of a
+     *        category that are logged.
+     */
+    static LogVerbosity
+    getVerbosity(uint32 category);
+
+    /**
+     * @brief Sets the most verbose level of the GE_LOG messages of a
+     *        category that are logged. All of them are logged by default.
+     * @note  Messages more verbose than GE_LOG_VERBOSITY aren't compiled in,
+     *        so they can't be enabled at runtime.
+     */
+    static void
+    setVerbosity(uint32 category, LogVerbosity verbosity);
+
+    /**
+     * @brief Sets the most verbose level of the GE_LOG messages of every
+     *        category that are logged.
+     */
+    static void
+    setVerbosity(LogVerbosity verbosity);
+
+    /**
+     * @brief Sets the verbosity of several categories from a list separated
+     *        by commas, like "Warning, FileSystem=Verbose, RTTI=Error".
+     *        Entries without a category apply to all of them, and must be
+     *        first. Names are compared ignoring case.
+     * @return  False if any entry isn't valid. The valid ones are applied.
+     */
+    static bool
+    setVerbosity(const String& filters);
+
+    /**
+     * @brief Returns the flood protection of the GE_LOG messages of a
+     *        category.
+     */
+    static LogFloodProtection
+    getFloodProtection(uint32 category);
+
+    /**
+     * @brief Sets the flood protection of the GE_LOG messages of a category.
+     *        They have none by default.
+     */
+    static void
+    setFloodProtection(uint32 category, const LogFloodProtection& options);
+
+    /**
+     * @brief Sets the flood protection of the GE_LOG messages of every
+     *        category.
+     */
+    static void
+    setFloodProtection(const LogFloodProtection& options);
+
+    /**
+     * @brief Returns the number of messages suppressed for repeating the
+     *        previous one.
+     */
+    static uint64
+    getNumRepeated();
+
+    /**
+     * @brief Returns the number of messages dropped by the rate limit.
+     */
+    static uint64
+    getNumRateLimited();
+
+    /**
+     * @brief Returns the flood protection of a category packed in a single
+     *        value: the rate in the low 32 bits, the burst in the next 31
+     *        and whether repeats are collapsed in the last. 0 if it has none.
+     * @note  Internal method. GE_LOG checks it before formatting a message.
+     */
+    static uint64
+    _getFloodProtection(uint32 category) {
+      return s_floodProtection[category].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns true if a value returned by _getFloodProtection()
+     *        collapses repeated messages.
+     */
+    static bool
+    _collapsesRepeats(uint64 floodProtection) {
+      return 0 != (floodProtection >> 63);
+    }
+
+    /**
+     * @brief Checks a message of @p site against the flood protection of its
+     *        category, and logs the messages of the site suppressed before it.
+     * @param[in] argsHash  Hash of the arguments of the message. Only used if
+     *                      repeats are collapsed.
+     * @return  False if the message must be suppressed.
+     * @note  Internal method.
+     */
+    static bool
+    _admitMessage(const LogCallSite& site, uint64 floodProtection, SIZE_T argsHash);
+
+    /**
+     * @brief Logs the number of messages suppressed by every call site that
+     *        weren't reported yet.
+     * @note  Internal method. Called by Debug.
+     */
+    static void
+    _reportSuppressed();
+
    private:
     friend class Debug;
 
@@ -248,10 +520,24 @@ namespace geEngineSDK {
     Vector<LogEntry>
     getAllEntries() const;
 
-    Vector<LogEntry> m_entries;
+    Deque<LogEntry> m_entries;
     Queue<LogEntry> m_unreadEntries;
+    uint32 m_maxEntries = DEFAULT_MAX_ENTRIES;
     uint64 m_hash = 0;
     mutable RecursiveMutex m_mutex;
     static UnorderedMap<uint32, String> s_categories;
+
+    /**
+     * Number of verbosity levels, from the most verbose, muted for each
+     * category. Zero initialized, so GE_LOG can be used during static
+     * initialization.
+     */
+    static std::atomic<uint8> s_mutedLevels[MAX_CATEGORIES];
+
+    /**
+     * Flood protection of each category, packed as returned by
+     * _getFloodProtection().
+     */
+    static std::atomic<uint64> s_floodProtection[MAX_CATEGORIES];
   };
 }
@@ -0,0 +1,172 @@
+/*****************************************************************************/
+/**
+ * @file    geLogSink.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Destinations the log entries are streamed to.
+ *
+ * Sinks receive every entry logged through Debug as it is added, so the
+ * history can be persisted while the application runs instead of kept in
+ * memory until it ends.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geLog.h"
+
+namespace geEngineSDK {
+  /**
+   * @brief Receives the entries logged through Debug.
+   * @note  write() may be called from several threads at once.
+   */
+  class GE_UTILITIES_EXPORT LogSink
+  {
+   public:
+    virtual ~LogSink() = default;
+
+    /**
+     * @brief Called for every new entry.
+     */
+    virtual void
+    write(const LogEntry& entry) = 0;
+
+    /**
+     * @brief Blocks until all the entries written so far are persisted.
+     */
+    virtual void
+    flush() {}
+  };
+
+  /**
+   * @brief Options used to create a FileLogSink.
+   */
+  struct FileLogSinkOptions
+  {
+    /**
+     * Size in bytes the log file is rotated at. 0 to never rotate it by size.
+     * A file may grow past it by up to a single batch.
+     */
+    uint64 maxFileSize = 16 * 1024 * 1024;
+
+    /**
+     * Time in seconds since the log file was created it is rotated at. 0 to
+     * never rotate it by time.
+     */
+    uint32 maxFileAge = 24 * 60 * 60;
+
+    /**
+     * Number of rotated files kept besides the current one. Older ones are
+     * removed.
+     */
+    uint32 maxFiles = 4;
+
+    /**
+     * Size in bytes of the text waiting to be written. Once reached the
+     * threads logging wait for it to be written.
+     */
+    uint32 bufferSize = 1024 * 1024;
+
+    /**
+     * Maximum time the entries wait before being written.
+     */
+    uint32 flushIntervalMs = 200;
+  };
+
+  /**
+   * @brief Writes the entries to a text file, in the same format as
+   *        Debug::saveTextLog(). Entries are formatted when written, and
+   *        saved in batches by a background thread.
+   *
+   *        The file is rotated when it gets too big or too old: "app.log"
+   *        is renamed to "app.1.log", "app.1.log" to "app.2.log" and so on,
+   *        and a new "app.log" is started. An existing file is rotated when
+   *        the sink is created.
+   * @note  Thread safe.
+   */
+  class GE_UTILITIES_EXPORT FileLogSink : public LogSink
+  {
+   public:
+    explicit FileLogSink(const Path& path,
+                         const FileLogSinkOptions& options = FileLogSinkOptions());
+    ~FileLogSink();
+
+    /**
+     * @copydoc LogSink::write
+     */
+    void
+    write(const LogEntry& entry) override;
+
+    /**
+     * @copydoc LogSink::flush
+     */
+    void
+    flush() override;
+
+    /**
+     * @brief Returns the path of the file currently being written.
+     */
+    const Path&
+    getPath() const {
+      return m_path;
+    }
+
+   private:
+    /**
+     * @brief Main loop of the writing thread.
+     */
+    void
+    run();
+
+    /**
+     * @brief Writes a batch of text to the file, rotating it first if needed.
+     */
+    void
+    writeBatch(const String& batch);
+
+    /**
+     * @brief Returns the path of a rotated file. 0 is the current one.
+     */
+    Path
+    getRotatedPath(uint32 idx) const;
+
+    /**
+     * @brief Shifts the rotated files and starts a new log file.
+     */
+    void
+    rotate();
+
+    /**
+     * @brief Creates the log file and writes its header.
+     */
+    void
+    openFile();
+
+    Path m_path;
+    FileLogSinkOptions m_options;
+
+    //Written by the logging threads
+    Mutex m_mutex;
+    Signal m_wakeSignal;
+    Signal m_writtenSignal;
+    String m_pending;
+    uint64 m_flushesRequested = 0;
+    uint64 m_flushesDone = 0;
+    bool m_stop = false;
+
+    //Owned by the writing thread
+    SPtr<DataStream> m_file;
+    uint64 m_fileSize = 0;
+    uint64 m_entriesSize = 0;
+    time_t m_fileCreationTime = 0;
+
+    Thread m_thread;
+  };
+}
@@ -51,6 +51,12 @@ namespace geEngineSDK {
      *            restored upon decoding.
      * @param[in] params        Optional parameters to be passed to the
      *            serialization callbacks on the objects being serialized.
+     * @param[in] deduplicate   If true identical content in the object is
+     *            only written once. See BinarySerializer::encode().
+     * @param[in] parallel      If true the objects are encoded on the
+     *            TaskScheduler workers. See BinarySerializer::encode().
+     * @param[in] compact       If true the data is written in the compact
+     *            format. See BinarySerializer::encode().
      * @return  A buffer containing the encoded object. It is up to the user to
      *          release the buffer memory when no longer needed.
      */
@@ -59,7 +65,10 @@ namespace geEngineSDK {
            uint32& bytesWritten,
            function<void*(SIZE_T)> allocator = nullptr,
            bool shallow = false,
-           SerializationContext* context = nullptr);
+           SerializationContext* context = nullptr,
+           bool deduplicate = false,
+           bool parallel = false,
+           bool compact = false);
 
     /**
      * @brief Deserializes an IReflectable object by reading the binary data
@@ -68,11 +77,14 @@ namespace geEngineSDK {
      * @param[in] bufferSize  Size of the @p buffer in bytes.
      * @param[in] params      Optional parameters to be passed to the
                   serialization callbacks on the objects being serialized.
+     * @param[in] parallel    If true the objects are decoded on the
+     *            TaskScheduler workers. See BinarySerializer::decode().
      */
     SPtr<IReflectable>
     decode(uint8* buffer,
            uint32 bufferSize,
-           SerializationContext* context = nullptr);
+           SerializationContext* context = nullptr,
+           bool parallel = false);
 
    private:
     Vector<BufferPiece> m_bufferPieces;
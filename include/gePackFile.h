@@ -0,0 +1,387 @@
+/*****************************************************************************/
+/**
+ * @file    gePackFile.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Read-only archives holding many files in a single one.
+ *
+ * Pack files store many small files in a single one, so they can be read
+ * without opening each of them separately. A pack starts with a header and
+ * an index, followed by the aligned contents of the files. The index is an
+ * open-addressed hash table of the paths, so entries are found without
+ * searching.
+ *
+ * Packs are mapped in memory, and mounted on a directory through the
+ * PackFileSystem. FileSystem looks for files in the mounted packs before
+ * going to the OS. Uncompressed entries are read directly from the mapping,
+ * without any copy.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geCompression.h"
+#include "geDataStream.h"
+#include "geModule.h"
+
+namespace geEngineSDK {
+  namespace PACK_ENTRY_FLAGS {
+    enum E {
+      kNONE = 0,
+      kCOMPRESSED = 1 << 0,
+      kDIRECTORY = 1 << 1
+    };
+  }
+
+  /**
+   * @brief Header at the start of every pack file. All the offsets are in
+   *        bytes from the start of the file.
+   */
+  struct PackFileHeader
+  {
+    static CONSTEXPR uint32 MAGIC = 0x4B504547; //"GEPK"
+    static CONSTEXPR uint32 VERSION = 1;
+
+    uint32 magic = MAGIC;
+    uint32 version = VERSION;
+    uint32 numEntries = 0;
+
+    /**
+     * Number of slots of the hash table. Always a power of two.
+     */
+    uint32 numSlots = 0;
+    uint64 slotsOffset = 0;
+    uint64 entriesOffset = 0;
+    uint64 namesOffset = 0;
+    uint64 namesSize = 0;
+
+    /**
+     * Time the pack was built at. Reported as the modification time of all
+     * of its entries.
+     */
+    int64 timestamp = 0;
+    uint64 reserved = 0;
+  };
+
+  /**
+   * @brief Slot of the hash table of a pack. Empty slots have an entry
+   *        index of 0.
+   */
+  struct PackFileSlot
+  {
+    /**
+     * Upper half of the hash of the path, so most mismatches are discarded
+     * without comparing the names.
+     */
+    uint32 hash;
+
+    /**
+     * Index of the entry plus one.
+     */
+    uint32 entryIdx;
+  };
+
+  /**
+   * @brief File or directory stored in a pack.
+   */
+  struct PackFileEntry
+  {
+    uint64 offset;
+
+    /**
+     * Size of the data in the pack. Differs from @p size for compressed
+     * entries.
+     */
+    uint64 storedSize;
+    uint64 size;
+
+    /**
+     * Path of the entry relative to the root of the pack, using '/' as
+     * separator. Null terminated.
+     */
+    uint32 nameOffset;
+    uint32 nameLength;
+    uint32 flags;
+    uint32 reserved;
+  };
+
+  /**
+   * @brief Options used to build a pack file.
+   */
+  struct PackFileBuildOptions
+  {
+    /**
+     * Alignment of the data of each entry in the pack.
+     */
+    uint32 alignment = 16;
+
+    /**
+     * If true the entries are compressed, and stored that way if it saves
+     * at least @p minCompressionSavings of their size.
+     */
+    bool compress = false;
+    float minCompressionSavings = 0.1f;
+    CompressionOptions compression;
+  };
+
+  /**
+   * @brief Builds pack files.
+   */
+  class GE_UTILITIES_EXPORT PackFileBuilder
+  {
+   public:
+    explicit PackFileBuilder(const PackFileBuildOptions& options = PackFileBuildOptions())
+      : m_options(options)
+    {}
+
+    /**
+     * @brief Adds a file to the pack. It's read when the pack is written.
+     * @param[in] packedPath  Path of the file inside the pack. Must be
+     *            relative. Replaces any entry previously added with it.
+     * @param[in] sourcePath  File to read the contents from.
+     */
+    void
+    addFile(const Path& packedPath, const Path& sourcePath);
+
+    /**
+     * @brief Adds a file to the pack with the contents of a stream, read from
+     *        its current position when the pack is written.
+     */
+    void
+    addData(const Path& packedPath, const SPtr<DataStream>& data);
+
+    /**
+     * @brief Adds all the files inside a directory, and its subdirectories,
+     *        to the pack.
+     * @param[in] sourceDir Directory to add.
+     * @param[in] packedDir Directory inside the pack to add the files to.
+     *            Blank for its root.
+     */
+    void
+    addDirectory(const Path& sourceDir, const Path& packedDir = Path::BLANK);
+
+    /**
+     * @brief Returns the number of files added so far.
+     */
+    uint32
+    getNumFiles() const {
+      return static_cast<uint32>(m_files.size());
+    }
+
+    /**
+     * @brief Writes the pack with all the files added so far.
+     * @return  False if the pack, or any of its files, couldn't be written.
+     */
+    bool
+    write(const Path& outputPath) const;
+
+   private:
+    struct Source
+    {
+      String name;
+      Path sourcePath;
+      SPtr<DataStream> data;
+    };
+
+    void
+    addSource(const Path& packedPath, Source&& source);
+
+    PackFileBuildOptions m_options;
+    Vector<Source> m_files;
+    UnorderedMap<String, uint32> m_fileIndices;
+  };
+
+  /**
+   * @brief Pack file mapped in memory.
+   * @note  Thread safe.
+   */
+  class GE_UTILITIES_EXPORT PackFile
+  {
+   public:
+    PackFile() = default;
+    ~PackFile();
+
+    /**
+     * @brief Maps a pack file in memory. Returns null if it isn't a valid
+     *        pack.
+     */
+    static SPtr<PackFile>
+    open(const Path& packPath);
+
+    /**
+     * @brief Looks for an entry by its path inside the pack. Paths are
+     *        compared ignoring case, as Path does.
+     * @param[in] path  Path of the entry.
+     * @param[in] firstDirectory  Number of directories at the start of
+     *            @p path that are skipped. Lets a path under the directory a
+     *            pack is mounted on be looked for as is.
+     * @return  The entry, or null if there is none with that path.
+     */
+    const PackFileEntry*
+    find(const Path& path, SIZE_T firstDirectory = 0) const;
+
+    /**
+     * @brief Opens a stream to read an entry of a pack. Uncompressed entries
+     *        are read directly from the mapping, which is kept alive while
+     *        the stream is.
+     * @return  Null for directories, or entries that couldn't be decompressed.
+     */
+    static SPtr<DataStream>
+    openEntry(const SPtr<PackFile>& pack, const PackFileEntry& entry);
+
+    uint32
+    getNumEntries() const {
+      return m_header->numEntries;
+    }
+
+    const PackFileEntry&
+    getEntry(uint32 idx) const {
+      GE_ASSERT(idx < m_header->numEntries);
+      return m_entries[idx];
+    }
+
+    /**
+     * @brief Returns the path of an entry inside the pack.
+     */
+    const ANSICHAR*
+    getEntryName(const PackFileEntry& entry) const {
+      return m_names + entry.nameOffset;
+    }
+
+    /**
+     * @brief Returns the data of an entry as stored in the pack.
+     */
+    const uint8*
+    getEntryData(const PackFileEntry& entry) const {
+      return m_data + entry.offset;
+    }
+
+    time_t
+    getTimestamp() const {
+      return static_cast<time_t>(m_header->timestamp);
+    }
+
+    const Path&
+    getPath() const {
+      return m_path;
+    }
+
+   private:
+    /**
+     * @brief Checks that the header and every entry are inside the file.
+     */
+    bool
+    validate();
+
+    Path m_path;
+    uint8* m_data = nullptr;
+    SIZE_T m_size = 0;
+    bool m_isMapped = false;
+
+    const PackFileHeader* m_header = nullptr;
+    const PackFileSlot* m_slots = nullptr;
+    const PackFileEntry* m_entries = nullptr;
+    const ANSICHAR* m_names = nullptr;
+  };
+
+  /**
+   * @brief Stream reading an uncompressed entry straight from the memory a
+   *        pack is mapped to. Read only.
+   */
+  class GE_UTILITIES_EXPORT PackedDataStream : public MemoryDataStream
+  {
+   public:
+    /**
+     * @brief Wraps data inside the mapping of a pack.
+     * @param[in] pack  Pack the data belongs to. Kept alive by the stream.
+     * @param[in] data  Start of the data.
+     * @param[in] inSize  Size of the data in bytes.
+     */
+    PackedDataStream(const SPtr<PackFile>& pack, const uint8* data, SIZE_T inSize);
+
+    /**
+     * @brief @copydoc DataStream::clone
+     */
+    SPtr<DataStream>
+    clone(bool copyData = true) const override;
+
+   private:
+    SPtr<PackFile> m_pack;
+  };
+
+  /**
+   * @brief Entry of a mounted pack, as reported by the PackFileSystem.
+   */
+  struct PackedFileInfo
+  {
+    bool isDirectory = false;
+    uint64 size = 0;
+    time_t lastModifiedTime = 0;
+  };
+
+  /**
+   * @brief Keeps the packs mounted on the file system. FileSystem looks for
+   *        files in them before going to the OS.
+   * @note  Thread safe.
+   */
+  class GE_UTILITIES_EXPORT PackFileSystem : public Module<PackFileSystem>
+  {
+   public:
+    /**
+     * @brief Mounts a pack on a directory, so its entries are found at the
+     *        paths they have inside the pack appended to @p mountPoint.
+     *        Packs mounted later take precedence over earlier ones.
+     * @param[in] packPath  Pack file to mount.
+     * @param[in] mountPoint  Directory to mount the pack on. Relative paths
+     *            are resolved from the working directory.
+     * @return  False if the pack couldn't be opened.
+     */
+    bool
+    mount(const Path& packPath, const Path& mountPoint);
+
+    /**
+     * @brief Unmounts a pack mounted by mount(). Streams already opened
+     *        from it remain valid.
+     */
+    void
+    unmount(const Path& packPath);
+
+    /**
+     * @brief Looks for a path in the mounted packs.
+     * @return  False if no mounted pack has it.
+     */
+    bool
+    find(const Path& fullPath, PackedFileInfo& info) const;
+
+    /**
+     * @brief Opens a file from the mounted packs.
+     * @return  Null if no mounted pack has it.
+     */
+    SPtr<DataStream>
+    openFile(const Path& fullPath) const;
+
+   private:
+    struct Mount
+    {
+      Path packPath;
+      Path mountPoint;
+      SPtr<PackFile> pack;
+    };
+
+    /**
+     * @brief Finds the mounted pack, and its entry, for a path.
+     */
+    const PackFileEntry*
+    findEntry(const Path& fullPath, SPtr<PackFile>& pack) const;
+
+    Vector<Mount> m_mounts;
+    mutable Mutex m_mutex;
+  };
+}
@@ -535,5 +535,7 @@
 //Features implementations
 #define GE_FEATURE_THREADING IN_USE
 
-#define GE_USE_GENERIC_FILESYSTEM     USE_IF(!USING(GE_PLATFORM_WINDOWS) && USING(GE_CPP17_OR_LATER))
+#define GE_USE_GENERIC_FILESYSTEM     USE_IF(!USING(GE_PLATFORM_WINDOWS) &&              \
+                                             !USING(GE_PLATFORM_LINUX) &&                \
+                                             USING(GE_CPP17_OR_LATER))
 /*****************************************************************************/
\ No newline at end of file
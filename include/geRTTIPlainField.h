@@ -121,6 +121,40 @@ namespace geEngineSDK {
      */
     virtual void
     arrayElemFromBuffer(RTTITypeBase* rtti, void* object, uint32 index, void* buffer) = 0;
+
+    /**
+     * @brief Copies the value of this field from one object to another,
+     *        calling the getter on the source and the setter on the
+     *        destination without going through an intermediate buffer.
+     *        Both objects must be of the type owning the field.
+     */
+    virtual void
+    copyValue(RTTITypeBase* srcRtti,
+              void* srcObject,
+              RTTITypeBase* dstRtti,
+              void* dstObject) = 0;
+
+    /**
+     * @brief Copies the whole array of this field from one object to another.
+     *        The destination array is resized to match the source. Arrays of
+     *        trivially copyable types stored contiguously on both objects
+     *        are copied with a single memcpy, otherwise elements are copied
+     *        one by one through the getters and setters.
+     */
+    virtual void
+    copyArray(RTTITypeBase* srcRtti,
+              void* srcObject,
+              RTTITypeBase* dstRtti,
+              void* dstObject) = 0;
+
+    /**
+     * @brief Returns the memory holding the @p numElements elements of the
+     *        array, if they are of a trivially copyable type stored
+     *        contiguously, so they can be compared or hashed as raw bytes.
+     *        Returns null otherwise.
+     */
+    virtual const uint8*
+    getArrayBytes(RTTITypeBase* rtti, void* object, uint32 numElements) = 0;
   };
 
   /**
@@ -402,5 +436,114 @@ namespace geEngineSDK {
 
       (rttiObject->*m_arraySetter)(castObject, index, value);
     }
+
+    /**
+     * @copydoc RTTIPlainFieldBase::copyValue
+     */
+    void
+    copyValue(RTTITypeBase* srcRtti,
+              void* srcObject,
+              RTTITypeBase* dstRtti,
+              void* dstObject) override {
+      checkIsArray(false);
+      checkType<DataType>();
+
+      if (!m_valueSetter) {
+        GE_EXCEPT(InternalErrorException,
+                  "Specified field (" + m_name + ") has no setter.");
+      }
+
+      auto srcRttiObject = static_cast<InterfaceType*>(srcRtti);
+      auto dstRttiObject = static_cast<InterfaceType*>(dstRtti);
+      auto srcCastObject = static_cast<ObjectType*>(srcObject);
+      auto dstCastObject = static_cast<ObjectType*>(dstObject);
+
+      DataType& value = (srcRttiObject->*m_valueGetter)(srcCastObject);
+      (dstRttiObject->*m_valueSetter)(dstCastObject, value);
+    }
+
+    /**
+     * @copydoc RTTIPlainFieldBase::copyArray
+     */
+    void
+    copyArray(RTTITypeBase* srcRtti,
+              void* srcObject,
+              RTTITypeBase* dstRtti,
+              void* dstObject) override {
+      checkIsArray(true);
+      checkType<DataType>();
+
+      auto srcRttiObject = static_cast<InterfaceType*>(srcRtti);
+      auto dstRttiObject = static_cast<InterfaceType*>(dstRtti);
+      auto srcCastObject = static_cast<ObjectType*>(srcObject);
+      auto dstCastObject = static_cast<ObjectType*>(dstObject);
+
+      const uint32 numElements = (srcRttiObject->*m_arraySizeGetter)(srcCastObject);
+      setArraySize(dstRtti, dstObject, numElements);
+      if (0 == numElements) {
+        return;
+      }
+
+      DataType* srcFirst = getContiguousArray(srcRttiObject, srcCastObject, numElements);
+      DataType* dstFirst = getContiguousArray(dstRttiObject, dstCastObject, numElements);
+      if (nullptr != srcFirst && nullptr != dstFirst && srcFirst != dstFirst) {
+        memcpy(static_cast<void*>(dstFirst),
+               static_cast<const void*>(srcFirst),
+               sizeof(DataType) * numElements);
+        return;
+      }
+
+      if (!m_arraySetter) {
+        GE_EXCEPT(InternalErrorException,
+                  "Specified field (" + m_name + ") has no setter.");
+      }
+
+      for (uint32 i = 0; i < numElements; ++i) {
+        DataType& value = (srcRttiObject->*m_arrayGetter)(srcCastObject, i);
+        (dstRttiObject->*m_arraySetter)(dstCastObject, i, value);
+      }
+    }
+
+    /**
+     * @copydoc RTTIPlainFieldBase::getArrayBytes
+     */
+    const uint8*
+    getArrayBytes(RTTITypeBase* rtti, void* object, uint32 numElements) override {
+      checkIsArray(true);
+      checkType<DataType>();
+
+      auto rttiObject = static_cast<InterfaceType*>(rtti);
+      auto castObject = static_cast<ObjectType*>(object);
+
+      return reinterpret_cast<const uint8*>(getContiguousArray(rttiObject,
+                                                               castObject,
+                                                               numElements));
+    }
+
+   private:
+    /**
+     * @brief Returns the first element of the array if the elements are
+     *        trivially copyable and stored contiguously, null otherwise.
+     */
+    DataType*
+    getContiguousArray(InterfaceType* rttiObject,
+                       ObjectType* object,
+                       uint32 numElements) {
+      if (!std::is_trivially_copyable<DataType>::value ||
+          0 != RTTIPlainType<DataType>::kHasDynamicSize ||
+          2 > numElements) {
+        return nullptr;
+      }
+
+      //Only trust the storage if the getter hands out references to
+      //contiguous memory, otherwise it might be returning temporaries
+      DataType* first = &(rttiObject->*m_arrayGetter)(object, 0);
+      DataType* last = &(rttiObject->*m_arrayGetter)(object, numElements - 1);
+      if (last != first + (numElements - 1)) {
+        return nullptr;
+      }
+
+      return first;
+    }
   };
 }
@@ -33,6 +33,7 @@
 #include <string>
 #include <algorithm>
 #include <unordered_map>
+#include <mutex>
 
 #include "gePrerequisitesUtilities.h"
 #include "geRTTIField.h"
@@ -533,7 +534,73 @@ namespace geEngineSDK {
 
   //RTTI-Internal
   struct SerializationContext;
-  
+  class RTTITypeBase;
+
+  /***************************************************************************/
+
+  /**
+   * @brief Precomputed description of the fields of a type, flattened across
+   *        its whole class hierarchy. Serializers iterate this instead of
+   *        walking the base classes and querying each field through virtual
+   *        calls for every object they process.
+   * @note  The plan is built the first time it's requested and is immutable
+   *        afterwards, so it can be shared between threads.
+   */
+  struct RTTISerializationPlan
+  {
+    /**
+     * @brief Cached information about a single field.
+     */
+    struct FieldEntry
+    {
+      RTTIField* field;
+
+      /**
+       * Size of the field type, as returned by RTTIField::getTypeSize().
+       * Only meaningful for plain fields without dynamic size.
+       */
+      uint32 typeSize;
+      uint16 uniqueId;
+      SERIALIZABLE_FIELD_TYPE::E type;
+      bool isArray;
+      bool hasDynamicSize;
+    };
+
+    /**
+     * @brief A single class in the hierarchy and the range of its fields.
+     */
+    struct ClassEntry
+    {
+      RTTITypeBase* rtti;
+      uint32 rttiId;
+      uint32 firstField;
+      uint32 numFields;
+    };
+
+    /**
+     * Classes of the hierarchy, starting with the most derived one.
+     */
+    Vector<ClassEntry> classes;
+
+    /**
+     * Fields of all the classes, stored in the same order as the classes.
+     */
+    Vector<FieldEntry> fields;
+
+    /**
+     * Indices in fields of the fields of the most derived class, by name and
+     * by unique id. Used by RTTITypeBase::findField().
+     */
+    UnorderedMap<String, uint32> fieldsByName;
+    UnorderedMap<uint16, uint32> fieldsById;
+
+    /**
+     * True if any class in the hierarchy overrides the serialization
+     * callbacks.
+     */
+    bool hasSerializationCallbacks = false;
+  };
+
   /***************************************************************************/
 
   /**
@@ -642,6 +709,16 @@ namespace geEngineSDK {
                            SerializationContext* /*context*/)
     {}
 
+    /**
+     * @brief Returns true if the class owning this RTTI type overrides any of
+     *        the serialization or deserialization callbacks. Systems that copy
+     *        fields directly, without going through a serializer, can't
+     *        honor those callbacks and need to fall back to a full
+     *        serialization round trip for such types.
+     */
+    virtual bool
+    hasSerializationCallbacks() const = 0;
+
     /**
      * @brief Returns a handler that determines how are "diffs" generated and
      *        applied when it comes to objects of this RTTI type. A "diff" is a
@@ -681,6 +758,13 @@ namespace geEngineSDK {
       return m_fields.at(static_cast<SIZE_T>(idx));
     }
 
+    /**
+     * @brief Returns the serialization plan of this type, building it on the
+     *        first call. See RTTISerializationPlan.
+     */
+    const RTTISerializationPlan&
+    getSerializationPlan();
+
     /**
      * @brief Tries to find a field with the specified name.
      *        Throws an exception if it can't.
@@ -717,6 +801,21 @@ namespace geEngineSDK {
     virtual RTTITypeBase*
     _clone(FrameAlloc& alloc) = 0;
 
+    /**
+     * @brief Returns the instance to pass to the fields and callbacks while
+     *        processing a single object. Only types with serialization
+     *        callbacks, that may keep per-object data, are cloned. Others
+     *        return this type. Release it with _releaseInstance().
+     */
+    RTTITypeBase*
+    _getInstance(FrameAlloc& alloc);
+
+    /**
+     * @brief Releases an instance returned by _getInstance().
+     */
+    static void
+    _releaseInstance(RTTITypeBase* instance, FrameAlloc& alloc);
+
    protected:
     /**
      * @brief Tries to add a new field to the fields array, and throws an
@@ -727,7 +826,20 @@ namespace geEngineSDK {
     addNewField(RTTIField* field);
 
    private:
+    /**
+     * @brief Builds m_plan with the fields of this type and its base classes.
+     */
+    void
+    buildSerializationPlan();
+
     Vector<RTTIField*> m_fields;
+
+    /**
+     * Only built on the types the plan is requested from, so the clones
+     * made while serializing don't allocate it.
+     */
+    std::once_flag m_planInitFlag;
+    UPtr<RTTISerializationPlan> m_plan;
   };
 
   /**
@@ -863,6 +975,34 @@ namespace geEngineSDK {
       return false;
     }
 
+    /**
+     * @copydoc RTTITypeBase::hasSerializationCallbacks
+     */
+    bool
+    hasSerializationCallbacks() const override {
+      using std::is_same;
+      using BaseSerializationStarted =
+        decltype(&RTTITypeBase::onSerializationStarted);
+      using BaseSerializationEnded =
+        decltype(&RTTITypeBase::onSerializationEnded);
+      using BaseDeserializationStarted =
+        decltype(&RTTITypeBase::onDeserializationStarted);
+      using BaseDeserializationEnded =
+        decltype(&RTTITypeBase::onDeserializationEnded);
+
+      //A member pointer taken through the derived type only keeps the base
+      //class type if the method wasn't overridden along the way
+      return
+        !is_same<decltype(&MyRTTIType::onSerializationStarted),
+                 BaseSerializationStarted>::value ||
+        !is_same<decltype(&MyRTTIType::onSerializationEnded),
+                 BaseSerializationEnded>::value ||
+        !is_same<decltype(&MyRTTIType::onDeserializationStarted),
+                 BaseDeserializationStarted>::value ||
+        !is_same<decltype(&MyRTTIType::onDeserializationEnded),
+                 BaseDeserializationEnded>::value;
+    }
+
     /**
      * @copydoc RTTITypeBase::_registerDerivedClass
      */
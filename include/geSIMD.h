@@ -25,14 +25,14 @@
 
 #define SIMDPP_ARCH_X86_SSE4_1
 
-#if GE_COMPILER == GE_COMPILER_MSVC
+#if USING(GE_COMPILER_MSVC)
 # pragma warning(disable: 4127)
 # pragma warning(disable: 4244)
 #endif
 
 # include "Externals/simdpp/simd.h"
 
-#if GE_COMPILER == GE_COMPILER_MSVC
+#if USING(GE_COMPILER_MSVC)
 # pragma warning(default: 4127)
 # pragma warning(default: 4244)
 #endif
@@ -150,12 +150,20 @@ namespace geEngineSDK {
      *                    callbacks. Can be used for controlling
      *                    deserialization, maintaining state or sharing
      *                    information between objects during deserialization.
+     * @param[in] useArena  If true every node of the tree, together with the
+     *                    field values and data blocks, is allocated from a
+     *                    single memory arena instead of one heap allocation
+     *                    each. The arena is released in one go once the last
+     *                    node referencing it is destroyed. Best suited for
+     *                    trees that are built, used and dropped as a whole,
+     *                    like the ones used to generate diffs.
      * @return    Serialized version of @p obj.
      */
     static SPtr<SerializedObject>
     create(IReflectable& obj,
            bool shallow = false,
-           SerializationContext* context = nullptr);
+           SerializationContext* context = nullptr,
+           bool useArena = false);
 
     Vector<SerializedSubObject> subObjects;
 
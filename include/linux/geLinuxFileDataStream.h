@@ -0,0 +1,208 @@
+/*****************************************************************************/
+/**
+ * @file    geLinuxFileDataStream.h
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Data stream for files, built directly on the Linux file API.
+ *
+ * Data stream for files built on open/pread/pwrite. Small reads and writes
+ * are served from an aligned buffer owned by the stream, so they don't pay
+ * for the iostream machinery, and sequential reads hint the kernel to read
+ * ahead of the current position.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+#pragma once
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePrerequisitesUtilities.h"
+#include "geDataStream.h"
+#include "gePath.h"
+
+#if USING(GE_PLATFORM_LINUX)
+
+namespace geEngineSDK {
+  /**
+   * @brief Options used to open a LinuxFileDataStream.
+   */
+  struct LinuxFileStreamOptions
+  {
+    /**
+     * Size in bytes of the stream buffer. Reads and writes smaller than the
+     * buffer are gathered in it, bigger ones go straight to the file.
+     */
+    uint32 bufferSize = 64 * 1024;
+
+    /**
+     * Alignment in bytes of the stream buffer. Must be a power of two, and a
+     * multiple of the device block size when @p directIO is used.
+     */
+    uint32 alignment = 4096;
+
+    /**
+     * Number of bytes the kernel is asked to read ahead of the current
+     * position while the stream is read sequentially. 0 disables the hints.
+     */
+    uint32 readAhead = 1024 * 1024;
+
+    /**
+     * If true, read-only streams are opened with O_DIRECT and bypass the page
+     * cache. Meant for large streaming reads of data that won't be read again.
+     * Ignored for writable streams, and if the file system doesn't support it.
+     */
+    bool directIO = false;
+  };
+
+  /**
+   * @brief Data stream for files built on the Linux file API.
+   */
+  class GE_UTILITIES_EXPORT LinuxFileDataStream : public DataStream
+  {
+   public:
+    /**
+     * @brief Construct a file stream.
+     * @param[in] filePath  Path of the file to open.
+     * @param[in] accessMode  Determines should the file be opened in read,
+     *            write or read/write mode. Write only streams truncate the
+     *            file, creating it if it doesn't exist.
+     * @param[in] options Buffering and read-ahead options.
+     */
+    LinuxFileDataStream(const Path& filePath,
+                        ACCESS_MODE::E accessMode = ACCESS_MODE::kREAD,
+                        const LinuxFileStreamOptions& options =
+                          LinuxFileStreamOptions());
+
+    ~LinuxFileDataStream();
+
+    bool
+    isFile() const override {
+      return true;
+    }
+
+    /**
+     * @brief @copydoc DataStream::read
+     */
+    SIZE_T
+    read(void* buf, SIZE_T count) override;
+
+    /**
+     * @brief @copydoc DataStream::write
+     */
+    SIZE_T
+    write(const void* buf, SIZE_T count) override;
+
+    /**
+     * @brief @copydoc DataStream::skip
+     */
+    void
+    skip(SIZE_T count) override;
+
+    /**
+     * @brief @copydoc DataStream::seek
+     */
+    void
+    seek(SIZE_T pos) override;
+
+    /**
+     * @brief @copydoc DataStream::tell
+     */
+    SIZE_T
+    tell() const override;
+
+    /**
+     * @brief @copydoc DataStream::isEOF
+     */
+    bool
+    isEOF() const override;
+
+    /**
+     * @brief @copydoc DataStream::clone
+     */
+    SPtr<DataStream>
+    clone(bool copyData = true) const override;
+
+    /**
+     * @brief @copydoc DataStream::close
+     */
+    void
+    close() override;
+
+    /**
+     * @brief Writes any buffered data to the file.
+     */
+    void
+    flush();
+
+    /**
+     * @brief Returns true if the file was opened successfully.
+     */
+    bool
+    isOpen() const {
+      return -1 != m_fd;
+    }
+
+    /**
+     * @brief Returns true if the file was opened with O_DIRECT.
+     */
+    bool
+    isDirectIO() const {
+      return m_directIO;
+    }
+
+    /**
+     * @brief Returns the path of the file opened by the stream.
+     */
+    const Path&
+    getPath() const {
+      return m_path;
+    }
+
+   private:
+    /**
+     * @brief Fills the buffer with the data of the file at @p offset.
+     */
+    void
+    fillBuffer(SIZE_T offset);
+
+    /**
+     * @brief Reads @p count bytes at @p offset straight into @p buf,
+     *        bypassing the stream buffer.
+     */
+    SIZE_T
+    readDirect(uint8* buf, SIZE_T count, SIZE_T offset);
+
+    /**
+     * @brief Writes @p count bytes at @p offset straight to the file.
+     */
+    SIZE_T
+    writeDirect(const uint8* buf, SIZE_T count, SIZE_T offset);
+
+    /**
+     * @brief Asks the kernel to read ahead of a read of @p count bytes at
+     *        @p offset, if the stream is being read sequentially.
+     */
+    void
+    hintReadAhead(SIZE_T offset, SIZE_T count);
+
+    Path m_path;
+    LinuxFileStreamOptions m_options;
+    int32 m_fd = -1;
+    bool m_directIO = false;
+    bool m_eof = false;
+
+    uint8* m_buffer = nullptr;
+    SIZE_T m_bufferOffset = 0;  //File offset of the first buffered byte
+    SIZE_T m_bufferSize = 0;    //Bytes of file data held by the buffer
+    bool m_bufferDirty = false; //Buffer holds data not written yet
+    SIZE_T m_position = 0;
+    SIZE_T m_lastReadEnd = 0;
+    SIZE_T m_readAheadEnd = 0;
+  };
+}
+
+#endif
@@ -0,0 +1,788 @@
+/*****************************************************************************/
+/**
+ * @file    geAsyncFileIO.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Asynchronous, batched file reads and writes.
+ *
+ * Asynchronous, batched file reads and writes. On Linux the requests are
+ * submitted to the kernel through io_uring, so hundreds of them can be in
+ * flight without tying up a thread each. Elsewhere, or if the kernel doesn't
+ * support io_uring, they are executed by a small set of dedicated I/O
+ * threads.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geAsyncFileIO.h"
+#include "geDataStream.h"
+#include "geFileSystem.h"
+#include "geTaskScheduler.h"
+#include "geDebug.h"
+
+#if USING(GE_PLATFORM_LINUX)
+#   include <cerrno>
+#   include <fcntl.h>
+#   include <linux/io_uring.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/syscall.h>
+#   include <sys/uio.h>
+#   include <unistd.h>
+#endif
+
+namespace geEngineSDK {
+  using std::max;
+  using std::min;
+  using std::move;
+
+  struct AsyncFileIO::PendingIO
+  {
+    Path path;
+    ASYNC_IO_OP::E operation = ASYNC_IO_OP::kREAD;
+    uint8* buffer = nullptr;
+    SIZE_T size = 0;
+    uint64 offset = 0;
+    SIZE_T transferred = 0;
+    bool success = true;
+
+    /**
+     * If true the size of the file is only known once it's opened, and the
+     * buffer is allocated by us and handed to a MemoryDataStream.
+     */
+    bool wholeFile = false;
+
+    /**
+     * False for operations submitted from an I/O thread while the queue was
+     * full. They wait in m_waiting until a completed operation hands them
+     * its slot.
+     */
+    bool hasSlot = true;
+
+    function<void(const AsyncIOResult&)> callback;
+    function<void(const SPtr<DataStream>&)> fileCallback;
+    SPtr<AsyncOpSyncData> syncData;
+    AsyncOp asyncOp;
+
+#if USING(GE_PLATFORM_LINUX)
+    int32 fd = -1;
+    iovec iov;
+#endif
+  };
+
+#if USING(GE_PLATFORM_LINUX)
+  namespace {
+    int32
+    sys_ioUringSetup(uint32 entries, io_uring_params* params) {
+      return static_cast<int32>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int32
+    sys_ioUringEnter(int32 fd, uint32 toSubmit, uint32 minComplete, uint32 flags) {
+      return static_cast<int32>(::syscall(__NR_io_uring_enter,
+                                          fd,
+                                          toSubmit,
+                                          minComplete,
+                                          flags,
+                                          nullptr,
+                                          0));
+    }
+
+    /**
+     * The ring indices are shared with the kernel, which reads and writes
+     * them concurrently.
+     */
+    uint32
+    loadAcquire(const uint32* value) {
+      return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    }
+
+    void
+    storeRelease(uint32* value, uint32 newValue) {
+      __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+    }
+  }
+#endif
+
+  namespace {
+    /**
+     * Module whose I/O thread is the current one, if any. Waiting for a
+     * queue slot there would block the thread that has to free it.
+     */
+    GE_THREADLOCAL const AsyncFileIO* t_ioThreadOwner = nullptr;
+  }
+
+#if USING(GE_PLATFORM_LINUX)
+
+  /**
+   * @brief Submission and completion queues shared with the kernel, used
+   *        without liburing so there are no extra dependencies.
+   */
+  struct AsyncFileIO::IOUring
+  {
+    bool
+    initialize(uint32 entries) {
+      io_uring_params params;
+      memset(&params, 0, sizeof(params));
+
+      fd = sys_ioUringSetup(entries, &params);
+      if (-1 == fd) {
+        return false;
+      }
+
+      sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32);
+      cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+      const bool singleMap = 0 != (params.features & IORING_FEAT_SINGLE_MMAP);
+      if (singleMap) {
+        sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+      }
+
+      sqRing = ::mmap(nullptr,
+                      sqRingSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      fd,
+                      IORING_OFF_SQ_RING);
+      if (MAP_FAILED == sqRing) {
+        sqRing = nullptr;
+        destroy();
+        return false;
+      }
+
+      if (singleMap) {
+        cqRing = sqRing;
+      }
+      else {
+        cqRing = ::mmap(nullptr,
+                        cqRingSize,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE,
+                        fd,
+                        IORING_OFF_CQ_RING);
+        if (MAP_FAILED == cqRing) {
+          cqRing = nullptr;
+          destroy();
+          return false;
+        }
+      }
+
+      void* sqesMap = ::mmap(nullptr,
+                             sqesSize,
+                             PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE,
+                             fd,
+                             IORING_OFF_SQES);
+      if (MAP_FAILED == sqesMap) {
+        destroy();
+        return false;
+      }
+      sqes = reinterpret_cast<io_uring_sqe*>(sqesMap);
+
+      uint8* sqBase = reinterpret_cast<uint8*>(sqRing);
+      sqHead = reinterpret_cast<uint32*>(sqBase + params.sq_off.head);
+      sqTail = reinterpret_cast<uint32*>(sqBase + params.sq_off.tail);
+      sqMask = *reinterpret_cast<uint32*>(sqBase + params.sq_off.ring_mask);
+      sqArray = reinterpret_cast<uint32*>(sqBase + params.sq_off.array);
+      sqEntries = params.sq_entries;
+
+      uint8* cqBase = reinterpret_cast<uint8*>(cqRing);
+      cqHead = reinterpret_cast<uint32*>(cqBase + params.cq_off.head);
+      cqTail = reinterpret_cast<uint32*>(cqBase + params.cq_off.tail);
+      cqMask = *reinterpret_cast<uint32*>(cqBase + params.cq_off.ring_mask);
+      cqes = reinterpret_cast<io_uring_cqe*>(cqBase + params.cq_off.cqes);
+
+      return true;
+    }
+
+    void
+    destroy() {
+      if (nullptr != sqes) {
+        ::munmap(sqes, sqesSize);
+      }
+
+      if (nullptr != cqRing && cqRing != sqRing) {
+        ::munmap(cqRing, cqRingSize);
+      }
+
+      if (nullptr != sqRing) {
+        ::munmap(sqRing, sqRingSize);
+      }
+
+      if (-1 != fd) {
+        ::close(fd);
+      }
+
+      sqes = nullptr;
+      sqRing = cqRing = nullptr;
+      fd = -1;
+    }
+
+    /**
+     * @brief Opens the file of an operation. Returns false if it couldn't be
+     *        opened.
+     */
+    static bool
+    open(PendingIO* operation) {
+      int32 flags = O_CLOEXEC;
+      if (ASYNC_IO_OP::kREAD == operation->operation) {
+        flags |= O_RDONLY;
+      }
+      else {
+        flags |= O_WRONLY | O_CREAT;
+      }
+
+      operation->fd = ::open(operation->path.toPlatformString().c_str(), flags, 0644);
+      if (-1 == operation->fd) {
+        GE_LOG(kWarning, FileSystem, "Cannot open file: {0}", operation->path);
+        return false;
+      }
+
+      if (operation->wholeFile) {
+        struct stat fileStat;
+        if (0 != ::fstat(operation->fd, &fileStat)) {
+          return false;
+        }
+
+        operation->size = static_cast<SIZE_T>(fileStat.st_size);
+        operation->buffer = reinterpret_cast<uint8*>(ge_alloc(max(operation->size,
+                                                                  SIZE_T(1))));
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Submits the remaining part of each operation to the kernel. A
+     *        null operation submits a no-op used to wake up the completion
+     *        thread.
+     */
+    void
+    submit(PendingIO** operations, uint32 count) {
+      Lock lock(submitMutex);
+
+      //The kernel consumes every entry on each enter, so the queue is always
+      //empty here and never holds more than the operations in flight
+      uint32 tail = *sqTail;
+      for (uint32 i = 0; i < count; ++i) {
+        PendingIO* operation = operations[i];
+        const uint32 index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        memset(&sqe, 0, sizeof(sqe));
+
+        if (nullptr == operation) {
+          sqe.opcode = IORING_OP_NOP;
+        }
+        else {
+          operation->iov.iov_base = operation->buffer + operation->transferred;
+          operation->iov.iov_len = operation->size - operation->transferred;
+
+          sqe.opcode = ASYNC_IO_OP::kREAD == operation->operation ?
+                         IORING_OP_READV : IORING_OP_WRITEV;
+          sqe.fd = operation->fd;
+          sqe.addr = reinterpret_cast<uint64>(&operation->iov);
+          sqe.len = 1;
+          sqe.off = operation->offset + operation->transferred;
+          sqe.user_data = reinterpret_cast<uint64>(operation);
+        }
+
+        sqArray[index] = index;
+        ++tail;
+      }
+      storeRelease(sqTail, tail);
+
+      uint32 numSubmitted = 0;
+      while (numSubmitted < count) {
+        const int32 result = sys_ioUringEnter(fd, count - numSubmitted, 0, 0);
+        if (result >= 0) {
+          numSubmitted += static_cast<uint32>(result);
+        }
+        else if (EINTR != errno && EAGAIN != errno && EBUSY != errno) {
+          GE_LOG(kError,
+                 FileSystem,
+                 "Failed to submit file operations to io_uring: {0}",
+                 errno);
+          break;
+        }
+      }
+    }
+
+    /**
+     * @brief Reaps the completions until the no-op submitted on shut down
+     *        is found.
+     */
+    void
+    runCompletions(AsyncFileIO& owner) {
+      t_ioThreadOwner = &owner;
+      while (true) {
+        uint32 head = *cqHead;
+        const uint32 tail = loadAcquire(cqTail);
+        if (head == tail) {
+          sys_ioUringEnter(fd, 0, 1, IORING_ENTER_GETEVENTS);
+          continue;
+        }
+
+        bool shutdown = false;
+        for (; head != tail; ++head) {
+          const io_uring_cqe& cqe = cqes[head & cqMask];
+          PendingIO* operation = reinterpret_cast<PendingIO*>(cqe.user_data);
+          const int32 result = cqe.res;
+          storeRelease(cqHead, head + 1);
+
+          if (nullptr == operation) {
+            shutdown = true;
+            continue;
+          }
+
+          if (-EINTR == result || -EAGAIN == result) {
+            submit(&operation, 1);
+            continue;
+          }
+
+          if (result < 0) {
+            operation->success = false;
+            owner.complete(operation);
+            continue;
+          }
+
+          //Short transfers only mean end of file once nothing else is read
+          operation->transferred += static_cast<SIZE_T>(result);
+          if (result > 0 && operation->transferred < operation->size) {
+            submit(&operation, 1);
+            continue;
+          }
+
+          owner.complete(operation);
+        }
+
+        if (shutdown) {
+          break;
+        }
+      }
+    }
+
+    int32 fd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    SIZE_T sqRingSize = 0;
+    SIZE_T cqRingSize = 0;
+    SIZE_T sqesSize = 0;
+
+    uint32* sqHead = nullptr;
+    uint32* sqTail = nullptr;
+    uint32* sqArray = nullptr;
+    uint32 sqMask = 0;
+    uint32 sqEntries = 0;
+    io_uring_sqe* sqes = nullptr;
+
+    uint32* cqHead = nullptr;
+    uint32* cqTail = nullptr;
+    uint32 cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    Mutex submitMutex;
+  };
+#endif
+
+  AsyncFileIO::AsyncFileIO(uint32 queueDepth, uint32 numThreads, bool allowIOUring)
+    : m_queueDepth(max(queueDepth, 1u)) {
+#if USING(GE_PLATFORM_LINUX)
+    if (allowIOUring) {
+      m_ring = ge_new<IOUring>();
+      if (!m_ring->initialize(m_queueDepth)) {
+        GE_LOG(kWarning,
+               FileSystem,
+               "io_uring isn't available ({0}). Using I/O threads instead.",
+               errno);
+        ge_delete(m_ring);
+        m_ring = nullptr;
+      }
+      else {
+        //Never keep more operations in flight than the ring can hold
+        m_queueDepth = min(m_queueDepth, m_ring->sqEntries);
+      }
+    }
+
+    if (nullptr != m_ring) {
+      m_completionThread = ThreadPool::instance().run("AsyncFileIO", [this]() {
+        m_ring->runCompletions(*this);
+      });
+      return;
+    }
+#else
+    GE_UNREFERENCED_PARAMETER(allowIOUring);
+#endif
+
+    numThreads = max(numThreads, 1u);
+    m_workers.reserve(numThreads);
+    for (uint32 i = 0; i < numThreads; ++i) {
+      m_workers.push_back(ThreadPool::instance().run("AsyncFileIO", [this]() {
+        runWorker();
+      }));
+    }
+  }
+
+  AsyncFileIO::~AsyncFileIO() {
+    waitUntilIdle();
+
+    {
+      Lock lock(m_mutex);
+      m_shutdown = true;
+    }
+    m_queueCond.notify_all();
+
+    for (auto& worker : m_workers) {
+      worker.blockUntilComplete();
+    }
+
+#if USING(GE_PLATFORM_LINUX)
+    if (nullptr != m_ring) {
+      PendingIO* wakeUp = nullptr;
+      m_ring->submit(&wakeUp, 1);
+      m_completionThread.blockUntilComplete();
+
+      m_ring->destroy();
+      ge_delete(m_ring);
+      m_ring = nullptr;
+    }
+#endif
+  }
+
+  AsyncOp
+  AsyncFileIO::submit(const AsyncIORequest& request) {
+    PendingIO* operation = createPending(request.path, request.operation, true);
+    operation->buffer = reinterpret_cast<uint8*>(request.buffer);
+    operation->size = request.size;
+    operation->offset = request.offset;
+    operation->callback = request.callback;
+
+    AsyncOp asyncOp = operation->asyncOp;
+    start(&operation, 1);
+    return asyncOp;
+  }
+
+  Vector<AsyncOp>
+  AsyncFileIO::submit(const Vector<AsyncIORequest>& requests) {
+    Vector<AsyncOp> asyncOps;
+    asyncOps.reserve(requests.size());
+
+    Vector<PendingIO*> batch;
+    batch.reserve(min(static_cast<uint32>(requests.size()), m_queueDepth));
+
+    for (const auto& request : requests) {
+      PendingIO* operation = createPending(request.path, request.operation, false);
+
+      //The queue is full, start what we have so far before waiting for a slot
+      if (nullptr == operation) {
+        start(batch.data(), static_cast<uint32>(batch.size()));
+        batch.clear();
+        operation = createPending(request.path, request.operation, true);
+      }
+
+      operation->buffer = reinterpret_cast<uint8*>(request.buffer);
+      operation->size = request.size;
+      operation->offset = request.offset;
+      operation->callback = request.callback;
+
+      asyncOps.push_back(operation->asyncOp);
+      batch.push_back(operation);
+    }
+
+    if (!batch.empty()) {
+      start(batch.data(), static_cast<uint32>(batch.size()));
+    }
+
+    return asyncOps;
+  }
+
+  AsyncOp
+  AsyncFileIO::readFileAsync(const Path& path,
+                             function<void(const SPtr<DataStream>&)> callback) {
+    PendingIO* operation = createPending(path, ASYNC_IO_OP::kREAD, true);
+    operation->wholeFile = true;
+    operation->fileCallback = move(callback);
+
+    AsyncOp asyncOp = operation->asyncOp;
+    start(&operation, 1);
+    return asyncOp;
+  }
+
+  void
+  AsyncFileIO::waitUntilIdle() {
+    Lock lock(m_mutex);
+    while (0 != m_numPending) {
+      m_idleCond.wait(lock);
+    }
+  }
+
+  uint32
+  AsyncFileIO::getNumPending() const {
+    Lock lock(m_mutex);
+    return m_numPending;
+  }
+
+  AsyncFileIO::PendingIO*
+  AsyncFileIO::createPending(const Path& path, ASYNC_IO_OP::E operation, bool block) {
+    bool hasSlot = true;
+    {
+      Lock lock(m_mutex);
+      if (m_numInFlight >= m_queueDepth) {
+        if (!block) {
+          return nullptr;
+        }
+
+        //Callbacks running on our own I/O threads can't wait, start() queues
+        //the operation until a slot is handed to it instead
+        if (this == t_ioThreadOwner) {
+          hasSlot = false;
+        }
+        else {
+          while (m_numInFlight >= m_queueDepth) {
+            m_slotCond.wait(lock);
+          }
+        }
+      }
+
+      if (hasSlot) {
+        ++m_numInFlight;
+      }
+      ++m_numPending;
+    }
+
+    PendingIO* pending = ge_new<PendingIO>();
+    pending->hasSlot = hasSlot;
+    pending->path = path;
+    pending->operation = operation;
+    pending->syncData = ge_shared_ptr_new<AsyncOpSyncData>();
+    pending->asyncOp = AsyncOp(pending->syncData);
+    return pending;
+  }
+
+  void
+  AsyncFileIO::start(PendingIO** operations, uint32 count) {
+    //A slot may have been freed since the operations without one were created
+    uint32 numReady = 0;
+    {
+      Lock lock(m_mutex);
+      for (uint32 i = 0; i < count; ++i) {
+        PendingIO* operation = operations[i];
+        if (!operation->hasSlot) {
+          if (m_numInFlight >= m_queueDepth) {
+            m_waiting.push_back(operation);
+            continue;
+          }
+
+          ++m_numInFlight;
+          operation->hasSlot = true;
+        }
+
+        operations[numReady++] = operation;
+      }
+    }
+    count = numReady;
+
+    if (0 == count) {
+      return;
+    }
+
+#if USING(GE_PLATFORM_LINUX)
+    if (nullptr != m_ring) {
+      //Operations whose file can't be opened fail right away
+      uint32 numOpened = 0;
+      for (uint32 i = 0; i < count; ++i) {
+        if (IOUring::open(operations[i])) {
+          operations[numOpened++] = operations[i];
+        }
+        else {
+          operations[i]->success = false;
+          complete(operations[i]);
+        }
+      }
+
+      if (0 != numOpened) {
+        m_ring->submit(operations, numOpened);
+      }
+      return;
+    }
+#endif
+
+    {
+      Lock lock(m_mutex);
+      for (uint32 i = 0; i < count; ++i) {
+        m_queue.push_back(operations[i]);
+      }
+    }
+
+    if (1 == count) {
+      m_queueCond.notify_one();
+    }
+    else {
+      m_queueCond.notify_all();
+    }
+  }
+
+  void
+  AsyncFileIO::complete(PendingIO* operation) {
+#if USING(GE_PLATFORM_LINUX)
+    if (-1 != operation->fd) {
+      ::close(operation->fd);
+    }
+#endif
+
+    AsyncIOResult result;
+    result.bytesTransferred = operation->transferred;
+    result.success = operation->success;
+
+    function<void()> callback;
+    if (operation->wholeFile) {
+      SPtr<DataStream> fileData;
+      if (operation->success) {
+        fileData = ge_shared_ptr_new<MemoryDataStream>(operation->buffer,
+                                                       operation->transferred,
+                                                       true);
+      }
+      else if (nullptr != operation->buffer) {
+        ge_free(operation->buffer);
+      }
+
+      {
+        Lock lock(operation->syncData->m_mutex);
+        operation->asyncOp._completeOperation(Any(fileData));
+      }
+
+      if (operation->fileCallback) {
+        callback = [fileCallback = move(operation->fileCallback), fileData]() {
+          fileCallback(fileData);
+        };
+      }
+    }
+    else {
+      {
+        Lock lock(operation->syncData->m_mutex);
+        operation->asyncOp._completeOperation(Any(result));
+      }
+
+      if (operation->callback) {
+        callback = [resultCallback = move(operation->callback), result]() {
+          resultCallback(result);
+        };
+      }
+    }
+
+    ge_delete(operation);
+
+    //Free the slot before the callback runs, so it can submit more requests
+    PendingIO* next = nullptr;
+    {
+      Lock lock(m_mutex);
+      if (!m_waiting.empty()) {
+        next = m_waiting.front();
+        m_waiting.pop_front();
+        next->hasSlot = true;
+      }
+      else {
+        --m_numInFlight;
+      }
+    }
+
+    if (nullptr != next) {
+      start(&next, 1);
+    }
+    else {
+      m_slotCond.notify_one();
+    }
+
+    if (callback) {
+      if (TaskScheduler::isStarted()) {
+        TaskScheduler::instance().addTask(Task::create("AsyncFileIO", move(callback)));
+      }
+      else {
+        callback();
+      }
+    }
+
+    //Only idle once the callback ran, in case it submitted more requests
+    uint32 numPending;
+    {
+      Lock lock(m_mutex);
+      numPending = --m_numPending;
+    }
+
+    if (0 == numPending) {
+      m_idleCond.notify_all();
+    }
+  }
+
+  void
+  AsyncFileIO::execute(PendingIO* operation) {
+    SPtr<DataStream> stream;
+    if (ASYNC_IO_OP::kREAD == operation->operation) {
+      stream = FileSystem::openFile(operation->path, true, FILE_STREAM_TYPE::kNATIVE);
+    }
+    else {
+      //Only create missing files, writes at an offset must not truncate them
+      {
+        Lock lock(m_createMutex);
+        if (!FileSystem::exists(operation->path)) {
+          FileSystem::createAndOpenFile(operation->path)->close();
+        }
+      }
+
+      stream = FileSystem::openFile(operation->path, false, FILE_STREAM_TYPE::kNATIVE);
+    }
+
+    if (nullptr == stream) {
+      operation->success = false;
+      complete(operation);
+      return;
+    }
+
+    if (operation->wholeFile) {
+      operation->size = stream->size();
+      operation->buffer = reinterpret_cast<uint8*>(ge_alloc(max(operation->size,
+                                                                SIZE_T(1))));
+    }
+
+    stream->seek(static_cast<SIZE_T>(operation->offset));
+    if (ASYNC_IO_OP::kREAD == operation->operation) {
+      operation->transferred = stream->read(operation->buffer, operation->size);
+    }
+    else {
+      operation->transferred = stream->write(operation->buffer, operation->size);
+      operation->success = operation->transferred == operation->size;
+    }
+
+    stream->close();
+    complete(operation);
+  }
+
+  void
+  AsyncFileIO::runWorker() {
+    t_ioThreadOwner = this;
+    while (true) {
+      PendingIO* operation = nullptr;
+      {
+        Lock lock(m_mutex);
+        while (m_queue.empty() && !m_shutdown) {
+          m_queueCond.wait(lock);
+        }
+
+        if (m_queue.empty()) {
+          return;
+        }
+
+        operation = m_queue.front();
+        m_queue.pop_front();
+      }
+
+      execute(operation);
+    }
+  }
+}
@@ -0,0 +1,443 @@
+/*****************************************************************************/
+/**
+ * @file    geAsyncLog.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Logs messages formatting them on a background thread.
+ *
+ * Each thread writes its records to its own ring buffer, with a single
+ * producer and a single consumer, so logging only needs a few atomic
+ * operations on memory no other thread writes to.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geAsyncLog.h"
+#include "geDebug.h"
+#include "geBitwise.h"
+
+namespace geEngineSDK {
+  using std::memory_order_relaxed;
+  using std::memory_order_acquire;
+  using std::memory_order_release;
+  using std::memory_order_seq_cst;
+
+  /**
+   * @brief Header of every record in a ring buffer. Records are padded to a
+   *        multiple of its alignment.
+   */
+  struct LogRecordHeader
+  {
+    /**
+     * Null for the padding left at the end of the buffer when a record
+     * doesn't fit before it.
+     */
+    const LogCallSite* site;
+
+    /**
+     * Nanoseconds since the epoch of the system clock.
+     */
+    int64 timestamp;
+    uint32 size;
+    uint32 threadIdx;
+  };
+
+  /**
+   * @brief Ring buffer with the records of a thread. Written only by its
+   *        thread, and read only by the logging thread.
+   */
+  class LogRingBuffer
+  {
+   public:
+    LogRingBuffer(uint64 capacity, uint32 threadIdx)
+      : m_data(reinterpret_cast<uint8*>(ge_alloc(static_cast<SIZE_T>(capacity)))),
+        m_capacity(capacity),
+        m_threadIdx(threadIdx)
+    {}
+
+    ~LogRingBuffer() {
+      ge_free(m_data);
+    }
+
+    uint8* m_data;
+    uint64 m_capacity;
+    uint32 m_threadIdx;
+
+    /**
+     * Set by the thread when it ends. The buffer is released once the
+     * logging thread reads its last records.
+     */
+    atomic<bool> m_released{ false };
+
+    //Owned by the writing thread
+    uint8 m_padding0[64];
+    atomic<uint64> m_head{ 0 };
+    atomic<bool> m_writing{ false };
+    uint64 m_cachedTail = 0;
+    uint64 m_pendingHead = 0;
+
+    //Owned by the logging thread
+    uint8 m_padding1[64];
+    atomic<uint64> m_tail{ 0 };
+  };
+
+  namespace {
+    CONSTEXPR SIZE_T kRecordAlignment = alignof(LogRecordHeader);
+
+    /**
+     * @brief Buffer of the current thread. Marks it as released when the
+     *        thread ends.
+     */
+    struct LocalLogBuffer
+    {
+      ~LocalLogBuffer() {
+        if (buffer) {
+          buffer->m_released.store(true, memory_order_release);
+        }
+      }
+
+      SPtr<LogRingBuffer> buffer;
+      bool isLoggingThread = false;
+    };
+
+    thread_local LocalLogBuffer t_localBuffer;
+
+    /**
+     * Serializes the creation of buffers with the shut down, so no buffer
+     * is created once it starts.
+     */
+    Mutex s_activeMutex;
+
+    int64
+    getTimestamp() {
+      using namespace std::chrono;
+      return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Returns the next record of a buffer, skipping any padding.
+     * @return  Null if there are no more records before @p head.
+     */
+    const LogRecordHeader*
+    peekRecord(const LogRingBuffer& buffer, uint64& tail, uint64 head) {
+      while (tail < head) {
+        const uint64 pos = tail & (buffer.m_capacity - 1);
+        const uint64 toEnd = buffer.m_capacity - pos;
+        if (toEnd < sizeof(LogRecordHeader)) {
+          tail += toEnd;
+          continue;
+        }
+
+        auto record = reinterpret_cast<const LogRecordHeader*>(buffer.m_data + pos);
+        if (nullptr == record->site) {
+          tail += record->size;
+          continue;
+        }
+
+        return record;
+      }
+
+      return nullptr;
+    }
+  }
+
+  atomic<bool> AsyncLog::s_active{ false };
+
+  AsyncLog::AsyncLog(const AsyncLogOptions& options)
+    : m_options(options) {
+    m_options.bufferSize = Bitwise::nextPow2(Math::max(m_options.bufferSize, 4096U));
+    m_thread = Thread([this]() {
+      run();
+    });
+  }
+
+  AsyncLog::~AsyncLog() {
+    if (m_thread.joinable()) {
+      {
+        Lock lock(m_mutex);
+        m_stop = true;
+      }
+      m_wakeSignal.notify_one();
+      m_thread.join();
+    }
+  }
+
+  void
+  AsyncLog::onStartUp() {
+    if (m_options.binaryLog) {
+      g_debug().addSink(m_options.binaryLog);
+    }
+
+    Lock lock(s_activeMutex);
+    s_active.store(true, memory_order_seq_cst);
+  }
+
+  void
+  AsyncLog::onShutDown() {
+    {
+      Lock lock(s_activeMutex);
+      s_active.store(false, memory_order_seq_cst);
+    }
+
+    //Let the threads already writing a record finish. The logging thread
+    //keeps running, so the ones waiting for space get it.
+    Vector<SPtr<LogRingBuffer>> buffers;
+    {
+      Lock lock(m_mutex);
+      buffers = m_buffers;
+    }
+
+    for (auto& buffer : buffers) {
+      while (buffer->m_writing.load(memory_order_seq_cst)) {
+        std::this_thread::yield();
+      }
+    }
+
+    //The last pass logs everything left in the buffers
+    {
+      Lock lock(m_mutex);
+      m_stop = true;
+    }
+    m_wakeSignal.notify_one();
+    m_thread.join();
+
+    if (m_options.binaryLog) {
+      g_debug().removeSink(m_options.binaryLog);
+    }
+  }
+
+  void
+  AsyncLog::flush() {
+    if (t_localBuffer.isLoggingThread) {
+      return;
+    }
+
+    Lock lock(m_mutex);
+    const uint64 pass = m_passesStarted + 1;
+    m_flushRequested = true;
+    m_wakeSignal.notify_one();
+    m_flushSignal.wait(lock, [this, pass]() {
+      return m_passesDone >= pass;
+    });
+  }
+
+  bool
+  AsyncLog::_beginRecord(const LogCallSite& site, SIZE_T argsSize, uint8*& data) {
+    LocalLogBuffer& local = t_localBuffer;
+    if (local.isLoggingThread) {
+      //Messages logged while formatting another one
+      return false;
+    }
+
+    if (!local.buffer) {
+      Lock lock(s_activeMutex);
+      if (!s_active.load(memory_order_relaxed)) {
+        return false;
+      }
+      local.buffer = _instance()->createBuffer();
+    }
+
+    //Pairs with the shut down, which clears s_active before waiting for
+    //m_writing. Either it waits for this record, or this sees it inactive.
+    LogRingBuffer& buffer = *local.buffer;
+    buffer.m_writing.store(true, memory_order_seq_cst);
+    if (!s_active.load(memory_order_seq_cst)) {
+      buffer.m_writing.store(false, memory_order_release);
+      return false;
+    }
+
+    AsyncLog& asyncLog = *_instance();
+    const SIZE_T recordSize = Math::divideAndRoundUp(sizeof(LogRecordHeader) + argsSize,
+                                                     kRecordAlignment) * kRecordAlignment;
+    if (static_cast<int32>(site.verbosity) <=
+          static_cast<int32>(asyncLog.m_options.syncVerbosity) ||
+        recordSize > buffer.m_capacity / 4) {
+      asyncLog.flush();
+      buffer.m_writing.store(false, memory_order_release);
+      return false;
+    }
+
+    uint64 head = buffer.m_head.load(memory_order_relaxed);
+    const uint64 pos = head & (buffer.m_capacity - 1);
+    const uint64 toEnd = buffer.m_capacity - pos;
+    const uint64 needed = recordSize + (toEnd < recordSize ? toEnd : 0);
+
+    while (buffer.m_capacity - (head - buffer.m_cachedTail) < needed) {
+      buffer.m_cachedTail = buffer.m_tail.load(memory_order_acquire);
+      if (buffer.m_capacity - (head - buffer.m_cachedTail) >= needed) {
+        break;
+      }
+
+      if (!asyncLog.m_options.blockWhenFull) {
+        asyncLog.m_numDropped.fetch_add(1, memory_order_relaxed);
+        buffer.m_writing.store(false, memory_order_release);
+        data = nullptr;
+        return true;
+      }
+
+      asyncLog.wakeUp();
+      std::this_thread::yield();
+    }
+
+    //Records are never split, the rest of the buffer is skipped instead
+    uint8* recordData = buffer.m_data + pos;
+    if (toEnd < recordSize) {
+      if (toEnd >= sizeof(LogRecordHeader)) {
+        auto padding = reinterpret_cast<LogRecordHeader*>(recordData);
+        padding->site = nullptr;
+        padding->size = static_cast<uint32>(toEnd);
+      }
+
+      head += toEnd;
+      recordData = buffer.m_data;
+    }
+
+    auto record = reinterpret_cast<LogRecordHeader*>(recordData);
+    record->site = &site;
+    record->timestamp = getTimestamp();
+    record->size = static_cast<uint32>(recordSize);
+    record->threadIdx = buffer.m_threadIdx;
+
+    buffer.m_pendingHead = head + recordSize;
+    data = recordData + sizeof(LogRecordHeader);
+    return true;
+  }
+
+  void
+  AsyncLog::_commitRecord() {
+    LogRingBuffer& buffer = *t_localBuffer.buffer;
+    buffer.m_head.store(buffer.m_pendingHead, memory_order_release);
+
+    //Don't wait for the interval to end if the buffer is getting full
+    if (buffer.m_pendingHead - buffer.m_cachedTail > buffer.m_capacity / 2) {
+      buffer.m_cachedTail = buffer.m_tail.load(memory_order_acquire);
+      if (buffer.m_pendingHead - buffer.m_cachedTail > buffer.m_capacity / 2) {
+        _instance()->wakeUp();
+      }
+    }
+
+    buffer.m_writing.store(false, memory_order_release);
+  }
+
+  SPtr<LogRingBuffer>
+  AsyncLog::createBuffer() {
+    Lock lock(m_mutex);
+    auto buffer = ge_shared_ptr_new<LogRingBuffer>(m_options.bufferSize, m_nextThreadIdx++);
+    m_buffers.push_back(buffer);
+    return buffer;
+  }
+
+  void
+  AsyncLog::wakeUp() {
+    m_wakeSignal.notify_one();
+  }
+
+  void
+  AsyncLog::run() {
+    t_localBuffer.isLoggingThread = true;
+
+    Vector<SPtr<LogRingBuffer>> buffers;
+    while (true) {
+      uint64 pass;
+      bool stop;
+      {
+        Lock lock(m_mutex);
+        if (!m_stop && !m_flushRequested) {
+          m_wakeSignal.wait_for(lock,
+                                std::chrono::milliseconds(m_options.flushIntervalMs));
+        }
+
+        m_flushRequested = false;
+        stop = m_stop;
+        pass = ++m_passesStarted;
+        buffers = m_buffers;
+      }
+
+      drain(buffers);
+
+      {
+        Lock lock(m_mutex);
+        m_passesDone = pass;
+
+        //Release the buffers of the threads that ended
+        auto removed = std::remove_if(m_buffers.begin(),
+                                      m_buffers.end(),
+                                      [](const SPtr<LogRingBuffer>& buffer) {
+                                        return buffer->m_released.load(memory_order_acquire) &&
+                                               buffer->m_tail.load(memory_order_relaxed) ==
+                                                 buffer->m_head.load(memory_order_acquire);
+                                      });
+        m_buffers.erase(removed, m_buffers.end());
+      }
+      m_flushSignal.notify_all();
+
+      if (stop) {
+        break;
+      }
+    }
+  }
+
+  void
+  AsyncLog::drain(const Vector<SPtr<LogRingBuffer>>& buffers) {
+    struct Cursor
+    {
+      LogRingBuffer* buffer;
+      uint64 tail;
+      uint64 head;
+      const LogRecordHeader* next;
+    };
+
+    Vector<Cursor> cursors;
+    cursors.reserve(buffers.size());
+    for (auto& buffer : buffers) {
+      Cursor cursor;
+      cursor.buffer = buffer.get();
+      cursor.tail = buffer->m_tail.load(memory_order_relaxed);
+      cursor.head = buffer->m_head.load(memory_order_acquire);
+      cursor.next = peekRecord(*buffer, cursor.tail, cursor.head);
+      if (nullptr != cursor.next) {
+        cursors.push_back(cursor);
+      }
+    }
+
+    //Merge the buffers, so the messages are logged in the order they were
+    //recorded and not grouped by thread
+    Debug& debug = g_debug();
+    while (!cursors.empty()) {
+      auto oldest = cursors.begin();
+      for (auto it = cursors.begin() + 1; it != cursors.end(); ++it) {
+        if (it->next->timestamp < oldest->next->timestamp) {
+          oldest = it;
+        }
+      }
+
+      const LogRecordHeader* record = oldest->next;
+      const LogCallSite& site = *record->site;
+      auto args = reinterpret_cast<const uint8*>(record + 1);
+      if (m_options.binaryLog) {
+        m_options.binaryLog->_writeRecord(site, record->timestamp, args);
+      }
+      else {
+        debug.log(site.formatArgs(args) + site.location,
+                  site.verbosity,
+                  site.category,
+                  static_cast<time_t>(record->timestamp / 1000000000));
+      }
+
+      oldest->tail += record->size;
+      oldest->buffer->m_tail.store(oldest->tail, memory_order_release);
+      oldest->next = peekRecord(*oldest->buffer, oldest->tail, oldest->head);
+      if (nullptr == oldest->next) {
+        //Publish any padding skipped after the last record
+        oldest->buffer->m_tail.store(oldest->tail, memory_order_release);
+        cursors.erase(oldest);
+      }
+    }
+  }
+}
@@ -0,0 +1,1302 @@
+/*****************************************************************************/
+/**
+ * @file    geBinaryBufferDiff.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Generates and applies diffs directly on data encoded by the
+ *          BinarySerializer.
+ *
+ * Generates and applies diffs directly on data encoded by the
+ * BinarySerializer, without building SerializedObject trees for the original
+ * and the new states first.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geBinaryBufferDiff.h"
+#include "geBinarySerializer.h"
+#include "geDataStream.h"
+#include "geDebug.h"
+#include "geException.h"
+#include "geIReflectable.h"
+#include "geRTTIType.h"
+#include "geRTTIPlainField.h"
+#include "geRTTIReflectableField.h"
+#include "geRTTIReflectablePtrField.h"
+#include "geRTTIManagedDataBlockField.h"
+
+namespace geEngineSDK {
+  namespace {
+    /**
+     * @brief Identifies patches generated by BinaryBufferDiff ("GEBD").
+     */
+    CONSTEXPR uint32 PATCH_MAGIC = 0x44424547;
+
+    /**
+     * @brief The patch touches objects other than the root, so the IDs of the
+     *        objects in the target graph must be resolved before applying it.
+     */
+    CONSTEXPR uint32 PATCH_FLAG_RESOLVE_IDS = 0x01;
+
+    /**
+     * @brief Size of the chunks the encoded data grows by.
+     */
+    CONSTEXPR uint32 ENCODE_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief Size of the header of a run of modified array elements. Runs
+     *        separated by fewer unchanged bytes than this are merged.
+     */
+    CONSTEXPR SIZE_T RUN_HEADER_SIZE = sizeof(uint32) * 2;
+
+    /**
+     * @brief Number of fixed size array elements compared at once while
+     *        looking for the next modified element.
+     */
+    CONSTEXPR uint32 COMPARE_BLOCK_ELEMENTS = 64;
+
+    namespace PATCH_OBJECT_OP {
+      enum E : uint8 {
+        kFull   = 0, //Whole encoded object entry
+        kFields = 1  //List of modified fields
+      };
+    }
+
+    namespace PATCH_FIELD_OP {
+      enum E : uint8 {
+        kReplace  = 0, //Whole encoded field payload
+        kElements = 1  //Array size and the runs of modified elements
+      };
+    }
+
+    struct PatchHeader
+    {
+      uint32 magic;
+      uint32 flags;
+      uint32 numObjects;
+    };
+
+    template<class T>
+    T
+    readValue(const uint8*& data, const uint8* end) {
+      T value;
+      if (static_cast<SIZE_T>(end - data) < sizeof(T)) {
+        GE_EXCEPT(InternalErrorException, "Error decoding data.");
+        memset(&value, 0, sizeof(T));
+        return value;
+      }
+
+      memcpy(&value, data, sizeof(T));
+      data += sizeof(T);
+      return value;
+    }
+
+    const uint8*
+    advance(const uint8* data, const uint8* end, SIZE_T size) {
+      if (static_cast<SIZE_T>(end - data) < size) {
+        GE_EXCEPT(InternalErrorException, "Error decoding data.");
+        return end;
+      }
+
+      return data + size;
+    }
+
+    template<class T>
+    void
+    writeValue(Vector<uint8>& output, const T& value) {
+      auto bytes = reinterpret_cast<const uint8*>(&value);
+      output.insert(output.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<class T>
+    void
+    writeValueAt(Vector<uint8>& output, SIZE_T offset, const T& value) {
+      memcpy(&output[offset], &value, sizeof(T));
+    }
+
+    void
+    writeBytes(Vector<uint8>& output, const uint8* data, SIZE_T size) {
+      output.insert(output.end(), data, data + size);
+    }
+
+    bool
+    sameBytes(const uint8* a, SIZE_T sizeA, const uint8* b, SIZE_T sizeB) {
+      return sizeA == sizeB && 0 == memcmp(a, b, sizeA);
+    }
+
+    int32
+    findClassIndex(const RTTISerializationPlan& plan, uint32 typeId) {
+      for (SIZE_T i = 0; i < plan.classes.size(); ++i) {
+        if (plan.classes[i].rttiId == typeId) {
+          return static_cast<int32>(i);
+        }
+      }
+
+      return -1;
+    }
+
+    void
+    beginDeserialization(IReflectable* object,
+                         const RTTISerializationPlan& plan,
+                         FrameAlloc& alloc,
+                         SerializationContext* context,
+                         FrameVector<RTTITypeBase*>& rttiInstances) {
+      rttiInstances.reserve(plan.classes.size());
+      for (const auto& classEntry : plan.classes) {
+        rttiInstances.push_back(classEntry.rtti->_getInstance(alloc));
+      }
+
+      //Iterate in reverse to notify base classes before derived classes
+      for (auto iter = rttiInstances.rbegin(); iter != rttiInstances.rend(); ++iter) {
+        (*iter)->onDeserializationStarted(object, context);
+      }
+    }
+
+    void
+    endDeserialization(IReflectable* object,
+                       FrameAlloc& alloc,
+                       SerializationContext* context,
+                       FrameVector<RTTITypeBase*>& rttiInstances) {
+      //Same order as the BinarySerializer uses when decoding
+      for (auto iter = rttiInstances.rbegin(); iter != rttiInstances.rend(); ++iter) {
+        (*iter)->onDeserializationEnded(object, context);
+        RTTITypeBase::_releaseInstance(*iter, alloc);
+      }
+
+      rttiInstances.clear();
+    }
+  }
+
+  void
+  BinaryBufferDiff::encode(IReflectable& object, Vector<uint8>& output, bool shallow) {
+    //Encode straight into the vector, growing it whenever the serializer
+    //runs out of space
+    SIZE_T usedSize = 0;
+    output.resize(std::max(output.capacity(), static_cast<SIZE_T>(ENCODE_CHUNK_SIZE)));
+
+    auto flushBuffer = [&output, &usedSize](uint8* /*bufferStart*/,
+                                            uint32 bytesWritten,
+                                            uint32& newBufferSize) -> uint8* {
+      usedSize += bytesWritten;
+      output.resize(usedSize + ENCODE_CHUNK_SIZE);
+
+      newBufferSize = ENCODE_CHUNK_SIZE;
+      return output.data() + usedSize;
+    };
+
+    BinarySerializer bs;
+    uint32 bytesWritten = 0;
+    bs.encode(&object,
+              output.data(),
+              static_cast<uint32>(output.size()),
+              &bytesWritten,
+              flushBuffer,
+              shallow);
+
+    output.resize(bytesWritten);
+  }
+
+  void
+  BinaryBufferDiff::buildIndex(const uint8* data, uint32 size, EncodedIndex& index) {
+    index.clear();
+
+    if (BinarySerializer::FORMAT_VERSION_DEFAULT !=
+          BinarySerializer::getFormatVersion(data, size)) {
+      GE_EXCEPT(InvalidParametersException,
+                "Only data encoded in the default format can be diffed.");
+      return;
+    }
+
+    const uint8* end = data + size;
+    while (data < end) {
+      EncodedIndex::Object object;
+      object.data = data;
+
+      bool isBaseClass = false;
+      readObjectMeta(data, end, object.id, object.typeId, isBaseClass);
+
+      if (isBaseClass) {
+        GE_EXCEPT(InternalErrorException,
+                  "Encountered a base-class object while looking for a new "
+                  "object. Base class objects are only supposed to be parts "
+                  "of a larger object.");
+      }
+
+      object.firstClass = static_cast<uint32>(index.classes.size());
+      object.numClasses = 1;
+      index.classes.push_back({object.typeId,
+                               static_cast<uint32>(index.fields.size()),
+                               0});
+
+      while (data < end) {
+        const uint8* metaStart = data;
+        const uint32 meta = readValue<uint32>(data, end);
+
+        if (isObjectMeta(meta)) {
+          data = metaStart;
+
+          uint32 classObjectId = 0;
+          uint32 classTypeId = 0;
+          bool classIsBase = false;
+          readObjectMeta(data, end, classObjectId, classTypeId, classIsBase);
+
+          if (!classIsBase) {
+            //Found the next object
+            data = metaStart;
+            break;
+          }
+
+          ++object.numClasses;
+          index.classes.push_back({classTypeId,
+                                   static_cast<uint32>(index.fields.size()),
+                                   0});
+          continue;
+        }
+
+        const FieldMeta fieldMeta = decodeFieldMeta(meta);
+        if (fieldMeta.terminator) {
+          GE_EXCEPT(InternalErrorException,
+                    "Error decoding data. Found a terminator field outside "
+                    "of an embedded object.");
+        }
+
+        const uint8* payloadEnd = skipPayload(fieldMeta, data, end);
+        index.fields.push_back({meta, static_cast<uint32>(payloadEnd - data), data});
+        ++index.classes.back().numFields;
+
+        data = payloadEnd;
+      }
+
+      object.size = static_cast<uint32>(data - object.data);
+      index.objects.push_back(object);
+    }
+  }
+
+  bool
+  BinaryBufferDiff::generateDiff(const uint8* orgData,
+                                 uint32 orgSize,
+                                 const uint8* newData,
+                                 uint32 newSize,
+                                 Vector<uint8>& patch) {
+    EncodedIndex orgIndex;
+    EncodedIndex newIndex;
+    buildIndex(orgData, orgSize, orgIndex);
+    buildIndex(newData, newSize, newIndex);
+
+    return generateDiff(orgIndex, newIndex, patch);
+  }
+
+  bool
+  BinaryBufferDiff::generateDiff(const EncodedIndex& orgIndex,
+                                 const EncodedIndex& newIndex,
+                                 Vector<uint8>& patch) {
+    patch.clear();
+
+    if (newIndex.objects.empty()) {
+      return false;
+    }
+
+    //Without original data every object is sent whole
+    if (!orgIndex.objects.empty() &&
+        orgIndex.objects[0].typeId != newIndex.objects[0].typeId) {
+      GE_EXCEPT(InvalidParametersException,
+                "Diffed objects must be of the same type.");
+      return false;
+    }
+
+    //Object IDs are assigned sequentially starting at 1, so they normally
+    //map directly to the position of the object in the index
+    auto findOrgObject = [&orgIndex](uint32 id) -> const EncodedIndex::Object* {
+      if (0 < id && id <= orgIndex.objects.size() && orgIndex.objects[id - 1].id == id) {
+        return &orgIndex.objects[id - 1];
+      }
+
+      for (const auto& object : orgIndex.objects) {
+        if (object.id == id) {
+          return &object;
+        }
+      }
+
+      return nullptr;
+    };
+
+    auto sameLayout = [&orgIndex, &newIndex](const EncodedIndex::Object& orgObject,
+                                             const EncodedIndex::Object& newObject) {
+      if (orgObject.typeId != newObject.typeId ||
+          orgObject.numClasses != newObject.numClasses) {
+        return false;
+      }
+
+      for (uint32 i = 0; i < newObject.numClasses; ++i) {
+        if (orgIndex.classes[orgObject.firstClass + i].typeId !=
+            newIndex.classes[newObject.firstClass + i].typeId) {
+          return false;
+        }
+      }
+
+      return true;
+    };
+
+    //If the object under some ID changed type, fields that still reference
+    //that ID would keep pointing to the old instance. Rather than tracking
+    //all of them down, every object is sent whole.
+    bool fullPatch = false;
+    for (const auto& newObject : newIndex.objects) {
+      const EncodedIndex::Object* orgObject = findOrgObject(newObject.id);
+      if (nullptr != orgObject && !sameLayout(*orgObject, newObject)) {
+        fullPatch = true;
+        break;
+      }
+    }
+
+    PatchHeader header;
+    header.magic = PATCH_MAGIC;
+    header.flags = 0;
+    header.numObjects = 0;
+    writeValue(patch, header);
+
+    for (const auto& newObject : newIndex.objects) {
+      const EncodedIndex::Object* orgObject = nullptr;
+      if (!fullPatch) {
+        orgObject = findOrgObject(newObject.id);
+      }
+
+      if (nullptr != orgObject &&
+          sameBytes(orgObject->data, orgObject->size, newObject.data, newObject.size)) {
+        continue;
+      }
+
+      const SIZE_T recordStart = patch.size();
+      writeValue(patch, newObject.id);
+      writeValue(patch, newObject.typeId);
+
+      if (nullptr == orgObject) {
+        writeValue(patch, static_cast<uint8>(PATCH_OBJECT_OP::kFull));
+        writeValue(patch, newObject.size);
+        writeBytes(patch, newObject.data, newObject.size);
+
+        header.flags |= PATCH_FLAG_RESOLVE_IDS;
+      }
+      else {
+        writeValue(patch, static_cast<uint8>(PATCH_OBJECT_OP::kFields));
+
+        const SIZE_T sizeOffset = patch.size();
+        writeValue(patch, static_cast<uint32>(0));
+
+        const SIZE_T bodyStart = patch.size();
+        writeValue(patch, static_cast<uint32>(0));
+
+        uint32 numChanges = 0;
+        const bool referencesObjects = diffFields(orgIndex,
+                                                  *orgObject,
+                                                  newIndex,
+                                                  newObject,
+                                                  patch,
+                                                  numChanges);
+
+        if (0 == numChanges) {
+          patch.resize(recordStart);
+          continue;
+        }
+
+        writeValueAt(patch, bodyStart, numChanges);
+        writeValueAt(patch, sizeOffset, static_cast<uint32>(patch.size() - bodyStart));
+
+        if (referencesObjects || 1 != newObject.id) {
+          header.flags |= PATCH_FLAG_RESOLVE_IDS;
+        }
+      }
+
+      ++header.numObjects;
+    }
+
+    if (0 == header.numObjects) {
+      patch.clear();
+      return false;
+    }
+
+    writeValueAt(patch, 0, header);
+    return true;
+  }
+
+  bool
+  BinaryBufferDiff::diffFields(const EncodedIndex& orgIndex,
+                               const EncodedIndex::Object& orgObject,
+                               const EncodedIndex& newIndex,
+                               const EncodedIndex::Object& newObject,
+                               Vector<uint8>& patch,
+                               uint32& numChanges) {
+    bool referencesObjects = false;
+
+    for (uint32 i = 0; i < newObject.numClasses; ++i) {
+      const EncodedIndex::Class& orgClass = orgIndex.classes[orgObject.firstClass + i];
+      const EncodedIndex::Class& newClass = newIndex.classes[newObject.firstClass + i];
+
+      for (uint32 j = 0; j < newClass.numFields; ++j) {
+        const EncodedIndex::Field& newField = newIndex.fields[newClass.firstField + j];
+
+        //Fields are normally encoded in the same order for both objects
+        const EncodedIndex::Field* orgField = nullptr;
+        if (j < orgClass.numFields &&
+            orgIndex.fields[orgClass.firstField + j].meta == newField.meta) {
+          orgField = &orgIndex.fields[orgClass.firstField + j];
+        }
+        else {
+          for (uint32 k = 0; k < orgClass.numFields; ++k) {
+            if (orgIndex.fields[orgClass.firstField + k].meta == newField.meta) {
+              orgField = &orgIndex.fields[orgClass.firstField + k];
+              break;
+            }
+          }
+        }
+
+        if (nullptr != orgField &&
+            sameBytes(orgField->data, orgField->size, newField.data, newField.size)) {
+          continue;
+        }
+
+        const FieldMeta meta = decodeFieldMeta(newField.meta);
+
+        writeValue(patch, newClass.typeId);
+        writeValue(patch, newField.meta);
+
+        const SIZE_T opOffset = patch.size();
+        bool wroteElements = false;
+        if (nullptr != orgField && meta.isArray) {
+          writeValue(patch, static_cast<uint8>(PATCH_FIELD_OP::kElements));
+          wroteElements = writeArrayElements(meta, *orgField, newField, patch);
+
+          if (!wroteElements) {
+            patch.resize(opOffset);
+          }
+        }
+
+        if (!wroteElements) {
+          writeValue(patch, static_cast<uint8>(PATCH_FIELD_OP::kReplace));
+          writeValue(patch, newField.size);
+          writeBytes(patch, newField.data, newField.size);
+        }
+
+        if (SERIALIZABLE_FIELD_TYPE::kReflectablePtr == meta.type ||
+            SERIALIZABLE_FIELD_TYPE::kReflectable == meta.type) {
+          referencesObjects = true;
+        }
+
+        ++numChanges;
+      }
+    }
+
+    return referencesObjects;
+  }
+
+  bool
+  BinaryBufferDiff::writeArrayElements(const FieldMeta& meta,
+                                       const EncodedIndex::Field& orgField,
+                                       const EncodedIndex::Field& newField,
+                                       Vector<uint8>& patch) {
+    const uint8* orgData = orgField.data;
+    const uint8* orgEnd = orgData + orgField.size;
+    const uint8* newData = newField.data;
+    const uint8* newEnd = newData + newField.size;
+
+    const uint32 orgNumElements = readValue<uint32>(orgData, orgEnd);
+    const uint32 newNumElements = readValue<uint32>(newData, newEnd);
+    const uint32 numCommon = std::min(orgNumElements, newNumElements);
+
+    const bool fixedSize = SERIALIZABLE_FIELD_TYPE::kReflectablePtr == meta.type ||
+                           (SERIALIZABLE_FIELD_TYPE::kPlain == meta.type &&
+                            !meta.hasDynamicSize);
+    const SIZE_T elementSize =
+      SERIALIZABLE_FIELD_TYPE::kReflectablePtr == meta.type ? sizeof(uint32) : meta.size;
+
+    //Elements of variable size must be located one by one first
+    Vector<uint32> orgOffsets;
+    Vector<uint32> newOffsets;
+    if (!fixedSize) {
+      auto findOffsets = [&meta](const uint8* data,
+                                 const uint8* end,
+                                 uint32 numElements,
+                                 Vector<uint32>& offsets) {
+        offsets.reserve(numElements + 1);
+
+        const uint8* element = data;
+        for (uint32 i = 0; i < numElements; ++i) {
+          offsets.push_back(static_cast<uint32>(element - data));
+          element = skipValue(meta, element, end);
+        }
+
+        offsets.push_back(static_cast<uint32>(element - data));
+      };
+
+      findOffsets(orgData, orgEnd, orgNumElements, orgOffsets);
+      findOffsets(newData, newEnd, newNumElements, newOffsets);
+    }
+
+    auto elementStart = [&](const uint8* data, const Vector<uint32>& offsets, uint32 idx) {
+      return fixedSize ? data + idx * elementSize : data + offsets[idx];
+    };
+
+    auto isModified = [&](uint32 idx) {
+      if (idx >= orgNumElements) {
+        return true;
+      }
+
+      const uint8* orgElement = elementStart(orgData, orgOffsets, idx);
+      const uint8* newElement = elementStart(newData, newOffsets, idx);
+      if (fixedSize) {
+        return 0 != memcmp(orgElement, newElement, elementSize);
+      }
+
+      return !sameBytes(orgElement,
+                        elementStart(orgData, orgOffsets, idx + 1) - orgElement,
+                        newElement,
+                        elementStart(newData, newOffsets, idx + 1) - newElement);
+    };
+
+    const SIZE_T sizeOffset = patch.size();
+    writeValue(patch, static_cast<uint32>(0));
+    writeValue(patch, newNumElements);
+
+    const SIZE_T numRunsOffset = patch.size();
+    writeValue(patch, static_cast<uint32>(0));
+
+    //Not worth it once the runs take as much space as the whole field
+    const SIZE_T maxSize = newField.size + sizeof(uint32);
+
+    uint32 numRuns = 0;
+    uint32 idx = 0;
+    while (idx < newNumElements) {
+      if (fixedSize) {
+        //Skip over unchanged blocks of elements with a single comparison
+        while (idx + COMPARE_BLOCK_ELEMENTS <= numCommon &&
+               0 == memcmp(orgData + idx * elementSize,
+                           newData + idx * elementSize,
+                           COMPARE_BLOCK_ELEMENTS * elementSize)) {
+          idx += COMPARE_BLOCK_ELEMENTS;
+        }
+
+        if (idx >= newNumElements) {
+          break;
+        }
+      }
+
+      if (!isModified(idx)) {
+        ++idx;
+        continue;
+      }
+
+      //Extend the run over the following modified elements, absorbing gaps
+      //of unchanged elements smaller than the header of a new run
+      const uint32 first = idx;
+      uint32 last = idx + 1;
+      SIZE_T gapSize = 0;
+      for (uint32 next = last; next < newNumElements; ++next) {
+        if (isModified(next)) {
+          last = next + 1;
+          gapSize = 0;
+          continue;
+        }
+
+        gapSize += elementStart(newData, newOffsets, next + 1) -
+                   elementStart(newData, newOffsets, next);
+        if (gapSize > RUN_HEADER_SIZE) {
+          break;
+        }
+      }
+
+      const uint8* runStart = elementStart(newData, newOffsets, first);
+      const uint8* runEnd = elementStart(newData, newOffsets, last);
+
+      writeValue(patch, first);
+      writeValue(patch, last - first);
+      writeBytes(patch, runStart, runEnd - runStart);
+      ++numRuns;
+
+      if (patch.size() - sizeOffset >= maxSize) {
+        return false;
+      }
+
+      idx = last;
+    }
+
+    writeValueAt(patch, numRunsOffset, numRuns);
+    writeValueAt(patch,
+                 sizeOffset,
+                 static_cast<uint32>(patch.size() - sizeOffset - sizeof(uint32)));
+    return true;
+  }
+
+  void
+  BinaryBufferDiff::applyDiff(const SPtr<IReflectable>& object,
+                              const uint8* patch,
+                              uint32 patchSize,
+                              SerializationContext* context) {
+    if (nullptr == object || nullptr == patch || 0 == patchSize) {
+      return;
+    }
+
+    const uint8* data = patch;
+    const uint8* end = patch + patchSize;
+
+    const auto header = readValue<PatchHeader>(data, end);
+    if (PATCH_MAGIC != header.magic) {
+      GE_EXCEPT(InvalidParametersException,
+                "Provided data is not a patch generated by BinaryBufferDiff.");
+      return;
+    }
+
+    FrameAlloc& alloc = g_frameAlloc();
+    alloc.markFrame();
+
+    //IDs must be resolved against the graph as it was encoded, so before
+    //any of the changes are applied
+    ObjectIdMap objects;
+    if (0 != (header.flags & PATCH_FLAG_RESOLVE_IDS)) {
+      gatherObjectIds(object, alloc, objects);
+    }
+    else {
+      objects[1] = object;
+    }
+
+    //Create the objects sent whole first, since any of the modified
+    //references can point to them
+    const uint8* records = data;
+    for (uint32 i = 0; i < header.numObjects; ++i) {
+      const uint32 objectId = readValue<uint32>(data, end);
+      const uint32 typeId = readValue<uint32>(data, end);
+      const uint8 op = readValue<uint8>(data, end);
+      const uint32 size = readValue<uint32>(data, end);
+      data = advance(data, end, size);
+
+      if (1 == objectId) {
+        if (object->getTypeId() != typeId) {
+          GE_EXCEPT(InvalidParametersException,
+                    "Patch was generated for an object of a different type.");
+          alloc.clear();
+          return;
+        }
+
+        continue;
+      }
+
+      if (PATCH_OBJECT_OP::kFull == op) {
+        SPtr<IReflectable> newObject = IReflectable::createInstanceFromTypeId(typeId);
+        if (nullptr == newObject) {
+          GE_LOG(kWarning, Generic, "When applying a patch, unable to create "
+                 "an object of type: {0}.", typeId);
+        }
+
+        objects[objectId] = newObject;
+      }
+    }
+
+    data = records;
+    for (uint32 i = 0; i < header.numObjects; ++i) {
+      const uint32 objectId = readValue<uint32>(data, end);
+      readValue<uint32>(data, end);
+      const uint8 op = readValue<uint8>(data, end);
+      const uint32 size = readValue<uint32>(data, end);
+      const uint8* recordEnd = advance(data, end, size);
+
+      auto iterFind = objects.find(objectId);
+      if (objects.end() == iterFind || nullptr == iterFind->second) {
+        GE_LOG(kWarning, Generic, "When applying a patch, object ID: {0} was "
+               "found but no such object exists in the target.", objectId);
+        data = recordEnd;
+        continue;
+      }
+
+      IReflectable* target = iterFind->second.get();
+      if (PATCH_OBJECT_OP::kFull == op) {
+        applyEntry(target, data, recordEnd, false, alloc, objects, context);
+      }
+      else {
+        applyFieldChanges(target, data, recordEnd, alloc, objects, context);
+      }
+
+      data = recordEnd;
+    }
+
+    alloc.clear();
+  }
+
+  void
+  BinaryBufferDiff::gatherObjectIds(const SPtr<IReflectable>& root,
+                                    FrameAlloc& alloc,
+                                    ObjectIdMap& objects) {
+    UnorderedSet<IReflectable*> visited;
+    Vector<SPtr<IReflectable>> foundObjects;
+
+    visited.insert(root.get());
+    foundObjects.push_back(root);
+
+    //The BinarySerializer assigns IDs to referenced objects in the order it
+    //finds them, and then encodes them in that same order
+    for (SIZE_T i = 0; i < foundObjects.size(); ++i) {
+      gatherReferences(foundObjects[i].get(), alloc, visited, foundObjects);
+    }
+
+    objects.reserve(foundObjects.size());
+    for (SIZE_T i = 0; i < foundObjects.size(); ++i) {
+      objects[static_cast<uint32>(i + 1)] = foundObjects[i];
+    }
+  }
+
+  void
+  BinaryBufferDiff::gatherReferences(IReflectable* object,
+                                     FrameAlloc& alloc,
+                                     UnorderedSet<IReflectable*>& visited,
+                                     Vector<SPtr<IReflectable>>& foundObjects) {
+    auto addReference = [&visited, &foundObjects](const SPtr<IReflectable>& reference) {
+      if (nullptr != reference && visited.insert(reference.get()).second) {
+        foundObjects.push_back(reference);
+      }
+    };
+
+    const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
+    Stack<RTTITypeBase*> rttiInstances;
+    for (const auto& classEntry : plan.classes) {
+      RTTITypeBase* rttiInstance = classEntry.rtti->_getInstance(alloc);
+      rttiInstance->onSerializationStarted(object, nullptr);
+
+      const uint32 lastField = classEntry.firstField + classEntry.numFields;
+      for (uint32 i = classEntry.firstField; i < lastField; ++i) {
+        const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+        RTTIField* field = fieldEntry.field;
+
+        if (SERIALIZABLE_FIELD_TYPE::kReflectablePtr == fieldEntry.type) {
+          auto curField = static_cast<RTTIReflectablePtrFieldBase*>(field);
+
+          if (fieldEntry.isArray) {
+            const uint32 numElements = field->getArraySize(rttiInstance, object);
+            for (uint32 j = 0; j < numElements; ++j) {
+              addReference(curField->getArrayValue(rttiInstance, object, j));
+            }
+          }
+          else {
+            addReference(curField->getValue(rttiInstance, object));
+          }
+        }
+        else if (SERIALIZABLE_FIELD_TYPE::kReflectable == fieldEntry.type) {
+          auto curField = static_cast<RTTIReflectableFieldBase*>(field);
+
+          if (fieldEntry.isArray) {
+            const uint32 numElements = field->getArraySize(rttiInstance, object);
+            for (uint32 j = 0; j < numElements; ++j) {
+              gatherReferences(&curField->getArrayValue(rttiInstance, object, j),
+                               alloc,
+                               visited,
+                               foundObjects);
+            }
+          }
+          else {
+            gatherReferences(&curField->getValue(rttiInstance, object),
+                             alloc,
+                             visited,
+                             foundObjects);
+          }
+        }
+      }
+
+      rttiInstances.push(rttiInstance);
+    }
+
+    while (!rttiInstances.empty()) {
+      RTTITypeBase* rttiInstance = rttiInstances.top();
+      rttiInstances.pop();
+
+      rttiInstance->onSerializationEnded(object, nullptr);
+      RTTITypeBase::_releaseInstance(rttiInstance, alloc);
+    }
+  }
+
+  const uint8*
+  BinaryBufferDiff::applyEntry(IReflectable* object,
+                               const uint8* data,
+                               const uint8* end,
+                               bool embedded,
+                               FrameAlloc& alloc,
+                               const ObjectIdMap& objects,
+                               SerializationContext* context) {
+    uint32 objectId = 0;
+    uint32 typeId = 0;
+    bool isBaseClass = false;
+    readObjectMeta(data, end, objectId, typeId, isBaseClass);
+
+    const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
+
+    FrameVector<RTTITypeBase*> rttiInstances;
+    beginDeserialization(object, plan, alloc, context, rttiInstances);
+
+    int32 classIdx = findClassIndex(plan, typeId);
+    while (data < end) {
+      const uint8* metaStart = data;
+      const uint32 meta = readValue<uint32>(data, end);
+
+      if (isObjectMeta(meta)) {
+        data = metaStart;
+        readObjectMeta(data, end, objectId, typeId, isBaseClass);
+
+        if (!isBaseClass) {
+          GE_EXCEPT(InternalErrorException,
+                    "Error decoding data. Found a new object inside of an "
+                    "object entry.");
+        }
+
+        //Data of base classes the object no longer has is skipped
+        classIdx = findClassIndex(plan, typeId);
+        continue;
+      }
+
+      const FieldMeta fieldMeta = decodeFieldMeta(meta);
+      if (fieldMeta.terminator) {
+        if (!embedded) {
+          GE_EXCEPT(InternalErrorException,
+                    "Error decoding data. Found a terminator field outside "
+                    "of an embedded object.");
+        }
+
+        break;
+      }
+
+      RTTIField* field = nullptr;
+      if (0 <= classIdx) {
+        field = findField(plan.classes[classIdx].rtti, fieldMeta);
+      }
+
+      if (nullptr == field) {
+        data = skipPayload(fieldMeta, data, end);
+        continue;
+      }
+
+      data = applyPayload(field,
+                          rttiInstances[classIdx],
+                          object,
+                          fieldMeta,
+                          data,
+                          end,
+                          alloc,
+                          objects,
+                          context);
+    }
+
+    endDeserialization(object, alloc, context, rttiInstances);
+    return data;
+  }
+
+  void
+  BinaryBufferDiff::applyFieldChanges(IReflectable* object,
+                                      const uint8* data,
+                                      const uint8* end,
+                                      FrameAlloc& alloc,
+                                      const ObjectIdMap& objects,
+                                      SerializationContext* context) {
+    const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
+
+    FrameVector<RTTITypeBase*> rttiInstances;
+    beginDeserialization(object, plan, alloc, context, rttiInstances);
+
+    const uint32 numChanges = readValue<uint32>(data, end);
+    for (uint32 i = 0; i < numChanges; ++i) {
+      const uint32 classTypeId = readValue<uint32>(data, end);
+      const FieldMeta fieldMeta = decodeFieldMeta(readValue<uint32>(data, end));
+      const uint8 op = readValue<uint8>(data, end);
+      const uint32 size = readValue<uint32>(data, end);
+      const uint8* changeEnd = advance(data, end, size);
+
+      const int32 classIdx = findClassIndex(plan, classTypeId);
+
+      RTTIField* field = nullptr;
+      if (0 <= classIdx) {
+        field = findField(plan.classes[classIdx].rtti, fieldMeta);
+      }
+
+      if (nullptr == field) {
+        data = changeEnd;
+        continue;
+      }
+
+      RTTITypeBase* rttiInstance = rttiInstances[classIdx];
+      if (PATCH_FIELD_OP::kReplace == op) {
+        applyPayload(field,
+                     rttiInstance,
+                     object,
+                     fieldMeta,
+                     data,
+                     changeEnd,
+                     alloc,
+                     objects,
+                     context);
+      }
+      else {
+        const uint32 numElements = readValue<uint32>(data, changeEnd);
+        const uint32 numRuns = readValue<uint32>(data, changeEnd);
+
+        field->setArraySize(rttiInstance, object, numElements);
+
+        for (uint32 j = 0; j < numRuns; ++j) {
+          const uint32 first = readValue<uint32>(data, changeEnd);
+          const uint32 count = readValue<uint32>(data, changeEnd);
+
+          for (uint32 k = 0; k < count; ++k) {
+            data = applyValue(field,
+                              rttiInstance,
+                              object,
+                              fieldMeta,
+                              static_cast<int32>(first + k),
+                              data,
+                              changeEnd,
+                              alloc,
+                              objects,
+                              context);
+          }
+        }
+      }
+
+      data = changeEnd;
+    }
+
+    endDeserialization(object, alloc, context, rttiInstances);
+  }
+
+  const uint8*
+  BinaryBufferDiff::applyPayload(RTTIField* field,
+                                 RTTITypeBase* rttiInstance,
+                                 IReflectable* object,
+                                 const FieldMeta& meta,
+                                 const uint8* data,
+                                 const uint8* end,
+                                 FrameAlloc& alloc,
+                                 const ObjectIdMap& objects,
+                                 SerializationContext* context) {
+    if (!meta.isArray) {
+      return applyValue(field,
+                        rttiInstance,
+                        object,
+                        meta,
+                        -1,
+                        data,
+                        end,
+                        alloc,
+                        objects,
+                        context);
+    }
+
+    const uint32 numElements = readValue<uint32>(data, end);
+    field->setArraySize(rttiInstance, object, numElements);
+
+    for (uint32 i = 0; i < numElements; ++i) {
+      data = applyValue(field,
+                        rttiInstance,
+                        object,
+                        meta,
+                        static_cast<int32>(i),
+                        data,
+                        end,
+                        alloc,
+                        objects,
+                        context);
+    }
+
+    return data;
+  }
+
+  const uint8*
+  BinaryBufferDiff::applyValue(RTTIField* field,
+                               RTTITypeBase* rttiInstance,
+                               IReflectable* object,
+                               const FieldMeta& meta,
+                               int32 arrayIdx,
+                               const uint8* data,
+                               const uint8* end,
+                               FrameAlloc& alloc,
+                               const ObjectIdMap& objects,
+                               SerializationContext* context) {
+    const bool isArrayElement = 0 <= arrayIdx;
+    const auto index = static_cast<uint32>(arrayIdx);
+
+    switch (meta.type)
+    {
+      case SERIALIZABLE_FIELD_TYPE::kPlain:
+      {
+        auto curField = static_cast<RTTIPlainFieldBase*>(field);
+
+        SIZE_T typeSize = meta.size;
+        if (meta.hasDynamicSize) {
+          const uint8* sizeData = data;
+          typeSize = readValue<uint32>(sizeData, end);
+        }
+
+        const uint8* valueEnd = advance(data, end, typeSize);
+
+        //Fields only read from the buffer, so it's decoded in place
+        auto value = const_cast<uint8*>(data);
+        if (isArrayElement) {
+          curField->arrayElemFromBuffer(rttiInstance, object, index, value);
+        }
+        else {
+          curField->fromBuffer(rttiInstance, object, value);
+        }
+
+        return valueEnd;
+      }
+      case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
+      {
+        auto curField = static_cast<RTTIReflectablePtrFieldBase*>(field);
+
+        const uint32 objectId = readValue<uint32>(data, end);
+
+        SPtr<IReflectable> value;
+        if (0 != objectId) {
+          auto iterFind = objects.find(objectId);
+          if (objects.end() != iterFind) {
+            value = iterFind->second;
+          }
+          else {
+            GE_LOG(kWarning, Generic, "When applying a patch, object ID: {0} "
+                   "was referenced but no such object exists in the target.",
+                   objectId);
+          }
+        }
+
+        if (isArrayElement) {
+          curField->setArrayValue(rttiInstance, object, index, value);
+        }
+        else {
+          curField->setValue(rttiInstance, object, value);
+        }
+
+        return data;
+      }
+      case SERIALIZABLE_FIELD_TYPE::kReflectable:
+      {
+        auto curField = static_cast<RTTIReflectableFieldBase*>(field);
+
+        SPtr<IReflectable> value = curField->newObject();
+        data = applyEntry(value.get(), data, end, true, alloc, objects, context);
+
+        if (isArrayElement) {
+          curField->setArrayValue(rttiInstance, object, index, *value);
+        }
+        else {
+          curField->setValue(rttiInstance, object, *value);
+        }
+
+        return data;
+      }
+      case SERIALIZABLE_FIELD_TYPE::kDataBlock:
+      {
+        auto curField = static_cast<RTTIManagedDataBlockFieldBase*>(field);
+
+        const uint32 dataBlockSize = readValue<uint32>(data, end);
+        const uint8* dataBlockEnd = advance(data, end, dataBlockSize);
+
+        auto dataBlockBuffer = reinterpret_cast<uint8*>(ge_alloc(dataBlockSize));
+        memcpy(dataBlockBuffer, data, dataBlockSize);
+
+        SPtr<DataStream> stream =
+          ge_shared_ptr_new<MemoryDataStream>(dataBlockBuffer, dataBlockSize);
+        curField->setValue(rttiInstance, object, stream, dataBlockSize);
+
+        return dataBlockEnd;
+      }
+      default:
+        GE_EXCEPT(InternalErrorException,
+                  "Error decoding data. Encountered a type I don't know how "
+                  "to decode. Type: " + toString(uint32(meta.type)));
+        return end;
+    }
+  }
+
+  RTTIField*
+  BinaryBufferDiff::findField(RTTITypeBase* rtti, const FieldMeta& meta) {
+    RTTIField* field = rtti->findField(meta.id);
+    if (nullptr == field) {
+      return nullptr;
+    }
+
+    //References point into the encoded data the patch was generated from
+    if (meta.hasReferences) {
+      GE_EXCEPT(InternalErrorException,
+                "Can't apply a patch generated from deduplicated data.");
+      return nullptr;
+    }
+
+    if (!meta.hasDynamicSize && field->getTypeSize() != meta.size) {
+      GE_EXCEPT(InternalErrorException,
+                "Data type mismatch. Type size stored in file and actual "
+                "type size don't match. (" + toString(field->getTypeSize()) +
+                " vs. " + toString(meta.size) + ")");
+    }
+
+    if (field->m_isVectorType != meta.isArray) {
+      GE_EXCEPT(InternalErrorException,
+                "Data type mismatch. One is array, other is a single type.");
+    }
+
+    if (field->m_type != meta.type) {
+      GE_EXCEPT(InternalErrorException,
+                "Data type mismatch. Field types don't match. " +
+                toString(uint32(field->m_type)) + " vs. " +
+                toString(uint32(meta.type)));
+    }
+
+    return field;
+  }
+
+  BinaryBufferDiff::FieldMeta
+  BinaryBufferDiff::decodeFieldMeta(uint32 meta) {
+    FieldMeta output;
+    BinarySerializer::decodeFieldMetaData(meta,
+                                          output.id,
+                                          output.size,
+                                          output.isArray,
+                                          output.type,
+                                          output.hasDynamicSize,
+                                          output.terminator,
+                                          output.hasReferences);
+    return output;
+  }
+
+  bool
+  BinaryBufferDiff::isObjectMeta(uint32 meta) {
+    return BinarySerializer::isObjectMetaData(meta);
+  }
+
+  void
+  BinaryBufferDiff::readObjectMeta(const uint8*& data,
+                                   const uint8* end,
+                                   uint32& objectId,
+                                   uint32& typeId,
+                                   bool& isBaseClass) {
+    const auto objectMeta = readValue<BinarySerializer::ObjectMetaData>(data, end);
+    BinarySerializer::decodeObjectMetaData(objectMeta, objectId, typeId, isBaseClass);
+  }
+
+  const uint8*
+  BinaryBufferDiff::skipEntry(const uint8* data, const uint8* end) {
+    uint32 objectId = 0;
+    uint32 typeId = 0;
+    bool isBaseClass = false;
+    readObjectMeta(data, end, objectId, typeId, isBaseClass);
+
+    while (true) {
+      const uint8* metaStart = data;
+      const uint32 meta = readValue<uint32>(data, end);
+
+      if (isObjectMeta(meta)) {
+        data = metaStart;
+        readObjectMeta(data, end, objectId, typeId, isBaseClass);
+
+        if (!isBaseClass) {
+          GE_EXCEPT(InternalErrorException,
+                    "Error decoding data. Found a new object inside of an "
+                    "embedded object.");
+          return end;
+        }
+
+        continue;
+      }
+
+      const FieldMeta fieldMeta = decodeFieldMeta(meta);
+      if (fieldMeta.terminator) {
+        return data;
+      }
+
+      data = skipPayload(fieldMeta, data, end);
+    }
+  }
+
+  const uint8*
+  BinaryBufferDiff::skipPayload(const FieldMeta& meta, const uint8* data, const uint8* end) {
+    if (!meta.isArray) {
+      return skipValue(meta, data, end);
+    }
+
+    const uint32 numElements = readValue<uint32>(data, end);
+
+    if (SERIALIZABLE_FIELD_TYPE::kReflectablePtr == meta.type) {
+      return advance(data, end, static_cast<SIZE_T>(numElements) * sizeof(uint32));
+    }
+
+    if (SERIALIZABLE_FIELD_TYPE::kPlain == meta.type && !meta.hasDynamicSize) {
+      return advance(data, end, static_cast<SIZE_T>(numElements) * meta.size);
+    }
+
+    for (uint32 i = 0; i < numElements; ++i) {
+      data = skipValue(meta, data, end);
+    }
+
+    return data;
+  }
+
+  const uint8*
+  BinaryBufferDiff::skipValue(const FieldMeta& meta, const uint8* data, const uint8* end) {
+    //Deduplicated values only follow their reference if it's not set
+    if (meta.hasReferences && 0 != readValue<uint32>(data, end)) {
+      return data;
+    }
+
+    switch (meta.type)
+    {
+      case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
+        return advance(data, end, sizeof(uint32));
+      case SERIALIZABLE_FIELD_TYPE::kReflectable:
+        return skipEntry(data, end);
+      case SERIALIZABLE_FIELD_TYPE::kPlain:
+      {
+        SIZE_T typeSize = meta.size;
+        if (meta.hasDynamicSize) {
+          const uint8* sizeData = data;
+          typeSize = readValue<uint32>(sizeData, end);
+        }
+
+        return advance(data, end, typeSize);
+      }
+      case SERIALIZABLE_FIELD_TYPE::kDataBlock:
+      {
+        const uint32 dataBlockSize = readValue<uint32>(data, end);
+        return advance(data, end, dataBlockSize);
+      }
+      default:
+        GE_EXCEPT(InternalErrorException,
+                  "Error decoding data. Encountered a type I don't know how "
+                  "to decode. Type: " + toString(uint32(meta.type)));
+        return end;
+    }
+  }
+
+  void
+  BinaryDiffBaseline::setBaseline(IReflectable& object) {
+    BinaryBufferDiff::encode(object, m_data, m_shallow);
+    BinaryBufferDiff::buildIndex(m_data.data(),
+                                 static_cast<uint32>(m_data.size()),
+                                 m_index);
+  }
+
+  bool
+  BinaryDiffBaseline::generateDiff(IReflectable& object,
+                                   Vector<uint8>& patch,
+                                   bool updateBaseline) {
+    BinaryBufferDiff::encode(object, m_scratchData, m_shallow);
+    BinaryBufferDiff::buildIndex(m_scratchData.data(),
+                                 static_cast<uint32>(m_scratchData.size()),
+                                 m_scratchIndex);
+
+    const bool hasChanges = BinaryBufferDiff::generateDiff(m_index, m_scratchIndex, patch);
+
+    //Swapping keeps the indexed memory in place, so the index stays valid
+    if (updateBaseline) {
+      std::swap(m_data, m_scratchData);
+      std::swap(m_index, m_scratchIndex);
+    }
+
+    return hasChanges;
+  }
+}
@@ -26,6 +26,7 @@
 #include "geRTTIReflectablePtrField.h"
 #include "geRTTIManagedDataBlockField.h"
 #include "geMemorySerializer.h"
+#include "geDataStream.h"
 
 namespace geEngineSDK {
   using std::function;
@@ -36,6 +37,11 @@ namespace geEngineSDK {
       return nullptr;
     }
 
+    SPtr<IReflectable> directClone = cloneDirect(object, shallow);
+    if (nullptr != directClone) {
+      return directClone;
+    }
+
     ObjectReferenceData referenceData;
     if (shallow) {
       FrameAlloc& alloc = g_frameAlloc();
@@ -66,6 +72,203 @@ namespace geEngineSDK {
     return clonedObj;
   }
 
+  SPtr<IReflectable>
+  BinaryCloner::cloneDirect(IReflectable* object, bool shallow) {
+    RTTITypeBase* rtti = object->getRTTI();
+    SPtr<IReflectable> clonedObj = rtti->newRTTIObject();
+
+    FrameAlloc& alloc = g_frameAlloc();
+
+    //The root can be referenced from within its own graph as well
+    CloneMap clonedObjects;
+    clonedObjects[object] = clonedObj;
+
+    alloc.markFrame();
+    const bool success = copyFields(object,
+                                    clonedObj.get(),
+                                    shallow,
+                                    alloc,
+                                    clonedObjects);
+    alloc.clear();
+
+    if (!success) {
+      return nullptr;
+    }
+
+    return clonedObj;
+  }
+
+  SPtr<IReflectable>
+  BinaryCloner::cloneReference(const SPtr<IReflectable>& object,
+                               FrameAlloc& alloc,
+                               CloneMap& clonedObjects) {
+    auto iterFind = clonedObjects.find(object.get());
+    if (clonedObjects.end() != iterFind) {
+      return iterFind->second;
+    }
+
+    SPtr<IReflectable> clonedObj = object->getRTTI()->newRTTIObject();
+
+    //Register the clone before copying the fields so circular references
+    //resolve to it instead of recursing forever
+    clonedObjects[object.get()] = clonedObj;
+
+    if (!copyFields(object.get(), clonedObj.get(), false, alloc, clonedObjects)) {
+      return nullptr;
+    }
+
+    return clonedObj;
+  }
+
+  bool
+  BinaryCloner::copyFields(IReflectable* src,
+                           IReflectable* dst,
+                           bool shallow,
+                           FrameAlloc& alloc,
+                           CloneMap& clonedObjects) {
+    const RTTISerializationPlan& plan = src->getRTTI()->getSerializationPlan();
+    if (plan.hasSerializationCallbacks) {
+      return false;
+    }
+
+    bool success = true;
+    for (const auto& classEntry : plan.classes) {
+      RTTITypeBase* srcInstance = classEntry.rtti->_getInstance(alloc);
+      RTTITypeBase* dstInstance = classEntry.rtti->_getInstance(alloc);
+
+      const uint32 lastField = classEntry.firstField + classEntry.numFields;
+      for (uint32 i = classEntry.firstField; i < lastField && success; ++i) {
+        const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+        RTTIField* field = fieldEntry.field;
+
+        switch (fieldEntry.type) {
+          case SERIALIZABLE_FIELD_TYPE::kPlain:
+          {
+            auto curField = static_cast<RTTIPlainFieldBase*>(field);
+
+            if (fieldEntry.isArray) {
+              curField->copyArray(srcInstance, src, dstInstance, dst);
+            }
+            else {
+              curField->copyValue(srcInstance, src, dstInstance, dst);
+            }
+            break;
+          }
+
+          case SERIALIZABLE_FIELD_TYPE::kDataBlock:
+          {
+            auto curField = static_cast<RTTIManagedDataBlockFieldBase*>(field);
+
+            uint32 dataBlockSize = 0;
+            SPtr<DataStream> blockStream = curField->getValue(srcInstance,
+                                                              src,
+                                                              dataBlockSize);
+
+            auto dataCopy = ge_shared_ptr_new<MemoryDataStream>(dataBlockSize);
+            blockStream->read(dataCopy->getPtr(), dataBlockSize);
+
+            curField->setValue(dstInstance, dst, dataCopy, dataBlockSize);
+            break;
+          }
+
+          case SERIALIZABLE_FIELD_TYPE::kReflectable:
+          {
+            auto curField = static_cast<RTTIReflectableFieldBase*>(field);
+
+            auto copyChild = [&](IReflectable& childObj) -> SPtr<IReflectable> {
+              SPtr<IReflectable> clonedChild = childObj.getRTTI()->newRTTIObject();
+              if (!copyFields(&childObj, clonedChild.get(), shallow, alloc, clonedObjects)) {
+                return nullptr;
+              }
+              return clonedChild;
+            };
+
+            if (fieldEntry.isArray) {
+              const uint32 numElements = curField->getArraySize(srcInstance, src);
+              curField->setArraySize(dstInstance, dst, numElements);
+
+              for (uint32 j = 0; j < numElements && success; ++j) {
+                SPtr<IReflectable> clonedChild =
+                  copyChild(curField->getArrayValue(srcInstance, src, j));
+                success = nullptr != clonedChild;
+
+                if (success) {
+                  curField->setArrayValue(dstInstance, dst, j, *clonedChild);
+                }
+              }
+            }
+            else {
+              SPtr<IReflectable> clonedChild =
+                copyChild(curField->getValue(srcInstance, src));
+              success = nullptr != clonedChild;
+
+              if (success) {
+                curField->setValue(dstInstance, dst, *clonedChild);
+              }
+            }
+            break;
+          }
+
+          case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
+          {
+            auto curField = static_cast<RTTIReflectablePtrFieldBase*>(field);
+
+            auto remap = [&](const SPtr<IReflectable>& childObj) -> SPtr<IReflectable> {
+              if (nullptr == childObj || shallow) {
+                return childObj;
+              }
+
+              SPtr<IReflectable> clonedChild = cloneReference(childObj,
+                                                              alloc,
+                                                              clonedObjects);
+              success = nullptr != clonedChild;
+              return clonedChild;
+            };
+
+            if (fieldEntry.isArray) {
+              const uint32 numElements = curField->getArraySize(srcInstance, src);
+              curField->setArraySize(dstInstance, dst, numElements);
+
+              for (uint32 j = 0; j < numElements && success; ++j) {
+                SPtr<IReflectable> childObj =
+                  remap(curField->getArrayValue(srcInstance, src, j));
+
+                if (success) {
+                  curField->setArrayValue(dstInstance, dst, j, childObj);
+                }
+              }
+            }
+            else {
+              SPtr<IReflectable> childObj = remap(curField->getValue(srcInstance, src));
+
+              if (success) {
+                curField->setValue(dstInstance, dst, childObj);
+              }
+            }
+            break;
+          }
+
+          default:
+            GE_EXCEPT(InternalErrorException,
+                      "Error cloning data. Encountered a type I don't know "
+                      "how to clone. Type: " +
+                      toString(uint32(field->m_type)) +
+                      ", Is array: " +
+                      toString(field->m_isVectorType));
+        }
+      }
+
+      RTTITypeBase::_releaseInstance(dstInstance, alloc);
+      RTTITypeBase::_releaseInstance(srcInstance, alloc);
+
+      if (!success) {
+        break;
+      }
+    }
+
+    return success;
+  }
+
   void
   BinaryCloner::gatherReferences(IReflectable* object,
                                  FrameAlloc& alloc,
@@ -74,21 +277,23 @@ namespace geEngineSDK {
       return;
     }
 
-    RTTITypeBase* rtti = object->getRTTI();
+    const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
     Stack<RTTITypeBase*> rttiInstances;
-    while (nullptr != rtti) {
-      RTTITypeBase* rttiInstance = rtti->_clone(alloc);
+    for (const auto& classEntry : plan.classes) {
+      RTTITypeBase* rtti = classEntry.rtti;
+      RTTITypeBase* rttiInstance = rtti->_getInstance(alloc);
       rttiInstance->onSerializationStarted(object, nullptr);
       SubObjectReferenceData* subObjectData = nullptr;
 
-      uint32 numFields = rtti->getNumFields();
-      for (uint32 i = 0; i < numFields; ++i) {
-        RTTIField* field = rtti->getField(i);
+      const uint32 lastField = classEntry.firstField + classEntry.numFields;
+      for (uint32 i = classEntry.firstField; i < lastField; ++i) {
+        const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+        RTTIField* field = fieldEntry.field;
         FieldId fieldId;
         fieldId.field = field;
         fieldId.arrayIdx = -1;
 
-        if (field->isArray()) {
+        if (fieldEntry.isArray) {
           uint32 numElements = field->getArraySize(rttiInstance, object);
 
           for (uint32 j = 0; j < numElements; ++j) {
@@ -171,7 +376,6 @@ namespace geEngineSDK {
       }
 
       rttiInstances.push(rttiInstance);
-      rtti = rtti->getBaseClass();
     }
 
     while (!rttiInstances.empty()) {
@@ -179,7 +383,7 @@ namespace geEngineSDK {
       rttiInstances.pop();
 
       rttiInstance->onSerializationEnded(object, nullptr);
-      alloc.destruct(rttiInstance);
+      RTTITypeBase::_releaseInstance(rttiInstance, alloc);
     }
   }
 
@@ -193,7 +397,7 @@ namespace geEngineSDK {
       const SubObjectReferenceData& subObject = *iter;
 
       if (!subObject.references.empty()) {
-        RTTITypeBase* rttiInstance = subObject.rtti->_clone(alloc);
+        RTTITypeBase* rttiInstance = subObject.rtti->_getInstance(alloc);
         rttiInstance->onDeserializationStarted(object, nullptr);
 
         for (auto& reference : subObject.references) {
@@ -211,13 +415,13 @@ namespace geEngineSDK {
         }
 
         rttiInstance->onDeserializationEnded(object, nullptr);
-        alloc.destruct(rttiInstance);
+        RTTITypeBase::_releaseInstance(rttiInstance, alloc);
       }
     }
 
     for (auto& subObject : referenceData.subObjectData) {
       if (!subObject.children.empty()) {
-        RTTITypeBase* rttiInstance = subObject.rtti->_clone(alloc);
+        RTTITypeBase* rttiInstance = subObject.rtti->_getInstance(alloc);
         rttiInstance->onSerializationStarted(object, nullptr);
 
         for (auto& childObjectData : subObject.children) {
@@ -238,7 +442,7 @@ namespace geEngineSDK {
         }
 
         rttiInstance->onSerializationEnded(object, nullptr);
-        alloc.destruct(rttiInstance);
+        RTTITypeBase::_releaseInstance(rttiInstance, alloc);
       }
     }
   }
@@ -21,6 +21,8 @@
 #include "geBinaryCompare.h"
 #include "geRTTIType.h"
 #include "geDataStream.h"
+#include "geMath.h"
+#include "geNumericLimits.h"
 
 namespace geEngineSDK {
   namespace impl {
@@ -39,6 +41,401 @@ namespace geEngineSDK {
     make_scope_guard(T callback) {
       return ScopeGuard<T>{callback};
     }
+
+    /**
+     * Size of the chunks data blocks are read in when they aren't held in
+     * memory.
+     */
+    static CONSTEXPR uint32 kStreamChunkSize = 4096;
+
+    /**
+     * @brief Returns the next @p size bytes of the stream if it holds them in
+     *        memory, or null if they need to be read.
+     */
+    static const uint8*
+    getStreamBytes(DataStream& stream, uint32 size) {
+      if (stream.isFile()) {
+        return nullptr;
+      }
+
+      auto memStream = dynamic_cast<MemoryDataStream*>(&stream);
+      if (nullptr == memStream || memStream->size() - memStream->tell() < size) {
+        return nullptr;
+      }
+
+      return memStream->getCurrentPtr();
+    }
+
+    /**
+     * @brief Checks if the next @p size bytes of both streams are equal,
+     *        without copying the ones that are held in memory.
+     */
+    static bool
+    compareStreams(DataStream& streamA, DataStream& streamB, uint32 size) {
+      const uint8* bytesA = getStreamBytes(streamA, size);
+      const uint8* bytesB = getStreamBytes(streamB, size);
+      if (nullptr != bytesA && nullptr != bytesB) {
+        return 0 == memcmp(bytesA, bytesB, size);
+      }
+
+      uint8 chunkA[kStreamChunkSize];
+      uint8 chunkB[kStreamChunkSize];
+      for (uint32 offset = 0; offset < size; offset += kStreamChunkSize) {
+        const uint32 chunkSize = Math::min(kStreamChunkSize, size - offset);
+        streamA.read(chunkA, chunkSize);
+        streamB.read(chunkB, chunkSize);
+
+        if (0 != memcmp(chunkA, chunkB, chunkSize)) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Streaming 128-bit hash, built from two independent lanes of the
+     *        xxHash64 round function.
+     */
+    class FingerprintHasher
+    {
+     public:
+      void
+      update(const void* data, SIZE_T size) {
+        auto bytes = static_cast<const uint8*>(data);
+        m_totalSize += size;
+
+        if (0 != m_bufferSize) {
+          const SIZE_T toCopy = Math::min<SIZE_T>(kBlockSize - m_bufferSize, size);
+          memcpy(m_buffer + m_bufferSize, bytes, toCopy);
+          m_bufferSize += static_cast<uint32>(toCopy);
+          bytes += toCopy;
+          size -= toCopy;
+
+          if (kBlockSize != m_bufferSize) {
+            return;
+          }
+
+          processBlock(m_buffer);
+          m_bufferSize = 0;
+        }
+
+        for (; size >= kBlockSize; size -= kBlockSize, bytes += kBlockSize) {
+          processBlock(bytes);
+        }
+
+        memcpy(m_buffer, bytes, size);
+        m_bufferSize = static_cast<uint32>(size);
+      }
+
+      template<class T>
+      void
+      updateValue(const T& value) {
+        update(&value, sizeof(T));
+      }
+
+      ObjectFingerprint
+      finish() {
+        if (0 != m_bufferSize) {
+          memset(m_buffer + m_bufferSize, 0, kBlockSize - m_bufferSize);
+          processBlock(m_buffer);
+          m_bufferSize = 0;
+        }
+
+        ObjectFingerprint output;
+        output.low = avalanche(m_lanes[0] + rotl(m_lanes[1], 27) + m_totalSize);
+        output.high = avalanche(m_lanes[1] ^ (rotl(m_lanes[0], 33) + m_totalSize * kPrime3));
+        return output;
+      }
+
+     private:
+      static CONSTEXPR uint32 kBlockSize = 16;
+      static CONSTEXPR uint64 kPrime1 = 0x9E3779B185EBCA87ULL;
+      static CONSTEXPR uint64 kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+      static CONSTEXPR uint64 kPrime3 = 0x165667B19E3779F9ULL;
+
+      static uint64
+      rotl(uint64 value, uint32 bits) {
+        return (value << bits) | (value >> (64 - bits));
+      }
+
+      static uint64
+      round(uint64 acc, uint64 input) {
+        acc += input * kPrime2;
+        acc = rotl(acc, 31);
+        return acc * kPrime1;
+      }
+
+      static uint64
+      avalanche(uint64 value) {
+        value ^= value >> 33;
+        value *= kPrime2;
+        value ^= value >> 29;
+        value *= kPrime3;
+        value ^= value >> 32;
+        return value;
+      }
+
+      void
+      processBlock(const uint8* block) {
+        uint64 input[2];
+        memcpy(input, block, sizeof(input));
+        m_lanes[0] = round(m_lanes[0], input[0]);
+        m_lanes[1] = round(m_lanes[1], input[1]);
+      }
+
+      uint64 m_lanes[2] = { kPrime1 + kPrime2, kPrime2 ^ kPrime3 };
+      uint64 m_totalSize = 0;
+      uint8 m_buffer[kBlockSize];
+      uint32 m_bufferSize = 0;
+    };
+
+    /**
+     * @brief Walks an object graph computing the fingerprints of the objects
+     *        in it.
+     */
+    class FingerprintWalker
+    {
+     public:
+      FingerprintWalker(FingerprintCache* cache, uint64 version, FrameAlloc& alloc)
+        : m_cache(cache),
+          m_version(version),
+          m_alloc(alloc)
+      {}
+
+      /**
+       * @brief Computes the fingerprint of an object referenced by pointer.
+       * @param[out] lowLink  Depth of the shallowest object still being
+       *             walked that the object, or any object it references,
+       *             points back to. MAX_UINT32 if there is none.
+       */
+      ObjectFingerprint
+      hashObject(IReflectable& object, uint32& lowLink) {
+        lowLink = NumLimit::MAX_UINT32;
+
+        auto iterFound = m_computed.find(&object);
+        if (m_computed.end() != iterFound) {
+          return iterFound->second;
+        }
+
+        ObjectFingerprint fingerprint;
+        if (nullptr != m_cache && m_cache->find(&object, m_version, fingerprint)) {
+          return fingerprint;
+        }
+
+        const uint32 depth = static_cast<uint32>(m_inProgress.size());
+        m_inProgress[&object] = depth;
+
+        FingerprintHasher hasher;
+        uint32 objectLowLink = NumLimit::MAX_UINT32;
+        hashFields(object, depth, hasher, objectLowLink);
+
+        m_inProgress.erase(&object);
+        fingerprint = hasher.finish();
+
+        //Only remember the fingerprint if it doesn't depend on which object
+        //the walk started from
+        if (objectLowLink >= depth) {
+          m_computed[&object] = fingerprint;
+          if (nullptr != m_cache) {
+            m_cache->store(&object, m_version, fingerprint);
+          }
+        }
+        else {
+          lowLink = objectLowLink;
+        }
+
+        return fingerprint;
+      }
+
+     private:
+      static CONSTEXPR uint32 kNullMarker = 0x4C4C554E;
+      static CONSTEXPR uint32 kCycleMarker = 0x45435943;
+      static CONSTEXPR uint32 kEmbeddedMarker = 0x44424D45;
+
+      /**
+       * @brief Hashes the fields of all the classes in the hierarchy of
+       *        @p object.
+       * @param[in] depth Depth of the referenced object being hashed, which
+       *            is @p object itself or the object that embeds it.
+       */
+      void
+      hashFields(IReflectable& object,
+                 uint32 depth,
+                 FingerprintHasher& hasher,
+                 uint32& lowLink) {
+        const RTTISerializationPlan& plan = object.getRTTI()->getSerializationPlan();
+
+        FrameVector<RTTITypeBase*> rttiInstances;
+        rttiInstances.reserve(plan.classes.size());
+        auto cleanup = make_scope_guard([&]() {
+          for (auto iter = rttiInstances.rbegin(); iter != rttiInstances.rend(); ++iter) {
+            (*iter)->onSerializationEnded(&object, nullptr);
+            RTTITypeBase::_releaseInstance(*iter, m_alloc);
+          }
+        });
+
+        for (const auto& classEntry : plan.classes) {
+          RTTITypeBase* rttiInstance = classEntry.rtti->_getInstance(m_alloc);
+          rttiInstances.push_back(rttiInstance);
+          rttiInstance->onSerializationStarted(&object, nullptr);
+
+          hasher.updateValue(classEntry.rttiId);
+
+          const uint32 lastField = classEntry.firstField + classEntry.numFields;
+          for (uint32 i = classEntry.firstField; i < lastField; ++i) {
+            const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+            hasher.updateValue(fieldEntry.uniqueId);
+            hashField(fieldEntry, rttiInstance, object, depth, hasher, lowLink);
+          }
+        }
+      }
+
+      void
+      hashField(const RTTISerializationPlan::FieldEntry& fieldEntry,
+                RTTITypeBase* rttiInstance,
+                IReflectable& object,
+                uint32 depth,
+                FingerprintHasher& hasher,
+                uint32& lowLink) {
+        RTTIField* field = fieldEntry.field;
+
+        uint32 numElements = 1;
+        if (fieldEntry.isArray) {
+          numElements = field->getArraySize(rttiInstance, &object);
+          hasher.updateValue(numElements);
+        }
+
+        switch (fieldEntry.type)
+        {
+          case SERIALIZABLE_FIELD_TYPE::kPlain:
+          {
+            auto curField = static_cast<RTTIPlainFieldBase*>(field);
+
+            if (fieldEntry.isArray) {
+              const uint8* bytes = curField->getArrayBytes(rttiInstance, &object, numElements);
+              if (nullptr != bytes) {
+                hasher.update(bytes, SIZE_T(fieldEntry.typeSize) * numElements);
+                break;
+              }
+            }
+
+            for (uint32 arrIdx = 0; arrIdx < numElements; ++arrIdx) {
+              uint32 typeSize = fieldEntry.typeSize;
+              if (fieldEntry.hasDynamicSize) {
+                typeSize = fieldEntry.isArray ?
+                  curField->getArrayElemDynamicSize(rttiInstance, &object, arrIdx) :
+                  curField->getDynamicSize(rttiInstance, &object);
+                hasher.updateValue(typeSize);
+              }
+
+              auto data = ge_managed_stack_alloc(typeSize);
+              if (fieldEntry.isArray) {
+                curField->arrayElemToBuffer(rttiInstance, &object, arrIdx, data);
+              }
+              else {
+                curField->toBuffer(rttiInstance, &object, data);
+              }
+
+              hasher.update(data, typeSize);
+            }
+
+            break;
+          }
+
+          case SERIALIZABLE_FIELD_TYPE::kDataBlock:
+          {
+            auto curField = static_cast<RTTIManagedDataBlockFieldBase*>(field);
+
+            uint32 dataBlockSize = 0;
+            SPtr<DataStream> blockStream = curField->getValue(rttiInstance,
+                                                              &object,
+                                                              dataBlockSize);
+            hasher.updateValue(dataBlockSize);
+
+            const uint8* bytes = getStreamBytes(*blockStream, dataBlockSize);
+            if (nullptr != bytes) {
+              hasher.update(bytes, dataBlockSize);
+              break;
+            }
+
+            uint8 chunk[kStreamChunkSize];
+            for (uint32 offset = 0; offset < dataBlockSize; offset += kStreamChunkSize) {
+              const uint32 chunkSize = Math::min(kStreamChunkSize, dataBlockSize - offset);
+              blockStream->read(chunk, chunkSize);
+              hasher.update(chunk, chunkSize);
+            }
+
+            break;
+          }
+
+          case SERIALIZABLE_FIELD_TYPE::kReflectable:
+          {
+            auto curField = static_cast<RTTIReflectableFieldBase*>(field);
+
+            for (uint32 arrIdx = 0; arrIdx < numElements; ++arrIdx) {
+              IReflectable& childObject = fieldEntry.isArray ?
+                curField->getArrayValue(rttiInstance, &object, arrIdx) :
+                curField->getValue(rttiInstance, &object);
+
+              hasher.updateValue(kEmbeddedMarker);
+              hashFields(childObject, depth, hasher, lowLink);
+            }
+
+            break;
+          }
+
+          case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
+          {
+            auto curField = static_cast<RTTIReflectablePtrFieldBase*>(field);
+
+            for (uint32 arrIdx = 0; arrIdx < numElements; ++arrIdx) {
+              SPtr<IReflectable> childObject = fieldEntry.isArray ?
+                curField->getArrayValue(rttiInstance, &object, arrIdx) :
+                curField->getValue(rttiInstance, &object);
+
+              if (nullptr == childObject) {
+                hasher.updateValue(kNullMarker);
+                continue;
+              }
+
+              //References back into the objects being walked are hashed by
+              //their distance, as their fingerprint isn't known yet
+              auto iterInProgress = m_inProgress.find(childObject.get());
+              if (m_inProgress.end() != iterInProgress) {
+                hasher.updateValue(kCycleMarker);
+                hasher.updateValue(depth - iterInProgress->second);
+                lowLink = Math::min(lowLink, iterInProgress->second);
+                continue;
+              }
+
+              uint32 childLowLink = NumLimit::MAX_UINT32;
+              ObjectFingerprint childFingerprint = hashObject(*childObject, childLowLink);
+              lowLink = Math::min(lowLink, childLowLink);
+
+              hasher.updateValue(childFingerprint.low);
+              hasher.updateValue(childFingerprint.high);
+            }
+
+            break;
+          }
+
+          default:
+            GE_EXCEPT(InternalErrorException,
+                      "Error encoding data. Encountered a type I don't "
+                      "know how to encode. Type: " +
+                      toString(uint32(fieldEntry.type)) +
+                      ", Is array: " +
+                      toString(fieldEntry.isArray));
+        }
+      }
+
+      FingerprintCache* m_cache;
+      uint64 m_version;
+      FrameAlloc& m_alloc;
+      UnorderedMap<IReflectable*, uint32> m_inProgress;
+      UnorderedMap<IReflectable*, ObjectFingerprint> m_computed;
+    };
   }
 
   BinaryCompare::BinaryCompare()
@@ -47,6 +444,11 @@ namespace geEngineSDK {
 
   bool
   BinaryCompare::run(IReflectable& a, IReflectable& b) {
+    bool equal = false;
+    if (findFingerprints(a, b, equal)) {
+      return equal;
+    }
+
     m_alloc->markFrame();
     bool output = compare(a, b);
     m_objectMap.clear();
@@ -55,6 +457,56 @@ namespace geEngineSDK {
     return output;
   }
 
+  bool
+  BinaryCompare::findFingerprints(IReflectable& a,
+                                  IReflectable& b,
+                                  bool& equal) const {
+    if (nullptr == m_fingerprintCache) {
+      return false;
+    }
+
+    ObjectFingerprint fingerprintA;
+    ObjectFingerprint fingerprintB;
+    if (!m_fingerprintCache->find(&a, m_fingerprintVersion, fingerprintA) ||
+        !m_fingerprintCache->find(&b, m_fingerprintVersion, fingerprintB)) {
+      return false;
+    }
+
+    equal = fingerprintA == fingerprintB;
+    return true;
+  }
+
+  bool
+  BinaryCompare::compareChild(IReflectable& a, IReflectable& b) {
+    RTTITypeBase* childRtti = a.getRTTI();
+    if (b.getRTTI() != childRtti) {
+      return false;
+    }
+
+    bool equal = false;
+    if (findFingerprints(a, b, equal)) {
+      return equal;
+    }
+
+    ICompare& handler = childRtti->getCompareHandler();
+    auto binaryHandler = dynamic_cast<BinaryCompare*>(&handler);
+    if (nullptr == m_fingerprintCache ||
+        nullptr == binaryHandler ||
+        this == binaryHandler) {
+      return handler.run(a, b);
+    }
+
+    //Let the handler skip the unchanged objects deeper in the hierarchy too
+    FingerprintCache* prevCache = binaryHandler->m_fingerprintCache;
+    uint64 prevVersion = binaryHandler->m_fingerprintVersion;
+    binaryHandler->setFingerprintCache(m_fingerprintCache, m_fingerprintVersion);
+
+    bool output = handler.run(a, b);
+    binaryHandler->setFingerprintCache(prevCache, prevVersion);
+
+    return output;
+  }
+
   bool
   BinaryCompare::compare(IReflectable& a, IReflectable& b) {
     RTTITypeBase* rtti = a.getRTTI();
@@ -75,8 +527,8 @@ namespace geEngineSDK {
         RTTIPair rttiPair = rttiInstances.top();
         rttiPair.rttiA->onSerializationEnded(&a, m_context);
         rttiPair.rttiB->onSerializationEnded(&b, m_context);
-        m_alloc->destruct(rttiPair.rttiA);
-        m_alloc->destruct(rttiPair.rttiB);
+        RTTITypeBase::_releaseInstance(rttiPair.rttiA, *m_alloc);
+        RTTITypeBase::_releaseInstance(rttiPair.rttiB, *m_alloc);
 
         rttiInstances.pop();
       }
@@ -84,8 +536,8 @@ namespace geEngineSDK {
 
     //If an object has base classes, we need to iterate through all of them
     do {
-      RTTITypeBase* rttiInstanceA = rtti->_clone(*m_alloc);
-      RTTITypeBase* rttiInstanceB = rtti->_clone(*m_alloc);
+      RTTITypeBase* rttiInstanceA = rtti->_getInstance(*m_alloc);
+      RTTITypeBase* rttiInstanceB = rtti->_getInstance(*m_alloc);
       rttiInstances.push({ rttiInstanceA, rttiInstanceB });
 
       rttiInstanceA->onSerializationStarted(&a, m_context);
@@ -117,18 +569,7 @@ namespace geEngineSDK {
                     return false;
                   }
 
-                  RTTITypeBase* childRtti = nullptr;
-                  if (childObjectA->getRTTI() == childObjectB->getRTTI()) {
-                    childRtti = childObjectA->getRTTI();
-                  }
-
-                  if (nullptr != childRtti) {
-                    ICompare& handler = childRtti->getCompareHandler();
-                    if (!handler.run(*childObjectA, *childObjectB)) {
-                      return false;
-                    }
-                  }
-                  else {
+                  if (!compareChild(*childObjectA, *childObjectB)) {
                     return false;
                   }
                 }
@@ -145,18 +586,7 @@ namespace geEngineSDK {
                 auto& childObjectA = curField->getArrayValue(rttiInstanceA, &a, arrIdx);
                 auto& childObjectB = curField->getArrayValue(rttiInstanceB, &b, arrIdx);
 
-                RTTITypeBase* childRtti = nullptr;
-                if (childObjectA.getRTTI() == childObjectB.getRTTI()) {
-                  childRtti = childObjectA.getRTTI();
-                }
-
-                if (nullptr != childRtti) {
-                  ICompare& handler = childRtti->getCompareHandler();
-                  if (!handler.run(childObjectA, childObjectB)) {
-                    return false;
-                  }
-                }
-                else {
+                if (!compareChild(childObjectA, childObjectB)) {
                   return false;
                 }
               }
@@ -168,6 +598,22 @@ namespace geEngineSDK {
             {
               auto curField = static_cast<RTTIPlainFieldBase*>(curGenericField);
 
+              //Compare the whole array at once if both are stored contiguously
+              const uint8* bytesA = curField->getArrayBytes(rttiInstanceA,
+                                                            &a,
+                                                            arrayNumElemsA);
+              const uint8* bytesB = curField->getArrayBytes(rttiInstanceB,
+                                                            &b,
+                                                            arrayNumElemsB);
+              if (nullptr != bytesA && nullptr != bytesB) {
+                SIZE_T arraySize = SIZE_T(curField->getTypeSize()) * arrayNumElemsA;
+                if (memcmp(bytesA, bytesB, arraySize) != 0) {
+                  return false;
+                }
+
+                break;
+              }
+
               for (uint32 arrIdx = 0; arrIdx < arrayNumElemsA; ++arrIdx) {
                 uint32 typeSizeA = 0;
                 uint32 typeSizeB = 0;
@@ -222,18 +668,7 @@ namespace geEngineSDK {
                   return false;
                 }
 
-                RTTITypeBase* childRtti = nullptr;
-                if (childObjectA->getRTTI() == childObjectB->getRTTI()) {
-                  childRtti = childObjectA->getRTTI();
-                }
-
-                if (nullptr != childRtti) {
-                  ICompare& handler = childRtti->getCompareHandler();
-                  if (!handler.run(*childObjectA, *childObjectB)) {
-                    return false;
-                  }
-                }
-                else {
+                if (!compareChild(*childObjectA, *childObjectB)) {
                   return false;
                 }
               }
@@ -248,18 +683,7 @@ namespace geEngineSDK {
               auto& childObjectA = curField->getValue(rttiInstanceA, &a);
               auto& childObjectB = curField->getValue(rttiInstanceB, &b);
 
-              RTTITypeBase* childRtti = nullptr;
-              if (childObjectA.getRTTI() == childObjectB.getRTTI()) {
-                childRtti = childObjectA.getRTTI();
-              }
-
-              if (nullptr != childRtti) {
-                ICompare& handler = childRtti->getCompareHandler();
-                if (!handler.run(childObjectA, childObjectB)) {
-                  return false;
-                }
-              }
-              else {
+              if (!compareChild(childObjectA, childObjectB)) {
                 return false;
               }
 
@@ -310,13 +734,7 @@ namespace geEngineSDK {
                 return false;
               }
 
-              auto dataA = ge_managed_stack_alloc(dataBlockSizeA);
-              auto dataB = ge_managed_stack_alloc(dataBlockSizeB);
-
-              blockStreamA->read(dataA, dataBlockSizeA);
-              blockStreamB->read(dataB, dataBlockSizeB);
-
-              if (memcmp(dataA, dataB, dataBlockSizeA) != 0) {
+              if (!impl::compareStreams(*blockStreamA, *blockStreamB, dataBlockSizeA)) {
                 return false;
               }
 
@@ -340,4 +758,60 @@ namespace geEngineSDK {
 
     return true;
   }
+
+  bool
+  FingerprintCache::find(const IReflectable* object,
+                         uint64 version,
+                         ObjectFingerprint& fingerprint) const {
+    auto iterFind = m_entries.find(object);
+    if (m_entries.end() == iterFind || iterFind->second.version != version) {
+      return false;
+    }
+
+    fingerprint = iterFind->second.fingerprint;
+    return true;
+  }
+
+  void
+  FingerprintCache::store(const IReflectable* object,
+                          uint64 version,
+                          const ObjectFingerprint& fingerprint) {
+    m_entries[object] = { version, fingerprint };
+  }
+
+  void
+  FingerprintCache::invalidate(const IReflectable* object) {
+    m_entries.erase(object);
+  }
+
+  void
+  FingerprintCache::clear() {
+    m_entries.clear();
+  }
+
+  ObjectFingerprint
+  BinaryFingerprint::compute(IReflectable& object,
+                             FingerprintCache* cache,
+                             uint64 version) {
+    FrameAlloc& alloc = g_frameAlloc();
+    alloc.markFrame();
+
+    ObjectFingerprint output;
+    {
+      impl::FingerprintWalker walker(cache, version, alloc);
+
+      uint32 lowLink = 0;
+      output = walker.hashObject(object, lowLink);
+    }
+
+    alloc.clear();
+    return output;
+  }
+
+  ObjectFingerprint
+  BinaryFingerprint::hashBytes(const void* data, SIZE_T size) {
+    impl::FingerprintHasher hasher;
+    hasher.update(data, size);
+    return hasher.finish();
+  }
 }
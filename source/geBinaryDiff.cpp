@@ -195,7 +195,7 @@ namespace geEngineSDK {
           //Call base class first, followed by derived classes
           while (!rttiTypes.empty()) {
             curRtti = rttiTypes.top();
-            rttiInstance = curRtti->_clone(alloc);
+            rttiInstance = curRtti->_getInstance(alloc);
 
             rttiInstances.emplace_back(rttiInstance, destObject);
             rttiInstance->onDeserializationStarted(destObject, context);
@@ -230,7 +230,7 @@ namespace geEngineSDK {
             rttiInstance = rttiInstances.back().first;
             rttiInstance->onDeserializationEnded(destObject, context);
 
-            alloc.destruct(rttiInstance);
+            RTTITypeBase::_releaseInstance(rttiInstance, alloc);
             rttiInstances.erase(rttiInstances.end() - 1);
           }
 
@@ -489,7 +489,7 @@ namespace geEngineSDK {
         continue;
       }
 
-      RTTITypeBase* rttiInstance = rtti->_clone(alloc);
+      RTTITypeBase* rttiInstance = rtti->_getInstance(alloc);
       rttiInstance->onSerializationStarted(object.get(), nullptr);
       rttiInstances.push(rttiInstance);
 
@@ -810,7 +810,7 @@ namespace geEngineSDK {
     while (!rttiInstances.empty()) {
       RTTITypeBase* rttiInstance = rttiInstances.top();
       rttiInstance->onSerializationEnded(object.get(), nullptr);
-      alloc.destruct(rttiInstance);
+      RTTITypeBase::_releaseInstance(rttiInstance, alloc);
       rttiInstances.pop();
     }
   }
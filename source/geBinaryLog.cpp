@@ -0,0 +1,637 @@
+/*****************************************************************************/
+/**
+ * @file    geBinaryLog.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Compact binary log files and the reader that decodes them.
+ *
+ * Compact binary log files and the reader that decodes them.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geBinaryLog.h"
+#include "geDebug.h"
+#include "geDataStream.h"
+#include "geFileSystem.h"
+#include "Externals/lz4.h"
+
+#include <array>
+
+namespace geEngineSDK {
+  /**
+   * Layout of a binary log:
+   *
+   *  FileHeader
+   *  Text log header, HTML log header
+   *  BlockHeader + block data    (repeated for each block)
+   *
+   * Each block holds a sequence of entries, each starting with its
+   * BINARY_LOG_ENTRY::E. Call sites and categories are stored the first time
+   * they are used, and the entries after them refer to them by id. Times are
+   * stored as the difference with the previous entry, so the blocks must be
+   * read in order.
+   */
+  namespace {
+    CONSTEXPR uint64 BINARY_LOG_MAGIC = 0x474F4C4E49424547ULL; //"GEBINLOG"
+    CONSTEXPR uint32 BINARY_LOG_VERSION = 1;
+
+    /**
+     * Set on BlockHeader::compSize when the block data is stored as is.
+     */
+    CONSTEXPR uint32 BLOCK_UNCOMPRESSED_FLAG = 0x80000000;
+
+    CONSTEXPR int64 NANOSECONDS_PER_SECOND = 1000000000;
+
+    /**
+     * Number of parameters StringUtil::format() can replace.
+     */
+    CONSTEXPR uint32 MAX_FORMAT_PARAMS = 20;
+
+    struct FileHeader
+    {
+      uint64 magic;
+      uint32 version;
+      uint32 textHeaderSize;
+      uint32 htmlHeaderSize;
+      uint32 blockSize;
+    };
+
+    struct BlockHeader
+    {
+      uint32 compSize;
+      uint32 rawSize;
+    };
+
+    namespace BINARY_LOG_ENTRY {
+      enum E {
+        /**
+         * Category id and name.
+         */
+        kCATEGORY = 1,
+
+        /**
+         * Call site id, verbosity, category, message if it's a literal,
+         * location and argument types.
+         */
+        kCALL_SITE,
+
+        /**
+         * Message logged with GE_LOG. Call site id, time and arguments.
+         */
+        kRECORD,
+
+        /**
+         * Message logged as text. Verbosity, category, time and message.
+         */
+        kENTRY
+      };
+    }
+
+    /**
+     * @brief Reads the entries of a block. Reading past its end marks it as
+     *        invalid instead of failing.
+     */
+    struct BlockReader
+    {
+      const uint8* data;
+      const uint8* end;
+      bool valid = true;
+
+      bool
+      isDone() const {
+        return !valid || data >= end;
+      }
+
+      uint8
+      readByte() {
+        if (data >= end) {
+          valid = false;
+          return 0;
+        }
+        return *data++;
+      }
+
+      uint64
+      readVarInt() {
+        uint64 value = 0;
+        for (uint32 shift = 0; shift < 64; shift += 7) {
+          const uint8 byte = readByte();
+          value |= static_cast<uint64>(byte & 0x7F) << shift;
+          if (0 == (byte & 0x80)) {
+            return value;
+          }
+        }
+
+        valid = false;
+        return 0;
+      }
+
+      const uint8*
+      skip(uint64 size) {
+        const uint8* start = data;
+        if (static_cast<uint64>(end - data) < size) {
+          valid = false;
+          data = end;
+          return start;
+        }
+        data += size;
+        return start;
+      }
+
+      String
+      readString() {
+        const uint64 size = readVarInt();
+        auto chars = reinterpret_cast<const ANSICHAR*>(skip(size));
+        return valid ? String(chars, static_cast<SIZE_T>(size)) : String();
+      }
+
+      template<class T>
+      T
+      readValue() {
+        T value{};
+        auto bytes = skip(sizeof(T));
+        if (valid) {
+          memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+      }
+    };
+
+    /**
+     * @brief Reads an argument and converts it to text, with the same
+     *        conversion StringUtil::format() used for its original type.
+     */
+    String
+    readArg(BlockReader& input, uint8 type) {
+      switch (type)
+      {
+        case LOG_BINARY_TYPE::kBOOL:
+          return toString(0 != input.readByte());
+        case LOG_BINARY_TYPE::kINT8:
+          return toString(static_cast<int8>(BinaryLogArgs::zigZagDecode(input.readVarInt())));
+        case LOG_BINARY_TYPE::kINT16:
+          return toString(static_cast<int16>(BinaryLogArgs::zigZagDecode(input.readVarInt())));
+        case LOG_BINARY_TYPE::kINT32:
+          return toString(static_cast<int32>(BinaryLogArgs::zigZagDecode(input.readVarInt())));
+        case LOG_BINARY_TYPE::kINT64:
+          //The width picks the int64 overload where time_t is the same type
+          return toString(BinaryLogArgs::zigZagDecode(input.readVarInt()),
+                          static_cast<uint16>(0));
+        case LOG_BINARY_TYPE::kUINT8:
+          return toString(static_cast<uint8>(input.readVarInt()));
+        case LOG_BINARY_TYPE::kUINT16:
+          return toString(static_cast<uint16>(input.readVarInt()));
+        case LOG_BINARY_TYPE::kUINT32:
+          return toString(static_cast<uint32>(input.readVarInt()));
+        case LOG_BINARY_TYPE::kUINT64:
+          return toString(static_cast<uint64>(input.readVarInt()));
+        case LOG_BINARY_TYPE::kFLOAT:
+          return toString(input.readValue<float>());
+        case LOG_BINARY_TYPE::kDOUBLE:
+          return toString(input.readValue<double>());
+        case LOG_BINARY_TYPE::kSTRING:
+          return input.readString();
+        default:
+          input.valid = false;
+          return String();
+      }
+    }
+
+    /**
+     * @brief Call site as stored in a binary log.
+     */
+    struct StoredCallSite
+    {
+      LogVerbosity verbosity = LogVerbosity::kLog;
+      uint32 category = 0;
+      bool hasMessage = false;
+      String message;
+      String location;
+      Vector<uint8> types;
+      bool isRead = false;
+    };
+  }
+
+  BinaryLogSink::BinaryLogSink(const Path& path, const BinaryLogSinkOptions& options)
+    : m_options(options) {
+    Path fullPath = path;
+    if (!fullPath.isAbsolute()) {
+      fullPath.makeAbsolute(FileSystem::getWorkingDirectoryPath());
+    }
+
+    const Path directory = fullPath.getDirectory();
+    if (!FileSystem::exists(directory)) {
+      FileSystem::createDir(directory);
+    }
+
+    m_file = FileSystem::createAndOpenFile(fullPath);
+
+    //The system information is the one of the machine that logs, not the
+    //one that reads the log
+    const String textHeader = Debug::getTextLogHeader();
+    const String htmlHeader = Debug::getHtmlLogHeader();
+
+    FileHeader header;
+    header.magic = BINARY_LOG_MAGIC;
+    header.version = BINARY_LOG_VERSION;
+    header.textHeaderSize = static_cast<uint32>(textHeader.size());
+    header.htmlHeaderSize = static_cast<uint32>(htmlHeader.size());
+    header.blockSize = m_options.blockSize;
+
+    m_file->write(&header, sizeof(header));
+    m_file->write(textHeader.data(), textHeader.size());
+    m_file->write(htmlHeader.data(), htmlHeader.size());
+    m_file->flush();
+
+    m_block.reserve(m_options.blockSize);
+  }
+
+  BinaryLogSink::~BinaryLogSink() {
+    flush();
+    m_file->close();
+  }
+
+  void
+  BinaryLogSink::write(const LogEntry& entry) {
+    Lock lock(m_mutex);
+    writeCategory(entry.getCategory());
+
+    m_block.push_back(BINARY_LOG_ENTRY::kENTRY);
+    m_block.push_back(static_cast<uint8>(entry.getVerbosity()));
+    BinaryLogArgs::writeVarInt(m_block, entry.getCategory());
+    writeTimestamp(static_cast<int64>(entry.getLocalTime()) * NANOSECONDS_PER_SECOND);
+    writeString(entry.getMessage());
+
+    if (m_block.size() >= m_options.blockSize) {
+      writeBlock();
+    }
+  }
+
+  void
+  BinaryLogSink::flush() {
+    Lock lock(m_mutex);
+    writeBlock();
+  }
+
+  void
+  BinaryLogSink::_writeRecord(const LogCallSite& site, int64 timestamp, const uint8* args) {
+    //Encoded without holding the lock, converting an argument to text may
+    //log a message
+    m_args.clear();
+    site.encodeArgs(args, m_args);
+
+    Lock lock(m_mutex);
+    if (m_writtenSites.size() <= site.id) {
+      m_writtenSites.resize(site.id + 1, false);
+    }
+
+    if (!m_writtenSites[site.id]) {
+      m_writtenSites[site.id] = true;
+      writeCategory(site.category);
+
+      m_block.push_back(BINARY_LOG_ENTRY::kCALL_SITE);
+      BinaryLogArgs::writeVarInt(m_block, site.id);
+      m_block.push_back(static_cast<uint8>(site.verbosity));
+      BinaryLogArgs::writeVarInt(m_block, site.category);
+
+      const ANSICHAR* message = m_args.getMessage();
+      m_block.push_back(nullptr != message ? 1 : 0);
+      if (nullptr != message) {
+        writeString(message);
+      }
+      writeString(site.location);
+
+      const Vector<uint8>& types = m_args.getTypes();
+      BinaryLogArgs::writeVarInt(m_block, types.size());
+      m_block.insert(m_block.end(), types.begin(), types.end());
+    }
+
+    const Vector<uint8>& data = m_args.getData();
+    m_block.push_back(BINARY_LOG_ENTRY::kRECORD);
+    BinaryLogArgs::writeVarInt(m_block, site.id);
+    writeTimestamp(timestamp);
+    BinaryLogArgs::writeVarInt(m_block, data.size());
+    m_block.insert(m_block.end(), data.begin(), data.end());
+
+    if (m_block.size() >= m_options.blockSize) {
+      writeBlock();
+    }
+  }
+
+  void
+  BinaryLogSink::writeCategory(uint32 category) {
+    //Ids out of the table are stored every time
+    if (category < Log::MAX_CATEGORIES) {
+      if (m_writtenCategories[category]) {
+        return;
+      }
+      m_writtenCategories[category] = true;
+    }
+
+    String name;
+    Log::getCategoryName(category, name);
+
+    m_block.push_back(BINARY_LOG_ENTRY::kCATEGORY);
+    BinaryLogArgs::writeVarInt(m_block, category);
+    writeString(name);
+  }
+
+  void
+  BinaryLogSink::writeTimestamp(int64 timestamp) {
+    BinaryLogArgs::writeVarInt(m_block, BinaryLogArgs::zigZagEncode(timestamp - m_lastTimestamp));
+    m_lastTimestamp = timestamp;
+  }
+
+  void
+  BinaryLogSink::writeString(const String& value) {
+    BinaryLogArgs::writeVarInt(m_block, value.size());
+    m_block.insert(m_block.end(), value.begin(), value.end());
+  }
+
+  void
+  BinaryLogSink::writeBlock() {
+    if (m_block.empty()) {
+      return;
+    }
+
+    BlockHeader header;
+    header.rawSize = static_cast<uint32>(m_block.size());
+    header.compSize = header.rawSize | BLOCK_UNCOMPRESSED_FLAG;
+
+    const uint8* data = m_block.data();
+    uint32 size = header.rawSize;
+    if (m_options.compress) {
+      const int32 rawSize = static_cast<int32>(header.rawSize);
+      m_compressed.resize(static_cast<SIZE_T>(LZ4_compressBound(rawSize)));
+      const int32 compSize = LZ4_compress_default(reinterpret_cast<const char*>(m_block.data()),
+                                                  reinterpret_cast<char*>(m_compressed.data()),
+                                                  rawSize,
+                                                  static_cast<int32>(m_compressed.size()));
+
+      //Stored as is if compressing it didn't make it smaller
+      if (0 < compSize && compSize < rawSize) {
+        header.compSize = static_cast<uint32>(compSize);
+        data = m_compressed.data();
+        size = header.compSize;
+      }
+    }
+
+    m_file->write(&header, sizeof(header));
+    m_file->write(data, size);
+    m_file->flush();
+    m_block.clear();
+  }
+
+  BinaryLogReader::BinaryLogReader(const Path& path)
+    : m_path(path) {
+    SPtr<DataStream> file = FileSystem::openFile(m_path);
+    if (!file) {
+      return;
+    }
+
+    FileHeader header;
+    if (file->read(&header, sizeof(header)) != sizeof(header) ||
+        BINARY_LOG_MAGIC != header.magic) {
+      GE_LOG(kError, FileSystem, "Not a binary log: {0}", m_path);
+      return;
+    }
+
+    if (BINARY_LOG_VERSION != header.version) {
+      GE_LOG(kError,
+             FileSystem,
+             "Unsupported binary log version {0}: {1}",
+             header.version,
+             m_path);
+      return;
+    }
+
+    m_textHeader.resize(header.textHeaderSize);
+    m_htmlHeader.resize(header.htmlHeaderSize);
+    if (file->read(&m_textHeader[0], m_textHeader.size()) != m_textHeader.size() ||
+        file->read(&m_htmlHeader[0], m_htmlHeader.size()) != m_htmlHeader.size()) {
+      GE_LOG(kError, FileSystem, "Truncated binary log: {0}", m_path);
+      return;
+    }
+
+    m_dataOffset = file->tell();
+  }
+
+  Vector<LogEntry>
+  BinaryLogReader::getEntries(const BinaryLogFilter& filter) const {
+    Vector<LogEntry> entries;
+    readEntries(filter, [&entries](const LogEntry& entry, const String&) {
+      entries.push_back(entry);
+    });
+    return entries;
+  }
+
+  void
+  BinaryLogReader::saveTextLog(const Path& path, const BinaryLogFilter& filter) const {
+    StringStream stream;
+    stream << m_textHeader;
+
+    readEntries(filter, [&stream](const LogEntry& entry, const String& categoryName) {
+      stream << Debug::getTextLogEntry(entry, categoryName) << "\n";
+    });
+
+    SPtr<DataStream> fileStream = FileSystem::createAndOpenFile(path);
+    fileStream->writeString(stream.str());
+  }
+
+  void
+  BinaryLogReader::saveHtmlLog(const Path& path, const BinaryLogFilter& filter) const {
+    StringStream stream;
+    stream << m_htmlHeader;
+
+    readEntries(filter, [&stream](const LogEntry& entry, const String&) {
+      stream << Debug::getHtmlLogEntry(entry);
+    });
+
+    stream << Debug::getHtmlLogFooter();
+
+    SPtr<DataStream> fileStream = FileSystem::createAndOpenFile(path);
+    fileStream->writeString(stream.str());
+  }
+
+  void
+  BinaryLogReader::readEntries(const BinaryLogFilter& filter,
+                               const function<void(const LogEntry& entry,
+                                                   const String& categoryName)>& callback) const {
+    if (!isValid()) {
+      return;
+    }
+
+    SPtr<DataStream> file = FileSystem::openFile(m_path);
+    if (!file) {
+      return;
+    }
+    file->seek(m_dataOffset);
+
+    auto isRead = [&filter](LogVerbosity verbosity, uint32 category) {
+      if (static_cast<int32>(verbosity) > static_cast<int32>(filter.verbosity)) {
+        return false;
+      }
+      return filter.categories.empty() ||
+             filter.categories.end() != std::find(filter.categories.begin(),
+                                                  filter.categories.end(),
+                                                  category);
+    };
+
+    auto isInRange = [&filter](time_t time) {
+      return (0 == filter.startTime || time >= filter.startTime) &&
+             (0 == filter.endTime || time <= filter.endTime);
+    };
+
+    UnorderedMap<uint32, String> categories;
+    auto getCategoryName = [&categories](uint32 category) -> const String& {
+      static const String unknown = "Unknown";
+      auto found = categories.find(category);
+      return categories.end() != found ? found->second : unknown;
+    };
+
+    Vector<StoredCallSite> sites;
+    Vector<uint8> compressed;
+    Vector<uint8> block;
+    std::array<String, MAX_FORMAT_PARAMS> params;
+    int64 timestamp = 0;
+
+    //A block cut short, because the application ended while writing it,
+    //ends the log
+    BlockHeader header;
+    while (file->read(&header, sizeof(header)) == sizeof(header)) {
+      const bool isCompressed = 0 == (header.compSize & BLOCK_UNCOMPRESSED_FLAG);
+      const uint32 compSize = header.compSize & ~BLOCK_UNCOMPRESSED_FLAG;
+
+      //LZ4 can't expand data more than 255 times
+      if (compSize > file->size() - file->tell() ||
+          (isCompressed && header.rawSize > static_cast<uint64>(compSize) * 255 + 16)) {
+        break;
+      }
+
+      compressed.resize(compSize);
+      if (file->read(compressed.data(), compSize) != compSize) {
+        break;
+      }
+
+      if (isCompressed) {
+        block.resize(header.rawSize);
+        const int32 rawSize = LZ4_decompress_safe(reinterpret_cast<const char*>(compressed.data()),
+                                                  reinterpret_cast<char*>(block.data()),
+                                                  static_cast<int32>(compSize),
+                                                  static_cast<int32>(header.rawSize));
+        if (rawSize != static_cast<int32>(header.rawSize)) {
+          break;
+        }
+      }
+      else {
+        block.swap(compressed);
+      }
+
+      BlockReader input{ block.data(), block.data() + block.size() };
+      while (!input.isDone()) {
+        switch (input.readByte())
+        {
+          case BINARY_LOG_ENTRY::kCATEGORY:
+          {
+            const uint32 category = static_cast<uint32>(input.readVarInt());
+            categories[category] = input.readString();
+            break;
+          }
+          case BINARY_LOG_ENTRY::kCALL_SITE:
+          {
+            const uint64 id = input.readVarInt();
+            if (id >= NumLimit::MAX_UINT32) {
+              input.valid = false;
+              break;
+            }
+            if (sites.size() <= id) {
+              sites.resize(static_cast<SIZE_T>(id) + 1);
+            }
+
+            StoredCallSite& site = sites[static_cast<SIZE_T>(id)];
+            site.verbosity = static_cast<LogVerbosity>(input.readByte());
+            site.category = static_cast<uint32>(input.readVarInt());
+            site.hasMessage = 0 != input.readByte();
+            site.message = site.hasMessage ? input.readString() : String();
+            site.location = input.readString();
+            const uint64 numTypes = input.readVarInt();
+            auto types = input.skip(numTypes);
+            site.types.assign(types, types + (input.valid ? numTypes : 0));
+            site.isRead = isRead(site.verbosity, site.category);
+            break;
+          }
+          case BINARY_LOG_ENTRY::kRECORD:
+          {
+            const uint64 id = input.readVarInt();
+            timestamp += BinaryLogArgs::zigZagDecode(input.readVarInt());
+            const uint64 size = input.readVarInt();
+            const uint8* args = input.skip(size);
+            if (!input.valid || sites.size() <= id) {
+              input.valid = false;
+              break;
+            }
+
+            //Skipped without decoding the arguments
+            const StoredCallSite& site = sites[static_cast<SIZE_T>(id)];
+            const time_t time = static_cast<time_t>(timestamp / NANOSECONDS_PER_SECOND);
+            if (!site.isRead || !isInRange(time)) {
+              break;
+            }
+
+            BlockReader argsInput{ args, args + size };
+            String message = site.hasMessage ? site.message : argsInput.readString();
+            for (SIZE_T i = 0; i < site.types.size(); ++i) {
+              String value = readArg(argsInput, site.types[i]);
+              if (i < params.size()) {
+                params[i] = std::move(value);
+              }
+            }
+
+            message = std::apply([&message](const auto&... values) {
+                                   return StringUtil::format(message, values...);
+                                 },
+                                 params);
+            for (auto& param : params) {
+              param.clear();
+            }
+
+            callback(LogEntry(message + site.location, site.verbosity, site.category, time),
+                     getCategoryName(site.category));
+            break;
+          }
+          case BINARY_LOG_ENTRY::kENTRY:
+          {
+            const auto verbosity = static_cast<LogVerbosity>(input.readByte());
+            const uint32 category = static_cast<uint32>(input.readVarInt());
+            timestamp += BinaryLogArgs::zigZagDecode(input.readVarInt());
+            const uint64 size = input.readVarInt();
+            auto chars = reinterpret_cast<const ANSICHAR*>(input.skip(size));
+            const time_t time = static_cast<time_t>(timestamp / NANOSECONDS_PER_SECOND);
+            if (!input.valid || !isRead(verbosity, category) || !isInRange(time)) {
+              break;
+            }
+
+            callback(LogEntry(String(chars, static_cast<SIZE_T>(size)), verbosity, category, time),
+                     getCategoryName(category));
+            break;
+          }
+          default:
+            input.valid = false;
+            break;
+        }
+      }
+
+      if (!input.valid) {
+        GE_LOG(kWarning, FileSystem, "Corrupted block found in binary log: {0}", m_path);
+        break;
+      }
+    }
+  }
+}
@@ -42,6 +42,8 @@
 #include "geRTTIManagedDataBlockField.h"
 #include "geMemorySerializer.h"
 #include "geDataStream.h"
+#include "geTaskScheduler.h"
+#include "geMath.h"
 
 namespace geEngineSDK {
   using std::move;
@@ -120,6 +122,107 @@ m_totalBytesRead -= size;                                                     \
 
   CONSTEXPR uint32 BinarySerializer::REPORT_AFTER_BYTES;
 
+  namespace {
+    /**
+     * Number of tasks the objects are split in per worker, so a few large
+     * objects don't leave the rest of the workers idle.
+     */
+    CONSTEXPR uint32 TASKS_PER_WORKER = 4;
+
+    /**
+     * Size of the chunks the workers of a parallel encode write to.
+     */
+    CONSTEXPR uint32 TASK_BUFFER_SIZE = 4096;
+
+    /**
+     * Data in the compact format starts with this header, followed by the
+     * format version in the high byte. Data in the default format starts with
+     * object meta data, which always has its lowest bit set, so a first byte
+     * of 0 tells both apart.
+     */
+    CONSTEXPR uint32 FORMAT_HEADER_TAG = 0x00424700; //"\0GB"
+    CONSTEXPR uint32 FORMAT_HEADER_TAG_MASK = 0x00FFFFFF;
+    CONSTEXPR uint32 FORMAT_HEADER_SIZE = sizeof(uint32);
+
+    /**
+     * Maximum size of a 32 bit LEB128 variable length integer.
+     */
+    CONSTEXPR uint32 MAX_VARINT_SIZE = 5;
+
+    /**
+     * @brief Writes @p value as a LEB128 variable length integer.
+     * @return  Number of bytes written.
+     */
+    uint32
+    writeVarInt(uint32 value, uint8* output) {
+      uint32 size = 0;
+      while (value >= 0x80) {
+        output[size++] = static_cast<uint8>(value | 0x80);
+        value >>= 7;
+      }
+
+      output[size++] = static_cast<uint8>(value);
+      return size;
+    }
+
+    /**
+     * @brief Reads a LEB128 variable length integer and advances past it.
+     * @return  False if the data ends before the integer does.
+     */
+    bool
+    readVarInt(const uint8*& data, const uint8* end, uint32& value) {
+      value = 0;
+      for (uint32 i = 0; i < MAX_VARINT_SIZE && data < end; ++i) {
+        const uint8 byte = *data++;
+        value |= static_cast<uint32>(byte & 0x7F) << (7 * i);
+        if (0 == (byte & 0x80)) {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    /**
+     * @brief Returns the number of tasks to split @p numItems items in.
+     */
+    uint32
+    getNumTasks(uint32 numItems) {
+      if (2 > numItems || !TaskScheduler::isStarted()) {
+        return 1;
+      }
+
+      const uint32 numWorkers = TaskScheduler::instance().getNumWorkers();
+      return Math::min(numItems, Math::max(1U, numWorkers * TASKS_PER_WORKER));
+    }
+
+    /**
+     * @brief Calls @p worker with each of the @p numTasks contiguous ranges
+     *        of items, on the TaskScheduler workers if there is more than
+     *        one task.
+     */
+    void
+    runTasks(uint32 numItems,
+             uint32 numTasks,
+             const function<void(uint32, uint32, uint32)>& worker) {
+      if (1 >= numTasks) {
+        worker(0, 0, numItems);
+        return;
+      }
+
+      auto taskGroup = TaskGroup::create("BinarySerializer",
+      [&](uint32 taskIdx) {
+        const uint32 first = (numItems * taskIdx) / numTasks;
+        const uint32 last = (numItems * (taskIdx + 1)) / numTasks;
+        worker(taskIdx, first, last);
+      },
+      numTasks);
+
+      TaskScheduler::instance().addTaskGroup(taskGroup);
+      taskGroup->wait();
+    }
+  }
+
   BinarySerializer::BinarySerializer()
     : m_alloc(&g_frameAlloc())
   {}
@@ -131,77 +234,112 @@ m_totalBytesRead -= size;                                                     \
                            uint32* bytesWritten,
                            function<uint8*(uint8*, uint32, uint32&)> flushBufferCallback,
                            bool shallow,
-                           SerializationContext* context) {
+                           SerializationContext* context,
+                           bool deduplicate,
+                           bool parallel,
+                           bool compact) {
     m_objectsToEncode.clear();
     m_objectAddrToId.clear();
     m_lastUsedObjectId = 1;
     *bytesWritten = 0;
     m_totalBytesWritten = 0;
     m_context = context;
+    m_deduplicate = deduplicate;
+    m_dedupSuspended = 0;
+    m_compact = compact;
 
     m_alloc->markFrame();
 
+    if (m_compact) {
+      uint8 header[FORMAT_HEADER_SIZE];
+      const uint32 headerValue = FORMAT_HEADER_TAG | (FORMAT_VERSION_COMPACT << 24);
+      memcpy(header, &headerValue, sizeof(headerValue));
+
+      buffer = dataBlockToBuffer(header,
+                                 FORMAT_HEADER_SIZE,
+                                 buffer,
+                                 bufferLength,
+                                 bytesWritten,
+                                 flushBufferCallback);
+      if (nullptr == buffer) {
+        GE_EXCEPT(InternalErrorException,
+                  "Destination buffer is null or not large enough.");
+      }
+    }
+
     Vector<SPtr<IReflectable>> encodedObjects;
     uint32 objectId = findOrCreatePersistentId(object);
 
-    //Encode primary object and its value types
-    buffer = encodeEntry(object,
-                         objectId,
-                         buffer,
-                         bufferLength,
-                         bytesWritten,
-                         flushBufferCallback,
-                         shallow);
-
-    if (nullptr == buffer) {
-      GE_EXCEPT(InternalErrorException,
-                "Destination buffer is null or not large enough.");
+    bool encoded = false;
+    if (parallel && !deduplicate && !shallow && TaskScheduler::isStarted()) {
+      encoded = encodeParallel(object,
+                               objectId,
+                               buffer,
+                               bufferLength,
+                               bytesWritten,
+                               flushBufferCallback);
     }
 
-    //Encode pointed to objects and their value types
-    UnorderedSet<uint32> serializedObjects;
-    while (true) {
-      auto iter = m_objectsToEncode.begin();
-      bool foundObjectToProcess = false;
-      for (; iter != m_objectsToEncode.end(); ++iter) {
-        auto foundExisting = serializedObjects.find(iter->objectId);
-        if (serializedObjects.end() != foundExisting){
-          continue; //Already processed
-        }
+    if (!encoded) {
+      //Encode primary object and its value types
+      buffer = encodeEntry(object,
+                           objectId,
+                           buffer,
+                           bufferLength,
+                           bytesWritten,
+                           flushBufferCallback,
+                           shallow);
 
-        SPtr<IReflectable> curObject = iter->object;
-        uint32 curObjectid = iter->objectId;
-        serializedObjects.insert(curObjectid);
-        m_objectsToEncode.erase(iter);
+      if (nullptr == buffer) {
+        GE_EXCEPT(InternalErrorException,
+                  "Destination buffer is null or not large enough.");
+      }
 
-        buffer = encodeEntry(curObject.get(),
-                             curObjectid,
-                             buffer,
-                             bufferLength,
-                             bytesWritten,
-                             flushBufferCallback,
-                             shallow);
-        if (nullptr == buffer) {
-          GE_EXCEPT(InternalErrorException,
-                    "Destination buffer is null or not large enough.");
-        }
+      //Encode pointed to objects and their value types
+      UnorderedSet<uint32> serializedObjects;
+      while (true) {
+        auto iter = m_objectsToEncode.begin();
+        bool foundObjectToProcess = false;
+        for (; iter != m_objectsToEncode.end(); ++iter) {
+          auto foundExisting = serializedObjects.find(iter->objectId);
+          if (serializedObjects.end() != foundExisting){
+            continue; //Already processed
+          }
+
+          SPtr<IReflectable> curObject = iter->object;
+          uint32 curObjectid = iter->objectId;
+          serializedObjects.insert(curObjectid);
+          m_objectsToEncode.erase(iter);
+
+          buffer = encodeEntry(curObject.get(),
+                               curObjectid,
+                               buffer,
+                               bufferLength,
+                               bytesWritten,
+                               flushBufferCallback,
+                               shallow);
+          if (nullptr == buffer) {
+            GE_EXCEPT(InternalErrorException,
+                      "Destination buffer is null or not large enough.");
+          }
 
-        foundObjectToProcess = true;
+          foundObjectToProcess = true;
 
-        //Ensure we keep a reference to the object so it isn't released.
-        //The system assigns unique IDs to IReflectable objects based on
-        //pointer addresses but if objects get released then same address could
-        //be assigned twice.
-        //NOTE: To get around this I could assign unique IDs to IReflectable
-        //objects
-        encodedObjects.push_back(curObject);
+          //Ensure we keep a reference to the object so it isn't released.
+          //The system assigns unique IDs to IReflectable objects based on
+          //pointer addresses but if objects get released then same address could
+          //be assigned twice.
+          //NOTE: To get around this I could assign unique IDs to IReflectable
+          //objects
+          encodedObjects.push_back(curObject);
 
-        //Need to start over as m_objectsToSerialize was possibly modified
-        break;
-      }
+          //Need to start over as m_objectsToSerialize was possibly modified
+          break;
+        }
 
-      if (!foundObjectToProcess) { //We're done
-        break;
+        if (!foundObjectToProcess) { //We're done
+          break;
+        }
       }
     }
 
@@ -217,6 +355,14 @@ m_totalBytesRead -= size;                                                     \
     m_objectsToEncode.clear();
     m_objectAddrToId.clear();
 
+    m_fingerprintCache.clear();
+    m_duplicateObjects.clear();
+    m_duplicateValues.clear();
+    m_duplicatesToKeep.clear();
+    m_dedupScratch.clear();
+    m_deduplicate = false;
+    m_compact = false;
+
     m_alloc->clear();
   }
 
@@ -224,7 +370,8 @@ m_totalBytesRead -= size;                                                     \
   BinarySerializer::decode(const SPtr<DataStream>& data,
                            uint32 dataLength,
                            SerializationContext* context,
-                           function<void(float)> progress) {
+                           function<void(float)> progress,
+                           bool parallel) {
     m_context = context;
     m_reportProgress = nullptr;
     m_totalBytesToRead = dataLength;
@@ -241,21 +388,55 @@ m_totalBytesRead -= size;                                                     \
     const SIZE_T start = data->tell();
     const SIZE_T end = start + dataLength;
     m_decodeObjectMap.clear();
+    m_decodeStart = start;
+
+    //Data without a format header is in the default format
+    uint8 header[FORMAT_HEADER_SIZE] = {};
+    const SIZE_T headerSize = data->read(header, Math::min<SIZE_T>(FORMAT_HEADER_SIZE,
+                                                                     dataLength));
+    data->seek(start);
+
+    const uint32 formatVersion = getFormatVersion(header, static_cast<uint32>(headerSize));
+    if (FORMAT_VERSION_COMPACT < formatVersion) {
+      GE_EXCEPT(InternalErrorException,
+                "Unsupported serialized data format version: " +
+                toString(formatVersion));
+      return nullptr;
+    }
+
+    m_compact = FORMAT_VERSION_COMPACT == formatVersion;
+    if (m_compact) {
+      SKIP_READ(FORMAT_HEADER_SIZE)
+    }
+
+    //A parallel decode needs to know which objects each object references,
+    //so it's gathered while going over the data the first time
+    MemoryDataStream* memoryData = nullptr;
+    if (parallel && TaskScheduler::isStarted()) {
+      memoryData = dynamic_cast<MemoryDataStream*>(data.get());
+    }
+
+    Vector<uint32> objectIds;
+    Vector<uint32> firstReference;
+    Vector<uint32> references;
+    if (nullptr != memoryData) {
+      m_gatheredReferences = &references;
+    }
 
     //Note: Ideally we can avoid iterating twice over the stream data
     //Create empty instances of all ptr objects
     SPtr<IReflectable> rootObject = nullptr;
 
-    do {
-      ObjectMetaData objectMetaData;
-      objectMetaData.objectMeta = 0;
-      objectMetaData.typeId = 0;
+    bool hasMoreObjects = true;
+    while (hasMoreObjects) {
+      const SIZE_T objectStart = data->tell();
 
-      if (data->read(&objectMetaData, sizeof(ObjectMetaData)) != sizeof(ObjectMetaData)) {
-        GE_EXCEPT(InternalErrorException, "Error decoding data.");
-      }
+      ObjectMetaData objectMetaData;
+      objectMetaData.objectMeta = readMetaData(data);
+      objectMetaData.typeId = readUInt32(data);
 
-      data->seek(data->tell() - sizeof(ObjectMetaData));
+      const auto metaSize = static_cast<uint32>(data->tell() - objectStart);
+      SEEK_BACK(metaSize)
 
       uint32 objectId = 0;
       uint32 objectTypeId = 0;
@@ -276,13 +457,25 @@ m_totalBytesRead -= size;                                                     \
         rootObject = object;
       }
 
-    }while (decodeEntry(data, end, nullptr));
+      if (nullptr != memoryData) {
+        objectIds.push_back(objectId);
+        firstReference.push_back(static_cast<uint32>(references.size()));
+      }
+
+      hasMoreObjects = decodeEntry(data, end, nullptr);
+    }
+
+    m_gatheredReferences = nullptr;
 
     GE_ASSERT(m_totalBytesRead == m_totalBytesToRead);
 
     //Don't set report callback until we actually do the reads
     m_reportProgress = move(progress);
-    m_totalBytesRead = 0;
+    m_totalBytesRead = m_compact ? FORMAT_HEADER_SIZE : 0;
+
+    if (nullptr != memoryData) {
+      decodeParallel(*memoryData, end, objectIds, firstReference, references);
+    }
 
     //Now go through all of the objects and actually decode them
     for (auto& iter : m_decodeObjectMap) {
@@ -305,6 +498,8 @@ m_totalBytesRead -= size;                                                     \
 
     GE_ASSERT(m_totalBytesRead == m_totalBytesToRead);
 
+    m_compact = false;
+
     if (m_reportProgress) {
       m_reportProgress(1.0f);
     }
@@ -312,6 +507,285 @@ m_totalBytesRead -= size;                                                     \
     return rootObject;
   }
 
+  uint32
+  BinarySerializer::getFormatVersion(const uint8* data, uint32 dataLength) {
+    uint32 header = 0;
+    if (FORMAT_HEADER_SIZE > dataLength) {
+      return FORMAT_VERSION_DEFAULT;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if (FORMAT_HEADER_TAG != (header & FORMAT_HEADER_TAG_MASK)) {
+      return FORMAT_VERSION_DEFAULT;
+    }
+
+    return header >> 24;
+  }
+
+  uint32
+  BinarySerializer::getEncodedTypeId(const uint8* data, uint32 dataLength) {
+    const uint8* end = data + dataLength;
+    ObjectMetaData metaData;
+
+    if (FORMAT_VERSION_COMPACT == getFormatVersion(data, dataLength)) {
+      data += FORMAT_HEADER_SIZE;
+      if (!readVarInt(data, end, metaData.objectMeta) ||
+          !readVarInt(data, end, metaData.typeId)) {
+        return 0;
+      }
+    }
+    else {
+      if (sizeof(ObjectMetaData) > dataLength) {
+        return 0;
+      }
+      memcpy(&metaData, data, sizeof(ObjectMetaData));
+    }
+
+    return isObjectMetaData(metaData.objectMeta) ? metaData.typeId : 0;
+  }
+
+  bool
+  BinarySerializer::encodeParallel(IReflectable* object,
+                                   uint32 objectId,
+                                   uint8*& buffer,
+                                   uint32& bufferLength,
+                                   uint32* bytesWritten,
+                                   function<uint8*(uint8*, uint32, uint32&)>
+                                   flushBufferCallback) {
+    //Assign the IDs up front, in the same order the serial path would, so
+    //the workers only need to look them up
+    gatherObjectPtrs(object);
+    for (SIZE_T i = 0; i < m_objectsToEncode.size(); ++i) {
+      SPtr<IReflectable> curObject = m_objectsToEncode[i].object;
+      gatherObjectPtrs(curObject.get());
+    }
+
+    const auto numObjects = static_cast<uint32>(m_objectsToEncode.size() + 1);
+    const uint32 numTasks = getNumTasks(numObjects);
+
+    Vector<Vector<uint8>> taskOutputs(numTasks);
+    std::atomic<bool> failed{ false };
+
+    runTasks(numObjects, numTasks, [&](uint32 taskIdx, uint32 first, uint32 last) {
+      BinarySerializer worker;
+      worker.m_context = m_context;
+      worker.m_assignedObjectIds = &m_objectAddrToId;
+      worker.m_compact = m_compact;
+      worker.m_alloc->markFrame();
+
+      Vector<uint8>& output = taskOutputs[taskIdx];
+      uint8 taskBuffer[TASK_BUFFER_SIZE];
+      uint32 taskBufferLength = TASK_BUFFER_SIZE;
+      uint32 taskBytesWritten = 0;
+
+      auto flushTaskBuffer = [&output](uint8* bufferStart,
+                                       uint32 size,
+                                       uint32& newBufferSize) {
+        output.insert(output.end(), bufferStart, bufferStart + size);
+        newBufferSize = TASK_BUFFER_SIZE;
+        return bufferStart;
+      };
+
+      uint8* taskBufferPos = taskBuffer;
+      for (uint32 i = first; i < last && nullptr != taskBufferPos; ++i) {
+        IReflectable* curObject = object;
+        uint32 curObjectId = objectId;
+        if (0 != i) {
+          curObject = m_objectsToEncode[i - 1].object.get();
+          curObjectId = m_objectsToEncode[i - 1].objectId;
+        }
+
+        taskBufferPos = worker.encodeEntry(curObject,
+                                           curObjectId,
+                                           taskBufferPos,
+                                           taskBufferLength,
+                                           &taskBytesWritten,
+                                           flushTaskBuffer,
+                                           false);
+      }
+
+      if (nullptr == taskBufferPos || worker.m_unassignedObjectFound) {
+        failed = true;
+      }
+      else {
+        output.insert(output.end(), taskBuffer, taskBuffer + taskBytesWritten);
+      }
+
+      worker.m_alloc->clear();
+    });
+
+    if (failed) {
+      //Start over with the IDs the serial path expects
+      m_objectsToEncode.clear();
+      m_objectAddrToId.clear();
+      m_lastUsedObjectId = 1;
+      findOrCreatePersistentId(object);
+
+      return false;
+    }
+
+    for (auto& output : taskOutputs) {
+      buffer = dataBlockToBuffer(output.data(),
+                                 static_cast<uint32>(output.size()),
+                                 buffer,
+                                 bufferLength,
+                                 bytesWritten,
+                                 flushBufferCallback);
+      if (nullptr == buffer) {
+        GE_EXCEPT(InternalErrorException,
+                  "Destination buffer is null or not large enough.");
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void
+  BinarySerializer::gatherObjectPtrs(IReflectable* object) {
+    const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
+
+    FrameStack<RTTITypeBase*> rttiInstances;
+    for (const auto& classEntry : plan.classes) {
+      RTTITypeBase* rtti = classEntry.rtti;
+      RTTITypeBase* rttiInstance = rtti->_getInstance(*m_alloc);
+      rttiInstances.push(rttiInstance);
+
+      rtti->onSerializationStarted(object, m_context);
+
+      const uint32 lastField = classEntry.firstField + classEntry.numFields;
+      for (uint32 i = classEntry.firstField; i < lastField; ++i) {
+        const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+
+        if (SERIALIZABLE_FIELD_TYPE::kReflectablePtr == fieldEntry.type) {
+          auto curField = static_cast<RTTIReflectablePtrFieldBase*>(fieldEntry.field);
+
+          if (fieldEntry.isArray) {
+            const uint32 numElements = curField->getArraySize(rttiInstance, object);
+            for (uint32 arrIdx = 0; arrIdx < numElements; ++arrIdx) {
+              registerObjectPtr(curField->getArrayValue(rttiInstance, object, arrIdx));
+            }
+          }
+          else {
+            registerObjectPtr(curField->getValue(rttiInstance, object));
+          }
+        }
+        else if (SERIALIZABLE_FIELD_TYPE::kReflectable == fieldEntry.type) {
+          auto curField = static_cast<RTTIReflectableFieldBase*>(fieldEntry.field);
+
+          if (fieldEntry.isArray) {
+            const uint32 numElements = curField->getArraySize(rttiInstance, object);
+            for (uint32 arrIdx = 0; arrIdx < numElements; ++arrIdx) {
+              gatherObjectPtrs(&curField->getArrayValue(rttiInstance, object, arrIdx));
+            }
+          }
+          else {
+            gatherObjectPtrs(&curField->getValue(rttiInstance, object));
+          }
+        }
+      }
+    }
+
+    while (!rttiInstances.empty()) {
+      RTTITypeBase* rttiInstance = rttiInstances.top();
+      rttiInstance->onSerializationEnded(object, m_context);
+      RTTITypeBase::_releaseInstance(rttiInstance, *m_alloc);
+
+      rttiInstances.pop();
+    }
+  }
+
+  void
+  BinarySerializer::decodeParallel(MemoryDataStream& data,
+                                   SIZE_T dataEnd,
+                                   const Vector<uint32>& objectIds,
+                                   const Vector<uint32>& firstReference,
+                                   const Vector<uint32>& references) {
+    const auto numObjects = static_cast<uint32>(objectIds.size());
+
+    UnorderedMap<uint32, uint32> objectIndices;
+    objectIndices.reserve(numObjects);
+    for (uint32 i = 0; i < numObjects; ++i) {
+      objectIndices[objectIds[i]] = i;
+    }
+
+    //An object is ready to be decoded once all the objects it references are
+    Vector<uint32> numPending(numObjects, 0);
+    Vector<Vector<uint32>> referencedBy(numObjects);
+    for (uint32 i = 0; i < numObjects; ++i) {
+      const uint32 lastReference = (i + 1 < numObjects) ?
+                                     firstReference[i + 1] :
+                                     static_cast<uint32>(references.size());
+
+      for (uint32 j = firstReference[i]; j < lastReference; ++j) {
+        auto iterFind = objectIndices.find(references[j]);
+        if (objectIndices.end() != iterFind) {
+          ++numPending[i];
+          referencedBy[iterFind->second].push_back(i);
+        }
+      }
+    }
+
+    Vector<uint32> wave;
+    Vector<uint32> nextWave;
+    for (uint32 i = 0; i < numObjects; ++i) {
+      if (0 == numPending[i]) {
+        wave.push_back(i);
+      }
+    }
+
+    while (!wave.empty()) {
+      const auto numWaveObjects = static_cast<uint32>(wave.size());
+      const uint32 numTasks = getNumTasks(numWaveObjects);
+      Vector<uint32> taskBytesRead(numTasks, 0);
+
+      runTasks(numWaveObjects, numTasks, [&](uint32 taskIdx, uint32 first, uint32 last) {
+        BinarySerializer worker;
+        worker.m_context = m_context;
+        worker.m_sharedDecodeObjectMap = &m_decodeObjectMap;
+        worker.m_decodeStart = m_decodeStart;
+        worker.m_totalBytesToRead = m_totalBytesToRead;
+        worker.m_compact = m_compact;
+        worker.m_alloc->markFrame();
+
+        //Each worker reads through its own view of the data
+        SPtr<DataStream> stream =
+          ge_shared_ptr_new<MemoryDataStream>(data.getPtr(), data.size(), false);
+
+        for (uint32 i = first; i < last; ++i) {
+          ObjectToDecode& objToDecode = m_decodeObjectMap.find(objectIds[wave[i]])->second;
+
+          stream->seek(objToDecode.offset);
+          worker.decodeEntry(stream, dataEnd, objToDecode.object);
+        }
+
+        taskBytesRead[taskIdx] = worker.m_totalBytesRead;
+        worker.m_alloc->clear();
+      });
+
+      for (uint32 bytesRead : taskBytesRead) {
+        m_totalBytesRead += bytesRead;
+      }
+
+      if (m_reportProgress) {
+        m_reportProgress(m_totalBytesRead / static_cast<float>(m_totalBytesToRead));
+      }
+
+      for (uint32 objectIdx : wave) {
+        m_decodeObjectMap.find(objectIds[objectIdx])->second.isDecoded = true;
+
+        for (uint32 parentIdx : referencedBy[objectIdx]) {
+          if (0 == --numPending[parentIdx]) {
+            nextWave.push_back(parentIdx);
+          }
+        }
+      }
+
+      std::swap(wave, nextWave);
+      nextWave.clear();
+    }
+  }
+
   uint8*
   BinarySerializer::encodeEntry(IReflectable* object,
                                 uint32 objectId,
@@ -320,54 +794,69 @@ m_totalBytesRead -= size;                                                     \
                                 uint32* bytesWritten,
                                 function<uint8*(uint8*, uint32, uint32&)> flushBufferCallback,
                                 bool shallow) {
-    RTTITypeBase* rtti = object->getRTTI();
+    const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
     bool isBaseClass = false;
 
+    //Values written while encoding an entry for deduplication are already
+    //covered by the reference to that entry
+    const bool deduplicate = m_deduplicate && 0 == m_dedupSuspended;
+
     FrameStack<RTTITypeBase*> rttiInstances;
+    uint8 metaBuffer[MAX_META_SIZE];
 
     const auto cleanup = [&]() {
       while (!rttiInstances.empty()) {
         RTTITypeBase* rttiInstance = rttiInstances.top();
         rttiInstance->onSerializationEnded(object, m_context);
-        m_alloc->destruct(rttiInstance);
+        RTTITypeBase::_releaseInstance(rttiInstance, *m_alloc);
 
         rttiInstances.pop();
       }
     };
 
     //If an object has base classes, we need to iterate through all of them
-    do {
-      RTTITypeBase* rttiInstance = rtti->_clone(*m_alloc);
+    for (const auto& classEntry : plan.classes) {
+      RTTITypeBase* rtti = classEntry.rtti;
+      RTTITypeBase* rttiInstance = rtti->_getInstance(*m_alloc);
       rttiInstances.push(rttiInstance);
 
       rtti->onSerializationStarted(object, m_context);
 
       //Encode object ID & type
       ObjectMetaData objectMetaData = encodeObjectMetaData(objectId,
-                                                           rtti->getRTTIId(),
+                                                           classEntry.rttiId,
                                                            isBaseClass);
-      COPY_TO_BUFFER(&objectMetaData, sizeof(ObjectMetaData));
+      const uint32 objectMetaSize = writeObjectMetaData(objectMetaData, metaBuffer);
+      COPY_TO_BUFFER(metaBuffer, objectMetaSize)
 
-      const uint32 numFields = rtti->getNumFields();
-      for (uint32 i = 0; i < numFields; ++i) {
-        RTTIField* curGenericField = rtti->getField(i);
+      const uint32 lastField = classEntry.firstField + classEntry.numFields;
+      for (uint32 i = classEntry.firstField; i < lastField; ++i) {
+        const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+        RTTIField* curGenericField = fieldEntry.field;
 
-        //Copy field ID & other meta-data like field size and type
-        uint32 metaData = encodeFieldMetaData(curGenericField->m_uniqueId,
-                                           static_cast<uint8>(curGenericField->getTypeSize()),
-                                           curGenericField->m_isVectorType,
-                                           curGenericField->m_type,
-                                           curGenericField->hasDynamicSize(),
-                                           false);
-        COPY_TO_BUFFER(&metaData, META_SIZE)
+        const bool hasReferences = deduplicate &&
+          (SERIALIZABLE_FIELD_TYPE::kReflectable == fieldEntry.type ||
+           SERIALIZABLE_FIELD_TYPE::kDataBlock == fieldEntry.type);
 
-        if (curGenericField->m_isVectorType) {
+        //Copy field ID & other meta-data like field size and type
+        uint32 metaData = encodeFieldMetaData(fieldEntry.uniqueId,
+                                              static_cast<uint8>(fieldEntry.typeSize),
+                                              fieldEntry.isArray,
+                                              fieldEntry.type,
+                                              fieldEntry.hasDynamicSize,
+                                              false,
+                                              hasReferences);
+        const uint32 metaSize = writeFieldMetaData(metaData, metaBuffer);
+        COPY_TO_BUFFER(metaBuffer, metaSize)
+
+        if (fieldEntry.isArray) {
           uint32 arrayNumElems = curGenericField->getArraySize(rttiInstance, object);
 
           //Copy num vector elements
-          COPY_TO_BUFFER(&arrayNumElems, NUM_ELEM_FIELD_SIZE);
+          const uint32 numElemsSize = writeUInt32(arrayNumElems, metaBuffer);
+          COPY_TO_BUFFER(metaBuffer, numElemsSize)
 
-          switch (curGenericField->m_type)
+          switch (fieldEntry.type)
           {
             case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
             {
@@ -381,7 +870,8 @@ m_totalBytesRead -= size;                                                     \
                 }
 
                 uint32 objId = registerObjectPtr(childObject);
-                COPY_TO_BUFFER(&objId, sizeof(uint32));
+                const uint32 objIdSize = writeUInt32(objId, metaBuffer);
+                COPY_TO_BUFFER(metaBuffer, objIdSize)
               }
 
               break;
@@ -395,12 +885,22 @@ m_totalBytesRead -= size;                                                     \
                                                             object,
                                                             arrIdx);
 
-                buffer = complexTypeToBuffer(&childObject,
-                                             buffer,
-                                             bufferLength,
-                                             bytesWritten,
-                                             flushBufferCallback,
-                                             shallow);
+                if (hasReferences) {
+                  buffer = dedupComplexTypeToBuffer(&childObject,
+                                                    buffer,
+                                                    bufferLength,
+                                                    bytesWritten,
+                                                    flushBufferCallback,
+                                                    shallow);
+                }
+                else {
+                  buffer = complexTypeToBuffer(&childObject,
+                                               buffer,
+                                               bufferLength,
+                                               bytesWritten,
+                                               flushBufferCallback,
+                                               shallow);
+                }
                 if (nullptr == buffer) {
                   cleanup();
                   return nullptr;
@@ -414,11 +914,11 @@ m_totalBytesRead -= size;                                                     \
 
               for (uint32 arrIdx = 0; arrIdx < arrayNumElems; ++arrIdx) {
                 uint32 typeSize = 0;
-                if (curField->hasDynamicSize()) {
+                if (fieldEntry.hasDynamicSize) {
                   typeSize = curField->getArrayElemDynamicSize(rttiInstance, object, arrIdx);
                 }
                 else {
-                  typeSize = curField->getTypeSize();
+                  typeSize = fieldEntry.typeSize;
                 }
 
                 if ((*bytesWritten + typeSize) > bufferLength) {
@@ -457,7 +957,7 @@ m_totalBytesRead -= size;                                                     \
           }
         }
         else {
-          switch (curGenericField->m_type)
+          switch (fieldEntry.type)
           {
             case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
             {
@@ -469,7 +969,8 @@ m_totalBytesRead -= size;                                                     \
               }
 
               uint32 objId = registerObjectPtr(childObject);
-              COPY_TO_BUFFER(&objId, sizeof(uint32));
+              const uint32 objIdSize = writeUInt32(objId, metaBuffer);
+              COPY_TO_BUFFER(metaBuffer, objIdSize)
               break;
             }
             case SERIALIZABLE_FIELD_TYPE::kReflectable:
@@ -477,12 +978,22 @@ m_totalBytesRead -= size;                                                     \
               auto curField = static_cast<RTTIReflectableFieldBase*>(curGenericField);
               auto& childObject = curField->getValue(rttiInstance, object);
 
-              buffer = complexTypeToBuffer(&childObject,
-                                           buffer,
-                                           bufferLength,
-                                           bytesWritten,
-                                           flushBufferCallback,
-                                           shallow);
+              if (hasReferences) {
+                buffer = dedupComplexTypeToBuffer(&childObject,
+                                                  buffer,
+                                                  bufferLength,
+                                                  bytesWritten,
+                                                  flushBufferCallback,
+                                                  shallow);
+              }
+              else {
+                buffer = complexTypeToBuffer(&childObject,
+                                             buffer,
+                                             bufferLength,
+                                             bytesWritten,
+                                             flushBufferCallback,
+                                             shallow);
+              }
               if (nullptr == buffer) {
                 cleanup();
                 return nullptr;
@@ -494,11 +1005,11 @@ m_totalBytesRead -= size;                                                     \
               auto curField = static_cast<RTTIPlainFieldBase*>(curGenericField);
 
               uint32 typeSize = 0;
-              if (curField->hasDynamicSize()) {
+              if (fieldEntry.hasDynamicSize) {
                 typeSize = curField->getDynamicSize(rttiInstance, object);
               }
               else {
-                typeSize = curField->getTypeSize();
+                typeSize = fieldEntry.typeSize;
               }
 
               if ((*bytesWritten + typeSize) > bufferLength) {
@@ -535,13 +1046,32 @@ m_totalBytesRead -= size;                                                     \
                                                                 object,
                                                                 dataBlockSize);
 
-              //Data block size
-              COPY_TO_BUFFER(&dataBlockSize, sizeof(uint32));
-
               //Data block data
               auto dataToStore = reinterpret_cast<uint8*>(ge_stack_alloc(dataBlockSize));
               blockStream->read(dataToStore, dataBlockSize);
 
+              if (hasReferences) {
+                //New values are preceded by a null reference
+                const uint32 valueOffset = m_totalBytesWritten +
+                                           *bytesWritten +
+                                           writeUInt32(0, metaBuffer);
+                uint32 reference =
+                  findOrAddDuplicateValue(BinaryFingerprint::hashBytes(dataToStore,
+                                                                       dataBlockSize),
+                                          valueOffset);
+                const uint32 referenceSize = writeUInt32(reference, metaBuffer);
+                COPY_TO_BUFFER(metaBuffer, referenceSize)
+
+                if (0 != reference) {
+                  ge_stack_free(dataToStore);
+                  break;
+                }
+              }
+
+              //Data block size
+              const uint32 dataBlockSizeSize = writeUInt32(dataBlockSize, metaBuffer);
+              COPY_TO_BUFFER(metaBuffer, dataBlockSizeSize)
+
               buffer = dataBlockToBuffer(dataToStore,
                                          dataBlockSize,
                                          buffer,
@@ -567,10 +1097,8 @@ m_totalBytesRead -= size;                                                     \
         }
       }
 
-      rtti = rtti->getBaseClass();
       isBaseClass = true;
-
-    } while (nullptr != rtti);  //Repeat until we reach the top of the inheritance hierarchy
+    }
 
     return buffer;
   }
@@ -580,10 +1108,8 @@ m_totalBytesRead -= size;                                                     \
                                 SIZE_T dataEnd,
                                 const SPtr<IReflectable>& output) {
     ObjectMetaData objectMetaData;
-    objectMetaData.objectMeta = 0;
-    objectMetaData.typeId = 0;
-
-    READ_FROM_BUFFER(&objectMetaData, sizeof(ObjectMetaData))
+    objectMetaData.objectMeta = readMetaData(data);
+    objectMetaData.typeId = readUInt32(data);
 
     uint32 objectId = 0;
     uint32 objectTypeId = 0;
@@ -601,6 +1127,9 @@ m_totalBytesRead -= size;                                                     \
       rtti = output->getRTTI();
     }
 
+    Map<uint32, ObjectToDecode>& decodeObjectMap =
+      nullptr != m_sharedDecodeObjectMap ? *m_sharedDecodeObjectMap : m_decodeObjectMap;
+
     FrameVector<RTTITypeBase*> rttiInstances;
 
     auto finalizeObject = [&rttiInstances, this](IReflectable* object) {
@@ -611,7 +1140,7 @@ m_totalBytesRead -= size;                                                     \
         RTTITypeBase* curRTTI = *iter;
 
         curRTTI->onDeserializationEnded(object, m_context);
-        m_alloc->destruct(curRTTI);
+        RTTITypeBase::_releaseInstance(curRTTI, *m_alloc);
       }
 
       rttiInstances.clear();
@@ -619,7 +1148,7 @@ m_totalBytesRead -= size;                                                     \
 
     RTTITypeBase* curRTTI = rtti;
     while (curRTTI) {
-      RTTITypeBase* rttiInstance = curRTTI->_clone(*m_alloc);
+      RTTITypeBase* rttiInstance = curRTTI->_getInstance(*m_alloc);
       rttiInstances.push_back(rttiInstance);
 
       curRTTI = curRTTI->getBaseClass();
@@ -637,17 +1166,14 @@ m_totalBytesRead -= size;                                                     \
     }
 
     while (data->tell() < dataEnd) {
-      int32 metaData = -1;
-      READ_FROM_BUFFER(&metaData, META_SIZE)
+      const SIZE_T metaStart = data->tell();
+      uint32 metaData = readMetaData(data);
 
       if (isObjectMetaData(metaData)){
         //We've reached a new object or a base class of the current one
         ObjectMetaData objMetaData;
-        objMetaData.objectMeta = 0;
-        objMetaData.typeId = 0;
-
-        SEEK_BACK(META_SIZE)
-        READ_FROM_BUFFER(&objMetaData, sizeof(ObjectMetaData))
+        objMetaData.objectMeta = metaData;
+        objMetaData.typeId = readUInt32(data);
 
         uint32 objId = 0;
         uint32 objTypeId = 0;
@@ -676,7 +1202,8 @@ m_totalBytesRead -= size;                                                     \
         }
         else {
           //Found new object, we're done
-          SEEK_BACK(sizeof(ObjectMetaData))
+          const auto objMetaSize = static_cast<uint32>(data->tell() - metaStart);
+          SEEK_BACK(objMetaSize)
 
           finalizeObject(output.get());
           return true;
@@ -689,13 +1216,15 @@ m_totalBytesRead -= size;                                                     \
       uint8 fieldSize;
       bool hasDynamicSize;
       bool terminator;
+      bool hasReferences;
       decodeFieldMetaData(metaData,
                           fieldId,
                           fieldSize,
                           isArray,
                           fieldType,
                           hasDynamicSize,
-                          terminator);
+                          terminator,
+                          hasReferences);
 
       if (terminator) {
         /*
@@ -741,7 +1270,7 @@ m_totalBytesRead -= size;                                                     \
 
       int32 arrayNumElems = 1;
       if (isArray) {
-        READ_FROM_BUFFER(&arrayNumElems, NUM_ELEM_FIELD_SIZE)
+        arrayNumElems = static_cast<int32>(readUInt32(data));
 
         if (nullptr != curGenericField) {
           curGenericField->setArraySize(rttiInstance, output.get(), arrayNumElems);
@@ -753,13 +1282,16 @@ m_totalBytesRead -= size;                                                     \
             auto curField = static_cast<RTTIReflectablePtrFieldBase*>(curGenericField);
 
             for (int32 i = 0; i < arrayNumElems; ++i) {
-              int32 childObjectId = 0;
-              READ_FROM_BUFFER(&childObjectId, COMPLEX_TYPE_FIELD_SIZE)
+              const uint32 childObjectId = readUInt32(data);
+
+              if (nullptr != m_gatheredReferences && 0 != childObjectId) {
+                m_gatheredReferences->push_back(childObjectId);
+              }
 
               if (nullptr != curField) {
-                auto findObj = m_decodeObjectMap.find(childObjectId);
+                auto findObj = decodeObjectMap.find(childObjectId);
 
-                if (m_decodeObjectMap.end() == findObj) {
+                if (decodeObjectMap.end() == findObj) {
                   if (childObjectId != 0) {
                     GE_LOG(kWarning, Generic, "When deserializing, object "
                            "ID: {0} was found but no such object was "
@@ -818,7 +1350,19 @@ m_totalBytesRead -= size;                                                     \
                 childObj = curField->newObject();
               }
 
-              decodeEntry(data, dataEnd, childObj);
+              uint32 reference = 0;
+              if (hasReferences) {
+                reference = readUInt32(data);
+              }
+
+              if (0 == reference) {
+                decodeEntry(data, dataEnd, childObj);
+              }
+              else if (nullptr != curField || nullptr != m_gatheredReferences) {
+                decodeReferencedValue(data, reference, [&]() {
+                  decodeEntry(data, dataEnd, childObj);
+                });
+              }
 
               if (nullptr != curField) {
                 //NOTE: Would be nice to avoid this copy by value and decode
@@ -874,13 +1418,16 @@ m_totalBytesRead -= size;                                                     \
           {
             auto curField = static_cast<RTTIReflectablePtrFieldBase*>(curGenericField);
 
-            int32 childObjectId = 0;
-            READ_FROM_BUFFER(&childObjectId, COMPLEX_TYPE_FIELD_SIZE)
+            const uint32 childObjectId = readUInt32(data);
+
+            if (nullptr != m_gatheredReferences && 0 != childObjectId) {
+              m_gatheredReferences->push_back(childObjectId);
+            }
 
             if (nullptr != curField) {
-              auto findObj = m_decodeObjectMap.find(childObjectId);
+              auto findObj = decodeObjectMap.find(childObjectId);
 
-              if (m_decodeObjectMap.end() == findObj) {
+              if (decodeObjectMap.end() == findObj) {
                 if (childObjectId != 0) {
                   GE_LOG(kWarning, Generic, "When deserializing, object ID: "
                          "{0} was found but no such object was contained in "
@@ -937,7 +1484,19 @@ m_totalBytesRead -= size;                                                     \
               childObj = curField->newObject();
             }
 
-            decodeEntry(data, dataEnd, childObj);
+            uint32 reference = 0;
+            if (hasReferences) {
+              reference = readUInt32(data);
+            }
+
+            if (0 == reference) {
+              decodeEntry(data, dataEnd, childObj);
+            }
+            else if (nullptr != curField || nullptr != m_gatheredReferences) {
+              decodeReferencedValue(data, reference, [&]() {
+                decodeEntry(data, dataEnd, childObj);
+              });
+            }
 
             if (nullptr != curField) {
               //NOTE: Would be nice to avoid this copy by value and decode
@@ -981,32 +1540,45 @@ m_totalBytesRead -= size;                                                     \
           {
             auto curField = static_cast<RTTIManagedDataBlockFieldBase*>(curGenericField);
 
-            //Data block size
-            uint32 dataBlockSize = 0;
-            READ_FROM_BUFFER(&dataBlockSize, DATA_BLOCK_TYPE_FIELD_SIZE)
+            auto decodeDataBlock = [&]() {
+              //Data block size
+              const uint32 dataBlockSize = readUInt32(data);
+
+              //Data block data
+              if (nullptr != curField) {
+                if (data->isFile()) { //Allow streaming
+                  const SIZE_T dataBlockOffset = data->tell();
+                  curField->setValue(rttiInstance, output.get(), data, dataBlockSize);
+                  REPORT_READ(dataBlockSize);
+
+                  //Seek past the data
+                  //(use original offset in case the field read from the stream)
+                  data->seek(dataBlockOffset + dataBlockSize);
+                }
+                else {
+                  auto dataBlockBuffer = reinterpret_cast<uint8*>(ge_alloc(dataBlockSize));
+                  READ_FROM_BUFFER(dataBlockBuffer, dataBlockSize)
 
-            //Data block data
-            if (nullptr != curField) {
-              if (data->isFile()) { //Allow streaming
-                const SIZE_T dataBlockOffset = data->tell();
-                curField->setValue(rttiInstance, output.get(), data, dataBlockSize);
-                REPORT_READ(dataBlockSize);
-
-                //Seek past the data
-                //(use original offset in case the field read from the stream)
-                data->seek(dataBlockOffset + dataBlockSize);
+                  SPtr<DataStream> stream =
+                    ge_shared_ptr_new<MemoryDataStream>(dataBlockBuffer, dataBlockSize);
+                  curField->setValue(rttiInstance, output.get(), stream, dataBlockSize);
+                }
               }
               else {
-                auto dataBlockBuffer = reinterpret_cast<uint8*>(ge_alloc(dataBlockSize));
-                READ_FROM_BUFFER(dataBlockBuffer, dataBlockSize)
-
-                SPtr<DataStream> stream =
-                  ge_shared_ptr_new<MemoryDataStream>(dataBlockBuffer, dataBlockSize);
-                curField->setValue(rttiInstance, output.get(), stream, dataBlockSize);
+                SKIP_READ(dataBlockSize)
               }
+            };
+
+            uint32 reference = 0;
+            if (hasReferences) {
+              reference = readUInt32(data);
             }
-            else {
-              SKIP_READ(dataBlockSize)
+
+            if (0 == reference) {
+              decodeDataBlock();
+            }
+            else if (nullptr != curField) {
+              decodeReferencedValue(data, reference, decodeDataBlock);
             }
             break;
           }
@@ -1047,27 +1619,127 @@ m_totalBytesRead -= size;                                                     \
       //Complex types require terminator fields because they can be embedded
       //within other complex types and we need to know when their fields end
       //and parent's resume
-      int32 metaData = encodeFieldMetaData(0,
-                                           0,
-                                           false,
-                                           SERIALIZABLE_FIELD_TYPE::kPlain,
-                                           false,
-                                           true);
-      COPY_TO_BUFFER(&metaData, META_SIZE)
+      uint32 metaData = encodeFieldMetaData(0,
+                                            0,
+                                            false,
+                                            SERIALIZABLE_FIELD_TYPE::kPlain,
+                                            false,
+                                            true);
+      uint8 metaBuffer[MAX_META_SIZE];
+      const uint32 metaSize = writeFieldMetaData(metaData, metaBuffer);
+      COPY_TO_BUFFER(metaBuffer, metaSize)
     }
 
     return buffer;
   }
 
+  uint8*
+  BinarySerializer::dedupComplexTypeToBuffer(IReflectable* object,
+                                             uint8* buffer,
+                                             uint32& bufferLength,
+                                             uint32* bytesWritten,
+                                             function<uint8*(uint8*, uint32, uint32&)>
+                                             flushBufferCallback,
+                                             bool shallow) {
+    //Encode the entry on its own first, so its contents can be hashed.
+    //Any nested values are written inline as part of it.
+    static CONSTEXPR uint32 SCRATCH_CHUNK_SIZE = 4096;
+    uint8 scratchChunk[SCRATCH_CHUNK_SIZE];
+    uint32 scratchLength = SCRATCH_CHUNK_SIZE;
+    uint32 scratchWritten = 0;
+
+    const uint32 totalBytesWritten = m_totalBytesWritten;
+    m_dedupScratch.clear();
+    ++m_dedupSuspended;
+
+    uint8* scratchEnd = complexTypeToBuffer(object,
+                                            scratchChunk,
+                                            scratchLength,
+                                            &scratchWritten,
+                                            [this](uint8* chunk,
+                                                   uint32 size,
+                                                   uint32& length) {
+                                              m_dedupScratch.insert(m_dedupScratch.end(),
+                                                                    chunk,
+                                                                    chunk + size);
+                                              length = SCRATCH_CHUNK_SIZE;
+                                              return chunk;
+                                            },
+                                            shallow);
+
+    --m_dedupSuspended;
+    m_totalBytesWritten = totalBytesWritten;
+
+    if (nullptr == scratchEnd) {
+      return nullptr;
+    }
+
+    m_dedupScratch.insert(m_dedupScratch.end(), scratchChunk, scratchChunk + scratchWritten);
+    const auto entrySize = static_cast<uint32>(m_dedupScratch.size());
+
+    //New values are preceded by a null reference
+    uint8 referenceBuffer[MAX_META_SIZE];
+    const uint32 valueOffset = m_totalBytesWritten +
+                               *bytesWritten +
+                               writeUInt32(0, referenceBuffer);
+    uint32 reference =
+      findOrAddDuplicateValue(BinaryFingerprint::hashBytes(m_dedupScratch.data(), entrySize),
+                              valueOffset);
+    const uint32 referenceSize = writeUInt32(reference, referenceBuffer);
+    COPY_TO_BUFFER(referenceBuffer, referenceSize)
+
+    if (0 != reference) {
+      return buffer;
+    }
+
+    return dataBlockToBuffer(m_dedupScratch.data(),
+                             entrySize,
+                             buffer,
+                             bufferLength,
+                             bytesWritten,
+                             flushBufferCallback);
+  }
+
+  uint32
+  BinarySerializer::findOrAddDuplicateValue(const ObjectFingerprint& hash, uint32 offset) {
+    auto iterFind = m_duplicateValues.find(hash.low);
+    if (m_duplicateValues.end() != iterFind) {
+      //Entries that only match in one half are left alone
+      return iterFind->second.high == hash.high ? iterFind->second.value : 0;
+    }
+
+    m_duplicateValues.insert(make_pair(hash.low, DuplicateEntry{ hash.high, offset }));
+    return 0;
+  }
+
+  void
+  BinarySerializer::decodeReferencedValue(const SPtr<DataStream>& data,
+                                          uint32 reference,
+                                          const function<void()>& decodeValue) {
+    //The referenced value was already accounted for when it was first read
+    const SIZE_T curOffset = data->tell();
+    const uint32 totalBytesRead = m_totalBytesRead;
+    function<void(float)> reportProgress = move(m_reportProgress);
+    m_reportProgress = nullptr;
+
+    data->seek(m_decodeStart + reference);
+    decodeValue();
+
+    data->seek(curOffset);
+    m_totalBytesRead = totalBytesRead;
+    m_reportProgress = move(reportProgress);
+  }
+
   uint32
   BinarySerializer::encodeFieldMetaData(uint16 id,
                                         uint8 size,
                                         bool array,
                                         SERIALIZABLE_FIELD_TYPE::E type,
                                         bool hasDynamicSize,
-                                        bool terminator) {
+                                        bool terminator,
+                                        bool hasReferences) {
     // If O == 0 - Meta contains field information (Encoded using this method)
-    //// Encoding: IIII IIII IIII IIII SSSS SSSS xTYP DCAO
+    //// Encoding: IIII IIII IIII IIII SSSS SSSS RTYP DCAO
     //// I - Id
     //// S - Size
     //// C - Complex
@@ -1077,6 +1749,8 @@ m_totalBytesRead -= size;                                                     \
     //// O - Object descriptor
     //// Y - Plain field has dynamic size
     //// T - Terminator (last field in an object)
+    //// R - Values are preceded by a reference to an identical earlier value
+    ////     (offset from the start of the data, or 0 if the value follows)
 
     return (id << 16 | size << 8 |
            (array ? 0x02 : 0) |
@@ -1084,7 +1758,8 @@ m_totalBytesRead -= size;                                                     \
            ((type == SERIALIZABLE_FIELD_TYPE::kReflectable) ? 0x08 : 0) |
            ((type == SERIALIZABLE_FIELD_TYPE::kReflectablePtr) ? 0x10 : 0) |
            (hasDynamicSize ? 0x20 : 0) |
-           (terminator ? 0x40 : 0));
+           (terminator ? 0x40 : 0) |
+           (hasReferences ? 0x80 : 0));
     //TODO: Low priority. Technically I could encode this much more tightly,
     //and use var-ints for ID
   }
@@ -1096,13 +1771,15 @@ m_totalBytesRead -= size;                                                     \
                                         bool& array,
                                         SERIALIZABLE_FIELD_TYPE::E& type,
                                         bool& hasDynamicSize,
-                                        bool& terminator) {
+                                        bool& terminator,
+                                        bool& hasReferences) {
     if (isObjectMetaData(encodedData)) {
       GE_EXCEPT(InternalErrorException,
                 "Meta data represents an object description but is trying to "
                 "be decoded as a field descriptor.");
     }
 
+    hasReferences = (encodedData & 0x80) != 0;
     terminator = (encodedData & 0x40) != 0;
     hasDynamicSize = (encodedData & 0x20) != 0;
 
@@ -1165,6 +1842,92 @@ m_totalBytesRead -= size;                                                     \
     return ((encodedData & 0x01) != 0);
   }
 
+  uint32
+  BinarySerializer::writeFieldMetaData(uint32 metaData, uint8* output) const {
+    if (!m_compact) {
+      memcpy(output, &metaData, META_SIZE);
+      return META_SIZE;
+    }
+
+    //Compact encoding: varint(IIII IIII IIII IIII RTYP DCAO) [SSSS SSSS]
+    //The size is only stored for plain fields of fixed size, the rest of the
+    //fields always store 0
+    const uint32 flags = metaData & 0xFF;
+    uint32 size = writeVarInt(((metaData >> 16) << 8) | flags, output);
+    if (0 == (flags & (0x20 | 0x40))) {
+      output[size++] = static_cast<uint8>((metaData >> 8) & 0xFF);
+    }
+
+    return size;
+  }
+
+  uint32
+  BinarySerializer::writeObjectMetaData(const ObjectMetaData& metaData,
+                                        uint8* output) const {
+    if (!m_compact) {
+      memcpy(output, &metaData, sizeof(ObjectMetaData));
+      return sizeof(ObjectMetaData);
+    }
+
+    const uint32 size = writeVarInt(metaData.objectMeta, output);
+    return size + writeVarInt(metaData.typeId, output + size);
+  }
+
+  uint32
+  BinarySerializer::writeUInt32(uint32 value, uint8* output) const {
+    if (!m_compact) {
+      memcpy(output, &value, sizeof(uint32));
+      return sizeof(uint32);
+    }
+
+    return writeVarInt(value, output);
+  }
+
+  uint32
+  BinarySerializer::readMetaData(const SPtr<DataStream>& data) {
+    if (!m_compact) {
+      uint32 metaData = 0;
+      READ_FROM_BUFFER(&metaData, META_SIZE)
+      return metaData;
+    }
+
+    //Both field and object meta data keep the object flag in the lowest bit
+    const uint32 value = readUInt32(data);
+    if (isObjectMetaData(value)) {
+      return value;
+    }
+
+    const uint32 flags = value & 0xFF;
+    uint8 size = 0;
+    if (0 == (flags & (0x20 | 0x40))) {
+      READ_FROM_BUFFER(&size, sizeof(size))
+    }
+
+    return ((value >> 8) << 16) | (static_cast<uint32>(size) << 8) | flags;
+  }
+
+  uint32
+  BinarySerializer::readUInt32(const SPtr<DataStream>& data) {
+    uint32 value = 0;
+    if (!m_compact) {
+      READ_FROM_BUFFER(&value, sizeof(uint32))
+      return value;
+    }
+
+    for (uint32 i = 0; i < MAX_VARINT_SIZE; ++i) {
+      uint8 byte = 0;
+      READ_FROM_BUFFER(&byte, sizeof(byte))
+
+      value |= static_cast<uint32>(byte & 0x7F) << (7 * i);
+      if (0 == (byte & 0x80)) {
+        return value;
+      }
+    }
+
+    GE_EXCEPT(InternalErrorException, "Error decoding data.");
+    return 0;
+  }
+
   uint8*
   BinarySerializer::dataBlockToBuffer(uint8* data,
                               uint32 size,
@@ -1222,10 +1985,48 @@ m_totalBytesRead -= size;                                                     \
 
     auto ptrAddress = reinterpret_cast<void*>(object.get());
 
+    //Objects encoded by a parallel encode were all assigned IDs beforehand
+    if (nullptr != m_assignedObjectIds) {
+      auto iterAssigned = m_assignedObjectIds->find(ptrAddress);
+      if (m_assignedObjectIds->end() == iterAssigned) {
+        m_unassignedObjectFound = true;
+        return 0;
+      }
+
+      return iterAssigned->second;
+    }
+
     auto iterFind = m_objectAddrToId.find(ptrAddress);
     if (m_objectAddrToId.end() == iterFind) {
+      ObjectFingerprint fingerprint;
+      bool canDeduplicate = false;
+      if (m_deduplicate) {
+        BinaryFingerprint::compute(*object, &m_fingerprintCache);
+
+        //Objects in a reference cycle that leaves them aren't cached, as
+        //their fingerprint depends on where the walk started
+        canDeduplicate = m_fingerprintCache.find(object.get(), 0, fingerprint);
+      }
+
+      if (canDeduplicate) {
+        auto iterDuplicate = m_duplicateObjects.find(fingerprint.low);
+        if (m_duplicateObjects.end() != iterDuplicate &&
+            iterDuplicate->second.high == fingerprint.high) {
+          //Keep the object alive, so its address isn't reused by another one
+          m_duplicatesToKeep.push_back(object);
+          m_objectAddrToId.insert(make_pair(ptrAddress, iterDuplicate->second.value));
+
+          return iterDuplicate->second.value;
+        }
+      }
+
       uint32 objId = findOrCreatePersistentId(object.get());
 
+      if (canDeduplicate) {
+        m_duplicateObjects.insert(make_pair(fingerprint.low,
+                                            DuplicateEntry{ fingerprint.high, objId }));
+      }
+
       m_objectsToEncode.emplace_back(objId, object);
       m_objectAddrToId.insert(make_pair(ptrAddress, objId));
 
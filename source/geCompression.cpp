@@ -18,109 +18,912 @@
 /*****************************************************************************/
 #include "geCompression.h"
 #include "geDataStream.h"
+#include "geTaskScheduler.h"
 #include "geDebug.h"
+#include "geSIMD.h"
+#define LZ4_STATIC_LINKING_ONLY
 #include "Externals/lz4.h"
 
 namespace geEngineSDK {
-  using std::static_pointer_cast;
+  using std::atomic;
+  using std::max;
+  using std::min;
+
+  /**
+   * Layout of a compressed frame:
+   *
+   *  FrameHeader
+   *  BlockHeader + block data    (repeated for each block)
+   *  BlockHeader { 0, 0 }        (end of blocks marker)
+   *  uint64 x numBlocks          (offset of each BlockHeader from frame start)
+   *  FrameFooter
+   *
+   * The block headers allow the frame to be read sequentially, while the
+   * footer and the block index allow random access to any block.
+   */
+  namespace {
+    /**
+     * "GELZFRM1". Read as the uint64 size header of the old single block
+     * format this would be a size far above what LZ4 can handle, so both
+     * formats can't be confused.
+     */
+    CONSTEXPR uint64 FRAME_MAGIC = 0x314D52465A4C4547ULL;
+    CONSTEXPR uint32 FOOTER_MAGIC = 0x465A4547; //"GEZF"
+    CONSTEXPR uint16 FRAME_VERSION = 1;
+
+    /**
+     * Set on BlockHeader::compSize when the block data is stored as is,
+     * because compressing it didn't make it smaller.
+     */
+    CONSTEXPR uint32 BLOCK_UNCOMPRESSED_FLAG = 0x80000000;
+
+    struct FrameHeader
+    {
+      uint64 magic;
+      uint16 version;
+      uint8 filters;
+      uint8 elementSize;
+      uint32 blockSize;
+    };
+
+    struct BlockHeader
+    {
+      uint32 compSize;
+      uint32 rawSize;
+    };
+
+    struct FrameFooter
+    {
+      uint64 rawSize;
+      uint64 indexOffset;
+      uint32 numBlocks;
+      uint32 magic;
+    };
+
+    /**
+     * Data compressed with a dictionary is stored as a single block preceded
+     * by this header. Read as the uint64 size header of the old single block
+     * format the dictionary ID makes it bigger than what LZ4 can handle.
+     */
+    CONSTEXPR uint32 DICT_MAGIC = 0x445A4547; //"GEZD"
+
+    struct DictBlockHeader
+    {
+      uint32 magic;
+      uint32 dictId;
+      BlockHeader block;
+    };
+
+    /**
+     * Length of the byte sequences counted when training a dictionary, and
+     * length of the segments of the samples the dictionary is made of.
+     */
+    CONSTEXPR uint32 DICT_KMER_SIZE = 8;
+    CONSTEXPR uint32 DICT_SEGMENT_SIZE = 64;
+    CONSTEXPR uint32 DICT_HASH_BITS = 20;
+
+    /**
+     * @brief Calls @p worker for each block, splitting the blocks among the
+     *        TaskScheduler workers if possible.
+     */
+    void
+    runOnBlocks(uint32 numBlocks,
+                bool parallel,
+                const function<void(uint32)>& worker,
+                const function<void(float)>& reportProgress) {
+      uint32 numWorkers = 1;
+      if (parallel && numBlocks > 1 && TaskScheduler::isStarted()) {
+        numWorkers = min(numBlocks, TaskScheduler::instance().getNumWorkers());
+      }
+
+      if (numWorkers <= 1) {
+        for (uint32 i = 0; i < numBlocks; ++i) {
+          worker(i);
+          if (reportProgress) {
+            reportProgress(static_cast<float>(i + 1) / numBlocks);
+          }
+        }
+        return;
+      }
+
+      //Each task works on a contiguous range of blocks
+      auto taskGroup = TaskGroup::create("Compression",
+      [&](uint32 taskIdx) {
+        const uint32 first = (numBlocks * taskIdx) / numWorkers;
+        const uint32 last = (numBlocks * (taskIdx + 1)) / numWorkers;
+        for (uint32 i = first; i < last; ++i) {
+          worker(i);
+        }
+      },
+      numWorkers);
+
+      TaskScheduler::instance().addTaskGroup(taskGroup);
+      taskGroup->wait();
+
+      if (reportProgress) {
+        reportProgress(1.0f);
+      }
+    }
+
+    /**
+     * @brief Returns a pointer to the remaining data of a memory stream, or
+     *        null if the stream isn't memory backed.
+     */
+    uint8*
+    getMemoryPtr(DataStream* stream) {
+      auto memStream = dynamic_cast<MemoryDataStream*>(stream);
+      if (nullptr == memStream) {
+        return nullptr;
+      }
+      return memStream->getCurrentPtr();
+    }
+
+    /**
+     * @brief Decompresses the old format: a uint64 with the size of the
+     *        original data followed by a single LZ4 block.
+     */
+    SPtr<MemoryDataStream>
+    decompressLegacy(const uint8* src, SIZE_T srcSize) {
+      uint64 originalDataSize = 0;
+      if (srcSize > sizeof(uint64)) {
+        memcpy(&originalDataSize, src, sizeof(uint64));
+      }
+
+      if (!originalDataSize) {
+        GE_LOG(kError, Generic, "Invalid compressed data");
+        return nullptr;
+      }
+
+      //Create a buffer the size of the original data
+      SPtr<MemoryDataStream> decompData = ge_shared_ptr_new<MemoryDataStream>
+                                          (static_cast<SIZE_T>(originalDataSize));
+
+      int32 decompSize = LZ4_decompress_safe(reinterpret_cast<const char*>(src) +
+                                               sizeof(uint64),
+                                             reinterpret_cast<char*>(decompData->getPtr()),
+                                             static_cast<int32>(srcSize - sizeof(uint64)),
+                                             static_cast<int32>(originalDataSize));
+      if (decompSize < 0) {
+        GE_LOG(kError, Generic, "Failure trying to decompress the data.");
+        return nullptr;
+      }
+
+      if (static_cast<uint64>(decompSize) != originalDataSize) {
+        GE_LOG(kError, Generic, "Difference in data compressed and decompressed.");
+        return nullptr;
+      }
+
+      return decompData;
+    }
+
+    /**
+     * @brief Decompresses a single block into @p dst.
+     * @return  false if the block is corrupt.
+     */
+    bool
+    decompressBlock(const BlockHeader& header,
+                    const uint8* src,
+                    uint8* dst,
+                    uint32 maxRawSize) {
+      if (header.rawSize > maxRawSize) {
+        return false;
+      }
+
+      if (header.compSize & BLOCK_UNCOMPRESSED_FLAG) {
+        if ((header.compSize & ~BLOCK_UNCOMPRESSED_FLAG) != header.rawSize) {
+          return false;
+        }
+        memcpy(dst, src, header.rawSize);
+        return true;
+      }
+
+      int32 decompSize = LZ4_decompress_safe(reinterpret_cast<const char*>(src),
+                                             reinterpret_cast<char*>(dst),
+                                             static_cast<int32>(header.compSize),
+                                             static_cast<int32>(header.rawSize));
+      return decompSize == static_cast<int32>(header.rawSize);
+    }
+
+    /**
+     * @brief Compresses a single block into @p dst, which must be able to hold
+     *        LZ4_compressBound(rawSize) bytes.
+     * @return  The value to store in BlockHeader::compSize.
+     */
+    uint32
+    compressBlock(const uint8* src, uint32 rawSize, uint8* dst, int32 acceleration) {
+      const int32 bound = LZ4_compressBound(static_cast<int32>(rawSize));
+      const int32 compSize = LZ4_compress_fast(reinterpret_cast<const char*>(src),
+                                               reinterpret_cast<char*>(dst),
+                                               static_cast<int32>(rawSize),
+                                               bound,
+                                               acceleration);
+      if (compSize <= 0 || static_cast<uint32>(compSize) >= rawSize) {
+        return rawSize | BLOCK_UNCOMPRESSED_FLAG;
+      }
+      return static_cast<uint32>(compSize);
+    }
+
+    SIZE_T
+    getStoredSize(uint32 compSize) {
+      return compSize & ~BLOCK_UNCOMPRESSED_FLAG;
+    }
+
+    FrameHeader
+    makeFrameHeader(const CompressionOptions& options) {
+      FrameHeader header;
+      header.magic = FRAME_MAGIC;
+      header.version = FRAME_VERSION;
+      header.filters = static_cast<uint8>(options.filters);
+      header.elementSize = options.filters ? static_cast<uint8>(options.elementSize) : 0;
+      header.blockSize = options.blockSize;
+      return header;
+    }
+
+    /**
+     * Filters are stored in one byte of the frame header.
+     */
+    CONSTEXPR uint32 VALID_FILTERS =
+      static_cast<uint32>(COMPRESSION_FILTER::kByteShuffle) |
+      static_cast<uint32>(COMPRESSION_FILTER::kBitShuffle) |
+      static_cast<uint32>(COMPRESSION_FILTER::kDelta) |
+      static_cast<uint32>(COMPRESSION_FILTER::kXorDelta);
+
+    using simd::uint8x16;
+
+    /**
+     * @brief Splits K vectors holding 16 interleaved elements of K bytes into
+     *        K vectors each holding the same byte of the 16 elements.
+     */
+    template<uint32 K>
+    void
+    deinterleave(uint8x16 (&v)[K]) {
+      for (uint32 level = 1; level < K; level <<= 1) {
+        uint8x16 t[K];
+        for (uint32 j = 0; j < K / 2; ++j) {
+          t[j] = simd::unzip16_lo(v[2 * j], v[2 * j + 1]);
+          t[K / 2 + j] = simd::unzip16_hi(v[2 * j], v[2 * j + 1]);
+        }
+        for (uint32 j = 0; j < K; ++j) {
+          v[j] = t[j];
+        }
+      }
+    }
+
+    /**
+     * @brief Inverse of deinterleave().
+     */
+    template<uint32 K>
+    void
+    interleave(uint8x16 (&v)[K]) {
+      for (uint32 level = 1; level < K; level <<= 1) {
+        uint8x16 t[K];
+        for (uint32 j = 0; j < K / 2; ++j) {
+          t[2 * j] = simd::zip16_lo(v[j], v[K / 2 + j]);
+          t[2 * j + 1] = simd::zip16_hi(v[j], v[K / 2 + j]);
+        }
+        for (uint32 j = 0; j < K; ++j) {
+          v[j] = t[j];
+        }
+      }
+    }
+
+    /**
+     * @brief Byte shuffle of @p numElems elements of K bytes, 16 at a time.
+     * @return  Number of elements processed.
+     */
+    template<uint32 K>
+    SIZE_T
+    byteShuffleSIMD(const uint8* src, uint8* dst, SIZE_T numElems) {
+      const SIZE_T numSIMD = numElems & ~static_cast<SIZE_T>(15);
+      for (SIZE_T i = 0; i < numSIMD; i += 16) {
+        uint8x16 v[K];
+        for (uint32 j = 0; j < K; ++j) {
+          v[j] = simd::load_u(src + i * K + j * 16);
+        }
+        deinterleave<K>(v);
+        for (uint32 j = 0; j < K; ++j) {
+          simd::store_u(dst + j * numElems + i, v[j]);
+        }
+      }
+      return numSIMD;
+    }
+
+    /**
+     * @brief Inverse of byteShuffleSIMD().
+     */
+    template<uint32 K>
+    SIZE_T
+    byteUnshuffleSIMD(const uint8* src, uint8* dst, SIZE_T numElems) {
+      const SIZE_T numSIMD = numElems & ~static_cast<SIZE_T>(15);
+      for (SIZE_T i = 0; i < numSIMD; i += 16) {
+        uint8x16 v[K];
+        for (uint32 j = 0; j < K; ++j) {
+          v[j] = simd::load_u(src + j * numElems + i);
+        }
+        interleave<K>(v);
+        for (uint32 j = 0; j < K; ++j) {
+          simd::store_u(dst + i * K + j * 16, v[j]);
+        }
+      }
+      return numSIMD;
+    }
+
+    /**
+     * @brief Stores the n-th byte of every element contiguously. The bytes
+     *        past the last whole element are copied as is.
+     */
+    void
+    byteShuffle(const uint8* src, uint8* dst, SIZE_T size, uint32 elemSize) {
+      const SIZE_T numElems = size / elemSize;
+
+      SIZE_T done = 0;
+      switch (elemSize)
+      {
+        case 2: done = byteShuffleSIMD<2>(src, dst, numElems); break;
+        case 4: done = byteShuffleSIMD<4>(src, dst, numElems); break;
+        case 8: done = byteShuffleSIMD<8>(src, dst, numElems); break;
+        case 16: done = byteShuffleSIMD<16>(src, dst, numElems); break;
+        default: break;
+      }
+
+      for (SIZE_T i = done; i < numElems; ++i) {
+        for (uint32 j = 0; j < elemSize; ++j) {
+          dst[j * numElems + i] = src[i * elemSize + j];
+        }
+      }
+
+      const SIZE_T tail = numElems * elemSize;
+      memcpy(dst + tail, src + tail, size - tail);
+    }
+
+    /**
+     * @brief Inverse of byteShuffle().
+     */
+    void
+    byteUnshuffle(const uint8* src, uint8* dst, SIZE_T size, uint32 elemSize) {
+      const SIZE_T numElems = size / elemSize;
+
+      SIZE_T done = 0;
+      switch (elemSize)
+      {
+        case 2: done = byteUnshuffleSIMD<2>(src, dst, numElems); break;
+        case 4: done = byteUnshuffleSIMD<4>(src, dst, numElems); break;
+        case 8: done = byteUnshuffleSIMD<8>(src, dst, numElems); break;
+        case 16: done = byteUnshuffleSIMD<16>(src, dst, numElems); break;
+        default: break;
+      }
+
+      for (SIZE_T i = done; i < numElems; ++i) {
+        for (uint32 j = 0; j < elemSize; ++j) {
+          dst[i * elemSize + j] = src[j * numElems + i];
+        }
+      }
+
+      const SIZE_T tail = numElems * elemSize;
+      memcpy(dst + tail, src + tail, size - tail);
+    }
+
+    /**
+     * @brief Transposes an 8x8 bit matrix stored one row per byte, so bit k
+     *        of byte j becomes bit j of byte k.
+     */
+    uint64
+    transposeBits8x8(uint64 x) {
+      uint64 t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+      x = x ^ t ^ (t << 7);
+      t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+      x = x ^ t ^ (t << 14);
+      t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+      return x ^ t ^ (t << 28);
+    }
+
+    /**
+     * @brief Splits each of the byte planes left by byteShuffle() in 8 bit
+     *        planes. Plane bytes past the last group of 8 are copied as is.
+     */
+    void
+    bitShuffle(const uint8* src, uint8* dst, SIZE_T size, uint32 elemSize) {
+      const SIZE_T numElems = size / elemSize;
+      const SIZE_T numGroups = numElems / 8;
+
+      for (uint32 plane = 0; plane < elemSize; ++plane) {
+        const uint8* in = src + plane * numElems;
+        uint8* out = dst + plane * numElems;
+
+        SIZE_T group = 0;
+        for (; group + 2 <= numGroups; group += 2) {
+          uint8x16 v = simd::load_u(in + group * 8);
+          const uint16 bits[8] = { simd::extract_bits<0>(v), simd::extract_bits<1>(v),
+                                   simd::extract_bits<2>(v), simd::extract_bits<3>(v),
+                                   simd::extract_bits<4>(v), simd::extract_bits<5>(v),
+                                   simd::extract_bits<6>(v), simd::extract_bits<7>(v) };
+          for (uint32 bit = 0; bit < 8; ++bit) {
+            memcpy(out + bit * numGroups + group, &bits[bit], sizeof(uint16));
+          }
+        }
+
+        for (; group < numGroups; ++group) {
+          uint64 rows;
+          memcpy(&rows, in + group * 8, sizeof(uint64));
+          const uint64 columns = transposeBits8x8(rows);
+          for (uint32 bit = 0; bit < 8; ++bit) {
+            out[bit * numGroups + group] = static_cast<uint8>(columns >> (bit * 8));
+          }
+        }
+
+        memcpy(out + numGroups * 8, in + numGroups * 8, numElems - numGroups * 8);
+      }
+
+      const SIZE_T tail = numElems * elemSize;
+      memcpy(dst + tail, src + tail, size - tail);
+    }
+
+    /**
+     * @brief Inverse of bitShuffle().
+     */
+    void
+    bitUnshuffle(const uint8* src, uint8* dst, SIZE_T size, uint32 elemSize) {
+      const SIZE_T numElems = size / elemSize;
+      const SIZE_T numGroups = numElems / 8;
+
+      for (uint32 plane = 0; plane < elemSize; ++plane) {
+        const uint8* in = src + plane * numElems;
+        uint8* out = dst + plane * numElems;
+
+        for (SIZE_T group = 0; group < numGroups; ++group) {
+          uint64 columns = 0;
+          for (uint32 bit = 0; bit < 8; ++bit) {
+            columns |= static_cast<uint64>(in[bit * numGroups + group]) << (bit * 8);
+          }
+          const uint64 rows = transposeBits8x8(columns);
+          memcpy(out + group * 8, &rows, sizeof(uint64));
+        }
+
+        memcpy(out + numGroups * 8, in + numGroups * 8, numElems - numGroups * 8);
+      }
+
+      const SIZE_T tail = numElems * elemSize;
+      memcpy(dst + tail, src + tail, size - tail);
+    }
+
+    template<class T, bool XOR>
+    void
+    deltaEncode(const uint8* src, uint8* dst, SIZE_T size) {
+      const SIZE_T numElems = size / sizeof(T);
+      T prev = 0;
+      for (SIZE_T i = 0; i < numElems; ++i) {
+        T value;
+        memcpy(&value, src + i * sizeof(T), sizeof(T));
+        const T delta = XOR ? static_cast<T>(value ^ prev) : static_cast<T>(value - prev);
+        memcpy(dst + i * sizeof(T), &delta, sizeof(T));
+        prev = value;
+      }
+
+      const SIZE_T tail = numElems * sizeof(T);
+      memcpy(dst + tail, src + tail, size - tail);
+    }
+
+    template<class T, bool XOR>
+    void
+    deltaDecode(const uint8* src, uint8* dst, SIZE_T size) {
+      const SIZE_T numElems = size / sizeof(T);
+      T prev = 0;
+      for (SIZE_T i = 0; i < numElems; ++i) {
+        T delta;
+        memcpy(&delta, src + i * sizeof(T), sizeof(T));
+        prev = XOR ? static_cast<T>(delta ^ prev) : static_cast<T>(delta + prev);
+        memcpy(dst + i * sizeof(T), &prev, sizeof(T));
+      }
+
+      const SIZE_T tail = numElems * sizeof(T);
+      memcpy(dst + tail, src + tail, size - tail);
+    }
+
+    template<bool XOR>
+    void
+    deltaFilter(const uint8* src, uint8* dst, SIZE_T size, uint32 elemSize, bool encode) {
+      switch (elemSize)
+      {
+        case 1:
+          encode ? deltaEncode<uint8, XOR>(src, dst, size)
+                 : deltaDecode<uint8, XOR>(src, dst, size);
+          break;
+        case 2:
+          encode ? deltaEncode<uint16, XOR>(src, dst, size)
+                 : deltaDecode<uint16, XOR>(src, dst, size);
+          break;
+        case 4:
+          encode ? deltaEncode<uint32, XOR>(src, dst, size)
+                 : deltaDecode<uint32, XOR>(src, dst, size);
+          break;
+        default:
+          encode ? deltaEncode<uint64, XOR>(src, dst, size)
+                 : deltaDecode<uint64, XOR>(src, dst, size);
+          break;
+      }
+    }
+
+    bool
+    validateFilters(CompressionFilterFlags filters, uint32 elemSize) {
+      if (!filters) {
+        return true;
+      }
+
+      const bool hasDelta = filters.isSetAny(COMPRESSION_FILTER::kDelta);
+      const bool hasXorDelta = filters.isSetAny(COMPRESSION_FILTER::kXorDelta);
+      const bool hasShuffle = filters.isSetAny(COMPRESSION_FILTER::kByteShuffle);
+      const bool hasBitShuffle = filters.isSetAny(COMPRESSION_FILTER::kBitShuffle);
+
+      if ((static_cast<uint32>(filters) & ~VALID_FILTERS) ||
+          (hasDelta && hasXorDelta) ||
+          (hasShuffle && hasBitShuffle) ||
+          0 == elemSize || 255 < elemSize) {
+        return false;
+      }
+
+      if ((hasDelta || hasXorDelta) &&
+          1 != elemSize && 2 != elemSize && 4 != elemSize && 8 != elemSize) {
+        return false;
+      }
+
+      return true;
+    }
+
+    /**
+     * @brief Applies the filters to a block of data, or reverts them.
+     * @param[in] src     Data to filter.
+     * @param[in] dst     Buffer that receives the result, @p size bytes.
+     * @param[in] scratch Buffer used for the intermediate steps, @p size bytes.
+     */
+    void
+    applyFilters(const uint8* src,
+                 uint8* dst,
+                 uint8* scratch,
+                 SIZE_T size,
+                 CompressionFilterFlags filters,
+                 uint32 elemSize,
+                 bool encode) {
+      using FilterStep = void(*)(const uint8*, uint8*, SIZE_T, uint32);
+      FilterStep steps[3];
+      uint32 numSteps = 0;
+
+      if (encode) {
+        if (filters.isSetAny(COMPRESSION_FILTER::kDelta)) {
+          steps[numSteps++] = [](const uint8* in, uint8* out, SIZE_T n, uint32 k) {
+            deltaFilter<false>(in, out, n, k, true);
+          };
+        }
+        if (filters.isSetAny(COMPRESSION_FILTER::kXorDelta)) {
+          steps[numSteps++] = [](const uint8* in, uint8* out, SIZE_T n, uint32 k) {
+            deltaFilter<true>(in, out, n, k, true);
+          };
+        }
+        if (filters.isSetAny(COMPRESSION_FILTER::kByteShuffle) ||
+            filters.isSetAny(COMPRESSION_FILTER::kBitShuffle)) {
+          steps[numSteps++] = &byteShuffle;
+        }
+        if (filters.isSetAny(COMPRESSION_FILTER::kBitShuffle)) {
+          steps[numSteps++] = &bitShuffle;
+        }
+      }
+      else {
+        if (filters.isSetAny(COMPRESSION_FILTER::kBitShuffle)) {
+          steps[numSteps++] = &bitUnshuffle;
+        }
+        if (filters.isSetAny(COMPRESSION_FILTER::kByteShuffle) ||
+            filters.isSetAny(COMPRESSION_FILTER::kBitShuffle)) {
+          steps[numSteps++] = &byteUnshuffle;
+        }
+        if (filters.isSetAny(COMPRESSION_FILTER::kDelta)) {
+          steps[numSteps++] = [](const uint8* in, uint8* out, SIZE_T n, uint32 k) {
+            deltaFilter<false>(in, out, n, k, false);
+          };
+        }
+        if (filters.isSetAny(COMPRESSION_FILTER::kXorDelta)) {
+          steps[numSteps++] = [](const uint8* in, uint8* out, SIZE_T n, uint32 k) {
+            deltaFilter<true>(in, out, n, k, false);
+          };
+        }
+      }
+
+      if (0 == numSteps) {
+        memcpy(dst, src, size);
+        return;
+      }
+
+      //Alternate between both buffers so the last step writes to dst
+      const uint8* in = src;
+      for (uint32 i = 0; i < numSteps; ++i) {
+        uint8* out = ((numSteps - 1 - i) % 2 == 0) ? dst : scratch;
+        steps[i](in, out, size, elemSize);
+        in = out;
+      }
+    }
+
+    /**
+     * @brief Returns true if the first 8 bytes of the data are the start of
+     *        a DictBlockHeader.
+     */
+    bool
+    isDictionaryBlock(uint64 magic) {
+      return DICT_MAGIC == static_cast<uint32>(magic) && 0 != (magic >> 32);
+    }
+
+    /**
+     * Compression state used by each thread to compress with a dictionary.
+     * Note: This will leak memory on thread exit, same as the frame
+     * allocator, but it's only 16KB per thread that ever used a dictionary.
+     */
+    GE_THREADLOCAL LZ4_stream_t* _dictWorkStream = nullptr;
+
+    LZ4_stream_t*
+    getDictWorkStream() {
+      if (nullptr == _dictWorkStream) {
+        _dictWorkStream = LZ4_createStream();
+      }
+      return _dictWorkStream;
+    }
+
+    /**
+     * @brief Returns the index of the k-mer starting at @p data in the table
+     *        of k-mer frequencies.
+     */
+    uint32
+    hashKmer(const uint8* data) {
+      uint64 value;
+      memcpy(&value, data, sizeof(value));
+      return static_cast<uint32>((value * 0x9E3779B185EBCA87ULL) >> (64 - DICT_HASH_BITS));
+    }
+  }
 
   SPtr<MemoryDataStream>
   Compression::compress(SPtr<DataStream>& input,
                         function<void(float)> reportProgress) {
-    //LZ4 provides a function that will tell you the maximum size of compressed
-    //output based on input data via LZ4_compressBound().
-    const auto maxDstSize = static_cast<SIZE_T>(LZ4_compressBound(
-                                                static_cast<int32>(input->size())));
-
-    //We will use that size for our destination boundary when allocating space.
-    MemoryDataStream compData(maxDstSize);
-
-    int32 compSize = -1; //Initially set to error
-    {//Make a local copy of the input data
-      MemoryDataStream inputData(input);
+    return compress(input, CompressionOptions(), reportProgress);
+  }
 
-      //Invoke LZ4_compress_default
-      compSize = LZ4_compress_default(reinterpret_cast<char*>(inputData.getPtr()),
-                                      reinterpret_cast<char*>(compData.getPtr()),
-                                      static_cast<int32>(inputData.size()),
-                                      static_cast<int32>(maxDstSize));
+  SPtr<MemoryDataStream>
+  Compression::compress(SPtr<DataStream>& input,
+                        const CompressionOptions& options,
+                        function<void(float)> reportProgress) {
+    //Memory streams are compressed in place, anything else is read first
+    SPtr<MemoryDataStream> inputCopy;
+    const uint8* src = getMemoryPtr(input.get());
+    SIZE_T srcSize = 0;
+    if (nullptr != src) {
+      srcSize = input->size() - input->tell();
+      input->skip(srcSize);
+    }
+    else {
+      inputCopy = ge_shared_ptr_new<MemoryDataStream>(input);
+      src = inputCopy->getPtr();
+      srcSize = inputCopy->size();
     }
 
-    //Check return_value to determine what happened.
-    if (compSize < 0) {
-      reportProgress(1.0f);
-      GE_LOG(kError, Generic, "Failure trying to compress the data.");
+    const uint32 blockSize = options.blockSize;
+    if (0 == blockSize || blockSize >= BLOCK_UNCOMPRESSED_FLAG) {
+      GE_LOG(kError, Generic, "Invalid compression block size: {0}", blockSize);
       return nullptr;
     }
-    else if (compSize == 0) {
-      reportProgress(1.0f);
-      GE_LOG(kError, Generic, "Destination buffer couldn't hold all the information.");
+
+    if (!validateFilters(options.filters, options.elementSize)) {
+      GE_LOG(kError, Generic, "Invalid compression filters for elements of {0} bytes.",
+             options.elementSize);
       return nullptr;
     }
 
-    //Create the return buffer set to the real size of the compression
-    //We will save the first the size of the real data, and then the data
-    SPtr<MemoryDataStream> realComp_data = ge_shared_ptr_new<MemoryDataStream>(
-                                                    compSize + sizeof(uint64));
+    const auto numBlocks = static_cast<uint32>((srcSize + blockSize - 1) / blockSize);
+    const auto slotSize = static_cast<SIZE_T>(LZ4_compressBound(
+                                              static_cast<int32>(blockSize)));
 
-    //This value indicates the real size of the data,
-    //we need to save this for decompression purposes
-    auto headerSizeData = static_cast<uint64>(input->size());
+    //Each block is compressed into its own slot, so the blocks can be
+    //processed in any order
+    auto scratch = reinterpret_cast<uint8*>(ge_alloc(slotSize * numBlocks));
+    Vector<uint32> compSizes(numBlocks);
 
-    realComp_data->write(&headerSizeData, sizeof(uint64));
-    realComp_data->write(compData.getPtr(), compSize);
+    runOnBlocks(numBlocks, options.parallel,
+    [&](uint32 blockIdx) {
+      const SIZE_T offset = static_cast<SIZE_T>(blockIdx) * blockSize;
+      const auto rawSize = static_cast<uint32>(min<SIZE_T>(blockSize, srcSize - offset));
+      uint8* slot = scratch + slotSize * blockIdx;
+
+      if (!options.filters) {
+        compSizes[blockIdx] = compressBlock(src + offset,
+                                            rawSize,
+                                            slot,
+                                            options.acceleration);
+        return;
+      }
+
+      auto filtered = reinterpret_cast<uint8*>(ge_alloc(static_cast<SIZE_T>(rawSize) * 2));
+      applyFilters(src + offset,
+                   filtered,
+                   filtered + rawSize,
+                   rawSize,
+                   options.filters,
+                   options.elementSize,
+                   true);
+
+      compSizes[blockIdx] = compressBlock(filtered, rawSize, slot, options.acceleration);
+      if (compSizes[blockIdx] & BLOCK_UNCOMPRESSED_FLAG) {
+        //The slot is always big enough to hold the block uncompressed
+        memcpy(slot, filtered, rawSize);
+      }
+      ge_free(filtered);
+    },
+    reportProgress);
+
+    SIZE_T totalSize = sizeof(FrameHeader) + sizeof(BlockHeader) +
+                       sizeof(uint64) * numBlocks + sizeof(FrameFooter);
+    for (auto compSize : compSizes) {
+      totalSize += sizeof(BlockHeader) + getStoredSize(compSize);
+    }
+
+    auto output = ge_shared_ptr_new<MemoryDataStream>(totalSize);
+
+    FrameHeader header = makeFrameHeader(options);
+    output->write(&header, sizeof(header));
+
+    Vector<uint64> blockOffsets(numBlocks);
+    for (uint32 i = 0; i < numBlocks; ++i) {
+      const SIZE_T offset = static_cast<SIZE_T>(i) * blockSize;
+      const uint8* blockData = scratch + slotSize * i;
+
+      BlockHeader blockHeader;
+      blockHeader.compSize = compSizes[i];
+      blockHeader.rawSize = static_cast<uint32>(min<SIZE_T>(blockSize, srcSize - offset));
+      if ((blockHeader.compSize & BLOCK_UNCOMPRESSED_FLAG) && !options.filters) {
+        blockData = src + offset;
+      }
+
+      blockOffsets[i] = output->tell();
+      output->write(&blockHeader, sizeof(blockHeader));
+      output->write(blockData, getStoredSize(blockHeader.compSize));
+    }
+
+    ge_free(scratch);
+
+    BlockHeader endMarker = { 0, 0 };
+    output->write(&endMarker, sizeof(endMarker));
+
+    FrameFooter footer;
+    footer.rawSize = srcSize;
+    footer.indexOffset = output->tell();
+    footer.numBlocks = numBlocks;
+    footer.magic = FOOTER_MAGIC;
+    output->write(blockOffsets.data(), sizeof(uint64) * numBlocks);
+    output->write(&footer, sizeof(footer));
 
     //Set the buffer to the starting point
-    realComp_data->seek(0);
+    output->seek(0);
 
     if (reportProgress) {
       reportProgress(1.0f);
     }
 
-    return realComp_data;
+    return output;
   }
 
   SPtr<MemoryDataStream>
   Compression::decompress(SPtr<DataStream>& input,
                           function<void(float)> reportProgress) {
-    MemoryDataStream src(input);
-    
-    //Read the original size of the data from the compressed buffer
-    uint64 originalDataSize = 0;
-    src >> originalDataSize;
+    //Memory streams are decompressed in place, anything else is read first
+    SPtr<MemoryDataStream> inputCopy;
+    const uint8* src = getMemoryPtr(input.get());
+    SIZE_T srcSize = 0;
+    if (nullptr != src) {
+      srcSize = input->size() - input->tell();
+      input->skip(srcSize);
+    }
+    else {
+      inputCopy = ge_shared_ptr_new<MemoryDataStream>(input);
+      src = inputCopy->getPtr();
+      srcSize = inputCopy->size();
+    }
+
+    uint64 magic = 0;
+    if (srcSize >= sizeof(uint64)) {
+      memcpy(&magic, src, sizeof(uint64));
+    }
 
-    if (!originalDataSize) {
+    if (isDictionaryBlock(magic)) {
       if (reportProgress) {
         reportProgress(1.0f);
       }
-      GE_LOG(kError, Generic, "Invalid compressed data");
+      GE_LOG(kError, Generic, "The data was compressed with a dictionary ({0}).",
+             static_cast<uint32>(magic >> 32));
       return nullptr;
     }
 
-    //Create a buffer the size of the original data
-    SPtr<MemoryDataStream> decompData = ge_shared_ptr_new<MemoryDataStream>
-                                        (static_cast<SIZE_T>(originalDataSize));
+    if (FRAME_MAGIC != magic) {
+      auto result = decompressLegacy(src, srcSize);
+      if (reportProgress) {
+        reportProgress(1.0f);
+      }
+      return result;
+    }
+
+    FrameHeader header;
+    FrameFooter footer;
+    bool isValid = srcSize >= sizeof(FrameHeader) + sizeof(FrameFooter);
+    if (isValid) {
+      memcpy(&header, src, sizeof(header));
+      memcpy(&footer, src + srcSize - sizeof(FrameFooter), sizeof(footer));
 
-    int32 decompSize = LZ4_decompress_safe(reinterpret_cast<char*>(src.getCurrentPtr()),
-                                           reinterpret_cast<char*>(decompData->getPtr()),
-                                           static_cast<int32>(src.size() - sizeof(uint64)),
-                                           static_cast<int32>(originalDataSize));
-    //Set the buffer to the starting point
-    decompData->seek(0);
+      isValid = FOOTER_MAGIC == footer.magic &&
+                FRAME_VERSION >= header.version &&
+                0 != header.blockSize &&
+                validateFilters(CompressionFilterFlags(static_cast<uint32>(header.filters)),
+                                header.elementSize) &&
+                footer.indexOffset + sizeof(uint64) * footer.numBlocks ==
+                  srcSize - sizeof(FrameFooter) &&
+                footer.rawSize <= static_cast<uint64>(header.blockSize) *
+                                  footer.numBlocks;
+    }
 
-    if (decompSize < 0) {
+    if (!isValid) {
       if (reportProgress) {
         reportProgress(1.0f);
       }
-      GE_LOG(kError, Generic, "Failure trying to decompress the data.");
+      GE_LOG(kError, Generic, "Invalid compressed data");
       return nullptr;
     }
-    
-    if (decompSize != originalDataSize) { //This should never happen
-      if (reportProgress) {
-        reportProgress(1.0f);
+
+    const auto rawSize = static_cast<SIZE_T>(footer.rawSize);
+    const SIZE_T indexOffset = static_cast<SIZE_T>(footer.indexOffset);
+    const uint32 blockSize = header.blockSize;
+    const CompressionFilterFlags filters(static_cast<uint32>(header.filters));
+
+    auto decompData = ge_shared_ptr_new<MemoryDataStream>(rawSize);
+    uint8* dst = decompData->getPtr();
+
+    atomic<bool> failed(false);
+    runOnBlocks(footer.numBlocks, true,
+    [&](uint32 blockIdx) {
+      uint64 blockOffset = 0;
+      memcpy(&blockOffset, src + indexOffset + sizeof(uint64) * blockIdx, sizeof(uint64));
+      if (blockOffset + sizeof(BlockHeader) > indexOffset) {
+        failed = true;
+        return;
+      }
+
+      BlockHeader blockHeader;
+      memcpy(&blockHeader, src + blockOffset, sizeof(blockHeader));
+
+      const SIZE_T dataOffset = static_cast<SIZE_T>(blockOffset) + sizeof(BlockHeader);
+      const SIZE_T dstOffset = static_cast<SIZE_T>(blockIdx) * blockSize;
+      if (dataOffset + getStoredSize(blockHeader.compSize) > indexOffset ||
+          dstOffset + blockHeader.rawSize > rawSize) {
+        failed = true;
+        return;
+      }
+
+      if (!filters) {
+        if (!decompressBlock(blockHeader, src + dataOffset, dst + dstOffset, blockSize)) {
+          failed = true;
+        }
+        return;
       }
-      GE_LOG(kError, Generic, "Difference in data compressed and decompressed.");
+
+      auto filtered = reinterpret_cast<uint8*>(ge_alloc(static_cast<SIZE_T>(blockSize) * 2));
+      if (decompressBlock(blockHeader, src + dataOffset, filtered, blockSize)) {
+        applyFilters(filtered,
+                     dst + dstOffset,
+                     filtered + blockSize,
+                     blockHeader.rawSize,
+                     filters,
+                     header.elementSize,
+                     false);
+      }
+      else {
+        failed = true;
+      }
+      ge_free(filtered);
+    },
+    reportProgress);
+
+    if (failed) {
+      GE_LOG(kError, Generic, "Failure trying to decompress the data.");
       return nullptr;
     }
 
@@ -129,4 +932,600 @@ namespace geEngineSDK {
     }
     return decompData;
   }
+
+  bool
+  Compression::isCompressedFrame(DataStream& input) {
+    const SIZE_T start = input.tell();
+
+    uint64 magic = 0;
+    const SIZE_T readBytes = input.read(&magic, sizeof(magic));
+    input.seek(start);
+
+    return sizeof(magic) == readBytes && FRAME_MAGIC == magic;
+  }
+
+  SPtr<MemoryDataStream>
+  Compression::compress(SPtr<DataStream>& input,
+                        const CompressionDictionary& dictionary,
+                        int32 acceleration) {
+    SPtr<MemoryDataStream> inputCopy;
+    const uint8* src = getMemoryPtr(input.get());
+    SIZE_T srcSize = 0;
+    if (nullptr != src) {
+      srcSize = input->size() - input->tell();
+      input->skip(srcSize);
+    }
+    else {
+      inputCopy = ge_shared_ptr_new<MemoryDataStream>(input);
+      src = inputCopy->getPtr();
+      srcSize = inputCopy->size();
+    }
+
+    if (srcSize > LZ4_MAX_INPUT_SIZE) {
+      GE_LOG(kError, Generic, "Data is too big to be compressed as a single block.");
+      return nullptr;
+    }
+
+    const auto rawSize = static_cast<uint32>(srcSize);
+
+    //Never store more than the raw data, so the output is allocated once
+    auto output = reinterpret_cast<uint8*>(ge_alloc(sizeof(DictBlockHeader) + srcSize));
+    uint8* dst = output + sizeof(DictBlockHeader);
+
+    //Attaching the dictionary only references its prepared state, the
+    //dictionary isn't loaded again
+    LZ4_stream_t* stream = getDictWorkStream();
+    LZ4_resetStream_fast(stream);
+    LZ4_attach_dictionary(stream, dictionary.m_stream);
+
+    int32 compSize = 0;
+    if (rawSize > 0) {
+      compSize = LZ4_compress_fast_continue(stream,
+                                            reinterpret_cast<const char*>(src),
+                                            reinterpret_cast<char*>(dst),
+                                            static_cast<int32>(rawSize),
+                                            static_cast<int32>(rawSize - 1),
+                                            acceleration);
+    }
+
+    DictBlockHeader header;
+    header.magic = DICT_MAGIC;
+    header.dictId = dictionary.getId();
+    header.block.rawSize = rawSize;
+    if (compSize <= 0) {
+      header.block.compSize = rawSize | BLOCK_UNCOMPRESSED_FLAG;
+      memcpy(dst, src, rawSize);
+    }
+    else {
+      header.block.compSize = static_cast<uint32>(compSize);
+    }
+    memcpy(output, &header, sizeof(header));
+
+    return ge_shared_ptr_new<MemoryDataStream>(output,
+                                               sizeof(DictBlockHeader) +
+                                                 getStoredSize(header.block.compSize));
+  }
+
+  SPtr<MemoryDataStream>
+  Compression::decompress(SPtr<DataStream>& input,
+                          const CompressionDictionary& dictionary) {
+    SPtr<MemoryDataStream> inputCopy;
+    const uint8* src = getMemoryPtr(input.get());
+    SIZE_T srcSize = 0;
+    if (nullptr != src) {
+      srcSize = input->size() - input->tell();
+      input->skip(srcSize);
+    }
+    else {
+      inputCopy = ge_shared_ptr_new<MemoryDataStream>(input);
+      src = inputCopy->getPtr();
+      srcSize = inputCopy->size();
+    }
+
+    DictBlockHeader header;
+    if (srcSize < sizeof(header)) {
+      GE_LOG(kError, Generic, "Invalid compressed data");
+      return nullptr;
+    }
+    memcpy(&header, src, sizeof(header));
+
+    if (DICT_MAGIC != header.magic ||
+        getStoredSize(header.block.compSize) != srcSize - sizeof(header)) {
+      GE_LOG(kError, Generic, "Invalid compressed data");
+      return nullptr;
+    }
+
+    if (dictionary.getId() != header.dictId) {
+      GE_LOG(kError, Generic,
+             "The data was compressed with dictionary {0} but dictionary {1} was provided.",
+             header.dictId,
+             dictionary.getId());
+      return nullptr;
+    }
+
+    auto decompData = ge_shared_ptr_new<MemoryDataStream>(
+                        static_cast<SIZE_T>(header.block.rawSize));
+    const uint8* blockData = src + sizeof(header);
+    if (header.block.compSize & BLOCK_UNCOMPRESSED_FLAG) {
+      if (getStoredSize(header.block.compSize) != header.block.rawSize) {
+        GE_LOG(kError, Generic, "Invalid compressed data");
+        return nullptr;
+      }
+      memcpy(decompData->getPtr(), blockData, header.block.rawSize);
+      return decompData;
+    }
+
+    int32 decompSize = LZ4_decompress_safe_usingDict(
+                         reinterpret_cast<const char*>(blockData),
+                         reinterpret_cast<char*>(decompData->getPtr()),
+                         static_cast<int32>(header.block.compSize),
+                         static_cast<int32>(header.block.rawSize),
+                         reinterpret_cast<const char*>(dictionary.getData()),
+                         static_cast<int32>(dictionary.getSize()));
+    if (decompSize != static_cast<int32>(header.block.rawSize)) {
+      GE_LOG(kError, Generic, "Failure trying to decompress the data.");
+      return nullptr;
+    }
+
+    return decompData;
+  }
+
+  uint32
+  Compression::getDictionaryId(DataStream& input) {
+    const SIZE_T start = input.tell();
+
+    uint64 magic = 0;
+    const SIZE_T readBytes = input.read(&magic, sizeof(magic));
+    input.seek(start);
+
+    if (sizeof(magic) != readBytes || !isDictionaryBlock(magic)) {
+      return 0;
+    }
+    return static_cast<uint32>(magic >> 32);
+  }
+
+  CompressionDictionary::CompressionDictionary(const void* data, SIZE_T size) {
+    //LZ4 can only reference the last 64KB
+    auto bytes = reinterpret_cast<const uint8*>(data);
+    if (size > MAX_SIZE) {
+      bytes += size - MAX_SIZE;
+      size = MAX_SIZE;
+    }
+    m_data.assign(bytes, bytes + size);
+
+    //FNV-1a, never 0 as that marks data without a dictionary
+    uint32 hash = 2166136261U;
+    for (auto value : m_data) {
+      hash = (hash ^ value) * 16777619U;
+    }
+    m_id = 0 != hash ? hash : 1;
+
+    m_stream = LZ4_createStream();
+    LZ4_loadDict(m_stream,
+                 reinterpret_cast<const char*>(m_data.data()),
+                 static_cast<int32>(m_data.size()));
+  }
+
+  CompressionDictionary::~CompressionDictionary() {
+    LZ4_freeStream(m_stream);
+  }
+
+  SPtr<CompressionDictionary>
+  CompressionDictionary::train(const Vector<SPtr<DataStream>>& samples, uint32 maxSize) {
+    maxSize = min(maxSize, MAX_SIZE);
+
+    //Gather all the samples in a single buffer, remembering where each ends
+    Vector<uint8> data;
+    Vector<SIZE_T> sampleEnds;
+    sampleEnds.reserve(samples.size());
+    for (auto& sample : samples) {
+      const uint8* src = getMemoryPtr(sample.get());
+      if (nullptr != src) {
+        data.insert(data.end(), src, src + (sample->size() - sample->tell()));
+      }
+      else {
+        MemoryDataStream sampleCopy(*sample);
+        data.insert(data.end(), sampleCopy.getPtr(), sampleCopy.getPtr() + sampleCopy.size());
+      }
+      sampleEnds.push_back(data.size());
+    }
+
+    if (data.size() < DICT_SEGMENT_SIZE || 0 == maxSize) {
+      return nullptr;
+    }
+
+    //Count in how many samples each k-mer appears. K-mers crossing the end
+    //of a sample use the last slot, which is always 0.
+    const uint32 emptySlot = 1U << DICT_HASH_BITS;
+    Vector<uint32> frequencies(emptySlot + 1, 0);
+    Vector<uint32> lastSample(emptySlot, NumLimit::MAX_UINT32);
+    Vector<uint32> kmers(data.size(), emptySlot);
+
+    SIZE_T sampleStart = 0;
+    for (SIZE_T i = 0; i < sampleEnds.size(); ++i) {
+      const SIZE_T sampleEnd = sampleEnds[i];
+      for (SIZE_T pos = sampleStart; pos + DICT_KMER_SIZE <= sampleEnd; ++pos) {
+        const uint32 kmer = hashKmer(&data[pos]);
+        kmers[pos] = kmer;
+        if (lastSample[kmer] != i) {
+          lastSample[kmer] = static_cast<uint32>(i);
+          ++frequencies[kmer];
+        }
+      }
+      sampleStart = sampleEnd;
+    }
+
+    //Pick the best segment of each epoch, so the dictionary covers all the
+    //samples instead of the most repeated sequence only. K-mers of chosen
+    //segments stop counting so the same content isn't picked twice.
+    struct Segment
+    {
+      SIZE_T start;
+      uint64 score;
+    };
+
+    const SIZE_T numKmers = DICT_SEGMENT_SIZE - DICT_KMER_SIZE + 1;
+    const SIZE_T numEpochs = max<SIZE_T>(1, min<SIZE_T>(maxSize / DICT_SEGMENT_SIZE,
+                                                        data.size() / DICT_SEGMENT_SIZE));
+    const SIZE_T epochSize = data.size() / numEpochs;
+
+    Vector<Segment> segments;
+    segments.reserve(numEpochs);
+    for (SIZE_T epoch = 0; epoch < numEpochs; ++epoch) {
+      const SIZE_T epochStart = epoch * epochSize;
+      const SIZE_T epochEnd = min(data.size(), epochStart + epochSize);
+      if (epochEnd - epochStart < DICT_SEGMENT_SIZE) {
+        continue;
+      }
+
+      //Sliding window with the sum of the frequencies of the segment k-mers
+      uint64 score = 0;
+      for (SIZE_T pos = epochStart; pos < epochStart + numKmers; ++pos) {
+        score += frequencies[kmers[pos]];
+      }
+
+      Segment best = { epochStart, score };
+      for (SIZE_T start = epochStart + 1; start + DICT_SEGMENT_SIZE <= epochEnd; ++start) {
+        score += frequencies[kmers[start + numKmers - 1]];
+        score -= frequencies[kmers[start - 1]];
+        if (score > best.score) {
+          best = { start, score };
+        }
+      }
+
+      //Segments seen in a single sample don't help compressing other data
+      if (best.score <= numKmers) {
+        continue;
+      }
+
+      segments.push_back(best);
+      for (SIZE_T pos = best.start; pos < best.start + numKmers; ++pos) {
+        frequencies[kmers[pos]] = 0;
+      }
+    }
+
+    if (segments.empty()) {
+      return nullptr;
+    }
+
+    //LZ4 finds closer matches first, so the best segments go at the end
+    std::stable_sort(segments.begin(), segments.end(),
+    [](const Segment& a, const Segment& b) {
+      return a.score < b.score;
+    });
+
+    Vector<uint8> dictionary;
+    dictionary.reserve(segments.size() * DICT_SEGMENT_SIZE);
+    for (auto& segment : segments) {
+      dictionary.insert(dictionary.end(),
+                        data.begin() + segment.start,
+                        data.begin() + segment.start + DICT_SEGMENT_SIZE);
+    }
+
+    return ge_shared_ptr_new<CompressionDictionary>(dictionary.data(), dictionary.size());
+  }
+
+  CompressedDataStream::CompressedDataStream(const SPtr<DataStream>& stream,
+                                             ACCESS_MODE::E accessMode,
+                                             const CompressionOptions& options)
+    : DataStream(stream->getName(), static_cast<uint16>(accessMode)),
+      m_stream(stream),
+      m_options(options),
+      m_frameStart(stream->tell()) {
+    if (isWriteable()) {
+      if (!validateFilters(m_options.filters, m_options.elementSize)) {
+        GE_LOG(kError, Generic, "Invalid compression filters for elements of {0} bytes.",
+               m_options.elementSize);
+        m_options.filters = CompressionFilterFlags();
+      }
+
+      FrameHeader header = makeFrameHeader(m_options);
+      m_stream->write(&header, sizeof(header));
+
+      m_block.reserve(m_options.blockSize);
+      m_compBlock.resize(LZ4_compressBound(static_cast<int32>(m_options.blockSize)));
+      return;
+    }
+
+    FrameHeader header;
+    if (m_stream->read(&header, sizeof(header)) != sizeof(header) ||
+        FRAME_MAGIC != header.magic ||
+        FRAME_VERSION < header.version ||
+        0 == header.blockSize ||
+        !validateFilters(CompressionFilterFlags(static_cast<uint32>(header.filters)),
+                         header.elementSize)) {
+      GE_LOG(kError, Generic, "Invalid compressed data");
+      m_endReached = true;
+      return;
+    }
+    m_options.blockSize = header.blockSize;
+    m_options.filters = CompressionFilterFlags(static_cast<uint32>(header.filters));
+    m_options.elementSize = header.elementSize;
+
+    //If the frame ends with the stream, the footer tells the uncompressed size
+    //and where each block is, which allows seeking without scanning the frame
+    const SIZE_T streamSize = m_stream->size();
+    if (streamSize >= m_frameStart + sizeof(FrameHeader) + sizeof(FrameFooter)) {
+      FrameFooter footer;
+      m_stream->seek(streamSize - sizeof(FrameFooter));
+      if (m_stream->read(&footer, sizeof(footer)) == sizeof(footer) &&
+          FOOTER_MAGIC == footer.magic &&
+          m_frameStart + footer.indexOffset + sizeof(uint64) * footer.numBlocks ==
+            streamSize - sizeof(FrameFooter)) {
+        m_blockOffsets.resize(footer.numBlocks);
+        m_stream->seek(m_frameStart + static_cast<SIZE_T>(footer.indexOffset));
+        m_stream->read(m_blockOffsets.data(), sizeof(uint64) * footer.numBlocks);
+        m_size = static_cast<SIZE_T>(footer.rawSize);
+      }
+      rewind();
+    }
+  }
+
+  CompressedDataStream::~CompressedDataStream() {
+    close();
+  }
+
+  SIZE_T
+  CompressedDataStream::read(void* buf, SIZE_T count) {
+    if (!isReadable() || isWriteable()) {
+      return 0;
+    }
+
+    auto dst = static_cast<uint8*>(buf);
+    SIZE_T totalRead = 0;
+    while (totalRead < count) {
+      if (m_blockPos >= m_blockLength) {
+        if (!loadNextBlock()) {
+          break;
+        }
+        continue;
+      }
+
+      const SIZE_T toCopy = min(count - totalRead, m_blockLength - m_blockPos);
+      memcpy(dst + totalRead, m_block.data() + m_blockPos, toCopy);
+      m_blockPos += toCopy;
+      totalRead += toCopy;
+    }
+
+    return totalRead;
+  }
+
+  SIZE_T
+  CompressedDataStream::write(const void* buf, SIZE_T count) {
+    if (!isWriteable() || m_closed) {
+      return 0;
+    }
+
+    auto src = static_cast<const uint8*>(buf);
+    SIZE_T written = 0;
+    while (written < count) {
+      const SIZE_T toCopy = min(count - written,
+                                static_cast<SIZE_T>(m_options.blockSize) - m_block.size());
+      m_block.insert(m_block.end(), src + written, src + written + toCopy);
+      written += toCopy;
+
+      if (m_block.size() == m_options.blockSize) {
+        flushBlock();
+      }
+    }
+
+    m_size += written;
+    return written;
+  }
+
+  void
+  CompressedDataStream::skip(SIZE_T count) {
+    seek(tell() + count);
+  }
+
+  void
+  CompressedDataStream::seek(SIZE_T pos) {
+    if (isWriteable()) {
+      GE_LOG(kWarning, Generic, "Seeking is not supported on compressed write streams.");
+      return;
+    }
+
+    //Inside the current block
+    if (pos >= m_blockStart && pos <= m_blockStart + m_blockLength) {
+      m_blockPos = pos - m_blockStart;
+      return;
+    }
+
+    const auto blockSize = static_cast<SIZE_T>(m_options.blockSize);
+    if (!m_blockOffsets.empty()) {
+      const SIZE_T blockIdx = pos / blockSize;
+      if (blockIdx >= m_blockOffsets.size()) {
+        m_blockStart = m_size;
+        m_blockPos = m_blockLength = 0;
+        m_endReached = true;
+        return;
+      }
+
+      m_stream->seek(m_frameStart + static_cast<SIZE_T>(m_blockOffsets[blockIdx]));
+      m_blockStart = blockIdx * blockSize;
+      m_blockLength = 0;
+      m_endReached = false;
+      loadNextBlock();
+      m_blockStart = blockIdx * blockSize;
+      m_blockPos = min(pos - m_blockStart, m_blockLength);
+      return;
+    }
+
+    //No index, scan the blocks from the start of the frame if needed
+    if (pos < m_blockStart) {
+      rewind();
+    }
+
+    while (pos > m_blockStart + m_blockLength) {
+      m_blockPos = m_blockLength;
+      if (!loadNextBlock()) {
+        return;
+      }
+    }
+    m_blockPos = pos - m_blockStart;
+  }
+
+  SIZE_T
+  CompressedDataStream::tell() const {
+    if (isWriteable()) {
+      return m_size;
+    }
+    return m_blockStart + m_blockPos;
+  }
+
+  bool
+  CompressedDataStream::isEOF() const {
+    if (isWriteable()) {
+      return false;
+    }
+    if (!m_blockOffsets.empty()) {
+      return tell() >= m_size;
+    }
+    return m_endReached && m_blockPos >= m_blockLength;
+  }
+
+  SPtr<DataStream>
+  CompressedDataStream::clone(bool copyData) const {
+    SPtr<DataStream> stream = m_stream->clone(copyData);
+    stream->seek(m_frameStart);
+    return ge_shared_ptr_new<CompressedDataStream>(stream,
+                                                   static_cast<ACCESS_MODE::E>(getAccessMode()),
+                                                   m_options);
+  }
+
+  void
+  CompressedDataStream::close() {
+    if (m_closed) {
+      return;
+    }
+    m_closed = true;
+
+    if (!isWriteable()) {
+      return;
+    }
+
+    if (!m_block.empty()) {
+      flushBlock();
+    }
+
+    BlockHeader endMarker = { 0, 0 };
+    m_stream->write(&endMarker, sizeof(endMarker));
+
+    FrameFooter footer;
+    footer.rawSize = m_size;
+    footer.indexOffset = m_stream->tell() - m_frameStart;
+    footer.numBlocks = static_cast<uint32>(m_blockOffsets.size());
+    footer.magic = FOOTER_MAGIC;
+    m_stream->write(m_blockOffsets.data(), sizeof(uint64) * m_blockOffsets.size());
+    m_stream->write(&footer, sizeof(footer));
+  }
+
+  void
+  CompressedDataStream::flushBlock() {
+    BlockHeader header;
+    header.rawSize = static_cast<uint32>(m_block.size());
+
+    const uint8* rawData = m_block.data();
+    if (m_options.filters) {
+      m_filterBlock.resize(m_block.size() * 2);
+      applyFilters(m_block.data(),
+                   m_filterBlock.data(),
+                   m_filterBlock.data() + m_block.size(),
+                   m_block.size(),
+                   m_options.filters,
+                   m_options.elementSize,
+                   true);
+      rawData = m_filterBlock.data();
+    }
+
+    header.compSize = compressBlock(rawData,
+                                    header.rawSize,
+                                    m_compBlock.data(),
+                                    m_options.acceleration);
+
+    const uint8* blockData = m_compBlock.data();
+    if (header.compSize & BLOCK_UNCOMPRESSED_FLAG) {
+      blockData = rawData;
+    }
+
+    m_blockOffsets.push_back(m_stream->tell() - m_frameStart);
+    m_stream->write(&header, sizeof(header));
+    m_stream->write(blockData, getStoredSize(header.compSize));
+
+    m_block.clear();
+  }
+
+  bool
+  CompressedDataStream::loadNextBlock() {
+    if (m_endReached) {
+      return false;
+    }
+
+    m_blockStart += m_blockLength;
+    m_blockPos = m_blockLength = 0;
+
+    BlockHeader header;
+    if (m_stream->read(&header, sizeof(header)) != sizeof(header) ||
+        (0 == header.compSize && 0 == header.rawSize)) {
+      m_endReached = true;
+      return false;
+    }
+
+    const SIZE_T storedSize = getStoredSize(header.compSize);
+    m_compBlock.resize(storedSize);
+    m_block.resize(m_options.blockSize);
+
+    uint8* rawData = m_block.data();
+    if (m_options.filters) {
+      m_filterBlock.resize(static_cast<SIZE_T>(m_options.blockSize) * 2);
+      rawData = m_filterBlock.data();
+    }
+
+    if (m_stream->read(m_compBlock.data(), storedSize) != storedSize ||
+        !decompressBlock(header, m_compBlock.data(), rawData, m_options.blockSize)) {
+      GE_LOG(kError, Generic, "Failure trying to decompress the data.");
+      m_endReached = true;
+      return false;
+    }
+
+    if (m_options.filters) {
+      applyFilters(rawData,
+                   m_block.data(),
+                   rawData + m_options.blockSize,
+                   header.rawSize,
+                   m_options.filters,
+                   m_options.elementSize,
+                   false);
+    }
+
+    m_blockLength = header.rawSize;
+    return true;
+  }
+
+  void
+  CompressedDataStream::rewind() {
+    m_stream->seek(m_frameStart + sizeof(FrameHeader));
+    m_blockStart = m_blockPos = m_blockLength = 0;
+    m_endReached = false;
+  }
 }
@@ -396,7 +396,9 @@ namespace geEngineSDK {
     SIZE_T written = 0;
     if (isWriteable() && m_pFStream) {
       m_pFStream->write(static_cast<const char*>(buf), static_cast<std::streamsize>(count));
-      written = count;
+      if (!m_pFStream->fail()) {
+        written = count;
+      }
     }
     return written;
   }
@@ -432,6 +434,13 @@ namespace geEngineSDK {
                                              true);
   }
 
+  void
+  FileDataStream::flush() {
+    if (m_pFStream) {
+      m_pFStream->flush();
+    }
+  }
+
   void
   FileDataStream::close() {
     if (m_pInStream) {
@@ -65,7 +65,30 @@ namespace geEngineSDK {
 
   void
   Debug::log(const String& message, LogVerbosity verbosity, uint32 category) {
-    m_log.logMsg(message, verbosity, category);
+    log(message, verbosity, category, time(nullptr));
+  }
+
+  void
+  Debug::log(const String& message,
+             LogVerbosity verbosity,
+             uint32 category,
+             time_t localTime) {
+    m_log.logMsg(message, verbosity, category, localTime);
+
+    //Sinks may block until they have space, so they are called without
+    //holding the lock
+    SPtr<const Vector<SPtr<LogSink>>> sinks;
+    {
+      Lock lock(m_sinksMutex);
+      sinks = m_sinks;
+    }
+
+    if (sinks) {
+      const LogEntry entry(message, verbosity, category, localTime);
+      for (auto& sink : *sinks) {
+        sink->write(entry);
+      }
+    }
 
     if (LogVerbosity::kLog != verbosity) {
       switch (verbosity)
@@ -93,6 +116,58 @@ namespace geEngineSDK {
     }
   }
 
+  void
+  Debug::addSink(const SPtr<LogSink>& sink) {
+    Lock lock(m_sinksMutex);
+    auto sinks = ge_shared_ptr_new<Vector<SPtr<LogSink>>>();
+    if (m_sinks) {
+      *sinks = *m_sinks;
+    }
+    sinks->push_back(sink);
+    m_sinks = sinks;
+  }
+
+  void
+  Debug::removeSink(const SPtr<LogSink>& sink) {
+    {
+      Lock lock(m_sinksMutex);
+      if (!m_sinks) {
+        return;
+      }
+
+      auto sinks = ge_shared_ptr_new<Vector<SPtr<LogSink>>>(*m_sinks);
+      auto found = std::find(sinks->begin(), sinks->end(), sink);
+      if (sinks->end() == found) {
+        return;
+      }
+      sinks->erase(found);
+      m_sinks = sinks->empty() ? nullptr : sinks;
+    }
+
+    sink->flush();
+  }
+
+  void
+  Debug::flush() {
+    Log::_reportSuppressed();
+
+    if (AsyncLog::isStarted()) {
+      AsyncLog::instance().flush();
+    }
+
+    SPtr<const Vector<SPtr<LogSink>>> sinks;
+    {
+      Lock lock(m_sinksMutex);
+      sinks = m_sinks;
+    }
+
+    if (sinks) {
+      for (auto& sink : *sinks) {
+        sink->flush();
+      }
+    }
+  }
+
   void
   Debug::writeAsBMP(uint8* rawPixels,
                     uint32 bytesPerPixel,
@@ -125,6 +200,12 @@ namespace geEngineSDK {
 
   void
   Debug::_triggerCallbacks() {
+    const time_t now = time(nullptr);
+    if (m_floodReportTime != now) {
+      Log::_reportSuppressed();
+      m_floodReportTime = now;
+    }
+
     LogEntry entry;
     while (m_log.getUnreadEntry(entry)) {
       onLogEntryAdded(entry);
@@ -153,6 +234,22 @@ namespace geEngineSDK {
 
   void
   Debug::saveHtmlLog(const Path& path) const {
+    StringStream stream;
+    stream << getHtmlLogHeader();
+
+    Vector<LogEntry> entries = m_log.getAllEntries();
+    for (auto& entry : entries) {
+      stream << getHtmlLogEntry(entry);
+    }
+
+    stream << getHtmlLogFooter();
+
+    auto fileStream = FileSystem::createAndOpenFile(path);
+    fileStream->writeString(stream.str());
+  }
+
+  String
+  Debug::getHtmlLogHeader() {
     static const char* style =
       R"(<link rel="stylesheet" type="text/css" href="../css/debug.css">)";
 
@@ -176,12 +273,6 @@ R"(<!DOCTYPE HTML PUBLIC '-//W3C//DTD HTML 4.0 Transitional//EN'>
           <div class="cell"> Description </div>
         </div>)";
 
-    static const char* htmlFooter = R"(
-        </div>
-      </div>
-    </body>
-</html>)";
-
     StringStream stream;
     stream << htmlPreStyleHeader;
     stream << style;
@@ -222,41 +313,47 @@ R"(<!DOCTYPE HTML PUBLIC '-//W3C//DTD HTML 4.0 Transitional//EN'>
     stream << "<h2>Log entries</h2>\n";
     stream << htmlEntriesTableHeader;
 
-    Vector<LogEntry> entries = m_log.getAllEntries();
-    for (auto& entry : entries) {
-      String channelName;
-
-      switch (entry.getVerbosity())
-      {
-        case LogVerbosity::kFatal:
-        case LogVerbosity::kError:
-          stream << R"(<div class="row red">)" << endl;
-          stream << R"(<div class="cell">Error</div>)" << endl;
-          break;
-        case LogVerbosity::kWarning:
-          stream << R"(<div class="row yellow">)" << endl;
-          stream << R"(<div class="cell">Warning</div>)" << endl;
-          break;
-        default:
-        case LogVerbosity::kInfo:
-        case LogVerbosity::kLog:
-        case LogVerbosity::kVerbose:
-        case LogVerbosity::kVeryVerbose:
-          stream << R"(<div class="row green">)" << endl;
-          stream << R"(<div class="cell">Debug</div>)" << endl;
-          break;
-      }
+    return stream.str();
+  }
 
-      stream << R"(<div>)" << entry.getLocalTime() << "</div>" << endl;
-      String parsedMessage = StringUtil::replaceAll(entry.getMessage(), "\n", "<br>\n");
-      stream << R"(<div class="cell">)" << parsedMessage << "</div>" << endl;
-      stream << R"(</div>)" << endl;
+  String
+  Debug::getHtmlLogEntry(const LogEntry& entry) {
+    StringStream stream;
+    switch (entry.getVerbosity())
+    {
+      case LogVerbosity::kFatal:
+      case LogVerbosity::kError:
+        stream << R"(<div class="row red">)" << endl;
+        stream << R"(<div class="cell">Error</div>)" << endl;
+        break;
+      case LogVerbosity::kWarning:
+        stream << R"(<div class="row yellow">)" << endl;
+        stream << R"(<div class="cell">Warning</div>)" << endl;
+        break;
+      default:
+      case LogVerbosity::kInfo:
+      case LogVerbosity::kLog:
+      case LogVerbosity::kVerbose:
+      case LogVerbosity::kVeryVerbose:
+        stream << R"(<div class="row green">)" << endl;
+        stream << R"(<div class="cell">Debug</div>)" << endl;
+        break;
     }
 
-    stream << htmlFooter;
+    stream << R"(<div>)" << entry.getLocalTime() << "</div>" << endl;
+    String parsedMessage = StringUtil::replaceAll(entry.getMessage(), "\n", "<br>\n");
+    stream << R"(<div class="cell">)" << parsedMessage << "</div>" << endl;
+    stream << R"(</div>)" << endl;
+    return stream.str();
+  }
 
-    auto fileStream = FileSystem::createAndOpenFile(path);
-    fileStream->writeString(stream.str());
+  String
+  Debug::getHtmlLogFooter() {
+    return R"(
+        </div>
+      </div>
+    </body>
+</html>)";
   }
 
   /**
@@ -275,6 +372,20 @@ R"(<!DOCTYPE HTML PUBLIC '-//W3C//DTD HTML 4.0 Transitional//EN'>
   void
   Debug::saveTextLog(const Path& path) const
   {
+    StringStream stream;
+    stream << getTextLogHeader();
+
+    Vector<LogEntry> entries = m_log.getAllEntries();
+    for (auto& entry : entries) {
+      stream << getTextLogEntry(entry) << "\n";
+    }
+
+    SPtr<DataStream> fileStream = FileSystem::createAndOpenFile(path);
+    fileStream->writeString(stream.str());
+  }
+
+  String
+  Debug::getTextLogHeader() {
     StringStream stream;
     stream << "geEngine Log\n";
     stream << 
@@ -317,57 +428,61 @@ R"(<!DOCTYPE HTML PUBLIC '-//W3C//DTD HTML 4.0 Transitional//EN'>
     stream <<
       "===================================================================================\n";
 
-    Vector<LogEntry> entries = m_log.getAllEntries();
-    for (auto& entry : entries) {
-      String builtMsg;
-      builtMsg.append(toString(entry.getLocalTime(),
-                               false,
-                               true,
-                               TIME_TO_STRING_CONVERSION_TYPE::kFull));
-      builtMsg.append(" ");
-
-      switch (entry.getVerbosity())
-      {
-        case LogVerbosity::kFatal:
-          builtMsg.append("[FATAL]");
-          break;
-        case LogVerbosity::kError:
-          builtMsg.append("[ERROR]");
-          break;
-        case LogVerbosity::kWarning:
-          builtMsg.append("[WARNING]");
-          break;
-        case LogVerbosity::kInfo:
-          builtMsg.append("[INFO]");
-          break;
-        case LogVerbosity::kLog:
-          builtMsg.append("[LOG]");
-          break;
-        case LogVerbosity::kVerbose:
-          builtMsg.append("[VERBOSE]");
-          break;
-        case LogVerbosity::kVeryVerbose:
-          builtMsg.append("[VERY_VERBOSE]");
-          break;
-      }
+    return stream.str();
+  }
 
-      String categoryName;
-      m_log.getCategoryName(entry.getCategory(), categoryName);
-      builtMsg.append(" <" + categoryName + ">");
+  String
+  Debug::getTextLogEntry(const LogEntry& entry) {
+    String categoryName;
+    Log::getCategoryName(entry.getCategory(), categoryName);
+    return getTextLogEntry(entry, categoryName);
+  }
 
-      builtMsg.append(" | ");
+  String
+  Debug::getTextLogEntry(const LogEntry& entry, const String& categoryName) {
+    String builtMsg;
+    builtMsg.append(toString(entry.getLocalTime(),
+                             false,
+                             true,
+                             TIME_TO_STRING_CONVERSION_TYPE::kFull));
+    builtMsg.append(" ");
+
+    switch (entry.getVerbosity())
+    {
+      case LogVerbosity::kFatal:
+        builtMsg.append("[FATAL]");
+        break;
+      case LogVerbosity::kError:
+        builtMsg.append("[ERROR]");
+        break;
+      case LogVerbosity::kWarning:
+        builtMsg.append("[WARNING]");
+        break;
+      case LogVerbosity::kInfo:
+        builtMsg.append("[INFO]");
+        break;
+      case LogVerbosity::kLog:
+        builtMsg.append("[LOG]");
+        break;
+      case LogVerbosity::kVerbose:
+        builtMsg.append("[VERBOSE]");
+        break;
+      case LogVerbosity::kVeryVerbose:
+        builtMsg.append("[VERY_VERBOSE]");
+        break;
+    }
 
-      String tmpSpaces = _getSpacesIndentation(builtMsg.length());
+    builtMsg.append(" <" + categoryName + ">");
 
-      String parsedMessage = StringUtil::replaceAll(entry.getMessage(),
-                                                    "\n\t\t",
-                                                    "\n" + tmpSpaces);
-      builtMsg.append(parsedMessage);
-      stream << builtMsg << "\n";
-    }
+    builtMsg.append(" | ");
 
-    SPtr<DataStream> fileStream = FileSystem::createAndOpenFile(path);
-    fileStream->writeString(stream.str());
+    String tmpSpaces = _getSpacesIndentation(builtMsg.length());
+
+    String parsedMessage = StringUtil::replaceAll(entry.getMessage(),
+                                                  "\n\t\t",
+                                                  "\n" + tmpSpaces);
+    builtMsg.append(parsedMessage);
+    return builtMsg;
   }
 
   GE_UTILITIES_EXPORT Debug& g_debug() {
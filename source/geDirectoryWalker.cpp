@@ -0,0 +1,590 @@
+/*****************************************************************************/
+/**
+ * @file    geDirectoryWalker.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Walks directory trees without building a Path per entry.
+ *
+ * Walks directory trees handing the callbacks a lightweight view of each
+ * entry, instead of building and parsing a full Path for every one of them.
+ * On Linux the directories are read with getdents64, and the entry types
+ * reported by the file system are used so no stat is needed in most cases.
+ * Subdirectories can optionally be read in parallel by TaskScheduler
+ * workers.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geDirectoryWalker.h"
+#include "geTaskScheduler.h"
+#include "geUnicode.h"
+
+#if USING(GE_PLATFORM_LINUX)
+#   include <cerrno>
+#   include <dirent.h>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#else
+#   include <filesystem>
+  namespace fileSys = std::filesystem;
+  using std::error_code;
+#endif
+
+namespace geEngineSDK {
+  using std::move;
+
+  /**
+   * @brief Entries of a single directory. The names are packed in a single
+   *        string so reading a directory doesn't allocate per entry.
+   */
+  struct DirectoryWalker::Listing
+  {
+    struct Entry
+    {
+      uint32 nameOffset;
+      uint32 nameLength;
+      bool isDirectory;
+      bool isSymbolicLink;
+    };
+
+    void
+    clear() {
+      names.clear();
+      entries.clear();
+    }
+
+    void
+    add(const ANSICHAR* name,
+        SIZE_T nameLength,
+        bool isDirectory,
+        bool isSymbolicLink) {
+      entries.push_back({ static_cast<uint32>(names.size()),
+                          static_cast<uint32>(nameLength),
+                          isDirectory,
+                          isSymbolicLink });
+      names.append(name, nameLength);
+    }
+
+    String names;
+    Vector<Entry> entries;
+  };
+
+  /**
+   * @brief Shared state of a parallel walk. The workers read the directories
+   *        queued, and queue their subdirectories in turn.
+   */
+  struct DirectoryWalker::ParallelWalk
+  {
+    struct Node
+    {
+      String path;
+      uint32 depth = 0;
+      Listing listing;
+
+      /**
+       * Nodes of the subdirectories to walk into, in the same order as their
+       * entries in the listing.
+       */
+      Vector<Node*> children;
+
+      /**
+       * True once the directory was read. Protected by the walk mutex.
+       */
+      bool ready = false;
+      bool valid = false;
+    };
+
+    /**
+     * @brief Main loop of the workers.
+     */
+    void
+    runWorker();
+
+    /**
+     * @brief Delivers the entries of a node, and then recursively the ones
+     *        of its children, in the order a serial walk would.
+     */
+    bool
+    deliverOrdered(Node* node,
+                   String& path,
+                   const EntryCallback& fileCallback,
+                   const EntryCallback& dirCallback);
+
+    /**
+     * @brief Delivers the nodes as they are read, in any order.
+     */
+    bool
+    deliverUnordered(const EntryCallback& fileCallback,
+                     const EntryCallback& dirCallback);
+
+    Mutex mutex;
+    Signal cond;
+
+    /**
+     * Nodes waiting to be read. Subdirectories are queued at the front, so
+     * the tree is read roughly depth-first, in the order it's delivered.
+     */
+    Deque<Node*> queue;
+
+    /**
+     * Nodes already read, waiting to be delivered by an unordered walk.
+     */
+    Deque<Node*> readyQueue;
+
+    /**
+     * Every node created, freed once the walk ends.
+     */
+    Vector<Node*> nodes;
+
+    /**
+     * Number of nodes queued or being read.
+     */
+    uint32 numPending = 0;
+    bool ordered = true;
+    bool cancel = false;
+  };
+
+  namespace {
+    /**
+     * @brief Appends a path separator unless @p path already ends with one,
+     *        which only happens for the file system root.
+     */
+    void
+    appendSeparator(String& path) {
+      if (path.empty() || '/' != path.back()) {
+        path += '/';
+      }
+    }
+  }
+
+  Path
+  DirectoryEntry::toPath() const {
+    return Path(toString());
+  }
+
+  bool
+  DirectoryWalker::walk(const Path& dirPath,
+                        const EntryCallback& fileCallback,
+                        const EntryCallback& dirCallback,
+                        const DirectoryWalkOptions& options) {
+    String rootPath = dirPath.toString();
+#if !USING(GE_PLATFORM_LINUX)
+    rootPath = StringUtil::replaceAll(rootPath, "\\", "/");
+#endif
+    while (rootPath.size() > 1 && '/' == rootPath.back()) {
+      rootPath.pop_back();
+    }
+
+    if (rootPath.empty()) {
+      rootPath = ".";
+    }
+
+    if (options.parallel &&
+        options.recursive &&
+        TaskScheduler::isStarted() &&
+        TaskScheduler::instance().getNumWorkers() > 1) {
+      return walkParallel(rootPath, fileCallback, dirCallback, options);
+    }
+
+    Deque<Listing> listings;
+    return walkSerial(rootPath, 0, listings, fileCallback, dirCallback, options);
+  }
+
+#if USING(GE_PLATFORM_LINUX)
+  namespace {
+    /**
+     * @brief Record returned by getdents64. glibc only declares it with
+     *        _GNU_SOURCE, and older versions don't at all.
+     */
+    struct LinuxDirent64
+    {
+      uint64 d_ino;
+      int64 d_off;
+      uint16 d_reclen;
+      uint8 d_type;
+      ANSICHAR d_name[1];
+    };
+
+    /**
+     * @brief Translates the type of a stat into a dirent type.
+     */
+    uint8
+    linux_direntType(mode_t mode) {
+      if (S_ISDIR(mode)) {
+        return DT_DIR;
+      }
+      if (S_ISREG(mode)) {
+        return DT_REG;
+      }
+      if (S_ISLNK(mode)) {
+        return DT_LNK;
+      }
+      return DT_UNKNOWN;
+    }
+  }
+
+  bool
+  DirectoryWalker::listDirectory(const String& dirPath, Listing& listing) {
+    const int32 fd = ::open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (-1 == fd) {
+      return false;
+    }
+
+    alignas(8) uint8 buffer[32 * 1024];
+    while (true) {
+      const int64 numRead = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+      if (numRead <= 0) {
+        if (numRead < 0 && EINTR == errno) {
+          continue;
+        }
+        break;
+      }
+
+      for (int64 offset = 0; offset < numRead;) {
+        auto dirent = reinterpret_cast<const LinuxDirent64*>(buffer + offset);
+        offset += dirent->d_reclen;
+
+        const ANSICHAR* name = dirent->d_name;
+        if ('.' == name[0] &&
+            ('\0' == name[1] || ('.' == name[1] && '\0' == name[2]))) {
+          continue;
+        }
+
+        //Some file systems don't report the type, so we fall back to stat
+        uint8 type = dirent->d_type;
+        struct stat info;
+        if (DT_UNKNOWN == type) {
+          if (0 != fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW)) {
+            continue;
+          }
+          type = linux_direntType(info.st_mode);
+        }
+
+        //Links are reported with the type of their target. Broken ones skipped
+        const bool isSymbolicLink = DT_LNK == type;
+        if (isSymbolicLink) {
+          if (0 != fstatat(fd, name, &info, 0)) {
+            continue;
+          }
+          type = linux_direntType(info.st_mode);
+        }
+
+        if (DT_DIR == type || DT_REG == type) {
+          listing.add(name, strlen(name), DT_DIR == type, isSymbolicLink);
+        }
+      }
+    }
+
+    ::close(fd);
+    return true;
+  }
+#else
+  bool
+  DirectoryWalker::listDirectory(const String& dirPath, Listing& listing) {
+    error_code ec;
+    fileSys::directory_iterator it(fileSys::path(UTF8::toWide(dirPath)), ec);
+    if (ec) {
+      return false;
+    }
+
+    for (const fileSys::directory_iterator end; it != end; it.increment(ec)) {
+      if (ec) {
+        break;
+      }
+
+      const auto& entry = *it;
+      const bool isSymbolicLink = entry.is_symlink(ec);
+      const bool isDirectory = entry.is_directory(ec);
+      if (!isDirectory && !entry.is_regular_file(ec)) {
+        continue;
+      }
+
+      String name = UTF8::fromWide(WString(entry.path().filename().wstring()));
+      listing.add(name.c_str(), name.size(), isDirectory, isSymbolicLink);
+    }
+
+    return true;
+  }
+#endif
+
+  bool
+  DirectoryWalker::deliverEntry(String& path,
+                                uint32 depth,
+                                const Listing& listing,
+                                uint32 entryIdx,
+                                const EntryCallback& fileCallback,
+                                const EntryCallback& dirCallback) {
+    const Listing::Entry& listEntry = listing.entries[entryIdx];
+
+    appendSeparator(path);
+    const SIZE_T nameOffset = path.size();
+    path.append(listing.names, listEntry.nameOffset, listEntry.nameLength);
+
+    const EntryCallback& callback = listEntry.isDirectory ? dirCallback
+                                                          : fileCallback;
+    if (!callback) {
+      return true;
+    }
+
+    DirectoryEntry entry;
+    entry.path = path.c_str();
+    entry.pathLength = static_cast<uint32>(path.size());
+    entry.nameOffset = static_cast<uint32>(nameOffset);
+    entry.depth = depth;
+    entry.isDirectory = listEntry.isDirectory;
+    entry.isSymbolicLink = listEntry.isSymbolicLink;
+    return callback(entry);
+  }
+
+  bool
+  DirectoryWalker::walkSerial(String& path,
+                              uint32 depth,
+                              Deque<Listing>& listings,
+                              const EntryCallback& fileCallback,
+                              const EntryCallback& dirCallback,
+                              const DirectoryWalkOptions& options) {
+    if (listings.size() <= depth) {
+      listings.emplace_back();
+    }
+
+    //References to the elements of a deque survive growing it
+    Listing& listing = listings[depth];
+    listing.clear();
+    if (!listDirectory(path, listing)) {
+      //Subdirectories that can't be read are skipped, like empty ones
+      return 0 != depth;
+    }
+
+    const SIZE_T baseLength = path.size();
+    const auto numEntries = static_cast<uint32>(listing.entries.size());
+    for (uint32 i = 0; i < numEntries; ++i) {
+      if (!deliverEntry(path, depth, listing, i, fileCallback, dirCallback)) {
+        return false;
+      }
+
+      const Listing::Entry& entry = listing.entries[i];
+      if (options.recursive && entry.isDirectory && !entry.isSymbolicLink) {
+        if (!walkSerial(path,
+                        depth + 1,
+                        listings,
+                        fileCallback,
+                        dirCallback,
+                        options)) {
+          return false;
+        }
+      }
+
+      path.resize(baseLength);
+    }
+
+    return true;
+  }
+
+  void
+  DirectoryWalker::ParallelWalk::runWorker() {
+    Vector<Node*> children;
+
+    while (true) {
+      Node* node = nullptr;
+      {
+        Lock lock(mutex);
+        while (queue.empty() && 0 != numPending && !cancel) {
+          cond.wait(lock);
+        }
+
+        if (queue.empty() || cancel) {
+          break;
+        }
+
+        node = queue.front();
+        queue.pop_front();
+      }
+
+      node->valid = listDirectory(node->path, node->listing);
+
+      children.clear();
+      for (const auto& entry : node->listing.entries) {
+        if (!entry.isDirectory || entry.isSymbolicLink) {
+          continue;
+        }
+
+        auto child = ge_new<Node>();
+        child->path.reserve(node->path.size() + entry.nameLength + 1);
+        child->path = node->path;
+        appendSeparator(child->path);
+        child->path.append(node->listing.names,
+                           entry.nameOffset,
+                           entry.nameLength);
+        child->depth = node->depth + 1;
+        children.push_back(child);
+      }
+
+      {
+        Lock lock(mutex);
+        nodes.insert(nodes.end(), children.begin(), children.end());
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+          queue.push_front(*it);
+        }
+
+        numPending += static_cast<uint32>(children.size());
+        --numPending;
+
+        node->children = move(children);
+        node->ready = true;
+        if (!ordered) {
+          readyQueue.push_back(node);
+        }
+      }
+
+      cond.notify_all();
+    }
+  }
+
+  bool
+  DirectoryWalker::ParallelWalk::deliverOrdered(Node* node,
+                                                String& path,
+                                                const EntryCallback& fileCallback,
+                                                const EntryCallback& dirCallback) {
+    {
+      Lock lock(mutex);
+      while (!node->ready) {
+        cond.wait(lock);
+      }
+    }
+
+    if (!node->valid) {
+      return 0 != node->depth;
+    }
+
+    const SIZE_T baseLength = path.size();
+    const Listing& listing = node->listing;
+    const auto numEntries = static_cast<uint32>(listing.entries.size());
+    uint32 childIdx = 0;
+    for (uint32 i = 0; i < numEntries; ++i) {
+      if (!deliverEntry(path,
+                        node->depth,
+                        listing,
+                        i,
+                        fileCallback,
+                        dirCallback)) {
+        return false;
+      }
+
+      const Listing::Entry& entry = listing.entries[i];
+      if (entry.isDirectory && !entry.isSymbolicLink) {
+        if (!deliverOrdered(node->children[childIdx++],
+                            path,
+                            fileCallback,
+                            dirCallback)) {
+          return false;
+        }
+      }
+
+      path.resize(baseLength);
+    }
+
+    //Release the names as soon as possible, the node itself is tiny
+    node->listing = Listing();
+    return true;
+  }
+
+  bool
+  DirectoryWalker::ParallelWalk::deliverUnordered(const EntryCallback& fileCallback,
+                                                  const EntryCallback& dirCallback) {
+    String path;
+    while (true) {
+      Node* node = nullptr;
+      {
+        Lock lock(mutex);
+        while (readyQueue.empty() && 0 != numPending) {
+          cond.wait(lock);
+        }
+
+        if (readyQueue.empty()) {
+          break;
+        }
+
+        node = readyQueue.front();
+        readyQueue.pop_front();
+      }
+
+      if (!node->valid) {
+        if (0 == node->depth) {
+          return false;
+        }
+        continue;
+      }
+
+      path = node->path;
+      const SIZE_T baseLength = path.size();
+      const auto numEntries = static_cast<uint32>(node->listing.entries.size());
+      for (uint32 i = 0; i < numEntries; ++i) {
+        if (!deliverEntry(path,
+                          node->depth,
+                          node->listing,
+                          i,
+                          fileCallback,
+                          dirCallback)) {
+          return false;
+        }
+        path.resize(baseLength);
+      }
+
+      node->listing = Listing();
+    }
+
+    return true;
+  }
+
+  bool
+  DirectoryWalker::walkParallel(const String& rootPath,
+                                const EntryCallback& fileCallback,
+                                const EntryCallback& dirCallback,
+                                const DirectoryWalkOptions& options) {
+    ParallelWalk walk;
+    walk.ordered = options.ordered;
+
+    auto root = ge_new<ParallelWalk::Node>();
+    root->path = rootPath;
+    walk.nodes.push_back(root);
+    walk.queue.push_back(root);
+    walk.numPending = 1;
+
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    auto taskGroup = TaskGroup::create("DirectoryWalker",
+                                       [&walk](uint32) { walk.runWorker(); },
+                                       scheduler.getNumWorkers());
+    scheduler.addTaskGroup(taskGroup);
+
+    bool result;
+    if (options.ordered) {
+      String path = rootPath;
+      result = walk.deliverOrdered(root, path, fileCallback, dirCallback);
+    }
+    else {
+      result = walk.deliverUnordered(fileCallback, dirCallback);
+    }
+
+    //Stop the workers still reading if a callback ended the walk early
+    {
+      Lock lock(walk.mutex);
+      walk.cancel = true;
+    }
+    walk.cond.notify_all();
+    taskGroup->wait();
+
+    for (auto node : walk.nodes) {
+      ge_delete(node);
+    }
+
+    return result;
+  }
+}
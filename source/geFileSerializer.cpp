@@ -19,9 +19,11 @@
 #include "geFileSerializer.h"
 #include "geException.h"
 #include "geIReflectable.h"
+#include "geRTTIType.h"
 #include "geBinarySerializer.h"
 #include "geFileSystem.h"
 #include "geDataStream.h"
+#include "geCompression.h"
 #include "geDebug.h"
 
 namespace geEngineSDK {
@@ -30,7 +32,33 @@ namespace geEngineSDK {
   using std::ios_base;
   using std::bind;
 
-  FileEncoder::FileEncoder(const Path& fileLocation) {
+  namespace {
+    /**
+     * Stored in place of an object size to mark the start of the index.
+     */
+    CONSTEXPR uint32 INDEX_MARKER = 0xFFFFFFFF;
+
+    /**
+     * Stored in place of the size of an object in compressed files. Its size
+     * is only stored in the index.
+     */
+    CONSTEXPR uint32 UNKNOWN_SIZE_MARKER = 0xFFFFFFFE;
+    CONSTEXPR uint32 INDEX_MAGIC = 0x58444947; //"GIDX"
+
+    /**
+     * The index is stored as INDEX_MARKER, followed by one FileObjectInfo
+     * per object and this footer at the very end of the file.
+     */
+    struct IndexFooter
+    {
+      uint64 indexOffset;
+      uint32 numObjects;
+      uint32 magic;
+    };
+  }
+
+  FileEncoder::FileEncoder(const Path& fileLocation, bool writeIndex)
+    : m_writeIndex(writeIndex) {
     m_writeBuffer = reinterpret_cast<uint8*>(
                       ge_alloc(static_cast<SIZE_T>(WRITE_BUFFER_SIZE)));
 
@@ -47,35 +75,116 @@ namespace geEngineSDK {
     }
   }
 
+  FileEncoder::FileEncoder(const Path& fileLocation, const CompressionOptions& options)
+    : m_writeIndex(true) {
+    m_writeBuffer = reinterpret_cast<uint8*>(
+                      ge_alloc(static_cast<SIZE_T>(WRITE_BUFFER_SIZE)));
+
+    Path parentDir = fileLocation.getDirectory();
+    if (!FileSystem::exists(parentDir)) {
+      FileSystem::createDir(parentDir);
+    }
+
+    SPtr<DataStream> fileStream = FileSystem::createAndOpenFile(fileLocation);
+    m_compressedStream = ge_shared_ptr_new<CompressedDataStream>(fileStream,
+                                                                 ACCESS_MODE::kWRITE,
+                                                                 options);
+  }
+
   FileEncoder::~FileEncoder() {
+    if (m_writeIndex) {
+      writeIndex();
+    }
+
+    if (m_compressedStream) {
+      m_compressedStream->close();
+    }
+
     ge_free(m_writeBuffer);
     m_outputStream.close();
     m_outputStream.clear();
   }
 
-  void
-  FileEncoder::encode(IReflectable* object, SerializationContext* context) {
+  uint32
+  FileEncoder::encode(IReflectable* object,
+                      SerializationContext* context,
+                      bool deduplicate,
+                      bool compact) {
     if (nullptr == object) {
-      return;
+      return NumLimit::MAX_UINT32;
     }
 
-    auto curPos = static_cast<uint64>(m_outputStream.tellp());
-    m_outputStream.seekp(sizeof(uint32), ios_base::cur);
+    const auto objectId = static_cast<uint32>(m_objectIndex.size());
+    m_objectIndex.emplace_back();
+    m_objectIndex.back().typeId = object->getRTTI()->getRTTIId();
 
     BinarySerializer bs;
     uint32 totalBytesWritten = 0;
+
+    if (m_compressedStream) {
+      m_objectIndex.back().offset = m_compressedStream->tell();
+      m_compressedStream->write(&UNKNOWN_SIZE_MARKER, sizeof(UNKNOWN_SIZE_MARKER));
+
+      bs.encode(object,
+                m_writeBuffer,
+                WRITE_BUFFER_SIZE,
+                &totalBytesWritten,
+                bind(&FileEncoder::flushBufferCompressed, this, _1, _2, _3),
+                false,
+                context,
+                deduplicate,
+                false,
+                compact);
+
+      m_objectIndex[objectId].size = totalBytesWritten;
+      return objectId;
+    }
+
+    auto curPos = static_cast<uint64>(m_outputStream.tellp());
+    m_objectIndex.back().offset = curPos;
+    m_outputStream.seekp(sizeof(uint32), ios_base::cur);
+
     bs.encode(object,
               m_writeBuffer,
               WRITE_BUFFER_SIZE,
               &totalBytesWritten,
               bind(&FileEncoder::flushBuffer, this, _1, _2, _3),
               false,
-              context);
+              context,
+              deduplicate,
+              false,
+              compact);
 
     m_outputStream.seekp(curPos);
     m_outputStream.write(reinterpret_cast<char*>(&totalBytesWritten),
                          sizeof(totalBytesWritten));
     m_outputStream.seekp(totalBytesWritten, ios_base::cur);
+
+    m_objectIndex[objectId].size = totalBytesWritten;
+    return objectId;
+  }
+
+  void
+  FileEncoder::writeIndex() {
+    auto writeData = [this](const void* data, SIZE_T size) {
+      if (m_compressedStream) {
+        m_compressedStream->write(data, size);
+      }
+      else {
+        m_outputStream.write(reinterpret_cast<const char*>(data), size);
+      }
+    };
+
+    IndexFooter footer;
+    footer.indexOffset = m_compressedStream ?
+                           static_cast<uint64>(m_compressedStream->tell()) :
+                           static_cast<uint64>(m_outputStream.tellp());
+    footer.numObjects = static_cast<uint32>(m_objectIndex.size());
+    footer.magic = INDEX_MAGIC;
+
+    writeData(&INDEX_MARKER, sizeof(INDEX_MARKER));
+    writeData(m_objectIndex.data(), m_objectIndex.size() * sizeof(FileObjectInfo));
+    writeData(&footer, sizeof(footer));
   }
 
   uint8*
@@ -86,8 +195,18 @@ namespace geEngineSDK {
     return bufferStart;
   }
 
+  uint8*
+  FileEncoder::flushBufferCompressed(uint8* bufferStart,
+                                     uint32 bytesWritten,
+                                     uint32& /*newBufferSize*/) {
+    m_compressedStream->write(bufferStart, bytesWritten);
+    return bufferStart;
+  }
+
   FileDecoder::FileDecoder(const Path& fileLocation) {
-    m_inputStream = FileSystem::openFile(fileLocation, true);
+    m_inputStream = FileSystem::openFile(fileLocation,
+                                         true,
+                                         FILE_STREAM_TYPE::kNATIVE);
 
     if (nullptr == m_inputStream) {
       return;
@@ -98,16 +217,24 @@ namespace geEngineSDK {
                 "File size is larger that uint32 can hold. Ask a programmer "
                 "to use a bigger data type.");
     }
+
+    if (Compression::isCompressedFrame(*m_inputStream)) {
+      m_inputStream = ge_shared_ptr_new<CompressedDataStream>(m_inputStream);
+    }
+
+    readIndex();
   }
 
   SPtr<IReflectable>
   FileDecoder::decode(SerializationContext* context) {
-    if (m_inputStream->isEOF()) {
+    if (isEndOfObjects()) {
       return nullptr;
     }
 
-    uint32 objectSize = 0;
-    m_inputStream->read(&objectSize, sizeof(objectSize));
+    const uint32 objectSize = readObjectSize();
+    if (0 == objectSize) {
+      return nullptr;
+    }
 
     BinarySerializer bs;
     SPtr<IReflectable> object = bs.decode(m_inputStream, objectSize, context);
@@ -117,25 +244,182 @@ namespace geEngineSDK {
 
   uint32
   FileDecoder::getSize() const {
-    if (m_inputStream->isEOF()) {
+    if (isEndOfObjects()) {
       return 0;
     }
 
-    uint32 objectSize = 0;
-    m_inputStream->read(&objectSize, sizeof(objectSize));
-    m_inputStream->seek(m_inputStream->tell() - sizeof(objectSize));
+    const SIZE_T curOffset = m_inputStream->tell();
+    const uint32 objectSize = readObjectSize();
+    m_inputStream->seek(curOffset);
 
     return objectSize;
   }
 
   void
   FileDecoder::skip() {
-    if (m_inputStream->isEOF()) {
+    if (isEndOfObjects()) {
       return;
     }
 
+    const uint32 objectSize = readObjectSize();
+    if (0 != objectSize) {
+      m_inputStream->skip(objectSize);
+    }
+  }
+
+  uint32
+  FileDecoder::getNumObjects() {
+    return static_cast<uint32>(getObjectIndex().size());
+  }
+
+  const Vector<FileObjectInfo>&
+  FileDecoder::getObjectIndex() {
+    if (!m_indexLoaded) {
+      scanObjects();
+    }
+
+    return m_objectIndex;
+  }
+
+  SPtr<IReflectable>
+  FileDecoder::decodeObject(uint32 objectId, SerializationContext* context) {
+    const Vector<FileObjectInfo>& objectIndex = getObjectIndex();
+    if (objectId >= objectIndex.size()) {
+      GE_LOG(kWarning, FileSystem, "Trying to decode an object that doesn't "
+             "exist in the file. Id: {0}", objectId);
+      return nullptr;
+    }
+
+    const FileObjectInfo& info = objectIndex[objectId];
+    const SIZE_T curOffset = m_inputStream->tell();
+
+    //Skip the size prefix, the size is already known from the index
+    m_inputStream->seek(static_cast<SIZE_T>(info.offset) + sizeof(uint32));
+
+    BinarySerializer bs;
+    SPtr<IReflectable> object = bs.decode(m_inputStream, info.size, context);
+
+    m_inputStream->seek(curOffset);
+    return object;
+  }
+
+  Vector<SPtr<IReflectable>>
+  FileDecoder::decodeObjects(const Vector<uint32>& objectIds,
+                             SerializationContext* context) {
+    Vector<SPtr<IReflectable>> objects;
+    objects.reserve(objectIds.size());
+
+    for (auto objectId : objectIds) {
+      objects.push_back(decodeObject(objectId, context));
+    }
+
+    return objects;
+  }
+
+  void
+  FileDecoder::readIndex() {
+    const SIZE_T streamSize = m_inputStream->size();
+
+    //Streams that don't know their size are read until they report EOF
+    m_objectsEnd = 0 == streamSize ? NumLimit::MAX_UINT64 : streamSize;
+
+    if (streamSize < sizeof(INDEX_MARKER) + sizeof(IndexFooter)) {
+      return;
+    }
+
+    IndexFooter footer;
+    m_inputStream->seek(streamSize - sizeof(IndexFooter));
+    m_inputStream->read(&footer, sizeof(footer));
+
+    const uint64 indexSize = sizeof(INDEX_MARKER) +
+                             static_cast<uint64>(footer.numObjects) * sizeof(FileObjectInfo);
+
+    if (INDEX_MAGIC == footer.magic &&
+        footer.indexOffset + indexSize + sizeof(IndexFooter) == streamSize) {
+      uint32 marker = 0;
+      m_inputStream->seek(static_cast<SIZE_T>(footer.indexOffset));
+      m_inputStream->read(&marker, sizeof(marker));
+
+      if (INDEX_MARKER == marker) {
+        m_objectIndex.resize(footer.numObjects);
+        m_inputStream->read(m_objectIndex.data(),
+                            m_objectIndex.size() * sizeof(FileObjectInfo));
+
+        m_objectsEnd = footer.indexOffset;
+        m_hasIndex = true;
+        m_indexLoaded = true;
+      }
+    }
+
+    m_inputStream->seek(0);
+  }
+
+  void
+  FileDecoder::scanObjects() {
+    const SIZE_T curOffset = m_inputStream->tell();
+    m_inputStream->seek(0);
+
+    m_objectIndex.clear();
+    while (!isEndOfObjects()) {
+      FileObjectInfo info;
+      info.offset = m_inputStream->tell();
+      info.size = readObjectSize();
+      if (0 == info.size) {
+        break;
+      }
+
+      //Every object starts with its meta data: the encoded object id
+      //followed by the RTTI type id
+      uint8 objectHeader[BinarySerializer::MAX_HEADER_SIZE];
+      const uint32 headerSize = std::min(info.size, BinarySerializer::MAX_HEADER_SIZE);
+      m_inputStream->read(objectHeader, headerSize);
+      m_inputStream->skip(info.size - headerSize);
+      info.typeId = BinarySerializer::getEncodedTypeId(objectHeader, headerSize);
+
+      m_objectIndex.push_back(info);
+    }
+
+    m_indexLoaded = true;
+    m_inputStream->seek(curOffset);
+  }
+
+  uint32
+  FileDecoder::readObjectSize() const {
+    const SIZE_T offset = m_inputStream->tell();
+
     uint32 objectSize = 0;
-    m_inputStream->read(&objectSize, sizeof(objectSize));
-    m_inputStream->skip(objectSize);
+    if (m_inputStream->read(&objectSize, sizeof(objectSize)) != sizeof(objectSize)) {
+      return 0;
+    }
+
+    if (INDEX_MARKER == objectSize) {
+      m_inputStream->seek(offset);
+      return 0;
+    }
+
+    if (UNKNOWN_SIZE_MARKER != objectSize) {
+      return objectSize;
+    }
+
+    //Objects are indexed in the order they are stored
+    auto found = std::lower_bound(m_objectIndex.begin(),
+                                  m_objectIndex.end(),
+                                  static_cast<uint64>(offset),
+                                  [](const FileObjectInfo& info, uint64 value) {
+                                    return info.offset < value;
+                                  });
+    if (m_hasIndex && m_objectIndex.end() != found && found->offset == offset) {
+      return found->size;
+    }
+
+    GE_LOG(kError, FileSystem, "The size of an object isn't in the index of the file. "
+           "The file may be truncated.");
+    m_inputStream->seek(m_inputStream->size());
+    return 0;
+  }
+
+  bool
+  FileDecoder::isEndOfObjects() const {
+    return m_inputStream->isEOF() || m_inputStream->tell() >= m_objectsEnd;
   }
 }
@@ -21,21 +21,67 @@
 #include "geDataStream.h"
 #include "geUnicode.h"
 #include "geDebug.h"
+#include "geDirectoryWalker.h"
+#include "geFileWatcher.h"
+#include "gePackFile.h"
+#include "geTaskScheduler.h"
+
+#if USING(GE_PLATFORM_LINUX)
+#   include <cstdio>
+#   include <sys/stat.h>
+#   include <sys/sysmacros.h>
+#endif
 
 #if USING(GE_USE_GENERIC_FILESYSTEM)
 #   include <filesystem>
   namespace fileSys = std::filesystem;
-  using std::visit;
   using std::error_code;
 #endif
 
 namespace geEngineSDK {
+  using std::max;
+  using std::min;
   using std::tuple;
   using std::make_tuple;
   using std::get;
   using namespace std::chrono;
   
   Mutex FileScheduler::m_mutex;
+  UnorderedMap<uint64, FileScheduler::DeviceState> FileScheduler::m_devices;
+  uint32 FileScheduler::m_rotationalConcurrency = 1;
+  uint32 FileScheduler::m_solidStateConcurrency = 4;
+
+  /**
+   * @brief Reads the state of a file from the FileWatcher stat cache.
+   *        Returns false if it isn't available for the path.
+   */
+  bool
+  sys_getCachedStat(const Path& fullPath, FileStat& stat) {
+    return FileWatcher::isStarted() &&
+           FileWatcher::instance().getStat(fullPath, stat);
+  }
+
+  /**
+   * @brief Drops a path, and everything under it, from the FileWatcher stat
+   *        cache. Called after FileSystem modifies it, so the change is seen
+   *        before its notification arrives.
+   */
+  void
+  sys_invalidateCachedStat(const Path& fullPath) {
+    if (FileWatcher::isStarted()) {
+      FileWatcher::instance().invalidate(fullPath);
+    }
+  }
+
+  /**
+   * @brief Looks for a path in the packs mounted on the PackFileSystem.
+   *        Returns false if none of them has it.
+   */
+  bool
+  sys_findPackedFile(const Path& fullPath, PackedFileInfo& info) {
+    return PackFileSystem::isStarted() &&
+           PackFileSystem::instance().find(fullPath, info);
+  }
 
 #if USING(GE_USE_GENERIC_FILESYSTEM)
   bool
@@ -123,7 +169,17 @@ namespace geEngineSDK {
   }
 
   SPtr<DataStream>
-  FileSystem::openFile(const Path& fullPath, bool readOnly) {
+  FileSystem::openFile(const Path& fullPath,
+                       bool readOnly,
+                       FILE_STREAM_TYPE::E streamType) {
+    //Mounted packs are read only
+    if (readOnly && PackFileSystem::isStarted()) {
+      SPtr<DataStream> packedFile = PackFileSystem::instance().openFile(fullPath);
+      if (packedFile) {
+        return packedFile;
+      }
+    }
+
     WString pathWString = UTF8::toWide(fullPath.toString());
     auto pathString = pathWString.c_str();
 
@@ -141,22 +197,54 @@ namespace geEngineSDK {
                      static_cast<uint32>(ACCESS_MODE::kWRITE));
     }
 
+    GE_UNREFERENCED_PARAMETER(streamType);
+
     return ge_shared_ptr_new<FileDataStream>(fullPath, accessMode, true);
   }
 
   bool
   FileSystem::exists(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return true;
+    }
+
+    FileStat stat;
+    if (sys_getCachedStat(fullPath, stat)) {
+      return stat.exists;
+    }
+
     return sys_pathExists(UTF8::toWide(fullPath.toString()));
   }
 
   bool
   FileSystem::isFile(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return !packedInfo.isDirectory;
+    }
+
+    FileStat stat;
+    if (sys_getCachedStat(fullPath, stat)) {
+      return stat.exists && !stat.isDirectory;
+    }
+
     WString pathStr = UTF8::toWide(fullPath.toString());
     return sys_pathExists(pathStr) && sys_isFile(pathStr);
   }
 
   bool
   FileSystem::isDirectory(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.isDirectory;
+    }
+
+    FileStat stat;
+    if (sys_getCachedStat(fullPath, stat)) {
+      return stat.isDirectory;
+    }
+
     WString pathStr = UTF8::toWide(fullPath.toString());
     return sys_pathExists(pathStr) && sys_isDirectory(pathStr);
   }
@@ -171,9 +259,10 @@ namespace geEngineSDK {
 
     WString result(currentDir.wstring());
 
-    //Append backslash if not present
-    if (!result.empty() && result.back() != L'\\') {
-      result.append(L"\\");
+    //Append the separator if not present, so it's parsed as a directory
+    const auto separator = static_cast<WString::value_type>(fileSys::path::preferred_separator);
+    if (!result.empty() && result.back() != separator) {
+      result.push_back(separator);
     }
 
     return Path(UTF8::fromWide(result));
@@ -184,9 +273,10 @@ namespace geEngineSDK {
     fileSys::path tempDir = fileSys::temp_directory_path();
     WString result(tempDir.wstring());
 
-    //Append backslash if not present
-    if (!result.empty() && result.back() != L'\\') {
-      result.append(L"\\");
+    //Append the separator if not present, so it's parsed as a directory
+    const auto separator = static_cast<WString::value_type>(fileSys::path::preferred_separator);
+    if (!result.empty() && result.back() != separator) {
+      result.push_back(separator);
     }
 
     return Path(UTF8::fromWide(result));
@@ -204,81 +294,42 @@ namespace geEngineSDK {
       //If `fullPath` is a directory, create all directories up to the directory
       fileSys::create_directories(dirPath);
     }
-  }
-
-  void
-  FileSystem::getChildren(const Path& dirPath,
-                          Vector<Path>& files,
-                          Vector<Path>& directories) {
-    WString findPath = UTF8::toWide(dirPath.toString());
-
-    //Check if the path is a directory; if it's a file, return immediately
-    if (!fileSys::exists(findPath) || !fileSys::is_directory(findPath)) {
-      return;
-    }
-
-    //Iterate over the directory entries
-    for (const auto& entry : fileSys::directory_iterator(findPath)) {
-      String fullPath = UTF8::fromWide(WString(entry.path().wstring()));
 
-      if (entry.is_directory()) {
-        directories.push_back(fullPath);
-      }
-      else if (entry.is_regular_file()) {
-        files.push_back(fullPath);
-      }
+    //Any of the parents created could be cached as missing
+    sys_invalidateCachedStat(fullPath);
+    for (Path parent = fullPath.getParent(); 0 != parent.getNumDirectories();) {
+      sys_invalidateCachedStat(parent);
+      parent = parent.getParent();
     }
   }
 
-  bool
-  FileSystem::iterate(const Path& dirPath,
-                      const function<bool(const Path&)>& fileCallback,
-                      const function<bool(const Path&)>& dirCallback,
-                      bool recursive) {
-    WString findPath = UTF8::toWide(dirPath.toString());
-
-    //Check if the path is a directory
-    if (!fileSys::exists(findPath) || !fileSys::is_directory(findPath)) {
-      return false;
+  uint64
+  FileSystem::getFileSize(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.size;
     }
 
-    // Use std::variant to hold either type of iterator
-    using DirIter = Variant<fileSys::directory_iterator,
-                            fileSys::recursive_directory_iterator>;
-    DirIter iterator = recursive ? DirIter(fileSys::recursive_directory_iterator(findPath))
-                                 : DirIter(fileSys::directory_iterator(findPath));
-
-    //Iterate over each entry in the directory
-    auto visitEntry = [&](auto& it)
-    {
-      for (const auto& entry : it) {
-        Path fullPath = UTF8::fromWide(WString(entry.path().wstring()));
-
-        if (entry.is_directory()) {
-          //Handle directories
-          if (dirCallback) {
-            if (!dirCallback(fullPath)) {
-              return false; //Stop iteration if callback returns false
-            }
-          }
-        }
-        else if (entry.is_regular_file()) {
-          //Handle files
-          if (fileCallback) {
-            if (!fileCallback(fullPath)) {
-              return false;  //Stop iteration if callback returns false
-            }
-          }
-        }
-      }
-      return true;
-    };
+    FileStat stat;
+    if (sys_getCachedStat(fullPath, stat)) {
+      return stat.isRegularFile ? stat.size : 0;
+    }
 
-    return visit(visitEntry, iterator);
+    return sys_getFileSize(UTF8::toWide(fullPath.toString()));
   }
 
   time_t
   FileSystem::getLastModifiedTime(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.lastModifiedTime;
+    }
+
+    FileStat stat;
+    if (sys_getCachedStat(fullPath, stat)) {
+      return stat.isRegularFile ? stat.lastModifiedTime : 0;
+    }
+
     return sys_getLastModifiedTime(UTF8::toWide(fullPath.toString()));
   }
 
@@ -295,6 +346,8 @@ namespace geEngineSDK {
              "Failed to copy file from \"{0}\" to \"{1}\". Error: {2}",
              from.toString(), to.toString(), String(ec.message()));
     }
+
+    sys_invalidateCachedStat(to);
   }
 
   void
@@ -310,6 +363,8 @@ namespace geEngineSDK {
         fileSys::remove(fromPath);  //Removes a single file
       }
     }
+
+    sys_invalidateCachedStat(path);
   }
 
   void
@@ -321,27 +376,109 @@ namespace geEngineSDK {
     if (fileSys::exists(fromPath)) {
       fileSys::rename(fromPath, toPath);  //Moves or renames the file
     }
+
+    sys_invalidateCachedStat(oldPath);
+    sys_invalidateCachedStat(newPath);
   }
 
 #endif // USING(GE_USE_GENERIC_FILESYSTEM)
 
+#if !USING(GE_PLATFORM_WINDOWS)
   void
-  FileSystem::copy(const Path& oldPath, const Path& newPath, bool overwriteExisting) {
-    Stack<tuple<Path, Path>> todo;
-    todo.push(make_tuple(oldPath, newPath));
+  FileSystem::getChildren(const Path& dirPath,
+                          Vector<Path>& files,
+                          Vector<Path>& directories) {
+    DirectoryWalkOptions options;
+    options.recursive = false;
+
+    //If the path isn't a directory the walk simply finds nothing
+    DirectoryWalker::walk(dirPath,
+                          [&files](const DirectoryEntry& entry) {
+                            files.push_back(entry.toPath());
+                            return true;
+                          },
+                          [&directories](const DirectoryEntry& entry) {
+                            directories.push_back(entry.toPath());
+                            return true;
+                          },
+                          options);
+  }
+
+  bool
+  FileSystem::iterate(const Path& dirPath,
+                      const function<bool(const Path&)>& fileCallback,
+                      const function<bool(const Path&)>& dirCallback,
+                      bool recursive) {
+    DirectoryWalkOptions options;
+    options.recursive = recursive;
+
+    //Paths are only built for the kinds of entries someone is listening to
+    DirectoryWalker::EntryCallback onFile;
+    if (fileCallback) {
+      onFile = [&fileCallback](const DirectoryEntry& entry) {
+        return fileCallback(entry.toPath());
+      };
+    }
+
+    DirectoryWalker::EntryCallback onDir;
+    if (dirCallback) {
+      onDir = [&dirCallback](const DirectoryEntry& entry) {
+        return dirCallback(entry.toPath());
+      };
+    }
+
+    return DirectoryWalker::walk(dirPath, onFile, onDir, options);
+  }
+#endif
+
+  /**
+   * @brief Returns @p path in directory form, so a path like "a/b" built for
+   *        a directory isn't taken as a file named "b" in "a".
+   */
+  Path
+  sys_asDirectory(const Path& path) {
+    Path dirPath = path;
+    return dirPath.append(Path::BLANK);
+  }
+
+  void
+  FileSystem::copy(const Path& oldPath,
+                   const Path& newPath,
+                   bool overwriteExisting,
+                   const function<void(const FileCopyProgress&)>& progressCallback) {
+    //Directories are created while walking the tree, the files are collected
+    //so they can all be copied at once
+    Vector<tuple<Path, Path, uint64>> filesToCopy;
+    FileCopyProgress progress;
+
+    //Entries listed by getChildren() are known to exist and their type is
+    //known. If their parent was just created, their destination is too
+    struct CopyEntry
+    {
+      Path source;
+      Path destination;
+      bool isListed;
+      bool isFile;
+      bool isNewDestination;
+    };
+
+    Stack<CopyEntry> todo;
+    todo.push({ oldPath, newPath, false, false, false });
 
     while (!todo.empty()) {
-      auto current = todo.top();
+      CopyEntry current = todo.top();
       todo.pop();
 
-      Path sourcePath = get<0>(current);
-      if (!FileSystem::exists(sourcePath)) {
+      const Path& sourcePath = current.source;
+      if (!current.isListed && !FileSystem::exists(sourcePath)) {
         continue;
       }
 
-      bool srcIsFile = FileSystem::isFile(sourcePath);
-      Path destinationPath = get<1>(current);
-      bool destExists = FileSystem::exists(destinationPath);
+      bool srcIsFile = current.isListed ? current.isFile
+                                        : FileSystem::isFile(sourcePath);
+      const Path& destinationPath = current.destination;
+      bool destExists = !current.isNewDestination &&
+                        FileSystem::exists(destinationPath);
 
       if (destExists) {
         if (FileSystem::isFile(destinationPath)) {
@@ -358,30 +495,131 @@ namespace geEngineSDK {
       }
 
       if (srcIsFile) {
-        FileSystem::copyFile(sourcePath, destinationPath);
+        const uint64 fileSize = FileSystem::getFileSize(sourcePath);
+        filesToCopy.push_back(make_tuple(sourcePath, destinationPath, fileSize));
+        progress.totalBytes += fileSize;
       }
       else {
         if (!destExists) {
-          FileSystem::createDir(destinationPath);
+          FileSystem::createDir(sys_asDirectory(destinationPath));
         }
 
         Vector<Path> files;
         Vector<Path> directories;
-        getChildren(destinationPath, files, directories);
+        getChildren(sourcePath, files, directories);
 
         for (auto& file : files) {
           Path fileDestPath = destinationPath;
           fileDestPath.append(Path(file.getTail()));
-          todo.push(make_tuple(file, fileDestPath));
+          todo.push({ file, fileDestPath, true, true, !destExists });
         }
 
         for (auto& dir : directories) {
           Path dirDestPath = destinationPath;
           dirDestPath.append(Path(dir.getTail()));
-          todo.push(make_tuple(dir, dirDestPath));
+          todo.push({ dir, dirDestPath, true, false, !destExists });
         }
       }
     }
+
+    const auto numFiles = static_cast<uint32>(filesToCopy.size());
+    progress.totalFiles = numFiles;
+
+    const auto startTime = high_resolution_clock::now();
+    auto reportProgress = [&](uint32 filesCopied, uint64 bytesCopied) {
+      progress.filesCopied = filesCopied;
+      progress.bytesCopied = bytesCopied;
+
+      const float elapsed = duration<float>(high_resolution_clock::now() -
+                                            startTime).count();
+      if (elapsed > 0.0f) {
+        progress.filesPerSecond = filesCopied / elapsed;
+        progress.bytesPerSecond = bytesCopied / elapsed;
+      }
+
+      progressCallback(progress);
+    };
+
+    uint32 numWorkers = 1;
+    if (numFiles > 1 && TaskScheduler::isStarted()) {
+      numWorkers = min(numFiles, TaskScheduler::instance().getNumWorkers());
+    }
+
+    if (numWorkers <= 1) {
+      uint64 bytesCopied = 0;
+      for (uint32 i = 0; i < numFiles; ++i) {
+        FileSystem::copyFile(get<0>(filesToCopy[i]), get<1>(filesToCopy[i]));
+        bytesCopied += get<2>(filesToCopy[i]);
+        if (progressCallback) {
+          reportProgress(i + 1, bytesCopied);
+        }
+      }
+      return;
+    }
+
+    //The concurrency limits of the devices bound the files copied at once
+    const uint64 srcDevice = FileScheduler::getDeviceId(oldPath);
+    const uint64 dstDevice = FileScheduler::getDeviceId(newPath);
+
+    Mutex mutex;
+    Signal copiedCond;
+    uint32 nextFile = 0;
+    uint32 filesCopied = 0;
+    uint64 bytesCopied = 0;
+
+    auto taskGroup = TaskGroup::create("FileCopy",
+    [&](uint32) {
+      while (true) {
+        uint32 fileIdx;
+        {
+          Lock lock(mutex);
+          if (nextFile >= numFiles) {
+            break;
+          }
+          fileIdx = nextFile++;
+        }
+
+        const auto& file = filesToCopy[fileIdx];
+        {
+          //Devices are always locked in the same order, so copies running in
+          //opposite directions can't block each other
+          FileScheduler::ScopedLock firstLock(min(srcDevice, dstDevice));
+          if (srcDevice == dstDevice) {
+            FileSystem::copyFile(get<0>(file), get<1>(file));
+          }
+          else {
+            FileScheduler::ScopedLock secondLock(max(srcDevice, dstDevice));
+            FileSystem::copyFile(get<0>(file), get<1>(file));
+          }
+        }
+
+        {
+          Lock lock(mutex);
+          ++filesCopied;
+          bytesCopied += get<2>(file);
+        }
+        copiedCond.notify_one();
+      }
+    },
+    numWorkers);
+
+    TaskScheduler::instance().addTaskGroup(taskGroup);
+
+    if (progressCallback) {
+      Lock lock(mutex);
+      uint32 filesReported = 0;
+      while (filesReported < numFiles) {
+        copiedCond.wait(lock, [&]() { return filesCopied != filesReported; });
+        filesReported = filesCopied;
+        const uint64 bytesReported = bytesCopied;
+
+        lock.unlock();
+        reportProgress(filesReported, bytesReported);
+        lock.lock();
+      }
+    }
+
+    taskGroup->wait();
   }
 
   void
@@ -426,6 +664,169 @@ namespace geEngineSDK {
 
   SPtr<DataStream>
   FileSystem::createAndOpenFile(const Path& fullPath) {
-    return ge_shared_ptr_new<FileDataStream>(fullPath, ACCESS_MODE::kWRITE, true);
+    auto fileStream = ge_shared_ptr_new<FileDataStream>(fullPath,
+                                                        ACCESS_MODE::kWRITE,
+                                                        true);
+    sys_invalidateCachedStat(fullPath);
+    return fileStream;
+  }
+
+#if USING(GE_PLATFORM_LINUX)
+  /**
+   * @brief Returns 1 for rotational block devices, 0 for solid state ones
+   *        and -1 if the type can't be determined (e.g. network or memory
+   *        file systems).
+   */
+  int32
+  linux_isRotationalDevice(uint64 deviceId) {
+    const dev_t device = static_cast<dev_t>(deviceId);
+    const String devicePath = "/sys/dev/block/" + toString(major(device)) +
+                              ":" + toString(minor(device));
+
+    //Partitions don't have a queue of their own, their parent disk does
+    FILE* file = fopen((devicePath + "/queue/rotational").c_str(), "r");
+    if (nullptr == file) {
+      file = fopen((devicePath + "/../queue/rotational").c_str(), "r");
+    }
+
+    if (nullptr == file) {
+      return -1;
+    }
+
+    int32 rotational = -1;
+    if (1 != fscanf(file, "%d", &rotational)) {
+      rotational = -1;
+    }
+    fclose(file);
+
+    return rotational;
+  }
+#endif
+
+  FileScheduler::ScopedLock::ScopedLock(const Path& path)
+    : m_deviceId(getDeviceId(path)) {
+    lockDevice(m_deviceId);
+  }
+
+  FileScheduler::ScopedLock::ScopedLock(uint64 deviceId)
+    : m_deviceId(deviceId) {
+    lockDevice(m_deviceId);
+  }
+
+  FileScheduler::ScopedLock::~ScopedLock() {
+    unlockDevice(m_deviceId);
+  }
+
+  void
+  FileScheduler::lock(const Path& path) {
+    lockDevice(getDeviceId(path));
+  }
+
+  void
+  FileScheduler::unlock(const Path& path) {
+    unlockDevice(getDeviceId(path));
+  }
+
+  uint64
+  FileScheduler::getDeviceId(const Path& path) {
+#if USING(GE_PLATFORM_LINUX)
+    Path current = path;
+    if (!current.isAbsolute()) {
+      current = path.getAbsolute(FileSystem::getWorkingDirectoryPath());
+    }
+
+    //Files that don't exist yet will be created on the device of their folder
+    while (true) {
+      struct stat fileStat;
+      if (0 == stat(current.toPlatformString().c_str(), &fileStat)) {
+        return static_cast<uint64>(fileStat.st_dev);
+      }
+
+      Path parent = current.getParent();
+      if (parent == current) {
+        break;
+      }
+      current = parent;
+    }
+
+    return 0;
+#else
+    //Drives (or network shares) are the closest we have to a device
+    if (path.getDevice().empty() && path.getNode().empty()) {
+      return 0;
+    }
+
+    String device = path.getNode() + ":" + path.getDevice();
+    StringUtil::toLowerCase(device);
+    return static_cast<uint64>(std::hash<String>()(device));
+#endif
+  }
+
+  void
+  FileScheduler::setDeviceConcurrency(uint64 deviceId, uint32 maxConcurrent) {
+    DeviceState* device;
+    {
+      Lock lock(m_mutex);
+      device = &getDevice(deviceId);
+      device->maxConcurrent = std::max(maxConcurrent, 1u);
+    }
+
+    device->released.notify_all();
+  }
+
+  uint32
+  FileScheduler::getDeviceConcurrency(uint64 deviceId) {
+    Lock lock(m_mutex);
+    return getDevice(deviceId).maxConcurrent;
+  }
+
+  void
+  FileScheduler::setDefaultConcurrency(uint32 rotational, uint32 solidState) {
+    Lock lock(m_mutex);
+    m_rotationalConcurrency = std::max(rotational, 1u);
+    m_solidStateConcurrency = std::max(solidState, 1u);
+  }
+
+  FileScheduler::DeviceState&
+  FileScheduler::getDevice(uint64 deviceId) {
+    auto iterFind = m_devices.find(deviceId);
+    if (m_devices.end() != iterFind) {
+      return iterFind->second;
+    }
+
+    DeviceState& device = m_devices[deviceId];
+#if USING(GE_PLATFORM_LINUX)
+    const bool solidState = 0 == linux_isRotationalDevice(deviceId);
+#else
+    const bool solidState = false;
+#endif
+    device.maxConcurrent = solidState ? m_solidStateConcurrency :
+                                        m_rotationalConcurrency;
+    return device;
+  }
+
+  void
+  FileScheduler::lockDevice(uint64 deviceId) {
+    Lock lock(m_mutex);
+    DeviceState& device = getDevice(deviceId);
+    while (device.numActive >= device.maxConcurrent) {
+      device.released.wait(lock);
+    }
+
+    ++device.numActive;
+  }
+
+  void
+  FileScheduler::unlockDevice(uint64 deviceId) {
+    DeviceState* device;
+    {
+      Lock lock(m_mutex);
+      device = &getDevice(deviceId);
+      if (device->numActive > 0) {
+        --device->numActive;
+      }
+    }
+
+    device->released.notify_one();
   }
 }
@@ -0,0 +1,576 @@
+/*****************************************************************************/
+/**
+ * @file    geFileWatcher.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Notifies about changes to watched directories.
+ *
+ * Notifies about files created, modified or removed inside watched
+ * directories. On Linux the changes are reported by inotify, and queued in
+ * batches until update() triggers the callbacks.
+ *
+ * The watcher can also keep a cache of the state of the files inside the
+ * watched directories. FileSystem queries it before going to the OS, and the
+ * watcher invalidates the entries as changes are reported, so repeated
+ * existence, size and timestamp checks don't need any system call.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geFileWatcher.h"
+#include "geDirectoryWalker.h"
+#include "geFileSystem.h"
+#include "geDebug.h"
+
+#if USING(GE_PLATFORM_LINUX)
+#   include <cerrno>
+#   include <poll.h>
+#   include <sys/eventfd.h>
+#   include <sys/inotify.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace geEngineSDK {
+  using std::max;
+  using std::move;
+  using namespace std::chrono;
+
+  namespace {
+    /**
+     * @brief Returns true if @p dirPath is @p rootPath or a directory inside
+     *        it.
+     */
+    bool
+    isInsideDirectory(const String& dirPath, const String& rootPath) {
+      if (dirPath.size() < rootPath.size() ||
+          0 != dirPath.compare(0, rootPath.size(), rootPath)) {
+        return false;
+      }
+
+      return dirPath.size() == rootPath.size() ||
+             '/' == rootPath.back() ||
+             '/' == dirPath[rootPath.size()];
+    }
+
+    /**
+     * @brief Returns the directory a path is in, or an empty string if it
+     *        has none.
+     */
+    String
+    getParentDirectory(const String& path) {
+      const SIZE_T separator = path.rfind('/');
+      if (String::npos == separator) {
+        return String();
+      }
+
+      return path.substr(0, 0 == separator ? 1 : separator);
+    }
+
+    /**
+     * @brief Returns the string used to identify an absolute path in the
+     *        watcher, or an empty string for relative paths.
+     */
+    String
+    getWatchKey(const Path& fullPath) {
+      if (!fullPath.isAbsolute()) {
+        return String();
+      }
+
+      String key = fullPath.toString();
+      while (key.size() > 1 && '/' == key.back()) {
+        key.pop_back();
+      }
+      return key;
+    }
+  }
+
+  void
+  FileWatcher::update() {
+    Vector<Batch> batches;
+    {
+      Lock lock(m_mutex);
+      batches.swap(m_queued);
+    }
+
+    for (auto& batch : batches) {
+      batch.callback(batch.changes);
+    }
+  }
+
+  void
+  FileWatcher::invalidate(const Path& fullPath) {
+    if (!m_options.enableStatCache) {
+      return;
+    }
+
+    const String key = getWatchKey(fullPath);
+    if (key.empty()) {
+      return;
+    }
+
+    Lock lock(m_mutex);
+    invalidateLocked(key, true);
+  }
+
+  bool
+  FileWatcher::isCovered(const String& dirPath) const {
+    for (const auto& watch : m_watches) {
+      if (dirPath == watch.path ||
+          (watch.recursive && isInsideDirectory(dirPath, watch.path))) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void
+  FileWatcher::onChange(const String& path,
+                        FILE_CHANGE::E type,
+                        bool isDirectory) {
+    invalidateLocked(path, isDirectory && FILE_CHANGE::kMODIFIED != type);
+
+    //Editors save with several writes, only the first change of a kind counts
+    auto it = m_pendingIdx.find(path);
+    if (m_pendingIdx.end() != it) {
+      const FILE_CHANGE::E lastType = m_pending[it->second].type;
+      if (lastType == type ||
+          (FILE_CHANGE::kCREATED == lastType && FILE_CHANGE::kMODIFIED == type)) {
+        return;
+      }
+    }
+
+    m_pendingIdx[path] = static_cast<uint32>(m_pending.size());
+    m_pending.push_back({ path, type, isDirectory });
+  }
+
+  void
+  FileWatcher::flushPending() {
+    Lock lock(m_mutex);
+
+    for (const auto& watch : m_watches) {
+      Batch batch;
+      for (const auto& change : m_pending) {
+        const String parent = getParentDirectory(change.path);
+        if (parent != watch.path &&
+            !(watch.recursive && isInsideDirectory(parent, watch.path))) {
+          continue;
+        }
+
+        FileChange fileChange;
+        fileChange.path = Path(change.path);
+        fileChange.type = change.type;
+        fileChange.isDirectory = change.isDirectory;
+        batch.changes.push_back(move(fileChange));
+      }
+
+      if (!batch.changes.empty()) {
+        batch.watchId = watch.id;
+        batch.callback = watch.callback;
+        m_queued.push_back(move(batch));
+      }
+    }
+
+    m_pending.clear();
+    m_pendingIdx.clear();
+  }
+
+  void
+  FileWatcher::invalidateLocked(const String& path, bool recursive) {
+    //Stats read before this point may be older than the change
+    ++m_cacheGeneration;
+    if (m_statCache.empty()) {
+      return;
+    }
+
+    //Adding or removing an entry changes the time of its directory as well
+    for (const auto& key : { path, getParentDirectory(path) }) {
+      if (0 != m_statCache.erase(key)) {
+        m_cachedPaths.erase(key);
+      }
+    }
+
+    if (!recursive) {
+      return;
+    }
+
+    String prefix = path;
+    if (prefix.empty() || '/' != prefix.back()) {
+      prefix += '/';
+    }
+
+    auto it = m_cachedPaths.lower_bound(prefix);
+    while (m_cachedPaths.end() != it &&
+           0 == it->compare(0, prefix.size(), prefix)) {
+      m_statCache.erase(*it);
+      it = m_cachedPaths.erase(it);
+    }
+  }
+
+#if USING(GE_PLATFORM_LINUX)
+  namespace {
+    const uint32 kWatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB |
+                              IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+                              IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR |
+                              IN_EXCL_UNLINK;
+  }
+
+  FileWatcher::FileWatcher(const FileWatcherOptions& options)
+    : m_options(options) {
+    m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (-1 == m_notifyFd || -1 == m_wakeFd) {
+      GE_LOG(kError,
+             FileSystem,
+             "Couldn't create the inotify instance ({0}). Files won't be "
+             "watched.",
+             errno);
+      return;
+    }
+
+    m_thread = ThreadPool::instance().run("FileWatcher", [this]() {
+      run();
+    });
+  }
+
+  FileWatcher::~FileWatcher() {
+    //The thread is only started if both descriptors were created
+    if (-1 != m_notifyFd && -1 != m_wakeFd) {
+      const uint64 value = 1;
+      if (sizeof(value) != ::write(m_wakeFd, &value, sizeof(value))) {
+        GE_LOG(kError, FileSystem, "Couldn't wake up the watcher thread.");
+      }
+      m_thread.blockUntilComplete();
+    }
+
+    if (-1 != m_notifyFd) {
+      ::close(m_notifyFd);
+    }
+
+    if (-1 != m_wakeFd) {
+      ::close(m_wakeFd);
+    }
+  }
+
+  uint32
+  FileWatcher::watch(const Path& dirPath, bool recursive, ChangeCallback callback) {
+    String path = dirPath.toString();
+    if (!dirPath.isAbsolute()) {
+      Path absolutePath = dirPath;
+      absolutePath.makeAbsolute(FileSystem::getWorkingDirectoryPath());
+      path = absolutePath.toString();
+    }
+
+    while (path.size() > 1 && '/' == path.back()) {
+      path.pop_back();
+    }
+
+    Lock lock(m_mutex);
+    if (-1 == m_notifyFd || !addDirectory(path, recursive, nullptr)) {
+      GE_LOG(kWarning,
+             FileSystem,
+             "Couldn't watch the directory: {0}",
+             dirPath);
+      return 0;
+    }
+
+    const uint32 watchId = m_nextWatchId++;
+    m_watches.push_back({ watchId, path, recursive, move(callback) });
+    return watchId;
+  }
+
+  void
+  FileWatcher::unwatch(uint32 watchId) {
+    Lock lock(m_mutex);
+
+    auto removedWatch = std::remove_if(m_watches.begin(),
+                                       m_watches.end(),
+                                       [watchId](const Watch& watch) {
+                                         return watch.id == watchId;
+                                       });
+    m_watches.erase(removedWatch, m_watches.end());
+
+    auto removedBatch = std::remove_if(m_queued.begin(),
+                                       m_queued.end(),
+                                       [watchId](const Batch& batch) {
+                                         return batch.watchId == watchId;
+                                       });
+    m_queued.erase(removedBatch, m_queued.end());
+
+    //Stop receiving notifications for directories no other watch needs
+    for (auto it = m_watchedDirs.begin(); it != m_watchedDirs.end();) {
+      if (isCovered(it->second)) {
+        ++it;
+        continue;
+      }
+
+      inotify_rm_watch(m_notifyFd, it->first);
+      invalidateLocked(it->second, true);
+      m_watchedDirIds.erase(it->second);
+      it = m_watchedDirs.erase(it);
+    }
+  }
+
+  bool
+  FileWatcher::addDirectory(const String& dirPath,
+                            bool recursive,
+                            Vector<FileChange>* found) {
+    const int32 watchDesc = inotify_add_watch(m_notifyFd, dirPath.c_str(), kWatchMask);
+    if (-1 == watchDesc) {
+      return false;
+    }
+
+    m_watchedDirs[watchDesc] = dirPath;
+    m_watchedDirIds[dirPath] = watchDesc;
+
+    if (!recursive && nullptr == found) {
+      return true;
+    }
+
+    auto reportFound = [found](const DirectoryEntry& entry) {
+      if (nullptr != found) {
+        FileChange change;
+        change.path = entry.toPath();
+        change.type = FILE_CHANGE::kCREATED;
+        change.isDirectory = entry.isDirectory;
+        found->push_back(move(change));
+      }
+      return true;
+    };
+
+    //Subdirectories are watched before their contents are listed, so files
+    //created in the meantime are either found or notified
+    DirectoryWalkOptions options;
+    options.recursive = recursive;
+    DirectoryWalker::walk(Path(dirPath),
+                          reportFound,
+                          [&](const DirectoryEntry& entry) {
+                            if (recursive && !entry.isSymbolicLink) {
+                              const String subdirPath = entry.toString();
+                              const int32 subdirDesc =
+                                inotify_add_watch(m_notifyFd,
+                                                  subdirPath.c_str(),
+                                                  kWatchMask);
+                              if (-1 != subdirDesc) {
+                                m_watchedDirs[subdirDesc] = subdirPath;
+                                m_watchedDirIds[subdirPath] = subdirDesc;
+                              }
+                            }
+                            return reportFound(entry);
+                          },
+                          options);
+
+    return true;
+  }
+
+  bool
+  FileWatcher::getStat(const Path& fullPath, FileStat& stat) {
+    if (!m_options.enableStatCache) {
+      return false;
+    }
+
+    const String key = getWatchKey(fullPath);
+    if (key.empty()) {
+      return false;
+    }
+
+    uint64 generation;
+    {
+      Lock lock(m_mutex);
+      auto it = m_statCache.find(key);
+      if (m_statCache.end() != it) {
+        stat = it->second;
+        return true;
+      }
+
+      //Only entries of watched directories get invalidated when they change
+      if (m_watchedDirIds.end() == m_watchedDirIds.find(getParentDirectory(key))) {
+        return false;
+      }
+
+      generation = m_cacheGeneration;
+    }
+
+    stat = FileStat();
+    struct stat info;
+    if (0 == ::stat(key.c_str(), &info)) {
+      stat.exists = true;
+      stat.isDirectory = S_ISDIR(info.st_mode);
+      stat.isRegularFile = S_ISREG(info.st_mode);
+      stat.size = static_cast<uint64>(info.st_size);
+      stat.lastModifiedTime = info.st_mtime;
+    }
+
+    Lock lock(m_mutex);
+    if (generation == m_cacheGeneration) {
+      if (m_statCache.size() >= m_options.maxCachedEntries) {
+        m_statCache.clear();
+        m_cachedPaths.clear();
+      }
+
+      m_statCache[key] = stat;
+      m_cachedPaths.insert(key);
+    }
+
+    return true;
+  }
+
+  void
+  FileWatcher::run() {
+    pollfd fds[2];
+    fds[0].fd = m_notifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeFd;
+    fds[1].events = POLLIN;
+
+    alignas(inotify_event) ANSICHAR buffer[64 * 1024];
+    Vector<FileChange> found;
+    auto batchStart = steady_clock::now();
+    bool hasPending = false;
+
+    while (true) {
+      int32 timeout = -1;
+      if (hasPending) {
+        const auto elapsed = duration_cast<milliseconds>(steady_clock::now() -
+                                                         batchStart).count();
+        timeout = static_cast<int32>(max(static_cast<int64>(0),
+                                         m_options.batchDelayMs - elapsed));
+      }
+
+      const int32 numReady = poll(fds, 2, timeout);
+      if (-1 == numReady && EINTR == errno) {
+        continue;
+      }
+
+      if (-1 == numReady || 0 != (fds[1].revents & POLLIN)) {
+        break;
+      }
+
+      if (0 != (fds[0].revents & POLLIN)) {
+        Lock lock(m_mutex);
+
+        int64 numRead;
+        while ((numRead = ::read(m_notifyFd, buffer, sizeof(buffer))) > 0) {
+          for (int64 offset = 0; offset < numRead;) {
+            auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (0 != (event->mask & IN_Q_OVERFLOW)) {
+              GE_LOG(kWarning,
+                     FileSystem,
+                     "Too many file changes at once, some weren't reported.");
+              m_statCache.clear();
+              m_cachedPaths.clear();
+              ++m_cacheGeneration;
+              continue;
+            }
+
+            auto dirIt = m_watchedDirs.find(event->wd);
+            if (m_watchedDirs.end() == dirIt) {
+              continue;
+            }
+
+            if (0 != (event->mask & IN_IGNORED)) {
+              invalidateLocked(dirIt->second, true);
+              m_watchedDirIds.erase(dirIt->second);
+              m_watchedDirs.erase(dirIt);
+              continue;
+            }
+
+            //The parent directory reports the change, we only stop watching
+            if (0 != (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))) {
+              invalidateLocked(dirIt->second, true);
+              inotify_rm_watch(m_notifyFd, event->wd);
+              continue;
+            }
+
+            if (0 == event->len) {
+              continue;
+            }
+
+            String path = dirIt->second;
+            if ('/' != path.back()) {
+              path += '/';
+            }
+            path += event->name;
+
+            const bool isDirectory = 0 != (event->mask & IN_ISDIR);
+            if (0 != (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+              onChange(path, FILE_CHANGE::kCREATED, isDirectory);
+
+              if (isDirectory && isCovered(path)) {
+                found.clear();
+                addDirectory(path, true, &found);
+                for (const auto& change : found) {
+                  onChange(change.path.toString(),
+                           FILE_CHANGE::kCREATED,
+                           change.isDirectory);
+                }
+              }
+            }
+            else if (0 != (event->mask & (IN_DELETE | IN_MOVED_FROM))) {
+              onChange(path, FILE_CHANGE::kREMOVED, isDirectory);
+            }
+            else {
+              onChange(path, FILE_CHANGE::kMODIFIED, isDirectory);
+            }
+          }
+        }
+
+        if (!hasPending && !m_pending.empty()) {
+          hasPending = true;
+          batchStart = steady_clock::now();
+        }
+      }
+
+      if (hasPending &&
+          duration_cast<milliseconds>(steady_clock::now() - batchStart).count() >=
+            m_options.batchDelayMs) {
+        flushPending();
+        hasPending = false;
+      }
+    }
+  }
+#else
+  FileWatcher::FileWatcher(const FileWatcherOptions& options)
+    : m_options(options) {
+    GE_LOG(kWarning,
+           FileSystem,
+           "File watching isn't supported on this platform.");
+  }
+
+  FileWatcher::~FileWatcher() = default;
+
+  uint32
+  FileWatcher::watch(const Path& dirPath, bool, ChangeCallback) {
+    GE_LOG(kWarning,
+           FileSystem,
+           "Couldn't watch the directory: {0}",
+           dirPath);
+    return 0;
+  }
+
+  void
+  FileWatcher::unwatch(uint32) {}
+
+  bool
+  FileWatcher::addDirectory(const String&, bool, Vector<FileChange>*) {
+    return false;
+  }
+
+  bool
+  FileWatcher::getStat(const Path&, FileStat&) {
+    return false;
+  }
+
+  void
+  FileWatcher::run() {}
+#endif
+}
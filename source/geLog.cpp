@@ -18,11 +18,191 @@
 */
 /*****************************************************************************/
 #include "geLog.h"
+#include "geDebug.h"
 #include "geException.h"
+#include "geMath.h"
 #include "geNumericLimits.h"
 
+#include <chrono>
+
 namespace geEngineSDK {
 //  UnorderedMap<uint32, String> Log::s_categories;
+  std::atomic<uint8> Log::s_mutedLevels[Log::MAX_CATEGORIES];
+  std::atomic<uint64> Log::s_floodProtection[Log::MAX_CATEGORIES];
+
+  namespace {
+    std::atomic<uint32> s_nextCallSiteId{ 0 };
+
+    const int64 NANOSECONDS_PER_SECOND = 1000000000;
+    const uint64 COLLAPSE_REPEATS_BIT = 1ULL << 63;
+    const uint32 MAX_FLOOD_BURST = 0x7FFFFFFF;
+
+    /**
+     * Call sites that suppressed messages, so the ones not reported yet can
+     * be logged on Debug::flush().
+     */
+    struct FloodedSites
+    {
+      Mutex mutex;
+      Vector<const LogCallSite*> sites;
+
+      /**
+       * Messages suppressed by all the call sites that were reported.
+       */
+      std::atomic<uint64> numRepeated{ 0 };
+      std::atomic<uint64> numRateLimited{ 0 };
+    };
+
+    FloodedSites&
+    getFloodedSites() {
+      static FloodedSites floodedSites;
+      return floodedSites;
+    }
+
+    int64
+    getFloodTime() {
+      using namespace std::chrono;
+      return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Adds a call site to the flooded sites the first time it
+     *        suppresses a message.
+     */
+    void
+    registerFloodedSite(const LogCallSite& site) {
+      auto& isRegistered = site.flood.isRegistered;
+      if (isRegistered.load(std::memory_order_relaxed) ||
+          isRegistered.exchange(true, std::memory_order_relaxed)) {
+        return;
+      }
+
+      auto& floodedSites = getFloodedSites();
+      Lock lock(floodedSites.mutex);
+      floodedSites.sites.push_back(&site);
+    }
+
+    /**
+     * @brief Returns the call site the suppressed messages of @p site are
+     *        reported from. It has the same verbosity, category and location.
+     */
+    const LogCallSite&
+    getSummarySite(const LogCallSite& site) {
+      auto& summarySite = site.flood.summarySite;
+      const LogCallSite* current = summarySite.load(std::memory_order_acquire);
+      if (nullptr != current) {
+        return *current;
+      }
+
+      //Call sites are static, so the summary one lives as long as the program
+      using Formatter = LogFormatter<String, uint32>;
+      auto newSite = ge_new<LogCallSite>(site.verbosity,
+                                         site.category,
+                                         site.function,
+                                         site.file,
+                                         site.line,
+                                         Formatter::format,
+                                         Formatter::encode);
+      if (summarySite.compare_exchange_strong(current,
+                                              newSite,
+                                              std::memory_order_acq_rel)) {
+        return *newSite;
+      }
+
+      ge_delete(newSite);
+      return *current;
+    }
+
+    /**
+     * @brief Logs the number of messages suppressed by a call site since the
+     *        last time they were reported, if any.
+     */
+    void
+    reportSuppressed(const LogCallSite& site) {
+      auto takeCount = [](std::atomic<uint32>& count) -> uint32 {
+        if (0 == count.load(std::memory_order_relaxed)) {
+          return 0;
+        }
+        return count.exchange(0, std::memory_order_relaxed);
+      };
+
+      const uint32 numRepeated = takeCount(site.flood.numRepeated);
+      const uint32 numRateLimited = takeCount(site.flood.numRateLimited);
+      if (0 == numRepeated && 0 == numRateLimited) {
+        return;
+      }
+
+      auto& floodedSites = getFloodedSites();
+      floodedSites.numRepeated.fetch_add(numRepeated, std::memory_order_relaxed);
+      floodedSites.numRateLimited.fetch_add(numRateLimited, std::memory_order_relaxed);
+
+      const LogCallSite& summarySite = getSummarySite(site);
+      if (0 != numRepeated) {
+        ge_logRecord(summarySite, String("Previous message repeated {0} times"), numRepeated);
+      }
+      if (0 != numRateLimited) {
+        ge_logRecord(summarySite,
+                     String("{0} messages dropped by the rate limit"),
+                     numRateLimited);
+      }
+    }
+
+    /**
+     * @brief Returns the messages suppressed by all the call sites, reported
+     *        or not.
+     */
+    uint64
+    getNumSuppressed(const std::atomic<uint64>& numReported,
+                     std::atomic<uint32> LogCallSite::FloodState::* numPending) {
+      auto& floodedSites = getFloodedSites();
+      Lock lock(floodedSites.mutex);
+
+      uint64 total = numReported.load(std::memory_order_relaxed);
+      for (auto site : floodedSites.sites) {
+        total += (site->flood.*numPending).load(std::memory_order_relaxed);
+      }
+
+      return total;
+    }
+
+    /**
+     * @brief Parses the name of a verbosity level, ignoring case.
+     */
+    bool
+    parseVerbosity(const String& name, LogVerbosity& verbosity) {
+      static const char* names[] = {
+        "Fatal", "Error", "Warning", "Info", "Log", "Verbose", "VeryVerbose", "Any"
+      };
+
+      for (uint32 i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (0 == StringUtil::compare(name, String(names[i]), false)) {
+          verbosity = static_cast<LogVerbosity>(i);
+          return true;
+        }
+      }
+
+      return false;
+    }
+  }
+
+  LogCallSite::LogCallSite(LogVerbosity inVerbosity,
+                           uint32 inCategory,
+                           const ANSICHAR* inFunction,
+                           const ANSICHAR* inFile,
+                           uint32 inLine,
+                           FormatFn inFormatArgs,
+                           EncodeFn inEncodeArgs)
+    : id(s_nextCallSiteId.fetch_add(1, std::memory_order_relaxed)),
+      verbosity(inVerbosity),
+      category(inCategory),
+      function(inFunction),
+      file(inFile),
+      line(inLine),
+      formatArgs(inFormatArgs),
+      encodeArgs(inEncodeArgs) {
+    location = String("\n\t\t in ") + function + " [" + file + ":" +
+               toString(static_cast<int32>(line)) + "]\n";
+  }
 
   Log::~Log() {
     clear();
@@ -30,8 +210,19 @@ namespace geEngineSDK {
 
   void
   Log::logMsg(const String& message, LogVerbosity verbosity, uint32 category) {
+    logMsg(message, verbosity, category, time(nullptr));
+  }
+
+  void
+  Log::logMsg(const String& message,
+              LogVerbosity verbosity,
+              uint32 category,
+              time_t localTime) {
     RecursiveLock lock(m_mutex);
-    m_unreadEntries.emplace(message, verbosity, category);
+    m_unreadEntries.emplace(message, verbosity, category, localTime);
+    if (m_unreadEntries.size() > m_maxEntries) {
+      m_unreadEntries.pop();
+    }
   }
 
   void
@@ -50,7 +241,7 @@ namespace geEngineSDK {
   Log::clear(LogVerbosity verbosity, uint32 category) {
     RecursiveLock lock(m_mutex);
 
-    Vector<LogEntry> newEntries;
+    Deque<LogEntry> newEntries;
     for (auto& entry : m_entries) {
       if( (LogVerbosity::kAny == verbosity || verbosity == entry.getVerbosity()) &&
          (category == NumLimit::MAX_UINT32 || category == entry.getCategory())) {
@@ -90,6 +281,9 @@ namespace geEngineSDK {
     entry = m_unreadEntries.front();
     m_unreadEntries.pop();
     m_entries.push_back(entry);
+    if (m_entries.size() > m_maxEntries) {
+      m_entries.pop_front();
+    }
     ++m_hash;
 
     return true;
@@ -97,6 +291,7 @@ namespace geEngineSDK {
 
   bool
   Log::getLastEntry(LogEntry& entry) {
+    RecursiveLock lock(m_mutex);
     if (m_entries.empty()) {
       return false;
     }
@@ -108,11 +303,28 @@ namespace geEngineSDK {
   Vector<LogEntry>
   Log::getEntries() const {
     RecursiveLock lock(m_mutex);
-    return m_entries;
+    return Vector<LogEntry>(m_entries.begin(), m_entries.end());
+  }
+
+  void
+  Log::setMaxEntries(uint32 maxEntries) {
+    RecursiveLock lock(m_mutex);
+    m_maxEntries = Math::max(maxEntries, 1U);
+
+    while (m_entries.size() > m_maxEntries) {
+      m_entries.pop_front();
+    }
+
+    while (m_unreadEntries.size() > m_maxEntries) {
+      m_unreadEntries.pop();
+    }
+
+    ++m_hash;
   }
 
   bool
   Log::_registerCategory(uint32 id, const char* name) {
+    GE_ASSERT(id < MAX_CATEGORIES);
     if (!categoryExists(id)) {
       s_categories.emplace(id, name);
       return true;
@@ -138,12 +350,203 @@ namespace geEngineSDK {
     return false;
   }
 
+  LogVerbosity
+  Log::getVerbosity(uint32 category) {
+    GE_ASSERT(category < MAX_CATEGORIES);
+    const uint8 mutedLevels = s_mutedLevels[category].load(std::memory_order_relaxed);
+    return static_cast<LogVerbosity>(static_cast<int32>(LogVerbosity::kVeryVerbose) -
+                                     mutedLevels);
+  }
+
+  void
+  Log::setVerbosity(uint32 category, LogVerbosity verbosity) {
+    GE_ASSERT(category < MAX_CATEGORIES);
+    if (LogVerbosity::kAny == verbosity) {
+      verbosity = LogVerbosity::kVeryVerbose;
+    }
+
+    //kFatal mutes every other level, so fatal messages are always logged
+    const int32 mutedLevels = static_cast<int32>(LogVerbosity::kVeryVerbose) -
+                              static_cast<int32>(verbosity);
+    s_mutedLevels[category].store(static_cast<uint8>(mutedLevels),
+                                  std::memory_order_relaxed);
+  }
+
+  void
+  Log::setVerbosity(LogVerbosity verbosity) {
+    for (uint32 i = 0; i < MAX_CATEGORIES; ++i) {
+      setVerbosity(i, verbosity);
+    }
+  }
+
+  bool
+  Log::setVerbosity(const String& filters) {
+    bool valid = true;
+    for (String filter : StringUtil::split(filters, ",")) {
+      StringUtil::trim(filter);
+      if (filter.empty()) {
+        continue;
+      }
+
+      LogVerbosity verbosity;
+      const SIZE_T separator = filter.find('=');
+      if (String::npos == separator) {
+        if (parseVerbosity(filter, verbosity)) {
+          setVerbosity(verbosity);
+        }
+        else {
+          valid = false;
+        }
+        continue;
+      }
+
+      String categoryName = filter.substr(0, separator);
+      String verbosityName = filter.substr(separator + 1);
+      StringUtil::trim(categoryName);
+      StringUtil::trim(verbosityName);
+      if (!parseVerbosity(verbosityName, verbosity)) {
+        valid = false;
+        continue;
+      }
+
+      auto category = std::find_if(s_categories.begin(),
+                                   s_categories.end(),
+                                   [&categoryName](const auto& entry) {
+                                     return 0 == StringUtil::compare(entry.second,
+                                                                     categoryName,
+                                                                     false);
+                                   });
+      if (s_categories.end() == category) {
+        valid = false;
+        continue;
+      }
+
+      setVerbosity(category->first, verbosity);
+    }
+
+    return valid;
+  }
+
+  LogFloodProtection
+  Log::getFloodProtection(uint32 category) {
+    GE_ASSERT(category < MAX_CATEGORIES);
+    const uint64 packed = s_floodProtection[category].load(std::memory_order_relaxed);
+
+    LogFloodProtection options;
+    if (0 != packed) {
+      options.maxPerSecond = static_cast<uint32>(packed);
+      options.burst = static_cast<uint32>(packed >> 32) & MAX_FLOOD_BURST;
+      options.collapseRepeats = _collapsesRepeats(packed);
+    }
+
+    return options;
+  }
+
+  void
+  Log::setFloodProtection(uint32 category, const LogFloodProtection& options) {
+    GE_ASSERT(category < MAX_CATEGORIES);
+
+    //Without a rate limit or collapsing the burst doesn't matter, and 0 lets
+    //GE_LOG skip the checks
+    uint64 packed = 0;
+    if (0 != options.maxPerSecond || options.collapseRepeats) {
+      const uint64 burst = Math::clamp(options.burst, 1U, MAX_FLOOD_BURST);
+      packed = options.maxPerSecond | (burst << 32) |
+               (options.collapseRepeats ? COLLAPSE_REPEATS_BIT : 0);
+    }
+
+    s_floodProtection[category].store(packed, std::memory_order_relaxed);
+  }
+
+  void
+  Log::setFloodProtection(const LogFloodProtection& options) {
+    for (uint32 i = 0; i < MAX_CATEGORIES; ++i) {
+      setFloodProtection(i, options);
+    }
+  }
+
+  uint64
+  Log::getNumRepeated() {
+    return getNumSuppressed(getFloodedSites().numRepeated,
+                            &LogCallSite::FloodState::numRepeated);
+  }
+
+  uint64
+  Log::getNumRateLimited() {
+    return getNumSuppressed(getFloodedSites().numRateLimited,
+                            &LogCallSite::FloodState::numRateLimited);
+  }
+
+  bool
+  Log::_admitMessage(const LogCallSite& site, uint64 floodProtection, SIZE_T argsHash) {
+    auto& flood = site.flood;
+    const bool collapseRepeats = _collapsesRepeats(floodProtection);
+
+    if (collapseRepeats) {
+      //0 is kept for when no message was logged
+      argsHash |= 1;
+      if (flood.lastArgsHash.load(std::memory_order_relaxed) == argsHash) {
+        flood.numRepeated.fetch_add(1, std::memory_order_relaxed);
+        registerFloodedSite(site);
+        return false;
+      }
+    }
+
+    const uint32 maxPerSecond = static_cast<uint32>(floodProtection);
+    if (0 != maxPerSecond) {
+      //Generic cell rate algorithm: a token bucket that only stores the time
+      //it's full at, as the time the next message is allowed without a burst
+      const uint32 burst = static_cast<uint32>(floodProtection >> 32) & MAX_FLOOD_BURST;
+      const int64 interval = Math::max(NANOSECONDS_PER_SECOND / maxPerSecond,
+                                       static_cast<int64>(1));
+      const int64 tolerance = interval * (burst - 1);
+      const int64 now = getFloodTime();
+
+      int64 allowedTime = flood.allowedTime.load(std::memory_order_relaxed);
+      int64 nextAllowedTime;
+      do {
+        const int64 startTime = Math::max(allowedTime, now);
+        if (startTime - now > tolerance) {
+          flood.numRateLimited.fetch_add(1, std::memory_order_relaxed);
+          registerFloodedSite(site);
+          return false;
+        }
+        nextAllowedTime = startTime + interval;
+      } while (!flood.allowedTime.compare_exchange_weak(allowedTime,
+                                                        nextAllowedTime,
+                                                        std::memory_order_relaxed));
+    }
+
+    if (collapseRepeats) {
+      flood.lastArgsHash.store(argsHash, std::memory_order_relaxed);
+    }
+
+    reportSuppressed(site);
+    return true;
+  }
+
+  void
+  Log::_reportSuppressed() {
+    Vector<const LogCallSite*> sites;
+    {
+      auto& floodedSites = getFloodedSites();
+      Lock lock(floodedSites.mutex);
+      sites = floodedSites.sites;
+    }
+
+    //Logged without the lock, in case a sink logs too
+    for (auto site : sites) {
+      reportSuppressed(*site);
+    }
+  }
+
   Vector<LogEntry>
   Log::getAllEntries() const {
     Vector<LogEntry> entries;
     
     {
       RecursiveLock lock(m_mutex);
+      entries.reserve(m_entries.size() + m_unreadEntries.size());
 
       for (auto& entry : m_entries) {
         entries.push_back(entry);
@@ -0,0 +1,210 @@
+/*****************************************************************************/
+/**
+ * @file    geLogSink.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Destinations the log entries are streamed to.
+ *
+ * Destinations the log entries are streamed to.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geLogSink.h"
+#include "geDebug.h"
+#include "geDataStream.h"
+#include "geFileSystem.h"
+
+namespace geEngineSDK {
+  namespace {
+    /**
+     * Sink whose thread is the current one, if any.
+     */
+    thread_local const FileLogSink* t_writingSink = nullptr;
+  }
+
+  FileLogSink::FileLogSink(const Path& path, const FileLogSinkOptions& options)
+    : m_path(path),
+      m_options(options) {
+    if (!m_path.isAbsolute()) {
+      m_path.makeAbsolute(FileSystem::getWorkingDirectoryPath());
+    }
+
+    m_pending.reserve(m_options.bufferSize);
+    m_thread = Thread([this]() {
+      run();
+    });
+  }
+
+  FileLogSink::~FileLogSink() {
+    {
+      Lock lock(m_mutex);
+      m_stop = true;
+    }
+    m_wakeSignal.notify_one();
+    m_thread.join();
+  }
+
+  void
+  FileLogSink::write(const LogEntry& entry) {
+    String line = Debug::getTextLogEntry(entry);
+    line += '\n';
+
+    Lock lock(m_mutex);
+
+    //Entries logged while writing, by the writing thread itself, can't wait
+    if (this != t_writingSink) {
+      m_writtenSignal.wait(lock, [this]() {
+        return m_pending.size() < m_options.bufferSize || m_stop;
+      });
+    }
+
+    m_pending += line;
+    if (m_pending.size() >= m_options.bufferSize / 2) {
+      m_wakeSignal.notify_one();
+    }
+  }
+
+  void
+  FileLogSink::flush() {
+    if (this == t_writingSink) {
+      return;
+    }
+
+    Lock lock(m_mutex);
+    const uint64 request = ++m_flushesRequested;
+    m_wakeSignal.notify_one();
+    m_writtenSignal.wait(lock, [this, request]() {
+      return m_flushesDone >= request;
+    });
+  }
+
+  void
+  FileLogSink::run() {
+    t_writingSink = this;
+    rotate();
+
+    String batch;
+    batch.reserve(m_options.bufferSize);
+    while (true) {
+      uint64 flushes;
+      bool stop;
+      {
+        Lock lock(m_mutex);
+        m_wakeSignal.wait_for(lock,
+                              std::chrono::milliseconds(m_options.flushIntervalMs),
+                              [this]() {
+                                return m_stop ||
+                                       m_flushesRequested != m_flushesDone ||
+                                       m_pending.size() >= m_options.bufferSize / 2;
+                              });
+
+        //Swapping keeps the capacity of both buffers, so no memory is
+        //allocated once they grow
+        batch.swap(m_pending);
+        flushes = m_flushesRequested;
+        stop = m_stop;
+      }
+      m_writtenSignal.notify_all();
+
+      writeBatch(batch);
+      batch.clear();
+
+      {
+        Lock lock(m_mutex);
+        m_flushesDone = flushes;
+      }
+      m_writtenSignal.notify_all();
+
+      if (stop) {
+        break;
+      }
+    }
+
+    m_file = nullptr;
+  }
+
+  void
+  FileLogSink::writeBatch(const String& batch) {
+    if (!m_file) {
+      //The file couldn't be created before, try again without rotating
+      openFile();
+    }
+    else if (0 != m_entriesSize) {
+      const bool tooBig = 0 != m_options.maxFileSize &&
+                          m_fileSize + batch.size() > m_options.maxFileSize;
+      const bool tooOld = 0 != m_options.maxFileAge &&
+                          time(nullptr) - m_fileCreationTime >=
+                            static_cast<time_t>(m_options.maxFileAge);
+      if (tooBig || tooOld) {
+        rotate();
+      }
+    }
+
+    if (!m_file || batch.empty()) {
+      return;
+    }
+
+    const SIZE_T written = m_file->write(batch.data(), batch.size());
+    m_file->flush();
+    m_fileSize += written;
+    m_entriesSize += written;
+  }
+
+  Path
+  FileLogSink::getRotatedPath(uint32 idx) const {
+    if (0 == idx) {
+      return m_path;
+    }
+
+    Path rotatedPath = m_path;
+    rotatedPath.setFilename(m_path.getFilename(false) + "." + toString(idx) +
+                            m_path.getExtension());
+    return rotatedPath;
+  }
+
+  void
+  FileLogSink::rotate() {
+    m_file = nullptr;
+
+    for (uint32 i = m_options.maxFiles + 1; i > 0; --i) {
+      const Path rotatedPath = getRotatedPath(i - 1);
+      if (!FileSystem::exists(rotatedPath)) {
+        continue;
+      }
+
+      if (i > m_options.maxFiles) {
+        FileSystem::remove(rotatedPath);
+      }
+      else {
+        FileSystem::move(rotatedPath, getRotatedPath(i));
+      }
+    }
+
+    openFile();
+  }
+
+  void
+  FileLogSink::openFile() {
+    const Path directory = m_path.getDirectory();
+    if (!FileSystem::exists(directory)) {
+      FileSystem::createDir(directory);
+    }
+
+    m_file = FileSystem::createAndOpenFile(m_path);
+    m_fileCreationTime = time(nullptr);
+    m_entriesSize = 0;
+
+    const String header = Debug::getTextLogHeader();
+    m_fileSize = m_file->write(header.data(), header.size());
+    if (m_fileSize != header.size()) {
+      m_file = nullptr;
+    }
+  }
+}
@@ -33,7 +33,10 @@ namespace geEngineSDK {
                            uint32& bytesWritten,
                            function<void*(SIZE_T)> allocator,
                            bool shallow,
-                           SerializationContext* context) {
+                           SerializationContext* context,
+                           bool deduplicate,
+                           bool parallel,
+                           bool compact) {
     BinarySerializer bs;
 
     BufferPiece piece;
@@ -48,7 +51,10 @@ namespace geEngineSDK {
               &bytesWritten,
               bind(&MemorySerializer::flushBuffer, this, _1, _2, _3),
               shallow,
-              context);
+              context,
+              deduplicate,
+              parallel,
+              compact);
 
     uint8* resultBuffer;
     if (nullptr != allocator) {
@@ -78,12 +84,13 @@ namespace geEngineSDK {
   SPtr<IReflectable>
   MemorySerializer::decode(uint8* buffer,
                            uint32 bufferSize,
-                           SerializationContext* context) {
+                           SerializationContext* context,
+                           bool parallel) {
     SPtr<MemoryDataStream>
       stream = ge_shared_ptr_new<MemoryDataStream>(buffer, bufferSize, false);
 
     BinarySerializer bs;
-    SPtr<IReflectable> object = bs.decode(stream, bufferSize, context);
+    SPtr<IReflectable> object = bs.decode(stream, bufferSize, context, nullptr, parallel);
 
     return object;
   }
@@ -0,0 +1,658 @@
+/*****************************************************************************/
+/**
+ * @file    gePackFile.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Read-only archives holding many files in a single one.
+ *
+ * Pack files store many small files in a single one, so they can be read
+ * without opening each of them separately. A pack starts with a header and
+ * an index, followed by the aligned contents of the files. The index is an
+ * open-addressed hash table of the paths, so entries are found without
+ * searching.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "gePackFile.h"
+#include "geBitwise.h"
+#include "geDebug.h"
+#include "geDirectoryWalker.h"
+#include "geFileSystem.h"
+
+#if USING(GE_PLATFORM_LINUX)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace geEngineSDK {
+  using std::max;
+  using std::sort;
+
+  namespace {
+    CONSTEXPR uint64 HASH_OFFSET = 14695981039346656037ULL;
+    CONSTEXPR uint64 HASH_PRIME = 1099511628211ULL;
+
+    /**
+     * @brief Lower case of an ASCII character, so paths are hashed ignoring
+     *        case as Path compares them.
+     */
+    ANSICHAR
+    toLowerASCII(ANSICHAR c) {
+      return ('A' <= c && 'Z' >= c) ? static_cast<ANSICHAR>(c - 'A' + 'a') : c;
+    }
+
+    /**
+     * @brief Adds a character to a FNV-1a hash.
+     */
+    uint64
+    hashChar(uint64 hash, ANSICHAR c) {
+      return (hash ^ static_cast<uint8>(toLowerASCII(c))) * HASH_PRIME;
+    }
+
+    uint64
+    hashName(const String& name) {
+      uint64 hash = HASH_OFFSET;
+      for (ANSICHAR c : name) {
+        hash = hashChar(hash, c);
+      }
+      return hash;
+    }
+
+    /**
+     * @brief Returns the number of directories and file names in a path.
+     */
+    SIZE_T
+    getNumElements(const Path& path) {
+      return path.getNumDirectories() + (path.getFilename().empty() ? 0 : 1);
+    }
+
+    /**
+     * @brief Returns a directory, or the file name for the last element.
+     */
+    const String&
+    getElement(const Path& path, SIZE_T idx) {
+      return idx < path.getNumDirectories() ? path.getDirectory(idx)
+                                            : path.getFilename();
+    }
+
+    /**
+     * @brief Joins the elements of a relative path with '/', as the names are
+     *        stored in the packs.
+     */
+    String
+    getEntryName(const Path& path) {
+      String name;
+      const SIZE_T numElements = getNumElements(path);
+      for (SIZE_T i = 0; i < numElements; ++i) {
+        if (0 != i) {
+          name += '/';
+        }
+        name += getElement(path, i);
+      }
+      return name;
+    }
+
+    /**
+     * @brief Returns true if @p path is strictly inside the directory
+     *        @p mountPoint.
+     */
+    bool
+    isInsideMountPoint(const Path& mountPoint, const Path& path) {
+      const SIZE_T numMountDirs = mountPoint.getNumDirectories();
+      if (getNumElements(path) <= numMountDirs ||
+          mountPoint.getDevice() != path.getDevice() ||
+          mountPoint.getNode() != path.getNode()) {
+        return false;
+      }
+
+      for (SIZE_T i = 0; i < numMountDirs; ++i) {
+        if (!Path::comparePathElem(mountPoint.getDirectory(i),
+                                   path.getDirectory(i))) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    uint64
+    alignOffset(uint64 offset, uint64 alignment) {
+      return (offset + alignment - 1) / alignment * alignment;
+    }
+  }
+
+  void
+  PackFileBuilder::addFile(const Path& packedPath, const Path& sourcePath) {
+    addSource(packedPath, Source{ String(), sourcePath, nullptr });
+  }
+
+  void
+  PackFileBuilder::addData(const Path& packedPath, const SPtr<DataStream>& data) {
+    addSource(packedPath, Source{ String(), Path::BLANK, data });
+  }
+
+  void
+  PackFileBuilder::addDirectory(const Path& sourceDir, const Path& packedDir) {
+    DirectoryWalker::walk(sourceDir,
+    [&](const DirectoryEntry& entry) {
+      const Path sourcePath = entry.toPath();
+      addFile(packedDir + sourcePath.getRelative(sourceDir), sourcePath);
+      return true;
+    });
+  }
+
+  void
+  PackFileBuilder::addSource(const Path& packedPath, Source&& source) {
+    if (packedPath.isAbsolute() || 0 == getNumElements(packedPath)) {
+      GE_LOG(kWarning, FileSystem, "Invalid path for a packed file: \"{0}\".",
+             packedPath);
+      return;
+    }
+
+    source.name = getEntryName(packedPath);
+
+    String key = source.name;
+    for (auto& c : key) {
+      c = toLowerASCII(c);
+    }
+
+    auto iterFind = m_fileIndices.find(key);
+    if (m_fileIndices.end() != iterFind) {
+      m_files[iterFind->second] = std::move(source);
+      return;
+    }
+
+    m_fileIndices[key] = static_cast<uint32>(m_files.size());
+    m_files.push_back(std::move(source));
+  }
+
+  bool
+  PackFileBuilder::write(const Path& outputPath) const {
+    //Files in the same directory are stored next to each other
+    Vector<const Source*> files;
+    files.reserve(m_files.size());
+    for (auto& file : m_files) {
+      files.push_back(&file);
+    }
+    sort(files.begin(), files.end(), [](const Source* a, const Source* b) {
+      return a->name < b->name;
+    });
+
+    //Directories aren't added explicitly, they are the ones the files are in
+    Set<String> directories;
+    for (auto file : files) {
+      for (SIZE_T separator = file->name.find('/');
+           String::npos != separator;
+           separator = file->name.find('/', separator + 1)) {
+        String dirKey = file->name.substr(0, separator);
+        for (auto& c : dirKey) {
+          c = toLowerASCII(c);
+        }
+        if (m_fileIndices.end() == m_fileIndices.find(dirKey)) {
+          directories.insert(file->name.substr(0, separator));
+        }
+      }
+    }
+
+    PackFileHeader header;
+    header.numEntries = static_cast<uint32>(files.size() + directories.size());
+    header.numSlots = Bitwise::nextPow2(max(header.numEntries * 2, 2U));
+    header.timestamp = static_cast<int64>(std::time(nullptr));
+
+    Vector<PackFileEntry> entries(header.numEntries);
+    String names;
+    uint32 entryIdx = 0;
+    auto addEntry = [&](const String& name, uint32 flags) {
+      PackFileEntry& entry = entries[entryIdx++];
+      memset(&entry, 0, sizeof(entry));
+      entry.nameOffset = static_cast<uint32>(names.size());
+      entry.nameLength = static_cast<uint32>(name.size());
+      entry.flags = flags;
+      names.append(name.c_str(), name.size() + 1);
+    };
+
+    for (auto file : files) {
+      addEntry(file->name, PACK_ENTRY_FLAGS::kNONE);
+    }
+    for (auto& dir : directories) {
+      addEntry(dir, PACK_ENTRY_FLAGS::kDIRECTORY);
+    }
+
+    Vector<PackFileSlot> slots(header.numSlots, PackFileSlot{ 0, 0 });
+    const uint32 slotMask = header.numSlots - 1;
+    for (uint32 i = 0; i < header.numEntries; ++i) {
+      const uint64 hash = hashName(String(&names[entries[i].nameOffset],
+                                          entries[i].nameLength));
+      uint32 slotIdx = static_cast<uint32>(hash) & slotMask;
+      while (0 != slots[slotIdx].entryIdx) {
+        slotIdx = (slotIdx + 1) & slotMask;
+      }
+      slots[slotIdx].hash = static_cast<uint32>(hash >> 32);
+      slots[slotIdx].entryIdx = i + 1;
+    }
+
+    header.slotsOffset = sizeof(PackFileHeader);
+    header.entriesOffset = header.slotsOffset + slots.size() * sizeof(PackFileSlot);
+    header.namesOffset = header.entriesOffset + entries.size() * sizeof(PackFileEntry);
+    header.namesSize = names.size();
+
+    const uint64 alignment = max(m_options.alignment, 1U);
+    const uint64 dataOffset = alignOffset(header.namesOffset + header.namesSize,
+                                          alignment);
+
+    SPtr<DataStream> output = FileSystem::createAndOpenFile(outputPath);
+    if (!output || !output->isWriteable()) {
+      GE_LOG(kError, FileSystem, "Failed to create pack file: \"{0}\".",
+             outputPath);
+      return false;
+    }
+
+    auto write = [&](const void* data, SIZE_T size) {
+      if (output->write(data, size) == size) {
+        return true;
+      }
+
+      GE_LOG(kError, FileSystem, "Failed to write pack file: \"{0}\".", outputPath);
+      output->close();
+      return false;
+    };
+
+    //The index is written at the end, once the data of every entry is known
+    Vector<uint8> padding(static_cast<SIZE_T>(max(dataOffset, alignment)), 0);
+    if (!write(padding.data(), static_cast<SIZE_T>(dataOffset))) {
+      return false;
+    }
+
+    uint64 offset = dataOffset;
+    for (uint32 i = 0; i < files.size(); ++i) {
+      const Source& file = *files[i];
+      SPtr<DataStream> source = file.data;
+      if (!source) {
+        source = FileSystem::openFile(file.sourcePath);
+      }
+      if (!source) {
+        GE_LOG(kError, FileSystem, "Failed to read \"{0}\" into pack file: \"{1}\".",
+               file.sourcePath, outputPath);
+        output->close();
+        return false;
+      }
+
+      SPtr<DataStream> contents = ge_shared_ptr_new<MemoryDataStream>(source);
+      PackFileEntry& entry = entries[i];
+      entry.size = contents->size();
+
+      SPtr<MemoryDataStream> stored = std::static_pointer_cast<MemoryDataStream>(contents);
+      if (m_options.compress && 0 < entry.size) {
+        auto compressed = Compression::compress(contents, m_options.compression);
+        const float maxSize = static_cast<float>(entry.size) *
+                              (1.0f - m_options.minCompressionSavings);
+        if (compressed && static_cast<float>(compressed->size()) <= maxSize) {
+          stored = compressed;
+          entry.flags |= PACK_ENTRY_FLAGS::kCOMPRESSED;
+        }
+      }
+
+      const uint64 alignedOffset = alignOffset(offset, alignment);
+      if (!write(padding.data(), static_cast<SIZE_T>(alignedOffset - offset))) {
+        return false;
+      }
+
+      entry.offset = alignedOffset;
+      entry.storedSize = stored->size();
+      if (!write(stored->getPtr(), stored->size())) {
+        return false;
+      }
+      offset = alignedOffset + entry.storedSize;
+    }
+
+    output->seek(0);
+    if (!write(&header, sizeof(header)) ||
+        !write(slots.data(), slots.size() * sizeof(PackFileSlot)) ||
+        !write(entries.data(), entries.size() * sizeof(PackFileEntry)) ||
+        !write(names.data(), names.size())) {
+      return false;
+    }
+    output->close();
+
+    return true;
+  }
+
+  PackFile::~PackFile() {
+    if (nullptr == m_data) {
+      return;
+    }
+
+#if USING(GE_PLATFORM_LINUX)
+    if (m_isMapped) {
+      munmap(m_data, m_size);
+      return;
+    }
+#endif
+
+    ge_free(m_data);
+  }
+
+  SPtr<PackFile>
+  PackFile::open(const Path& packPath) {
+    auto pack = ge_shared_ptr_new<PackFile>();
+    pack->m_path = packPath;
+
+#if USING(GE_PLATFORM_LINUX)
+    const int32 fd = ::open(packPath.toString().c_str(), O_RDONLY | O_CLOEXEC);
+    if (0 <= fd) {
+      struct stat fileStat;
+      if (0 == fstat(fd, &fileStat) && 0 < fileStat.st_size) {
+        pack->m_size = static_cast<SIZE_T>(fileStat.st_size);
+        void* mapping = mmap(nullptr, pack->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != mapping) {
+          pack->m_data = static_cast<uint8*>(mapping);
+          pack->m_isMapped = true;
+        }
+      }
+      close(fd);
+    }
+#endif
+
+    //Packs that can't be mapped are read in memory instead
+    if (nullptr == pack->m_data) {
+      SPtr<DataStream> stream = FileSystem::openFile(packPath);
+      if (stream && 0 < stream->size()) {
+        pack->m_size = stream->size();
+        pack->m_data = static_cast<uint8*>(ge_alloc(pack->m_size));
+        pack->m_size = stream->read(pack->m_data, pack->m_size);
+      }
+    }
+
+    if (nullptr == pack->m_data || !pack->validate()) {
+      GE_LOG(kError, FileSystem, "Invalid pack file: \"{0}\".", packPath);
+      return nullptr;
+    }
+
+#if USING(GE_PLATFORM_LINUX)
+    //Every lookup goes through the index, read it ahead of time
+    if (pack->m_isMapped) {
+      madvise(pack->m_data,
+              static_cast<SIZE_T>(pack->m_header->namesOffset +
+                                  pack->m_header->namesSize),
+              MADV_WILLNEED);
+    }
+#endif
+
+    return pack;
+  }
+
+  bool
+  PackFile::validate() {
+    if (m_size < sizeof(PackFileHeader)) {
+      return false;
+    }
+
+    auto header = reinterpret_cast<const PackFileHeader*>(m_data);
+    if (PackFileHeader::MAGIC != header->magic ||
+        PackFileHeader::VERSION != header->version ||
+        !Bitwise::isPow2(header->numSlots) ||
+        header->numSlots <= header->numEntries) {
+      return false;
+    }
+
+    auto isInside = [&](uint64 offset, uint64 size) {
+      return offset <= m_size && size <= m_size - offset;
+    };
+
+    if (0 != header->slotsOffset % alignof(PackFileSlot) ||
+        0 != header->entriesOffset % alignof(PackFileEntry) ||
+        !isInside(header->slotsOffset,
+                  static_cast<uint64>(header->numSlots) * sizeof(PackFileSlot)) ||
+        !isInside(header->entriesOffset,
+                  static_cast<uint64>(header->numEntries) * sizeof(PackFileEntry)) ||
+        !isInside(header->namesOffset, header->namesSize)) {
+      return false;
+    }
+
+    //Each entry must be in exactly one slot, so the rest are empty and every
+    //probe in find() ends
+    auto slots = reinterpret_cast<const PackFileSlot*>(m_data + header->slotsOffset);
+    Vector<uint8> isInSlot(header->numEntries, 0);
+    uint32 numOccupied = 0;
+    for (uint32 i = 0; i < header->numSlots; ++i) {
+      const uint32 entryIdx = slots[i].entryIdx;
+      if (0 == entryIdx) {
+        continue;
+      }
+
+      if (entryIdx > header->numEntries || 0 != isInSlot[entryIdx - 1]) {
+        return false;
+      }
+
+      isInSlot[entryIdx - 1] = 1;
+      ++numOccupied;
+    }
+
+    if (numOccupied != header->numEntries) {
+      return false;
+    }
+
+    auto entries = reinterpret_cast<const PackFileEntry*>(m_data + header->entriesOffset);
+    auto names = reinterpret_cast<const ANSICHAR*>(m_data + header->namesOffset);
+    for (uint32 i = 0; i < header->numEntries; ++i) {
+      const PackFileEntry& entry = entries[i];
+      if (static_cast<uint64>(entry.nameOffset) + entry.nameLength >= header->namesSize ||
+          '\0' != names[entry.nameOffset + entry.nameLength]) {
+        return false;
+      }
+
+      if (0 != (entry.flags & PACK_ENTRY_FLAGS::kDIRECTORY)) {
+        continue;
+      }
+
+      //Uncompressed entries are handed out as views of entry.size bytes
+      if (!isInside(entry.offset, entry.storedSize) ||
+          (0 == (entry.flags & PACK_ENTRY_FLAGS::kCOMPRESSED) &&
+           entry.size != entry.storedSize)) {
+        return false;
+      }
+    }
+
+    m_header = header;
+    m_slots = slots;
+    m_entries = entries;
+    m_names = names;
+    return true;
+  }
+
+  const PackFileEntry*
+  PackFile::find(const Path& path, SIZE_T firstDirectory) const {
+    const SIZE_T numElements = getNumElements(path);
+    if (numElements <= firstDirectory) {
+      return nullptr;
+    }
+
+    uint64 hash = HASH_OFFSET;
+    SIZE_T nameLength = 0;
+    for (SIZE_T i = firstDirectory; i < numElements; ++i) {
+      if (firstDirectory != i) {
+        hash = hashChar(hash, '/');
+        ++nameLength;
+      }
+
+      const String& element = getElement(path, i);
+      for (ANSICHAR c : element) {
+        hash = hashChar(hash, c);
+      }
+      nameLength += element.size();
+    }
+
+    const uint32 slotMask = m_header->numSlots - 1;
+    const uint32 hashTag = static_cast<uint32>(hash >> 32);
+    for (uint32 slotIdx = static_cast<uint32>(hash) & slotMask;
+         0 != m_slots[slotIdx].entryIdx;
+         slotIdx = (slotIdx + 1) & slotMask) {
+      const PackFileSlot& slot = m_slots[slotIdx];
+      if (hashTag != slot.hash) {
+        continue;
+      }
+
+      const PackFileEntry& entry = m_entries[slot.entryIdx - 1];
+      if (nameLength != entry.nameLength) {
+        continue;
+      }
+
+      //Compare the elements of the path with the stored name
+      const ANSICHAR* name = m_names + entry.nameOffset;
+      bool isEqual = true;
+      for (SIZE_T i = firstDirectory; i < numElements && isEqual; ++i) {
+        if (firstDirectory != i) {
+          isEqual = '/' == *name++;
+        }
+
+        const String& element = getElement(path, i);
+        for (SIZE_T j = 0; j < element.size() && isEqual; ++j) {
+          isEqual = toLowerASCII(element[j]) == toLowerASCII(*name++);
+        }
+      }
+
+      if (isEqual) {
+        return &entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  SPtr<DataStream>
+  PackFile::openEntry(const SPtr<PackFile>& pack, const PackFileEntry& entry) {
+    if (0 != (entry.flags & PACK_ENTRY_FLAGS::kDIRECTORY)) {
+      return nullptr;
+    }
+
+    const uint8* data = pack->getEntryData(entry);
+    if (0 == (entry.flags & PACK_ENTRY_FLAGS::kCOMPRESSED)) {
+      return ge_shared_ptr_new<PackedDataStream>(pack, data, entry.size);
+    }
+
+    SPtr<DataStream> input = ge_shared_ptr_new<PackedDataStream>(pack,
+                                                                 data,
+                                                                 entry.storedSize);
+    SPtr<MemoryDataStream> output = Compression::decompress(input);
+    if (!output || output->size() != entry.size) {
+      GE_LOG(kError, FileSystem, "Failed to decompress \"{0}\" from pack file: \"{1}\".",
+             pack->getEntryName(entry), pack->getPath());
+      return nullptr;
+    }
+
+    return output;
+  }
+
+  PackedDataStream::PackedDataStream(const SPtr<PackFile>& pack,
+                                     const uint8* data,
+                                     SIZE_T inSize)
+    : MemoryDataStream(const_cast<uint8*>(data), inSize, false),
+      m_pack(pack) {
+    //The mapping is read only
+    m_access = ACCESS_MODE::kREAD;
+  }
+
+  SPtr<DataStream>
+  PackedDataStream::clone(bool copyData) const {
+    if (!copyData) {
+      return ge_shared_ptr_new<PackedDataStream>(m_pack, m_data, m_size);
+    }
+
+    auto copy = ge_shared_ptr_new<MemoryDataStream>(m_size);
+    memcpy(copy->getPtr(), m_data, m_size);
+    return copy;
+  }
+
+  bool
+  PackFileSystem::mount(const Path& packPath, const Path& mountPoint) {
+    SPtr<PackFile> pack = PackFile::open(packPath);
+    if (!pack) {
+      return false;
+    }
+
+    Path mountDir = mountPoint;
+    if (!mountDir.isAbsolute()) {
+      mountDir.makeAbsolute(FileSystem::getWorkingDirectoryPath());
+    }
+    if (!mountDir.getFilename().empty()) {
+      mountDir.append(Path::BLANK);
+    }
+
+    Lock lock(m_mutex);
+    m_mounts.push_back(Mount{ packPath, mountDir, pack });
+    return true;
+  }
+
+  void
+  PackFileSystem::unmount(const Path& packPath) {
+    Lock lock(m_mutex);
+    m_mounts.erase(std::remove_if(m_mounts.begin(), m_mounts.end(),
+                   [&](const Mount& mount) {
+                     return mount.packPath == packPath;
+                   }),
+                   m_mounts.end());
+  }
+
+  const PackFileEntry*
+  PackFileSystem::findEntry(const Path& fullPath, SPtr<PackFile>& pack) const {
+    Lock lock(m_mutex);
+    if (m_mounts.empty()) {
+      return nullptr;
+    }
+
+    Path absolutePath;
+    const Path* path = &fullPath;
+    if (!fullPath.isAbsolute()) {
+      absolutePath = fullPath.getAbsolute(FileSystem::getWorkingDirectoryPath());
+      path = &absolutePath;
+    }
+
+    for (auto iter = m_mounts.rbegin(); iter != m_mounts.rend(); ++iter) {
+      if (!isInsideMountPoint(iter->mountPoint, *path)) {
+        continue;
+      }
+
+      auto entry = iter->pack->find(*path, iter->mountPoint.getNumDirectories());
+      if (nullptr != entry) {
+        pack = iter->pack;
+        return entry;
+      }
+    }
+
+    return nullptr;
+  }
+
+  bool
+  PackFileSystem::find(const Path& fullPath, PackedFileInfo& info) const {
+    SPtr<PackFile> pack;
+    auto entry = findEntry(fullPath, pack);
+    if (nullptr == entry) {
+      return false;
+    }
+
+    info.isDirectory = 0 != (entry->flags & PACK_ENTRY_FLAGS::kDIRECTORY);
+    info.size = entry->size;
+    info.lastModifiedTime = pack->getTimestamp();
+    return true;
+  }
+
+  SPtr<DataStream>
+  PackFileSystem::openFile(const Path& fullPath) const {
+    SPtr<PackFile> pack;
+    auto entry = findEntry(fullPath, pack);
+    if (nullptr == entry) {
+      return nullptr;
+    }
+
+    return PackFile::openEntry(pack, *entry);
+  }
+}
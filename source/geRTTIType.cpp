@@ -31,6 +31,7 @@
 /*****************************************************************************/
 #include "geRTTIType.h"
 #include "geException.h"
+#include "geFrameAlloc.h"
 
 namespace geEngineSDK {
   using std::find_if;
@@ -41,36 +42,87 @@ namespace geEngineSDK {
     }
   }
 
+  const RTTISerializationPlan&
+  RTTITypeBase::getSerializationPlan() {
+    std::call_once(m_planInitFlag, [this]() {
+      buildSerializationPlan();
+    });
+
+    return *m_plan;
+  }
+
+  void
+  RTTITypeBase::buildSerializationPlan() {
+    m_plan = ge_unique_ptr_new<RTTISerializationPlan>();
+    RTTISerializationPlan& plan = *m_plan;
+
+    for (RTTITypeBase* rtti = this; nullptr != rtti; rtti = rtti->getBaseClass()) {
+      RTTISerializationPlan::ClassEntry classEntry;
+      classEntry.rtti = rtti;
+      classEntry.rttiId = rtti->getRTTIId();
+      classEntry.firstField = static_cast<uint32>(plan.fields.size());
+      classEntry.numFields = rtti->getNumFields();
+      plan.classes.push_back(classEntry);
+
+      for (auto field : rtti->m_fields) {
+        if (this == rtti) {
+          const auto fieldIdx = static_cast<uint32>(plan.fields.size());
+          plan.fieldsByName[field->m_name] = fieldIdx;
+          plan.fieldsById[field->m_uniqueId] = fieldIdx;
+        }
+
+        RTTISerializationPlan::FieldEntry fieldEntry;
+        fieldEntry.field = field;
+        fieldEntry.typeSize = field->getTypeSize();
+        fieldEntry.uniqueId = field->m_uniqueId;
+        fieldEntry.type = field->m_type;
+        fieldEntry.isArray = field->m_isVectorType;
+        fieldEntry.hasDynamicSize = field->hasDynamicSize();
+        plan.fields.push_back(fieldEntry);
+      }
+
+      if (rtti->hasSerializationCallbacks()) {
+        plan.hasSerializationCallbacks = true;
+      }
+    }
+  }
+
   RTTIField*
   RTTITypeBase::findField(const String& name) {
-    auto foundElement = find_if(m_fields.begin(),
-                                m_fields.end(),
-                                [&name](RTTIField* x) {
-                                  return x->m_name == name;
-                                });
+    const RTTISerializationPlan& plan = getSerializationPlan();
+    auto foundElement = plan.fieldsByName.find(name);
 
-    if (m_fields.end() == foundElement) {
+    if (plan.fieldsByName.end() == foundElement) {
       GE_EXCEPT(InternalErrorException,
                 "Cannot find a field with the specified name: " + name);
     }
 
-    return *foundElement;
+    return plan.fields[foundElement->second].field;
   }
 
   RTTIField*
   RTTITypeBase::findField(int32 uniqueFieldId) {
-    auto foundElement = find_if(m_fields.begin(),
-                                m_fields.end(),
-                                [&uniqueFieldId](RTTIField* x) {
-                                  return x->m_uniqueId ==
-                                    static_cast<uint16>(uniqueFieldId);
-                                });
-
-    if (m_fields.end() == foundElement) {
+    const RTTISerializationPlan& plan = getSerializationPlan();
+    auto foundElement = plan.fieldsById.find(static_cast<uint16>(uniqueFieldId));
+
+    if (plan.fieldsById.end() == foundElement) {
       return nullptr;
     }
 
-    return *foundElement;
+    return plan.fields[foundElement->second].field;
+  }
+
+  RTTITypeBase*
+  RTTITypeBase::_getInstance(FrameAlloc& alloc) {
+    return hasSerializationCallbacks() ? _clone(alloc) : this;
+  }
+
+  void
+  RTTITypeBase::_releaseInstance(RTTITypeBase* instance, FrameAlloc& alloc) {
+    //Instances of types without callbacks aren't clones
+    if (instance->hasSerializationCallbacks()) {
+      alloc.destruct(instance);
+    }
   }
 
   void
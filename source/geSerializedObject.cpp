@@ -26,6 +26,74 @@ namespace geEngineSDK {
   using std::static_pointer_cast;
 
   namespace detail {
+    /**
+     * @brief Memory arena holding all the nodes of a serialized object tree.
+     *        Allocations are never freed individually, the whole arena goes
+     *        away with the last node that references it.
+     */
+    class SerializedObjectArena
+    {
+     public:
+      SerializedObjectArena() : m_alloc(ARENA_BLOCK_SIZE) {}
+
+      uint8*
+      alloc(SIZE_T amount) {
+        return reinterpret_cast<uint8*>(m_alloc.allocAligned(amount, 16));
+      }
+
+     private:
+      static CONSTEXPR SIZE_T ARENA_BLOCK_SIZE = 64 * 1024;
+
+      FrameAlloc m_alloc;
+    };
+
+    /**
+     * @brief STL allocator that allocates from a SerializedObjectArena. Each
+     *        copy keeps the arena alive, so shared pointers created with it
+     *        hold on to the arena through their control block.
+     */
+    template<class T>
+    class StdSerializedArenaAlloc
+    {
+     public:
+      using value_type = T;
+
+      explicit StdSerializedArenaAlloc(SPtr<SerializedObjectArena> arena)
+        : m_arena(std::move(arena))
+      {}
+
+      template<class U>
+      StdSerializedArenaAlloc(const StdSerializedArenaAlloc<U>& other)
+        : m_arena(other.m_arena)
+      {}
+
+      T*
+      allocate(SIZE_T num) {
+        return reinterpret_cast<T*>(m_arena->alloc(sizeof(T) * num));
+      }
+
+      void
+      deallocate(T*, SIZE_T) {}
+
+      template<class U>
+      bool
+      operator==(const StdSerializedArenaAlloc<U>& other) const {
+        return m_arena == other.m_arena;
+      }
+
+      template<class U>
+      bool
+      operator!=(const StdSerializedArenaAlloc<U>& other) const {
+        return m_arena != other.m_arena;
+      }
+
+     private:
+      template<class U>
+      friend class StdSerializedArenaAlloc;
+
+      SPtr<SerializedObjectArena> m_arena;
+    };
+
     /**
      * @brief Helper class for performing SerializedObject <-> IReflectable
      *        encoding & decoding.
@@ -42,7 +110,8 @@ namespace geEngineSDK {
       SPtr<SerializedObject>
       encode(IReflectable* object,
              bool shallow = false,
-             SerializationContext* context = nullptr);
+             SerializationContext* context = nullptr,
+             bool useArena = false);
 
       /**
        * @brief Decodes an intermediate representation of a serialized object
@@ -80,9 +149,38 @@ namespace geEngineSDK {
       SPtr<SerializedObject>
       encodeEntry(IReflectable* object, bool shallow);
 
+      /**
+       * @brief Creates a new node of the serialized tree, in the arena if
+       *        one is being used.
+       */
+      template<class T, class... Args>
+      SPtr<T>
+      newNode(Args&&... args) {
+        if (nullptr != m_arena) {
+          return std::allocate_shared<T>(StdSerializedArenaAlloc<T>(m_arena),
+                                         std::forward<Args>(args)...);
+        }
+
+        return ge_shared_ptr_new<T>(std::forward<Args>(args)...);
+      }
+
+      /**
+       * @brief Allocates memory for a field value or a data block. Memory
+       *        taken from the arena is not owned by the node using it.
+       */
+      uint8*
+      allocData(SIZE_T size) {
+        if (nullptr != m_arena) {
+          return m_arena->alloc(size);
+        }
+
+        return reinterpret_cast<uint8*>(ge_alloc(size));
+      }
+
       UnorderedMap<const SerializedObject*, ObjectToDecode> m_objectMap;
       SerializationContext* m_context = nullptr;
       FrameAlloc* m_alloc = nullptr;
+      SPtr<SerializedObjectArena> m_arena;
     };
 
     IntermediateSerializer::IntermediateSerializer()
@@ -134,9 +232,19 @@ namespace geEngineSDK {
     SPtr<SerializedObject>
     IntermediateSerializer::encode(IReflectable* object,
                                    bool shallow,
-                                   SerializationContext* context) {
+                                   SerializationContext* context,
+                                   bool useArena) {
       m_context = context;
-      return encodeEntry(object, shallow);
+
+      if (useArena) {
+        m_arena = ge_shared_ptr_new<SerializedObjectArena>();
+      }
+
+      SPtr<SerializedObject> output = encodeEntry(object, shallow);
+
+      //The nodes keep the arena alive from now on
+      m_arena = nullptr;
+      return output;
     }
 
     void
@@ -156,7 +264,7 @@ namespace geEngineSDK {
           continue;
         }
 
-        RTTITypeBase* rttiInstance = rtti->_clone(*m_alloc);
+        RTTITypeBase* rttiInstance = rtti->_getInstance(*m_alloc);
         rttiInstance->onDeserializationStarted(object.get(), m_context);
         rttiInstances.push(rttiInstance);
 
@@ -388,7 +496,7 @@ namespace geEngineSDK {
       while (!rttiInstances.empty()) {
         RTTITypeBase* rttiInstance = rttiInstances.top();
         rttiInstance->onDeserializationEnded(object.get(), m_context);
-        m_alloc->destruct(rttiInstance);
+        RTTITypeBase::_releaseInstance(rttiInstance, *m_alloc);
 
         rttiInstances.pop();
       }
@@ -397,45 +505,49 @@ namespace geEngineSDK {
     SPtr<SerializedObject>
     IntermediateSerializer::encodeEntry(IReflectable* object, bool shallow) {
       FrameStack<RTTITypeBase*> rttiInstances;
-      RTTITypeBase* rtti = object->getRTTI();
+      const RTTISerializationPlan& plan = object->getRTTI()->getSerializationPlan();
 
       const auto cleanup = [&]() {
         while (!rttiInstances.empty()) {
           RTTITypeBase* rttiInstance = rttiInstances.top();
           rttiInstance->onSerializationEnded(object, m_context);
-          m_alloc->destruct(rttiInstance);
+          RTTITypeBase::_releaseInstance(rttiInstance, *m_alloc);
 
           rttiInstances.pop();
         }
       };
 
-      auto output = ge_shared_ptr_new<SerializedObject>();
+      auto output = newNode<SerializedObject>();
+      output->subObjects.reserve(plan.classes.size());
 
       //If an object has base classes, we need to iterate through all of them
-      do {
-        RTTITypeBase* rttiInstance = rtti->_clone(*m_alloc);
+      for (const auto& classEntry : plan.classes) {
+        RTTITypeBase* rttiInstance = classEntry.rtti->_getInstance(*m_alloc);
         rttiInstances.push(rttiInstance);
 
         rttiInstance->onSerializationStarted(object, m_context);
 
         output->subObjects.emplace_back();
         SerializedSubObject& subObject = output->subObjects.back();
-        subObject.typeId = rtti->getRTTIId();
+        subObject.typeId = classEntry.rttiId;
+        subObject.entries.reserve(classEntry.numFields);
 
-        const uint32 numFields = rtti->getNumFields();
-        for (uint32 i = 0; i < numFields; ++i) {
+        const uint32 lastField = classEntry.firstField + classEntry.numFields;
+        for (uint32 i = classEntry.firstField; i < lastField; ++i) {
           SPtr<SerializedInstance> serializedEntry;
 
-          RTTIField* curGenericField = rtti->getField(i);
-          if (curGenericField->m_isVectorType) {
+          const RTTISerializationPlan::FieldEntry& fieldEntry = plan.fields[i];
+          RTTIField* curGenericField = fieldEntry.field;
+          if (fieldEntry.isArray) {
             const uint32 arrayNumElems = curGenericField->getArraySize(rttiInstance, object);
 
-            const auto serializedArray = ge_shared_ptr_new<SerializedArray>();
+            const auto serializedArray = newNode<SerializedArray>();
             serializedArray->numElements = arrayNumElems;
+            serializedArray->entries.reserve(arrayNumElems);
 
             serializedEntry = serializedArray;
 
-            switch (curGenericField->m_type) {
+            switch (fieldEntry.type) {
               case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
               {
                 auto curField = static_cast<RTTIReflectablePtrFieldBase*>(curGenericField);
@@ -484,18 +596,18 @@ namespace geEngineSDK {
 
                 for (uint32 arrIdx = 0; arrIdx < arrayNumElems; ++arrIdx) {
                   uint32 typeSize = 0;
-                  if (curField->hasDynamicSize()) {
+                  if (fieldEntry.hasDynamicSize) {
                     typeSize = curField->getArrayElemDynamicSize(rttiInstance,
                                                                  object,
                                                                  arrIdx);
                   }
                   else {
-                    typeSize = curField->getTypeSize();
+                    typeSize = fieldEntry.typeSize;
                   }
 
-                  const auto serializedField = ge_shared_ptr_new<SerializedField>();
-                  serializedField->value = reinterpret_cast<uint8*>(ge_alloc(typeSize));
-                  serializedField->ownsMemory = true;
+                  const auto serializedField = newNode<SerializedField>();
+                  serializedField->value = allocData(typeSize);
+                  serializedField->ownsMemory = nullptr == m_arena;
                   serializedField->size = typeSize;
 
                   curField->arrayElemToBuffer(rttiInstance,
@@ -521,7 +633,7 @@ namespace geEngineSDK {
             }
           }
           else {
-            switch (curGenericField->m_type) {
+            switch (fieldEntry.type) {
               case SERIALIZABLE_FIELD_TYPE::kReflectablePtr:
               {
                 auto curField = static_cast<RTTIReflectablePtrFieldBase*>(curGenericField);
@@ -548,16 +660,16 @@ namespace geEngineSDK {
                 auto curField = static_cast<RTTIPlainFieldBase*>(curGenericField);
 
                 uint32 typeSize = 0;
-                if (curField->hasDynamicSize()) {
+                if (fieldEntry.hasDynamicSize) {
                   typeSize = curField->getDynamicSize(rttiInstance, object);
                 }
                 else {
-                  typeSize = curField->getTypeSize();
+                  typeSize = fieldEntry.typeSize;
                 }
 
-                const auto serializedField = ge_shared_ptr_new<SerializedField>();
-                serializedField->value = reinterpret_cast<uint8*>(ge_alloc(typeSize));
-                serializedField->ownsMemory = true;
+                const auto serializedField = newNode<SerializedField>();
+                serializedField->value = allocData(typeSize);
+                serializedField->ownsMemory = nullptr == m_arena;
                 serializedField->size = typeSize;
 
                 curField->toBuffer(rttiInstance, object, serializedField->value);
@@ -573,13 +685,14 @@ namespace geEngineSDK {
                 uint32 dataBlockSize = 0;
                 auto blockStream = curField->getValue(rttiInstance, object, dataBlockSize);
 
-                auto dataBlockBuffer = reinterpret_cast<uint8*>(ge_alloc(dataBlockSize));
+                auto dataBlockBuffer = allocData(dataBlockSize);
                 blockStream->read(dataBlockBuffer, dataBlockSize);
 
-                SPtr<DataStream> stream = ge_shared_ptr_new<MemoryDataStream>
-                                            (dataBlockBuffer, dataBlockSize);
+                SPtr<DataStream> stream = newNode<MemoryDataStream>(dataBlockBuffer,
+                                                                    dataBlockSize,
+                                                                    nullptr == m_arena);
 
-                auto serializedDataBlock = ge_shared_ptr_new<SerializedDataBlock>();
+                auto serializedDataBlock = newNode<SerializedDataBlock>();
                 serializedDataBlock->stream = stream;
                 serializedDataBlock->offset = 0;
 
@@ -599,15 +712,12 @@ namespace geEngineSDK {
           }
 
           SerializedEntry entry;
-          entry.fieldId = curGenericField->m_uniqueId;
+          entry.fieldId = fieldEntry.uniqueId;
           entry.serialized = serializedEntry;
 
-          subObject.entries.insert(make_pair(curGenericField->m_uniqueId, entry));
+          subObject.entries.insert(make_pair(fieldEntry.uniqueId, entry));
         }
-
-        rtti = rtti->getBaseClass();
-
-      } while (rtti != nullptr); // Repeat until we reach the top of the inheritance hierarchy
+      }
 
       cleanup();
 
@@ -618,9 +728,10 @@ namespace geEngineSDK {
   SPtr<SerializedObject>
   SerializedObject::create(IReflectable& obj,
                            bool shallow,
-                           SerializationContext* context) {
+                           SerializationContext* context,
+                           bool useArena) {
     detail::IntermediateSerializer is;
-    return is.encode(&obj, shallow, context);
+    return is.encode(&obj, shallow, context, useArena);
   }
 
   SPtr<IReflectable>
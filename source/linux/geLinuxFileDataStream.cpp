@@ -0,0 +1,374 @@
+/*****************************************************************************/
+/**
+ * @file    geLinuxFileDataStream.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Data stream for files, built directly on the Linux file API.
+ *
+ * Data stream for files built on open/pread/pwrite. The stream keeps its own
+ * position, so no seek system calls are needed, and serves small reads and
+ * writes from an aligned buffer.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "linux/geLinuxFileDataStream.h"
+
+#if USING(GE_PLATFORM_LINUX)
+
+#include "geDebug.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace geEngineSDK {
+  using std::max;
+  using std::min;
+
+  LinuxFileDataStream::LinuxFileDataStream(const Path& filePath,
+                                           ACCESS_MODE::E accessMode,
+                                           const LinuxFileStreamOptions& options)
+    : DataStream(static_cast<uint16>(accessMode)),
+      m_path(filePath),
+      m_options(options) {
+    const bool readable = (accessMode & ACCESS_MODE::kREAD) != 0;
+    const bool writeable = (accessMode & ACCESS_MODE::kWRITE) != 0;
+
+    //Same semantics as the standard file stream: write only streams truncate
+    int32 flags = O_CLOEXEC;
+    if (readable && writeable) {
+      flags |= O_RDWR;
+    }
+    else if (writeable) {
+      flags |= O_WRONLY | O_CREAT | O_TRUNC;
+    }
+    else {
+      flags |= O_RDONLY;
+    }
+
+    m_options.alignment = max(m_options.alignment, 1u);
+    if (0 != (m_options.alignment & (m_options.alignment - 1))) {
+      GE_LOG(kWarning,
+             FileSystem,
+             "File stream alignment must be a power of two: {0}",
+             m_options.alignment);
+      m_options.alignment = 4096;
+    }
+
+    //The buffer must span whole aligned blocks for O_DIRECT reads
+    m_options.bufferSize = max(m_options.bufferSize, m_options.alignment);
+    m_options.bufferSize = (m_options.bufferSize + m_options.alignment - 1) &
+                           ~(m_options.alignment - 1);
+
+    const String platformPath = filePath.toPlatformString();
+    if (m_options.directIO && !writeable) {
+      m_fd = ::open(platformPath.c_str(), flags | O_DIRECT, 0644);
+      if (-1 != m_fd) {
+        m_directIO = true;
+      }
+      else if (EINVAL == errno) {
+        GE_LOG(kWarning,
+               FileSystem,
+               "Direct I/O isn't supported for: {0}. Using buffered reads.",
+               filePath);
+      }
+    }
+
+    if (-1 == m_fd) {
+      m_fd = ::open(platformPath.c_str(), flags, 0644);
+    }
+
+    if (-1 == m_fd) {
+      GE_LOG(kWarning, FileSystem, "Cannot open file: " + filePath.toString());
+      return;
+    }
+
+    struct stat fileStat;
+    if (0 == ::fstat(m_fd, &fileStat)) {
+      m_size = static_cast<SIZE_T>(fileStat.st_size);
+    }
+
+    if (readable && !m_directIO && 0 != m_options.readAhead) {
+      ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    m_buffer = reinterpret_cast<uint8*>(ge_alloc_aligned(m_options.bufferSize,
+                                                         m_options.alignment));
+  }
+
+  LinuxFileDataStream::~LinuxFileDataStream() {
+    close();
+  }
+
+  SIZE_T
+  LinuxFileDataStream::read(void* buf, SIZE_T count) {
+    if (-1 == m_fd || !isReadable()) {
+      return 0;
+    }
+
+    if (m_bufferDirty) {
+      flush();
+    }
+
+    uint8* dest = static_cast<uint8*>(buf);
+    SIZE_T totalRead = 0;
+    while (totalRead < count) {
+      const SIZE_T remaining = count - totalRead;
+
+      //Serve as much as possible from the buffer
+      if (m_position >= m_bufferOffset &&
+          m_position < m_bufferOffset + m_bufferSize) {
+        const SIZE_T available = m_bufferOffset + m_bufferSize - m_position;
+        const SIZE_T toCopy = min(available, remaining);
+        memcpy(dest + totalRead, m_buffer + (m_position - m_bufferOffset), toCopy);
+        m_position += toCopy;
+        totalRead += toCopy;
+        continue;
+      }
+
+      //Large reads go straight to the destination when the layout allows it
+      SIZE_T directSize = 0;
+      if (remaining >= m_options.bufferSize) {
+        if (!m_directIO) {
+          directSize = remaining;
+        }
+        else if (0 == (reinterpret_cast<uintptr_t>(dest + totalRead) &
+                       (m_options.alignment - 1)) &&
+                 0 == (m_position & (m_options.alignment - 1))) {
+          directSize = remaining & ~static_cast<SIZE_T>(m_options.alignment - 1);
+        }
+      }
+
+      if (0 != directSize) {
+        hintReadAhead(m_position, directSize);
+        const SIZE_T bytesRead = readDirect(dest + totalRead, directSize, m_position);
+        m_position += bytesRead;
+        totalRead += bytesRead;
+        if (bytesRead < directSize) {
+          break;
+        }
+        continue;
+      }
+
+      fillBuffer(m_position);
+      if (m_position < m_bufferOffset ||
+          m_position >= m_bufferOffset + m_bufferSize) {
+        break;
+      }
+    }
+
+    if (totalRead < count) {
+      m_eof = true;
+    }
+
+    return totalRead;
+  }
+
+  SIZE_T
+  LinuxFileDataStream::write(const void* buf, SIZE_T count) {
+    if (-1 == m_fd || !isWriteable()) {
+      return 0;
+    }
+
+    //Writes only extend the buffer if they continue the pending data
+    if (m_bufferDirty && m_position != m_bufferOffset + m_bufferSize) {
+      flush();
+    }
+    else if (!m_bufferDirty) {
+      m_bufferSize = 0;
+    }
+
+    SIZE_T written = 0;
+    if (count >= m_options.bufferSize) {
+      flush();
+      written = writeDirect(static_cast<const uint8*>(buf), count, m_position);
+    }
+    else {
+      if (m_bufferSize + count > m_options.bufferSize) {
+        flush();
+      }
+
+      if (!m_bufferDirty) {
+        m_bufferOffset = m_position;
+        m_bufferSize = 0;
+        m_bufferDirty = true;
+      }
+
+      memcpy(m_buffer + m_bufferSize, buf, count);
+      m_bufferSize += count;
+      written = count;
+    }
+
+    m_position += written;
+    m_size = max(m_size, m_position);
+    return written;
+  }
+
+  void
+  LinuxFileDataStream::skip(SIZE_T count) {
+    //Negative values wrap around, moving the position back
+    m_position += count;
+    m_eof = false;
+  }
+
+  void
+  LinuxFileDataStream::seek(SIZE_T pos) {
+    m_position = pos;
+    m_eof = false;
+  }
+
+  SIZE_T
+  LinuxFileDataStream::tell() const {
+    return m_position;
+  }
+
+  bool
+  LinuxFileDataStream::isEOF() const {
+    return m_eof;
+  }
+
+  SPtr<DataStream>
+  LinuxFileDataStream::clone(bool copyData) const {
+    GE_UNREFERENCED_PARAMETER(copyData);
+    return ge_shared_ptr_new<LinuxFileDataStream>(m_path,
+                                                  static_cast<ACCESS_MODE::E>(getAccessMode()),
+                                                  m_options);
+  }
+
+  void
+  LinuxFileDataStream::close() {
+    if (-1 == m_fd) {
+      return;
+    }
+
+    flush();
+    ::close(m_fd);
+    m_fd = -1;
+
+    ge_free_aligned(m_buffer);
+    m_buffer = nullptr;
+    m_bufferSize = 0;
+  }
+
+  void
+  LinuxFileDataStream::flush() {
+    if (!m_bufferDirty) {
+      return;
+    }
+
+    const SIZE_T written = writeDirect(m_buffer, m_bufferSize, m_bufferOffset);
+    if (written != m_bufferSize) {
+      GE_LOG(kError,
+             FileSystem,
+             "Failed to write {0} bytes to file: {1}",
+             m_bufferSize - written,
+             m_path);
+    }
+
+    m_bufferDirty = false;
+    m_bufferSize = 0;
+  }
+
+  void
+  LinuxFileDataStream::fillBuffer(SIZE_T offset) {
+    //O_DIRECT reads must start at an aligned offset
+    const SIZE_T fillOffset = m_directIO ?
+      offset & ~static_cast<SIZE_T>(m_options.alignment - 1) : offset;
+
+    hintReadAhead(fillOffset, m_options.bufferSize);
+    m_bufferOffset = fillOffset;
+    m_bufferSize = readDirect(m_buffer, m_options.bufferSize, fillOffset);
+  }
+
+  SIZE_T
+  LinuxFileDataStream::readDirect(uint8* buf, SIZE_T count, SIZE_T offset) {
+    SIZE_T totalRead = 0;
+    while (totalRead < count) {
+      const ssize_t bytesRead = ::pread(m_fd,
+                                        buf + totalRead,
+                                        count - totalRead,
+                                        static_cast<off_t>(offset + totalRead));
+      if (bytesRead > 0) {
+        totalRead += static_cast<SIZE_T>(bytesRead);
+        continue;
+      }
+
+      if (-1 == bytesRead && EINTR == errno) {
+        continue;
+      }
+
+      if (-1 == bytesRead) {
+        GE_LOG(kError, FileSystem, "Failed to read from file: {0}", m_path);
+      }
+      break;
+    }
+
+    return totalRead;
+  }
+
+  SIZE_T
+  LinuxFileDataStream::writeDirect(const uint8* buf, SIZE_T count, SIZE_T offset) {
+    SIZE_T totalWritten = 0;
+    while (totalWritten < count) {
+      const ssize_t bytesWritten = ::pwrite(m_fd,
+                                            buf + totalWritten,
+                                            count - totalWritten,
+                                            static_cast<off_t>(offset + totalWritten));
+      if (bytesWritten > 0) {
+        totalWritten += static_cast<SIZE_T>(bytesWritten);
+        continue;
+      }
+
+      if (-1 == bytesWritten && EINTR == errno) {
+        continue;
+      }
+
+      break;
+    }
+
+    return totalWritten;
+  }
+
+  void
+  LinuxFileDataStream::hintReadAhead(SIZE_T offset, SIZE_T count) {
+    //O_DIRECT reads don't go through the page cache the hints would fill
+    if (m_directIO || 0 == m_options.readAhead) {
+      return;
+    }
+
+    const bool sequential = offset == m_lastReadEnd;
+    m_lastReadEnd = offset + count;
+    if (!sequential) {
+      m_readAheadEnd = 0;
+      return;
+    }
+
+    //Reads as big as the window already keep the device busy on their own,
+    //hinting them only adds work to the kernel read ahead
+    if (count >= m_options.readAhead) {
+      m_readAheadEnd = m_lastReadEnd;
+      return;
+    }
+
+    //Keep the kernel a window ahead of the reads, refreshing it at half way
+    if (m_lastReadEnd + m_options.readAhead / 2 > m_readAheadEnd) {
+      const SIZE_T start = max(m_readAheadEnd, m_lastReadEnd);
+      const SIZE_T end = m_lastReadEnd + m_options.readAhead;
+      ::posix_fadvise(m_fd,
+                      static_cast<off_t>(start),
+                      static_cast<off_t>(end - start),
+                      POSIX_FADV_WILLNEED);
+      m_readAheadEnd = end;
+    }
+  }
+}
+
+#endif
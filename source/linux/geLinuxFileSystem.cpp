@@ -0,0 +1,539 @@
+/*****************************************************************************/
+/**
+ * @file    geLinuxFileSystem.cpp
+ * @author  Samuel Prince (samuel.prince.quezada@gmail.com)
+ * @date    2026/10/16
+ * @brief   Utility class for dealing with Linux files.
+ *
+ * Utility class for dealing with Linux files. Works directly with the UTF-8
+ * paths the kernel expects, and answers each query with a single statx call.
+ *
+ * @bug     No known bugs.
+ */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/**
+ * Includes
+ */
+/*****************************************************************************/
+#include "geFileSystem.h"
+
+#if USING(GE_PLATFORM_LINUX)
+
+#include "geDataStream.h"
+#include "geDebug.h"
+#include "geFileWatcher.h"
+#include "gePackFile.h"
+#include "linux/geLinuxFileDataStream.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace geEngineSDK {
+  using std::time_t;
+  using std::function;
+
+  /**
+   * @brief Defined in geFileSystem.cpp, shared by all the platforms.
+   */
+  bool
+  sys_getCachedStat(const Path& fullPath, FileStat& stat);
+
+  void
+  sys_invalidateCachedStat(const Path& fullPath);
+
+  bool
+  sys_findPackedFile(const Path& fullPath, PackedFileInfo& info);
+
+  /**
+   * @brief Subset of the state of a file read by linux_stat().
+   */
+  struct LinuxStat
+  {
+    uint32 mode = 0;
+    uint64 size = 0;
+    time_t lastModifiedTime = 0;
+  };
+
+  /**
+   * @brief Reads the state of a file, following symbolic links. Only the
+   *        fields in @p mask (STATX_*) are requested from the file system.
+   *        Returns false if the file doesn't exist or can't be accessed.
+   */
+  bool
+  linux_stat(const String& path, uint32 mask, LinuxStat& stat) {
+    //Kernels older than 4.11, and some sandboxes, don't have statx
+    static std::atomic<bool> s_hasStatx(true);
+
+    if (s_hasStatx.load(std::memory_order_relaxed)) {
+      struct statx info;
+      if (0 == statx(AT_FDCWD, path.c_str(), AT_STATX_SYNC_AS_STAT, mask, &info)) {
+        stat.mode = info.stx_mode;
+        stat.size = info.stx_size;
+        stat.lastModifiedTime = static_cast<time_t>(info.stx_mtime.tv_sec);
+        return true;
+      }
+
+      if (ENOSYS != errno && EPERM != errno) {
+        return false;
+      }
+      s_hasStatx.store(false, std::memory_order_relaxed);
+    }
+
+    struct stat info;
+    if (0 != fstatat(AT_FDCWD, path.c_str(), &info, 0)) {
+      return false;
+    }
+
+    stat.mode = info.st_mode;
+    stat.size = static_cast<uint64>(info.st_size);
+    stat.lastModifiedTime = info.st_mtime;
+    return true;
+  }
+
+  /**
+   * @brief Returns true for anything that isn't a directory or a device.
+   */
+  bool
+  linux_isFile(uint32 mode) {
+    return !S_ISDIR(mode) && !S_ISCHR(mode) && !S_ISBLK(mode);
+  }
+
+  /**
+   * @brief Builds a Path from a directory, appending the separator if it's
+   *        missing so it's parsed as a directory.
+   */
+  Path
+  linux_directoryPath(String path) {
+    if (path.empty() || '/' != path.back()) {
+      path += '/';
+    }
+    return Path(path);
+  }
+
+  /**
+   * @brief Creates a directory and any of its parents that is missing.
+   *        Parents are created relative to the deepest one that exists, so
+   *        the full path is only resolved once.
+   */
+  bool
+  linux_createDirectories(String path) {
+    while (path.size() > 1 && '/' == path.back()) {
+      path.pop_back();
+    }
+
+    if (path.empty() ||
+        0 == mkdirat(AT_FDCWD, path.c_str(), 0777) ||
+        EEXIST == errno) {
+      return true;
+    }
+
+    if (ENOENT != errno) {
+      return false;
+    }
+
+    //Look for the deepest parent that exists
+    SIZE_T firstMissing = 0;
+    int32 parentFd = -1;
+    for (SIZE_T end = path.size(); -1 == parentFd;) {
+      const SIZE_T separator = path.rfind('/', end - 1);
+      if (String::npos == separator || 0 == separator) {
+        parentFd = ::open(0 == separator ? "/" : ".",
+                          O_PATH | O_DIRECTORY | O_CLOEXEC);
+        firstMissing = String::npos == separator ? 0 : 1;
+        break;
+      }
+
+      parentFd = ::open(path.substr(0, separator).c_str(),
+                        O_PATH | O_DIRECTORY | O_CLOEXEC);
+      if (-1 == parentFd && ENOENT != errno) {
+        return false;
+      }
+
+      firstMissing = separator + 1;
+      end = separator;
+    }
+
+    if (-1 == parentFd) {
+      return false;
+    }
+
+    //Create the missing ones below it
+    bool created = true;
+    while (created && firstMissing < path.size()) {
+      SIZE_T separator = path.find('/', firstMissing);
+      if (String::npos == separator) {
+        separator = path.size();
+      }
+
+      const String name = path.substr(firstMissing, separator - firstMissing);
+      firstMissing = separator + 1;
+      if (name.empty()) {
+        continue;
+      }
+
+      created = 0 == mkdirat(parentFd, name.c_str(), 0777) || EEXIST == errno;
+      if (created) {
+        const int32 dirFd = openat(parentFd,
+                                   name.c_str(),
+                                   O_PATH | O_DIRECTORY | O_CLOEXEC);
+        created = -1 != dirFd;
+        ::close(parentFd);
+        parentFd = dirFd;
+      }
+    }
+
+    if (-1 != parentFd) {
+      ::close(parentFd);
+    }
+    return created;
+  }
+
+  /**
+   * @brief Removes an entry of a directory and, if it's a directory,
+   *        everything inside it. Entries are removed relative to the
+   *        directory they are in, so no path needs to be built.
+   * @param[in] parentFd  Directory the entry is in.
+   * @param[in] name  Name of the entry.
+   * @param[in] isDirectory True if the entry is known to be a directory.
+   */
+  bool
+  linux_removeAll(int32 parentFd, const ANSICHAR* name, bool isDirectory) {
+    if (!isDirectory) {
+      if (0 == unlinkat(parentFd, name, 0) || ENOENT == errno) {
+        return true;
+      }
+      if (EISDIR != errno) {
+        return false;
+      }
+    }
+
+    const int32 dirFd = openat(parentFd,
+                               name,
+                               O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (-1 == dirFd) {
+      return ENOENT == errno;
+    }
+
+    DIR* dir = fdopendir(dirFd);
+    if (nullptr == dir) {
+      ::close(dirFd);
+      return false;
+    }
+
+    bool removed = true;
+    while (dirent* entry = readdir(dir)) {
+      if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, "..")) {
+        continue;
+      }
+
+      removed = linux_removeAll(dirFd, entry->d_name, DT_DIR == entry->d_type) &&
+                removed;
+    }
+    closedir(dir);
+
+    return (0 == unlinkat(parentFd, name, AT_REMOVEDIR) || ENOENT == errno) &&
+           removed;
+  }
+
+  /**
+   * @brief Copies a file without moving its data through user space. Tries
+   *        a reflink first, which shares the data on copy-on-write file
+   *        systems, then copy_file_range and finally sendfile. Returns false
+   *        if none of them could copy the file.
+   */
+  bool
+  linux_copyFile(const String& from, const String& to) {
+    const int32 srcFd = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (-1 == srcFd) {
+      return false;
+    }
+
+    struct stat info;
+    if (0 != fstat(srcFd, &info) || !S_ISREG(info.st_mode)) {
+      ::close(srcFd);
+      return false;
+    }
+
+    const int32 dstFd = ::open(to.c_str(),
+                               O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                               info.st_mode & 07777);
+    if (-1 == dstFd) {
+      ::close(srcFd);
+      return false;
+    }
+
+    const loff_t size = info.st_size;
+    loff_t srcOffset = 0;
+    loff_t dstOffset = 0;
+    if (0 == ioctl(dstFd, FICLONE, srcFd)) {
+      srcOffset = size;
+    }
+
+    //Fails across file systems on older kernels, and on some file systems
+    while (srcOffset < size) {
+      const ssize_t copied = copy_file_range(srcFd, &srcOffset,
+                                             dstFd, &dstOffset,
+                                             static_cast<SIZE_T>(size - srcOffset),
+                                             0);
+      if (copied <= 0 && !(-1 == copied && EINTR == errno)) {
+        break;
+      }
+    }
+
+    //sendfile writes at the current position of the destination
+    if (srcOffset < size && -1 != lseek(dstFd, dstOffset, SEEK_SET)) {
+      while (srcOffset < size) {
+        const ssize_t sent = sendfile(dstFd,
+                                      srcFd,
+                                      &srcOffset,
+                                      static_cast<SIZE_T>(size - srcOffset));
+        if (sent <= 0 && !(-1 == sent && EINTR == errno)) {
+          break;
+        }
+      }
+    }
+
+    ::close(srcFd);
+    return 0 == ::close(dstFd) && srcOffset >= size;
+  }
+
+  SPtr<DataStream>
+  FileSystem::openFile(const Path& fullPath,
+                       bool readOnly,
+                       FILE_STREAM_TYPE::E streamType) {
+    //Mounted packs are read only
+    if (readOnly && PackFileSystem::isStarted()) {
+      SPtr<DataStream> packedFile = PackFileSystem::instance().openFile(fullPath);
+      if (packedFile) {
+        return packedFile;
+      }
+    }
+
+    LinuxStat stat;
+    if (!linux_stat(fullPath.toString(), STATX_TYPE, stat) || !linux_isFile(stat.mode)) {
+      GE_LOG(kWarning,
+             Platform,
+             "Attempting to open a file that doesn't exist: {0}",
+             fullPath);
+      return nullptr;
+    }
+
+    ACCESS_MODE::E accessMode = ACCESS_MODE::kREAD;
+    if (!readOnly) {
+      accessMode = static_cast<ACCESS_MODE::E>(accessMode |
+                     static_cast<uint32>(ACCESS_MODE::kWRITE));
+    }
+
+    if (FILE_STREAM_TYPE::kSTANDARD != streamType) {
+      LinuxFileStreamOptions options;
+      options.directIO = FILE_STREAM_TYPE::kNATIVE_DIRECT == streamType;
+      return ge_shared_ptr_new<LinuxFileDataStream>(fullPath, accessMode, options);
+    }
+
+    return ge_shared_ptr_new<FileDataStream>(fullPath, accessMode, true);
+  }
+
+  uint64
+  FileSystem::getFileSize(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.size;
+    }
+
+    FileStat cachedStat;
+    if (sys_getCachedStat(fullPath, cachedStat)) {
+      return cachedStat.isRegularFile ? cachedStat.size : 0;
+    }
+
+    LinuxStat stat;
+    if (!linux_stat(fullPath.toString(), STATX_TYPE | STATX_SIZE, stat) ||
+        !S_ISREG(stat.mode)) {
+      return 0;
+    }
+
+    return stat.size;
+  }
+
+  bool
+  FileSystem::exists(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return true;
+    }
+
+    FileStat cachedStat;
+    if (sys_getCachedStat(fullPath, cachedStat)) {
+      return cachedStat.exists;
+    }
+
+    LinuxStat stat;
+    return linux_stat(fullPath.toString(), 0, stat);
+  }
+
+  bool
+  FileSystem::isFile(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return !packedInfo.isDirectory;
+    }
+
+    FileStat cachedStat;
+    if (sys_getCachedStat(fullPath, cachedStat)) {
+      return cachedStat.exists && !cachedStat.isDirectory;
+    }
+
+    LinuxStat stat;
+    return linux_stat(fullPath.toString(), STATX_TYPE, stat) && linux_isFile(stat.mode);
+  }
+
+  bool
+  FileSystem::isDirectory(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.isDirectory;
+    }
+
+    FileStat cachedStat;
+    if (sys_getCachedStat(fullPath, cachedStat)) {
+      return cachedStat.isDirectory;
+    }
+
+    LinuxStat stat;
+    return linux_stat(fullPath.toString(), STATX_TYPE, stat) && S_ISDIR(stat.mode);
+  }
+
+  void
+  FileSystem::createDir(const Path& fullPath) {
+    //For files, all the directories up to their parent are created
+    const Path dirPath = fullPath.isFile() ? fullPath.getDirectory() : fullPath;
+    if (!linux_createDirectories(dirPath.toString())) {
+      GE_LOG(kWarning,
+             FileSystem,
+             "Failed to create directory \"{0}\". Error: {1}",
+             dirPath, String(strerror(errno)));
+    }
+
+    //Any of the parents created could be cached as missing
+    sys_invalidateCachedStat(fullPath);
+    for (Path parent = fullPath.getParent(); 0 != parent.getNumDirectories();) {
+      sys_invalidateCachedStat(parent);
+      parent = parent.getParent();
+    }
+  }
+
+  time_t
+  FileSystem::getLastModifiedTime(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.lastModifiedTime;
+    }
+
+    FileStat cachedStat;
+    if (sys_getCachedStat(fullPath, cachedStat)) {
+      return cachedStat.isRegularFile ? cachedStat.lastModifiedTime : 0;
+    }
+
+    LinuxStat stat;
+    if (!linux_stat(fullPath.toString(), STATX_TYPE | STATX_MTIME, stat) ||
+        !S_ISREG(stat.mode)) {
+      return 0;
+    }
+
+    return stat.lastModifiedTime;
+  }
+
+  Path
+  FileSystem::getWorkingDirectoryPath() {
+    String buffer(256, '\0');
+    while (nullptr == getcwd(&buffer[0], buffer.size())) {
+      if (ERANGE != errno) {
+        return Path::BLANK;
+      }
+      buffer.resize(buffer.size() * 2);
+    }
+
+    buffer.resize(strlen(buffer.c_str()));
+    return linux_directoryPath(std::move(buffer));
+  }
+
+  Path
+  FileSystem::getTempDirectoryPath() {
+    //Same variables, and order, std::filesystem::temp_directory_path uses
+    for (auto variable : { "TMPDIR", "TMP", "TEMP", "TEMPDIR" }) {
+      const ANSICHAR* value = getenv(variable);
+      if (nullptr != value && '\0' != value[0]) {
+        return linux_directoryPath(value);
+      }
+    }
+
+    return linux_directoryPath("/tmp");
+  }
+
+  void
+  FileSystem::copyFile(const Path& from, const Path& to) {
+    if (!linux_copyFile(from.toString(), to.toString())) {
+      GE_LOG(kWarning,
+             FileSystem,
+             "Failed to copy file from \"{0}\" to \"{1}\". Error: {2}",
+             from.toString(), to.toString(), String(strerror(errno)));
+    }
+
+    sys_invalidateCachedStat(to);
+  }
+
+  void
+  FileSystem::removeFile(const Path& path) {
+    //Directories are removed with all their contents
+    if (!linux_removeAll(AT_FDCWD, path.toString().c_str(), false)) {
+      GE_LOG(kWarning,
+             FileSystem,
+             "Failed to remove \"{0}\". Error: {1}",
+             path, String(strerror(errno)));
+    }
+
+    sys_invalidateCachedStat(path);
+  }
+
+  void
+  FileSystem::moveFile(const Path& oldPath, const Path& newPath) {
+    const String fromPath = oldPath.toString();
+    const String toPath = newPath.toString();
+
+    if (0 != renameat2(AT_FDCWD, fromPath.c_str(), AT_FDCWD, toPath.c_str(), 0)) {
+      if (EXDEV == errno) {
+        //Renames can't cross file systems, the file is copied instead
+        if (linux_copyFile(fromPath, toPath)) {
+          linux_removeAll(AT_FDCWD, fromPath.c_str(), false);
+        }
+        else {
+          GE_LOG(kWarning,
+                 FileSystem,
+                 "Failed to move \"{0}\" to \"{1}\". Error: {2}",
+                 oldPath, newPath, String(strerror(errno)));
+        }
+      }
+      else if (ENOENT != errno) {
+        GE_LOG(kWarning,
+               FileSystem,
+               "Failed to move \"{0}\" to \"{1}\". Error: {2}",
+               oldPath, newPath, String(strerror(errno)));
+      }
+    }
+
+    sys_invalidateCachedStat(oldPath);
+    sys_invalidateCachedStat(newPath);
+  }
+}
+
+#endif // USING(GE_PLATFORM_LINUX)
@@ -18,18 +18,25 @@
 /*****************************************************************************/
 #include "geFileSystem.h"
 
-#if !USING(GE_USE_GENERIC_FILESYSTEM)
+#if USING(GE_PLATFORM_WINDOWS)
 
 #include "geException.h"
 #include "geDataStream.h"
 #include "geDebug.h"
 #include "geUnicode.h"
+#include "gePackFile.h"
 #include "Win32/geMinWindows.h"
 
 namespace geEngineSDK {
   using std::time_t;
   using std::function;
 
+  /**
+   * @brief Defined in geFileSystem.cpp, shared by all the platforms.
+   */
+  bool
+  sys_findPackedFile(const Path& fullPath, PackedFileInfo& info);
+
   void
   win32_handleError(DWORD error, const WString& path) {
     switch (error)
@@ -244,7 +251,20 @@ namespace geEngineSDK {
   }
 
   SPtr<DataStream>
-  FileSystem::openFile(const Path& fullPath, bool readOnly) {
+  FileSystem::openFile(const Path& fullPath,
+                       bool readOnly,
+                       FILE_STREAM_TYPE::E streamType) {
+    //There is no native file stream for Windows yet
+    GE_UNREFERENCED_PARAMETER(streamType);
+
+    //Mounted packs are read only
+    if (readOnly && PackFileSystem::isStarted()) {
+      SPtr<DataStream> packedFile = PackFileSystem::instance().openFile(fullPath);
+      if (packedFile) {
+        return packedFile;
+      }
+    }
+
     WString pathWString = UTF8::toWide(fullPath.toString());
     const UNICHAR* pathString = pathWString.c_str();
 
@@ -267,22 +287,42 @@ namespace geEngineSDK {
 
   uint64
   FileSystem::getFileSize(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.size;
+    }
+
     return win32_getFileSize(UTF8::toWide(fullPath.toString()));
   }
   
   bool
   FileSystem::exists(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return true;
+    }
+
     return win32_pathExists(UTF8::toWide(fullPath.toString()));
   }
 
   bool
   FileSystem::isFile(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return !packedInfo.isDirectory;
+    }
+
     WString pathStr = UTF8::toWide(fullPath.toString());
     return win32_pathExists(pathStr) && win32_isFile(pathStr);
   }
 
   bool
   FileSystem::isDirectory(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.isDirectory;
+    }
+
     WString pathStr = UTF8::toWide(fullPath.toString());
     return win32_pathExists(pathStr) && win32_isDirectory(pathStr);
   }
@@ -429,6 +469,11 @@ namespace geEngineSDK {
 
   time_t
   FileSystem::getLastModifiedTime(const Path& fullPath) {
+    PackedFileInfo packedInfo;
+    if (sys_findPackedFile(fullPath, packedInfo)) {
+      return packedInfo.lastModifiedTime;
+    }
+
     return win32_getLastModifiedTime(UTF8::toWide(fullPath.toString()));
   }
 
@@ -479,4 +524,4 @@ namespace geEngineSDK {
   }
 }
 
-#endif  // !USING(GE_USE_GENERIC_FILESYSTEM)
\ No newline at end of file
+#endif  // USING(GE_PLATFORM_WINDOWS)
\ No newline at end of file